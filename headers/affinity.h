@@ -0,0 +1,102 @@
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dataset.h"
+#include "narrow.h"
+
+/**
+ * The largest number of a cpu, and of NUMA nodes, the topology can hold.
+ */
+#define AFFINITY_MAX_CPUS 1024
+#define AFFINITY_MAX_NODES 64
+
+/**
+ * Where the points read by the calculating threads are placed on a machine with several NUMA nodes.
+ *
+ * - AFFINITY_NUMA_NONE : The points stay where the main thread loaded them.
+ * - AFFINITY_NUMA_REPLICATE : Each node has it's own copy of the points, the workers read the one of their node.
+ * - AFFINITY_NUMA_PARTITION : One copy of the points, each node holding the pages of a contiguous part of them.
+ */
+typedef enum {
+    AFFINITY_NUMA_NONE,
+    AFFINITY_NUMA_REPLICATE,
+    AFFINITY_NUMA_PARTITION
+} affinity_numa_t;
+
+/**
+ * The NUMA nodes of the machine and the cpus the threads are pinned on.
+ *
+ * @param nbOfNodes (uint32_t) : The number of nodes.
+ * @param nodeCpus (uint32_t *) : The cpus of the nodes, those of the node n being from nodeFirst[n] to
+ *                                nodeFirst[n + 1] - 1.
+ * @param nodeFirst (uint32_t *) : The position of the first cpu of each node in nodeCpus, nbOfNodes + 1 of them.
+ * @param nodeOfCpu (uint32_t *) : The node of each cpu, by it's number.
+ * @param simulated (bool) : true if the nodes were given instead of read from the machine, their cpus may not exist.
+ * @param workerCpus (uint32_t *) : The cpu of each worker of the pool, modulo nbOfWorkerCpus, NULL if they are not
+ *                                  pinned.
+ * @param nbOfWorkerCpus (uint32_t) : The number of cpus of the workers.
+ * @param writerCpus (uint32_t *) : The cpus the output-writer thread may run on, NULL if it's not pinned.
+ * @param nbOfWriterCpus (uint32_t) : The number of cpus of the output-writer thread.
+ * @param warned (uint32_t) : Set by the first thread that could not be pinned, so it's only told once.
+ *
+ * Note that there are specific function for this data structure.
+ *
+ *      - Check the arguments   = <affinity_check>.
+ *      - Initialize            = <affinity_init>.
+ *      - Pin a thread          = <affinity_pinWorker> or <affinity_pinWriter>.
+ *      - Node of a worker      = <affinity_nodeOfWorker>.
+ *      - Place the points      = <affinity_place>.
+ *      - Destroy               = <affinity_destroy>.
+ */
+typedef struct {
+    uint32_t nbOfNodes;
+    uint32_t * nodeCpus;
+    uint32_t * nodeFirst;
+    uint32_t nodeOfCpu[AFFINITY_MAX_CPUS];
+    bool simulated;
+    uint32_t * workerCpus;
+    uint32_t nbOfWorkerCpus;
+    uint32_t * writerCpus;
+    uint32_t nbOfWriterCpus;
+    uint32_t warned;
+} affinity_t;
+
+/**
+ * The copies of the points read by the workers, first written by a thread running on the node that holds them.
+ *
+ * @param nbOfReplicas (uint32_t) : The number of copies, one per node or a single partitioned one.
+ * @param points (dataset_t *) : The copies of the points.
+ * @param narrow (narrow_t *) : The copies of the narrow points, NULL if the points have no narrow copy.
+ *
+ * Note that there are specific function for this data structure.
+ *
+ *      - Initialize            = <affinity_place>.
+ *      - Destroy with content  = <affinity_destroyReplicas>.
+ */
+typedef struct {
+    uint32_t nbOfReplicas;
+    dataset_t * points;
+    narrow_t * narrow;
+} affinity_replicas_t;
+
+int affinity_check(const char *, const char *);
+
+int affinity_init(affinity_t *, const char *, const char *, bool);
+
+int affinity_pinWorker(affinity_t *, uint32_t);
+
+int affinity_pinWriter(affinity_t *, pthread_t);
+
+uint32_t affinity_nodeOfWorker(const affinity_t *, uint32_t);
+
+int affinity_place(affinity_replicas_t *, const affinity_t *, affinity_numa_t, const dataset_t *, const narrow_t *);
+
+void affinity_destroyReplicas(affinity_replicas_t *);
+
+void affinity_destroy(affinity_t *);
+
+#endif //AFFINITY_H
@@ -12,9 +12,9 @@
 
 #include "distance.h"
 #include "point.h"
-#include "arrayofpoints.h"
-#include "arrayofclusters.h"
+#include "labels.h"
 #include "func.h"
+#include "affinity.h"
 
 extern squared_distance_func_t FORMULA_CHOOSED;
 
@@ -23,11 +23,21 @@ extern squared_distance_func_t FORMULA_CHOOSED;
  * 
  * @param input_pathName (char *) : The pathname to the input file.
  * @param output_pathName (char *) : The pathname to the output file, to write the result of calculations to.
- * @param n_threads (uint32_t) : The number of threads to execute the LLoyd Algorithm.
+ * @param n_threads (uint32_t) : The number of threads to execute the LLoyd Algorithm, 0 to let the planner choose it.
  * @param k (uint32_t) : The size of clusters.
  * @param n_first_initialization_points (uint32_t) : The number of first initialization.
  * @param quiet (bool) : The argument passed to know if the clusters have be to be written in the output file.
  * @param squared_distance_func (squared_distance_func_t) : The function for calculting the distance chose.
+ * @param algorithm (kmeans_algorithm_t) : The algorithm of the assignment of the points to the centroids.
+ * @param batch_size (uint32_t) : The number of points of a batch, in mini-batch mode.
+ * @param batch_iterations (uint32_t) : The number of batches of a run, in mini-batch mode.
+ * @param stream (bool) : true if the input file is read again at each iteration instead of being kept in memory.
+ * @param prepare (bool) : true if a prepared copy of the input file is written for the next runs.
+ * @param top (uint32_t) : The number of results of lowest distortion written, followed by a summary of all the runs,
+ *                         0 to write every result.
+ * @param affinity (char *) : The cpus the threads are pinned on (see <affinity_init>), NULL if they are not.
+ * @param numa (affinity_numa_t) : Where the points read by the calculating threads are placed.
+ * @param topology (char *) : The simulated NUMA nodes (see <affinity_check>), NULL to use the ones of the machine.
  */ 
 typedef struct {
     char * input_pathName;
@@ -37,6 +47,15 @@ typedef struct {
     uint32_t n_first_initialization_points;
     bool quiet;
     squared_distance_func_t squared_distance_func;
+    kmeans_algorithm_t algorithm;
+    uint32_t batch_size;
+    uint32_t batch_iterations;
+    bool stream;
+    bool prepare;
+    uint32_t top;
+    char * affinity;
+    affinity_numa_t numa;
+    char * topology;
 }args_t;
 
 void usage(char *);
@@ -0,0 +1,93 @@
+#ifndef BEST_H
+#define BEST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "threadshandler.h"
+
+/**
+ * The number of buckets of the histogram of the distortions : the bucket b > 0 counts the distortions in
+ * [2^(b - 1), 2^b), the bucket 0 the null ones.
+ */
+#define BEST_HISTOGRAM 65
+
+/**
+ * The part of the results kept by one calculating thread, only used by it until the shards are merged.
+ *
+ * @param heap (calculation_result_holder **) : The best results offered to the shard, the worst one first (a binary
+ *                                              max-heap on the distortion, then on the rank).
+ * @param size (uint32_t) : The number of results in the heap.
+ * @param runs (uint64_t) : The number of results offered to the shard.
+ * @param histogram (uint64_t [BEST_HISTOGRAM]) : The number of results per bucket of distortion.
+ * @param minIterations (uint64_t) : The fewest iterations of a run.
+ * @param maxIterations (uint64_t) : The most iterations of a run.
+ * @param sumIterations (uint64_t) : The sum of the iterations of the runs.
+ * @param solutions (uint64_t *) : The hashes of the final centroids met, an open addressing table (0 is a free slot).
+ * @param nbOfSolutions (uint64_t) : The number of hashes in the table.
+ * @param capacity (uint64_t) : The number of slots of the table, a power of 2.
+ */
+typedef struct {
+    calculation_result_holder ** heap;
+    uint32_t size;
+    uint64_t runs;
+    uint64_t histogram[BEST_HISTOGRAM];
+    uint64_t minIterations;
+    uint64_t maxIterations;
+    uint64_t sumIterations;
+    uint64_t * solutions;
+    uint64_t nbOfSolutions;
+    uint64_t capacity;
+} best_shard_t;
+
+/**
+ * The N results of lowest distortion among all the runs, and a summary of all of them. Each calculating thread takes
+ * a shard and offers it's results to it without any lock : a result that is not among the N best of the shard is
+ * freed at once, so only N results per thread are held whatever the number of runs. Once the threads are done, the
+ * shards are merged and the results written in order.
+ *
+ * Two runs with the same distortion are ordered by the rank of their initial centroids (see <combinator_t>), so the
+ * results kept don't depend on the threads. Two final centroids are the same solution when they have the same
+ * coordinates, in any order.
+ *
+ * @param top (uint32_t) : The number of results kept, N.
+ * @param shards (best_shard_t *) : The shards, one per calculating thread, the first one holds the merge.
+ * @param nbOfShards (uint32_t) : The number of shards.
+ * @param nextShard (uint32_t) : The first shard not taken yet, only changed with atomic operations.
+ * @param incomplete (uint32_t) : Set once a table of the solutions could not grow, the number of solutions being then
+ *                                a lower bound, only changed with atomic operations.
+ *
+ * Note that there are specific function for this data structure.
+ *
+ *      - Initialize            = <best_init>.
+ *      - Take a shard          = <best_claimShard>.
+ *      - Offer a result        = <best_offer>.
+ *      - Merge the shards      = <best_merge>.
+ *      - Write the best results = <best_write>.
+ *      - Write the summary     = <best_writeSummary>.
+ *      - Destroy with content  = <best_destroy>.
+ */
+typedef struct {
+    uint32_t top;
+    best_shard_t * shards;
+    uint32_t nbOfShards;
+    uint32_t nextShard;
+    uint32_t incomplete;
+} best_t;
+
+int best_init(best_t *, uint32_t, uint32_t);
+
+best_shard_t * best_claimShard(best_t *);
+
+void best_offer(best_t *, best_shard_t *, calculation_result_holder *, uint64_t);
+
+int best_merge(best_t *);
+
+int best_write(const best_t *, FILE *, bool, const file_t *);
+
+int best_writeSummary(const best_t *, FILE *);
+
+void best_destroy(best_t *);
+
+#endif //BEST_H
@@ -0,0 +1,87 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <float.h>
+
+#include "dataset.h"
+#include "labels.h"
+#include "distance.h"
+#include "kernels.h"
+
+/*
+ * The accelerated assignments (Elkan, Hamerly, Yinyang) keep bounds on the distances between the points and the
+ * centroids, to skip the distances that cannot change the closest centroid. The bounds are on the distances before
+ * squaring : both formulas are then metrics, for which the triangle inequality holds.
+ *
+ * The bounds are doubles, rounded so they stay on the safe side : a lower bound is never above the real distance and
+ * an upper bound never below it. A centroid is only skipped when it is strictly farther than the closest one, the
+ * exact distances (the integer squared ones) decide between the others, the first centroid winning a tie. So the
+ * labels are the same as the ones of <assign_vectors_to_centroids>.
+ */
+
+/**
+ * The relative error allowed for, larger than the one of a conversion to double followed by a square root.
+ */
+#define BOUNDS_ROUNDING (4 * DBL_EPSILON)
+
+/**
+ * Returns the distance before squaring, from the exact squared distance.
+ */
+static inline double bounds_distance(int64_t squaredDistance)
+{
+    return sqrt((double) squaredDistance);
+}
+
+/**
+ * Returns a lower bound of a distance computed by <bounds_distance>.
+ */
+static inline double bounds_lower(double distance)
+{
+    return distance * (1 - BOUNDS_ROUNDING);
+}
+
+/**
+ * Returns an upper bound of a distance computed by <bounds_distance>.
+ */
+static inline double bounds_upper(double distance)
+{
+    return distance * (1 + BOUNDS_ROUNDING);
+}
+
+/**
+ * Returns an upper bound of upper + drift, used when the centroid of an upper bound moves.
+ */
+static inline double bounds_increase(double upper, double drift)
+{
+    return (drift == 0) ? upper : (upper + drift) * (1 + BOUNDS_ROUNDING);
+}
+
+/**
+ * Returns a lower bound of lower - drift (at least 0), used when the centroid of a lower bound moves.
+ */
+static inline double bounds_decrease(double lower, double drift)
+{
+    if (drift == 0){ return lower; }
+    double bound = (lower - drift) * (1 - BOUNDS_ROUNDING);
+    return (bound > 0) ? bound : 0;
+}
+
+/**
+ * Returns an upper bound of the sum of the drifts of a centroid between two iterations, from the running totals of
+ * it's drifts (rounded upward by <bounds_increase>) at both iterations.
+ */
+static inline double bounds_driftSince(double total, double totalThen)
+{
+    return (total == totalThen) ? 0 : (total - totalThen) * (1 + BOUNDS_ROUNDING);
+}
+
+bool bounds_areExact(squared_distance_func_t, const dataset_t *);
+
+void bounds_drifts(const dataset_t *, const dataset_t *, double *, const lloyd_kernels_t *);
+
+void bounds_halfDistances(const dataset_t *, double *, double *, const lloyd_kernels_t *);
+
+#endif //BOUNDS_H
@@ -0,0 +1,58 @@
+#ifndef CANDIDATES_H
+#define CANDIDATES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dataset.h"
+#include "labels.h"
+#include "kernels.h"
+
+/**
+ * The number of bytes the matrix of the distances may take, past it the first assignments compute their distances.
+ */
+#define CANDIDATES_BUDGET (1 << 27)
+
+/**
+ * The number of points, and of candidates, of a block of the matrix computed at once : the rows of both fit in the
+ * cache while their distances are computed.
+ */
+#define CANDIDATES_BLOCK 64
+
+/**
+ * The squared distances between all the points and the candidates, the first points of the dataset from which the
+ * initial centroids of every run are picked. It's computed once and only read by the calculating threads : the first
+ * assignment of a run reads the K columns of it's initial centroids instead of computing the distances.
+ *
+ * The distances are the ones of the loops of Lloyd (see <lloyd_kernels_t>), so the first assignment gives the same
+ * labels, counts, moves and distortion.
+ *
+ * @param distances (uint64_t *) : The nbOfPoints * nbOfCandidates matrix, the distances of a point are contiguous.
+ * @param nbOfPoints (uint64_t) : The number of points.
+ * @param nbOfCandidates (uint32_t) : The number of candidates.
+ * @param points (const dataset_t *) : The points, the candidates are the first ones.
+ *
+ * Note that there are specific function for this data structure.
+ *
+ *      - Initialize            = <candidates_build>.
+ *      - Find the columns      = <candidates_columns>.
+ *      - Assign from the matrix = <candidates_assign>.
+ *      - Destroy with content  = <candidates_destroy>.
+ */
+typedef struct {
+    uint64_t * distances;
+    uint64_t nbOfPoints;
+    uint32_t nbOfCandidates;
+    const dataset_t * points;
+} candidates_t;
+
+int candidates_build(candidates_t *, const dataset_t *, uint32_t, const lloyd_kernels_t *, uint32_t);
+
+bool candidates_columns(const candidates_t *, const dataset_t *, uint32_t *);
+
+int candidates_assign(const candidates_t *, const uint32_t *, uint32_t, labels_t *, moves_t *, uint64_t *, uint64_t,
+                      uint64_t);
+
+void candidates_destroy(candidates_t *);
+
+#endif //CANDIDATES_H
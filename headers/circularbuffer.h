@@ -1,61 +1,87 @@
 #ifndef CIRCULAR_BUFFER
 #define CIRCULAR_BUFFER
 
-#include <semaphore.h>
 #include <pthread.h>
 #include <stdint.h>
-#include <stdbool.h> 
+#include <stdbool.h>
 
-#include "arrayofpoints.h"
+/**
+ * The size of a cache line. The positions of the producers and of the consumers are each on their own line, so
+ * the two sides never write in the same one.
+ */
+#define CIRCULARBUFFER_CACHE_LINE 64
+
+/**
+ * The largest number of elements the output-writer thread takes at once.
+ */
+#define CIRCULARBUFFER_BATCH 16
+
+/**
+ * A slot of the buffer.
+ *
+ * @param sequence (uint64_t) : The position the slot waits for : equal to the position of a put when it's free, to
+ *                              that position + 1 once filled, to the position + the size of the buffer once taken.
+ * @param data (void *) : The element.
+ */
+typedef struct {
+    uint64_t sequence;
+    void * data;
+} circular_cell_t;
 
 /**
- * A fixed size circular buffer.
- * 
- * @param maxSize (uint32_t) : The maximum size of the buffer.
- * @param array (void **) : The array in which the pointers will be stored. The size of the array must be equal the maxSize.
- * @param takePointer (uint32_t) : The pointer to where to pick data from the array.
- * @param putPointer (uint32_t) :  The pointer to where to put data from the array.
- * @param in (uint32_t) : The number of elements in the array.
- * @param done (int) : A signal to know if producers are done. 1 if producers are done, 0 else.
- * @param empty (sem_t *) : A semaphore.
- * @param full (sem_t *) : A semaphore.
- * @param mutex (pthread_mutex_t *) : A mutex for synchronisation.
- * @param waitingConsumers (uint64_t) : The number of consumers waiting on the buffer.
- * @param waitingProducers (uint64_t) : The number of producers waiting on the buffer.
- * 
+ * A fixed size circular buffer, shared by any number of producers and consumers without a lock (the bounded queue of
+ * Vyukov). Each slot holds a sequence number : a producer claims the next free positions with one compare-and-swap
+ * on putPosition, fills their slots and publishes each of them by it's sequence, the consumers do the same on
+ * takePosition. The elements come out in the order of their positions.
+ *
+ * A thread only sleeps when the buffer is full (producer) or empty (consumer) : it waits on the counter of the
+ * events of the other side with a futex, and the other side only wakes it up if a thread is waiting.
+ *
+ * @param maxSize (uint32_t) : The number of slots, a power of 2.
+ * @param mask (uint32_t) : maxSize - 1.
+ * @param cells (circular_cell_t *) : The slots.
+ * @param done (uint32_t) : A signal to know if producers are done. 1 if producers are done, 0 else.
+ * @param putPosition (uint64_t) : The position of the next put.
+ * @param puts (uint32_t) : Incremented after each put, the consumers wait on it.
+ * @param waitingConsumers (uint32_t) : The number of consumers waiting on the buffer.
+ * @param takePosition (uint64_t) : The position of the next get.
+ * @param takes (uint32_t) : Incremented after each get, the producers wait on it.
+ * @param waitingProducers (uint32_t) : The number of producers waiting on the buffer.
+ *
  * ATTENTION : Note that there are specific functions for :
  *              - initializing a circular buffer : <circulabuffer_init>
- *              - adding elements : <circularbuffer_put> 
- *              - get elements : <circularbuffer_get>
+ *              - adding elements : <circularbuffer_put> or <circularbuffer_putMany>
+ *              - get elements : <circularbuffer_get> or <circularbuffer_getMany>
  *              - wake producers threads : <wakeAllProducers>
- *              - wake consumers threads : <circularbuffer_get>
- * 
+ *              - wake consumers threads : <wakeAllConsumers>
+ *
  * It's better using these APIs for race free conditions.
  */
-typedef struct 
+typedef struct
 {
     uint32_t maxSize;
-    void ** array;
-    uint32_t takePointer;
-    uint32_t putPointer;
-    uint32_t in;
-    int done;
-    sem_t * empty;
-    sem_t * full;
-    pthread_mutex_t * mutex;
-    uint64_t waitingConsumers;
-    uint64_t waitingProducers;
+    uint32_t mask;
+    circular_cell_t * cells;
+    uint32_t done;
+    uint64_t putPosition __attribute__((aligned(CIRCULARBUFFER_CACHE_LINE)));
+    uint32_t puts;
+    uint32_t waitingConsumers;
+    uint64_t takePosition __attribute__((aligned(CIRCULARBUFFER_CACHE_LINE)));
+    uint32_t takes;
+    uint32_t waitingProducers;
 } circular_buf ;
 
 typedef void (*putFunction) (circular_buf *, void *);
 typedef void * (*getFunction) (circular_buf *);
-int circulabuffer_init(circular_buf * buff, pthread_mutex_t * mutex, uint32_t MaxSize, void ** array);
+int circulabuffer_init(circular_buf * buff, uint32_t MaxSize);
 void circularbuffer_setDone(circular_buf * );
 void wakeAllProducers(circular_buf * );
 void wakeAllConsumers(circular_buf * );
 void circularbuffer_handleError(circular_buf *, char *);
 int circularbuffer_put(circular_buf *, int *, void *);
+int circularbuffer_putMany(circular_buf *, int *, void **, uint32_t);
 int circularbuffer_get(circular_buf *, int *, void **);
+int circularbuffer_getMany(circular_buf *, int *, void **, uint32_t, uint32_t *);
 void circularbuffer_destroy(circular_buf *);
 
-#endif // CIRCULAR_BUFFER
\ No newline at end of file
+#endif // CIRCULAR_BUFFER
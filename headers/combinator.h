@@ -1,27 +1,55 @@
 #ifndef COMBINATOR_H
 #define COMBINATOR_H
 
-#include "point.h"
-#include "func.h"
-#include "filehandler.h"
-#include "arrayofpoints.h"
-#include "arrayofclusters.h"
-#include "threadshandler.h"
-#include "argumentsparser.h"
-
-/** This structure is going to be passed to the thread that generates combinations
- * 
- * @param pointsToPickFrom (point_t *) : The array of point_t to use within combinations.
- * @param inputArgs (args_t *) : The input arguments
- * @param buff (circular_buf *) : The circular buffer in which the thread will write the combinations into.
- */ 
-typedef struct
-{
-    point_t * pointsToPickFrom;
-    args_t * inputArgs;
-    circular_buf * buff;
-} combinations_args_t;
-
-void * getAllCentroidCombinations(void *);
-
-#endif //COMBINATOR_H
\ No newline at end of file
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dataset.h"
+
+/**
+ * The largest number of combinations claimed at once by a calculating thread.
+ */
+#define COMBINATOR_MAX_BATCH 64
+
+/**
+ * The combinations of k initial centroids among the p first points, shared by the calculating threads. They are
+ * numbered in lexicographic order (the rank of {0, ..., k - 1} is 0), a thread claims the next ranks with one atomic
+ * addition and builds the indexes of the first combination of the batch from it's rank, then the next ones from it.
+ *
+ * @param p (uint32_t) : The number of points to choose from.
+ * @param k (uint32_t) : The number of centroids of a combination.
+ * @param nbOfCombinations (uint64_t) : The number of combinations, UINT64_MAX if there are more.
+ * @param batch (uint64_t) : The number of ranks claimed at once.
+ * @param next (uint64_t) : The first rank not claimed yet, only changed with atomic operations.
+ * @param stopped (bool) : Set with an atomic operation when a thread failed, the next claims get nothing.
+ *
+ * Note that there are specific function for this data structure.
+ *
+ *      - Initialize            = <combinator_init>.
+ *      - Claim combinations    = <combinator_claim>.
+ *      - Stop the claims       = <combinator_stop>.
+ */
+typedef struct {
+    uint32_t p;
+    uint32_t k;
+    uint64_t nbOfCombinations;
+    uint64_t batch;
+    uint64_t next;
+    bool stopped;
+} combinator_t;
+
+uint64_t combinator_count(uint32_t, uint32_t);
+
+void combinator_init(combinator_t *, uint32_t, uint32_t, uint32_t);
+
+uint64_t combinator_claim(combinator_t *, uint64_t *);
+
+void combinator_stop(combinator_t *);
+
+void combinator_unrank(uint32_t, uint32_t, uint64_t, uint32_t *);
+
+bool combinator_next(uint32_t, uint32_t, uint32_t *);
+
+dataset_t * combinator_centroids(const dataset_t *, uint32_t, const uint32_t *);
+
+#endif //COMBINATOR_H
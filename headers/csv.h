@@ -0,0 +1,159 @@
+#ifndef CSV_H
+#define CSV_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * The size of the buffer of a writer, flushed at once when it's full.
+ */
+#define CSV_BUFFER_SIZE (1 << 20)
+
+/**
+ * The largest number of characters of an int64_t written in base 10, "-9223372036854775808".
+ */
+#define CSV_INT64_LENGTH 20
+
+/**
+ * The characters of the numbers from 00 to 99, two by two.
+ */
+extern const char CSV_DIGIT_PAIRS[200];
+
+/**
+ * A writer of the rows of the output file, owned by the thread writing them. The rows are rendered in a large buffer
+ * written to the file descriptor of the file at once when it's full (or when flushed), instead of going through
+ * fprintf for each coordinate.
+ *
+ * @param file (FILE *) : The file, flushed before each write of the buffer so the bytes written with it come first.
+ * @param bytes (char *) : The buffer.
+ * @param length (size_t) : The number of bytes in the buffer.
+ * @param capacity (size_t) : The size of the buffer.
+ * @param error (int) : -1 once a write failed, 0 else.
+ *
+ * Note that there are specific function for this data structure.
+ *
+ *      - Initialize                = <csv_init>.
+ *      - Room for some bytes       = <csv_reserve>, then <csv_commit>.
+ *      - Add bytes, a number       = <csv_putBytes>, <csv_putInt64>.
+ *      - Write the buffer          = <csv_flush>.
+ *      - Destroy                   = <csv_destroy>, which writes the buffer first.
+ */
+typedef struct {
+    FILE * file;
+    char * bytes;
+    size_t length;
+    size_t capacity;
+    int error;
+} csv_t;
+
+int csv_init(csv_t *, FILE *);
+
+int csv_flush(csv_t *);
+
+char * csv_grow(csv_t *, size_t);
+
+int csv_destroy(csv_t *);
+
+/**
+ * Returns the number of digits of a number in base 10.
+ */
+static inline uint32_t csv_digits(uint64_t value)
+{
+    uint32_t digits = 1;
+    while (value >= 100)
+    {
+        value /= 100;
+        digits += 2;
+    }
+    return digits + ((value >= 10) ? 1 : 0);
+}
+
+/**
+ * Writes a number in base 10, like "%lld", two digits at a time.
+ *
+ * @param out (char *) : Where to write it, with room for CSV_INT64_LENGTH characters.
+ * @param value (int64_t) : The number.
+ *
+ * @return (char *) : The character after the number.
+ */
+static inline char * csv_formatInt64(char * out, int64_t value)
+{
+    uint64_t magnitude = (uint64_t) value;
+    if (value < 0)
+    {
+        *out++ = '-';
+        magnitude = 0 - magnitude;
+    }
+    char * end = out + csv_digits(magnitude);
+    char * c = end;
+    while (magnitude >= 100)
+    {
+        uint32_t pair = (uint32_t) (magnitude % 100) * 2;
+        magnitude /= 100;
+        *--c = CSV_DIGIT_PAIRS[pair + 1];
+        *--c = CSV_DIGIT_PAIRS[pair];
+    }
+    if (magnitude >= 10)
+    {
+        *--c = CSV_DIGIT_PAIRS[magnitude * 2 + 1];
+        *--c = CSV_DIGIT_PAIRS[magnitude * 2];
+    } else {
+        *--c = (char) ('0' + magnitude);
+    }
+    return end;
+}
+
+/**
+ * Returns room for the given number of bytes at the end of the buffer, written first if it's too full. Once filled,
+ * the bytes are added with <csv_commit>.
+ *
+ * @param csv (csv_t *) : The writer.
+ * @param bytes (size_t) : The number of bytes.
+ *
+ * @return (char *) : The first byte of the room, NULL if a write failed or the buffer could not grow.
+ */
+static inline char * csv_reserve(csv_t * csv, size_t bytes)
+{
+    if (csv->length + bytes <= csv->capacity){ return csv->bytes + csv->length; }
+    return csv_grow(csv, bytes);
+}
+
+/**
+ * Adds the bytes written in the room given by <csv_reserve>, up to end.
+ */
+static inline void csv_commit(csv_t * csv, char * end)
+{
+    csv->length = (size_t) (end - csv->bytes);
+}
+
+/**
+ * Adds bytes to the buffer.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+static inline int csv_putBytes(csv_t * csv, const char * bytes, size_t length)
+{
+    char * c = csv_reserve(csv, length);
+    if (c == NULL){ return -1; }
+    memcpy(c, bytes, length);
+    csv_commit(csv, c + length);
+    return 0;
+}
+
+/**
+ * Adds a number in base 10 to the buffer, like "%lld".
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+static inline int csv_putInt64(csv_t * csv, int64_t value)
+{
+    char * c = csv_reserve(csv, CSV_INT64_LENGTH);
+    if (c == NULL){ return -1; }
+    csv_commit(csv, csv_formatInt64(c, value));
+    return 0;
+}
+
+#endif //CSV_H
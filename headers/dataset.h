@@ -0,0 +1,71 @@
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "point.h"
+#include "csv.h"
+
+/**
+ * The alignment of the matrix of a dataset, in bytes. It's the size of a cache line.
+ */
+#define DATASET_ALIGNMENT 64
+
+/**
+ * This structure represents a set of points of the same dimension, stored in a single row-major matrix.
+ *
+ * @param values (int64_t *) : The matrix, aligned on DATASET_ALIGNMENT bytes. The j-th coordinate of the i-th point
+ *                             is values[i * stride + j].
+ * @param dimension (uint32_t) : The dimension of the points.
+ * @param stride (uint32_t) : The number of int64_t between the first coordinates of two consecutive points (stride >= dimension).
+ * @param size (uint64_t) : The number of points.
+ *
+ * Python Equivalent Representation : List [ Tuple ]
+ *
+ * Note that there are specific function for this data structure.
+ *
+ *      - Initialize            = <dataset_init>.
+ *      - Get a point           = <dataset_row> or <dataset_point>.
+ *      - Destroy with content  = <dataset_destroy>.
+ */
+typedef struct {
+    int64_t * values;
+    uint32_t dimension;
+    uint32_t stride;
+    uint64_t size;
+} dataset_t;
+
+/**
+ * Returns the pointer to the coordinates of the i-th point of the dataset.
+ *
+ * @param dataset (const dataset_t *) : The dataset.
+ * @param i (uint64_t) : The index of the point.
+ */
+static inline int64_t * dataset_row(const dataset_t * dataset, uint64_t i)
+{
+    return dataset->values + i * dataset->stride;
+}
+
+/**
+ * Returns a point_t viewing the i-th point of the dataset. The point does not own it's values.
+ *
+ * @param dataset (const dataset_t *) : The dataset.
+ * @param i (uint64_t) : The index of the point.
+ */
+static inline point_t dataset_point(const dataset_t * dataset, uint64_t i)
+{
+    point_t view = { dataset->dimension, dataset_row(dataset, i) };
+    return view;
+}
+
+int dataset_init(dataset_t *, uint64_t, uint32_t);
+
+int dataset_writeToCSV(csv_t *, const dataset_t *, bool);
+
+void dataset_copy(dataset_t *, const dataset_t *);
+
+void dataset_destroy(dataset_t *);
+
+#endif //DATASET_H
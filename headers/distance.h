@@ -2,9 +2,9 @@
 #define DISTANCE_H
 
 #include <stdint.h>
-#include "arrayofclusters.h"
+#include "labels.h"
 #include "point.h"
-#include "arrayofpoints.h"
+#include "dataset.h"
 
 /**
  * This typedef below defines the distance_func_t type, a function pointer type that groups all
@@ -27,11 +27,60 @@
 typedef int64_t (*squared_distance_func_t) (const point_t *, const point_t *);
 
 
+/**
+ * This typedef defines the type of the kernels computing a squared distance between two rows of coordinates :
+ *
+ *      int64_t function_name(const int64_t * p1, const int64_t * p2, uint32_t dimension)
+ */
+typedef int64_t (*squared_row_distance_func_t) (const int64_t *, const int64_t *, uint32_t);
+
+/**
+ * The same kernels on rows of narrow coordinates (see narrow.h), stored with int16_t or int32_t.
+ */
+typedef int64_t (*squared_row16_distance_func_t) (const int16_t *, const int16_t *, uint32_t);
+typedef int64_t (*squared_row32_distance_func_t) (const int32_t *, const int32_t *, uint32_t);
+
+/**
+ * An implementation of the kernels of both formulas, for an instruction set.
+ *
+ * @param name (const char *) : The name of the implementation, the instruction set it needs ("avx2", "vector", ...).
+ * @param squared_manhattan (squared_row_distance_func_t) : The kernel for the manhattan formula.
+ * @param squared_euclidean (squared_row_distance_func_t) : The kernel for the euclidean formula.
+ * @param squared_manhattan16 (squared_row16_distance_func_t) : The manhattan kernel on int16_t coordinates whose
+ *                                                              distances fit in uint32_t (see <narrow_choose>).
+ * @param squared_euclidean16 (squared_row16_distance_func_t) : The euclidean one.
+ * @param squared_manhattan16w (squared_row16_distance_func_t) : The manhattan kernel on int16_t coordinates whose
+ *                                                               distances are summed with uint64_t.
+ * @param squared_euclidean16w (squared_row16_distance_func_t) : The euclidean one.
+ * @param squared_manhattan32 (squared_row32_distance_func_t) : The manhattan kernel on int32_t coordinates.
+ * @param squared_euclidean32 (squared_row32_distance_func_t) : The euclidean one.
+ *
+ * All the implementations give the same result, bit for bit, and the narrow kernels give the same result as the
+ * int64_t ones on the same coordinates.
+ */
+typedef struct {
+    const char * name;
+    squared_row_distance_func_t squared_manhattan;
+    squared_row_distance_func_t squared_euclidean;
+    squared_row16_distance_func_t squared_manhattan16;
+    squared_row16_distance_func_t squared_euclidean16;
+    squared_row16_distance_func_t squared_manhattan16w;
+    squared_row16_distance_func_t squared_euclidean16w;
+    squared_row32_distance_func_t squared_manhattan32;
+    squared_row32_distance_func_t squared_euclidean32;
+} distance_kernels_t;
+
+extern distance_kernels_t DISTANCE_KERNELS;
+
+void distance_init(void);
+
+uint32_t distance_supportedKernels(distance_kernels_t *, uint32_t);
+
 int64_t squared_manhattan_distance(const point_t *, const point_t *);
 
 int64_t squared_euclidean_distance(const point_t *, const point_t *);
 
-int64_t distortion_distance(const array_of_centroids*, const array_of_arrays_of_points *);
+int64_t distortion_distance(const dataset_t *, const dataset_t *, const labels_t *);
 
 uint32_t getLength(int64_t);
 
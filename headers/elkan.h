@@ -0,0 +1,52 @@
+#ifndef ELKAN_H
+#define ELKAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dataset.h"
+#include "labels.h"
+#include "kernels.h"
+
+/**
+ * The state of the assignment of Elkan, kept between the iterations of one run of k-means.
+ *
+ * @param K (uint32_t) : The number of centroids.
+ * @param upper (double *) : For each point, an upper bound of the distance to it's centroid.
+ * @param lower (double *) : A size * K matrix, the lower bounds of the distances of each point to each centroid.
+ * @param refreshed (uint32_t *) : For each point, the iteration at which it's bounds were computed.
+ * @param totals (double *) : For each iteration, a row of K running totals of the drifts of the centroids.
+ * @param nbOfTotals (uint32_t) : The number of rows of totals, the current iteration is the last one.
+ * @param capacity (uint32_t) : The number of rows allocated for totals.
+ * @param halves (double *) : A K * K matrix, the halves of the distances between the centroids.
+ * @param nearest (double *) : For each centroid, the half of the distance to the nearest other one.
+ * @param drifts (double *) : For each centroid, how much it has moved since the last assignment.
+ * @param started (bool) : false before the first assignment.
+ * @param previous (dataset_t) : The centroids of the last assignment.
+ *
+ * The bounds of a point are only brought up to date, with the totals of the drifts since they were computed, when
+ * it's upper bound does not prove that it keeps it's centroid. So most of the n * K lower bounds are not touched
+ * at each iteration.
+ */
+typedef struct {
+    uint32_t K;
+    double * upper;
+    double * lower;
+    uint32_t * refreshed;
+    double * totals;
+    uint32_t nbOfTotals;
+    uint32_t capacity;
+    double * halves;
+    double * nearest;
+    double * drifts;
+    bool started;
+    dataset_t previous;
+} elkan_t;
+
+void * elkan_create(const dataset_t *, uint32_t);
+
+int elkan_assign(void *, const dataset_t *, const dataset_t *, labels_t *, moves_t *, const lloyd_kernels_t *);
+
+void elkan_destroy(void *);
+
+#endif //ELKAN_H
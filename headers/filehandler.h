@@ -16,39 +16,129 @@
 #include <string.h>
 #include <sys/mman.h>
 
-#include "arrayofclusters.h"
-#include "arrayofpoints.h"
+#include "labels.h"
 #include "point.h"
+#include "dataset.h"
 #include "circularbuffer.h"
 
 /**
  * This structure represents the binary input file.
  * 
- * - ptrToPoints ( point_t * ) : An array of point_t structures.
- * - dimension ( uint32_t * ) : The pointer to the dimension.
- * - nbOfPoints ( uint64_t * ) : The pointer to the nb of points in the file.
+ * - dataset ( dataset_t ) : The points of the file, in host byte order. Points are not padded (stride == dimension).
+ *                           When the file is streamed, only it's first points (the ones of the initializations).
+ * - nbOfPoints ( uint64_t ) : The number of points of the file.
+ * - streamed ( bool ) : true if the points are read again from the file at each pass, see <fileOpenStream>.
+ * - fd ( int ) : The opened file when it is streamed, else -1.
+ * - mapping ( void * ) : The prepared file mapped in memory when the points are read from it, see <filePrepare>,
+ *                        else NULL. The matrix of the dataset is then inside the mapping and is read only.
+ * - mappingSize ( size_t ) : The size of the mapping.
+ * - minimum ( int64_t ) : The smallest coordinate of the points (0 if there is none, or if the file is streamed).
+ * - maximum ( int64_t ) : The largest coordinate of the points (0 if there is none, or if the file is streamed).
  */ 
 typedef struct fileStruct{
-    point_t * ptrToPoints;
-    uint32_t dimension;
+    dataset_t dataset;
     uint64_t nbOfPoints;
+    bool streamed;
+    int fd;
+    void * mapping;
+    size_t mappingSize;
+    int64_t minimum;
+    int64_t maximum;
 } file_t ;
 
+/**
+ * The size of the header of the binary input file : a uint32_t for the dimension and a uint64_t for the number of points.
+ */
+#define FILE_HEADER_SIZE (sizeof(uint32_t) + sizeof(uint64_t))
+
+/**
+ * The size in bytes of the chunks in which a streamed file is read.
+ */
+#define FILE_CHUNK_SIZE (1 << 22)
+
+/**
+ * The suffix added to the pathname of an input file to name it's prepared copy.
+ */
+#define FILE_PREPARED_SUFFIX ".prepared"
+
+/**
+ * The first bytes of a prepared file.
+ */
+#define FILE_PREPARED_MAGIC "KMEANSPF"
+
+/**
+ * The version of the layout of a prepared file, a file of another version is ignored.
+ */
+#define FILE_PREPARED_VERSION 1
+
+/**
+ * Written in the host byte order in a prepared file, so a file prepared on a host of the other byte order is ignored.
+ */
+#define FILE_PREPARED_BYTE_ORDER 0x01020304
+
+/**
+ * The offset of the matrix in a prepared file. It's a multiple of the size of a page, so the matrix is aligned on
+ * DATASET_ALIGNMENT bytes once the file is mapped.
+ */
+#define FILE_PREPARED_OFFSET 4096
+
+/**
+ * The header of a prepared file : the points of an input file already converted to the host byte order, written by
+ * <filePrepare> next to the input file and mapped as is by <fileRead> while the input file is unchanged. The matrix
+ * follows at the offset FILE_PREPARED_OFFSET, with a stride equal to the dimension.
+ *
+ * @param magic (char [8]) : FILE_PREPARED_MAGIC.
+ * @param version (uint32_t) : FILE_PREPARED_VERSION.
+ * @param byteOrder (uint32_t) : FILE_PREPARED_BYTE_ORDER.
+ * @param dimension (uint32_t) : The dimension of the points.
+ * @param stride (uint32_t) : The number of int64_t between the first coordinates of two consecutive points.
+ * @param nbOfPoints (uint64_t) : The number of points.
+ * @param offset (uint64_t) : The offset of the matrix in the file.
+ * @param minimum (int64_t) : The smallest coordinate of the points (0 without coordinates).
+ * @param maximum (int64_t) : The largest coordinate of the points (0 without coordinates).
+ * @param sourceSize (uint64_t) : The size of the input file.
+ * @param sourceSeconds (int64_t) : The time of the last modification of the input file, in seconds.
+ * @param sourceNanoseconds (int64_t) : The nanoseconds of the time of the last modification of the input file.
+ * @param checksum (uint64_t) : The checksum of the content of the input file, see <fileChecksum>.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t dimension;
+    uint32_t stride;
+    uint64_t nbOfPoints;
+    uint64_t offset;
+    int64_t minimum;
+    int64_t maximum;
+    uint64_t sourceSize;
+    int64_t sourceSeconds;
+    int64_t sourceNanoseconds;
+    uint64_t checksum;
+} prepared_header_t;
+
 /**
  *  This structure of arguments to be given to the output-writer thread.
  *  
  *  @param buff (circular_buf *) : The buffer that will containg the strings representing each a row to write in the output file.
  *  @param outPutFile (FILE *) : The opened outfile to write to.
  *  @param quietMode (bool) : The boolean for quiet. Given as parameter to the program.
+ *  @param inputFile (const file_t *) : The file of the points that are clustered, to write the content of the clusters.
  */
 typedef struct 
 {
     circular_buf * buff;
     FILE * outPutFile;
     bool quietMode;
+    const file_t * inputFile;
 } writerThreadArgs_t;
 
-int fileRead(file_t * theStruct, const char * filePathName);
+int fileRead(file_t * theStruct, const char * filePathName, uint32_t nThreads);
+int fileOpenStream(file_t * theStruct, const char * filePathName, uint64_t nbOfFirstPoints);
+uint64_t fileChunkSize(const file_t * inputFile);
+int fileReadPoints(const file_t * inputFile, uint64_t first, dataset_t * points);
+uint64_t fileChecksum(const void * content, size_t size);
+int filePrepare(const file_t * theStruct, const char * filePathName);
 void freeFileStruct(file_t * inputFile);
 void * writeToCSVFromBuffer(void * argT);
 
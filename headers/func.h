@@ -4,17 +4,70 @@
 #include <stdio.h>
 #include <stdint.h>
 
-#include "arrayofpoints.h"
-#include "arrayofclusters.h"
+#include "labels.h"
 #include "filehandler.h"
+#include "dataset.h"
+#include "team.h"
+#include "kdtree.h"
+#include "narrow.h"
+#include "memo.h"
+#include "candidates.h"
+#include "kernels.h"
 
+/**
+ * The amount of work (points * K * dimension) below which a member of a team is not worth waking for an iteration.
+ */
+#define LLOYD_WORK_PER_MEMBER (1 << 16)
+
+/**
+ * The algorithms computing the assignment of the points to their closest centroid. They give the same clusters,
+ * the accelerated ones skip the distances that cannot change the result.
+ *
+ *      - KMEANS_LLOYD : All the distances are computed at each iteration.
+ *      - KMEANS_ELKAN : Elkan's bounds, one lower bound per point and per centroid.
+ *      - KMEANS_HAMERLY : Hamerly's bounds, one lower bound per point.
+ *      - KMEANS_YINYANG : Yinyang's bounds, one lower bound per point and per group of centroids.
+ *      - KMEANS_KDTREE : The filtering algorithm of Kanungo et al., the nodes of a kd-tree of the points are given to
+ *                        their closest centroid at once.
+ *
+ * KMEANS_MINIBATCH is not an assignment but an approximation of k-means on batches of points, see <minibatch_kmeans>.
+ */
+typedef enum {
+    KMEANS_LLOYD,
+    KMEANS_ELKAN,
+    KMEANS_HAMERLY,
+    KMEANS_YINYANG,
+    KMEANS_KDTREE,
+    KMEANS_MINIBATCH,
+} kmeans_algorithm_t;
+
+/**
+ * The result of a run of k-means.
+ *
+ * @param finalCentroids (dataset_t *) : The final centroids.
+ * @param finalClusters (array_of_clusters *) : The labels of the points, NULL if they are not kept.
+ * @param distortion (int64_t) : The distortion of the clusters, measured while the points are assigned to the final
+ *                               centroids.
+ * @param iterations (uint64_t) : The number of iterations of the run, the last one (whose centroids do not change)
+ *                                included.
+ */
 typedef struct {
-    array_of_centroids *finalCentroids;
+    dataset_t *finalCentroids;
     array_of_clusters *finalClusters;
+    int64_t distortion;
+    uint64_t iterations;
 }list_of_centroids_and_clusters_only;
  
+int assign_vectors_to_centroids(const dataset_t *, const dataset_t *, labels_t *, moves_t *, uint64_t *,
+                                const lloyd_kernels_t *);
+
+void update_sums(dataset_t *, const dataset_t *, const labels_t *, const moves_t *, bool, const lloyd_kernels_t *);
+
 int k_means(list_of_centroids_and_clusters_only * ptr,
-            array_of_centroids *,
-            uint32_t , file_t *);
+            dataset_t *,
+            uint32_t , const dataset_t *, kmeans_algorithm_t, team_t *, const kdtree_t *,
+            const narrow_t *, const candidates_t *, memo_t *);
+
+int k_means_streamed(list_of_centroids_and_clusters_only *, dataset_t *, uint32_t, const file_t *, bool);
 
 #endif //FUNC_H
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef HAMERLY_H
+#define HAMERLY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dataset.h"
+#include "labels.h"
+#include "kernels.h"
+
+/**
+ * The state of the assignment of Hamerly, kept between the iterations of one run of k-means. It only needs two
+ * bounds per point, whatever K is.
+ *
+ * @param K (uint32_t) : The number of centroids.
+ * @param upper (double *) : For each point, an upper bound of the distance to it's centroid.
+ * @param lower (double *) : For each point, a lower bound of the distance to all the other centroids.
+ * @param nearest (double *) : For each centroid, the half of the distance to the nearest other one.
+ * @param drifts (double *) : For each centroid, how much it has moved since the last assignment.
+ * @param started (bool) : false before the first assignment.
+ * @param previous (dataset_t) : The centroids of the last assignment.
+ */
+typedef struct {
+    uint32_t K;
+    double * upper;
+    double * lower;
+    double * nearest;
+    double * drifts;
+    bool started;
+    dataset_t previous;
+} hamerly_t;
+
+void * hamerly_create(const dataset_t *, uint32_t);
+
+int hamerly_assign(void *, const dataset_t *, const dataset_t *, labels_t *, moves_t *, const lloyd_kernels_t *);
+
+void hamerly_destroy(void *);
+
+#endif //HAMERLY_H
@@ -0,0 +1,74 @@
+#ifndef KDTREE_H
+#define KDTREE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dataset.h"
+
+/**
+ * The largest number of points of a leaf.
+ */
+#define KDTREE_LEAF_SIZE 8
+
+/**
+ * A node of a kd-tree : the points of the positions [begin, end) of the order of the tree.
+ *
+ * @param begin (uint64_t) : The first position of the points of the node.
+ * @param end (uint64_t) : The position after the last point of the node.
+ * @param left (uint64_t) : The index of the child holding the first half of the points, 0 for a leaf.
+ * @param right (uint64_t) : The index of the child holding the second half of the points, 0 for a leaf.
+ */
+typedef struct {
+    uint64_t begin;
+    uint64_t end;
+    uint64_t left;
+    uint64_t right;
+} kdtree_node_t;
+
+/**
+ * A kd-tree over the points of a dataset, built once and then only read, so all the threads can share it. Each node
+ * splits it's points in two halves along the widest side of it's box, until at most KDTREE_LEAF_SIZE are left. The
+ * root is the node 0.
+ *
+ * @param points (const dataset_t *) : The points, they are not copied.
+ * @param order (uint64_t *) : The indexes of the points, sorted so that the points of a node are contiguous.
+ * @param nodes (kdtree_node_t *) : The nodes.
+ * @param nbOfNodes (uint64_t) : The number of nodes.
+ * @param capacity (uint64_t) : The number of nodes allocated.
+ * @param depth (uint32_t) : The number of levels of the tree.
+ * @param lower (int64_t *) : For each node, the smallest coordinates of it's points (nbOfNodes * dimension).
+ * @param upper (int64_t *) : For each node, the largest coordinates of it's points (nbOfNodes * dimension).
+ * @param sums (int64_t *) : For each node, the sums of the coordinates of it's points, modulo 2^64
+ *                           (nbOfNodes * dimension).
+ *
+ * Note that there are specific function for this data structure.
+ *
+ *      - Build                 = <kdtree_build>.
+ *      - Destroy with content  = <kdtree_destroy>.
+ */
+typedef struct {
+    const dataset_t * points;
+    uint64_t * order;
+    kdtree_node_t * nodes;
+    uint64_t nbOfNodes;
+    uint64_t capacity;
+    uint32_t depth;
+    int64_t * lower;
+    int64_t * upper;
+    int64_t * sums;
+} kdtree_t;
+
+/**
+ * Returns true if the node is a leaf.
+ */
+static inline bool kdtree_isLeaf(const kdtree_node_t * node)
+{
+    return node->left == 0;
+}
+
+int kdtree_build(kdtree_t *, const dataset_t *);
+
+void kdtree_destroy(kdtree_t *);
+
+#endif //KDTREE_H
@@ -0,0 +1,61 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dataset.h"
+#include "labels.h"
+#include "distance.h"
+#include "narrow.h"
+
+/**
+ * The loops of the Lloyd algorithm, specialized for a distance formula and a dimension. They work on the points
+ * of a range [begin, end) of the dataset.
+ *
+ * @param name (const char *) : The name of the specialization, for example "euclidean_3" or "manhattan_generic".
+ * @param assign (function) : Assigns each point of the range to it's closest centroid (the first one in case of a tie),
+ *                            updates the labels, adds the points to the counts, which are not reset, and records the
+ *                            points that have changed of cluster in the moves. If distortion is not NULL, the squared
+ *                            distances of the points to their closest centroid are added to it, modulo 2^64.
+ *                            Returns 1 if a point has changed of cluster, else 0.
+ * @param accumulate (function) : Adds each point of the range to the sum of the coordinates of it's cluster. The sums
+ *                                are a K * dimension matrix of int64_t, not reset.
+ * @param move (function) : Moves the points of the list from the sum of the cluster they left to the sum of their
+ *                          current cluster.
+ * @param distortion (function) : Returns the sum of the squared distances of the points of the range to their centroid.
+ * @param distance (squared_row_distance_func_t) : The squared distance between two rows.
+ */
+typedef struct {
+    const char * name;
+    int (*assign) (const dataset_t * centroids, const dataset_t * points, labels_t * labels, moves_t * moves,
+                   uint64_t * distortion, uint64_t begin, uint64_t end);
+    void (*accumulate) (int64_t * sums, const dataset_t * points, const labels_t * labels, uint64_t begin, uint64_t end);
+    void (*move) (int64_t * sums, const dataset_t * points, const labels_t * labels, const moves_t * moves);
+    int64_t (*distortion) (const dataset_t * centroids, const dataset_t * points, const labels_t * labels, uint64_t begin, uint64_t end);
+    squared_row_distance_func_t distance;
+} lloyd_kernels_t;
+
+/**
+ * The loops of the Lloyd algorithm on narrow points, like the ones of lloyd_kernels_t. The centroids are narrowed
+ * with the layout of the points (see <narrow_pack>), the sums stay a K * dimension matrix of int64_t. They give the
+ * same labels, counts, moves and sums as the int64_t loops.
+ *
+ * @param name (const char *) : The name of the specialization, for example "euclidean_int16_3".
+ * @param assign (function) : Like the assign of lloyd_kernels_t.
+ * @param accumulate (function) : Like the accumulate of lloyd_kernels_t.
+ * @param move (function) : Like the move of lloyd_kernels_t.
+ */
+typedef struct {
+    const char * name;
+    int (*assign) (const narrow_t * centroids, const narrow_t * points, labels_t * labels, moves_t * moves,
+                   uint64_t * distortion, uint64_t begin, uint64_t end);
+    void (*accumulate) (int64_t * sums, const narrow_t * points, const labels_t * labels, uint64_t begin, uint64_t end);
+    void (*move) (int64_t * sums, const narrow_t * points, const labels_t * labels, const moves_t * moves);
+} narrow_kernels_t;
+
+const lloyd_kernels_t * kernels_select(squared_distance_func_t, uint32_t);
+
+const narrow_kernels_t * kernels_selectNarrow(squared_distance_func_t, const narrow_t *);
+
+#endif //KERNELS_H
@@ -0,0 +1,136 @@
+#ifndef LABELS_H
+#define LABELS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dataset.h"
+
+/**
+ * This structure represents the clusters of a dataset : the index of the cluster of each point (it's label)
+ * and the number of points in each cluster.
+ *
+ * @param array (void *) : The labels. Depending on K they are uint8_t, uint16_t or uint32_t, the i-th element is the
+ *                         index of the cluster of the i-th point of the dataset.
+ * @param width (uint8_t) : The size in bytes of one label (1, 2 or 4).
+ * @param size (uint64_t) : The number of points, and of labels.
+ * @param K (uint32_t) : The number of clusters.
+ * @param counts (uint64_t *) : The number of points in each cluster, an array of K elements.
+ *
+ * Python Equivalent Representation : List [ List [ Tuple ] ], the clusters are only built when they are written.
+ *
+ * Note that there are specific function for this data structure.
+ *
+ *      - Initialize            = <labels_init>.
+ *      - Get/Set a label       = <labels_get> and <labels_set>.
+ *      - Destroy with content  = <labels_destroy>.
+ */
+typedef struct {
+    void * array;
+    uint8_t width;
+    uint64_t size;
+    uint32_t K;
+    uint64_t * counts;
+} labels_t;
+
+typedef labels_t array_of_clusters;
+
+/**
+ * The points that have changed of cluster during an assignment, with the cluster they left. Only capacity moves
+ * are recorded : past it, there are too many for the list to be useful and overflow is set.
+ *
+ * @param points (uint64_t *) : The indexes of the points that moved.
+ * @param from (uint32_t *) : The label of each of these points before the assignment.
+ * @param size (uint64_t) : The number of moves recorded.
+ * @param capacity (uint64_t) : The number of moves that can be recorded.
+ * @param overflow (bool) : true if more than capacity points have moved.
+ */
+typedef struct {
+    uint64_t * points;
+    uint32_t * from;
+    uint64_t size;
+    uint64_t capacity;
+    bool overflow;
+} moves_t;
+
+/**
+ * Returns the label of the i-th point.
+ *
+ * @param labels (const labels_t *) : The labels.
+ * @param i (uint64_t) : The index of the point.
+ */
+static inline uint32_t labels_get(const labels_t * labels, uint64_t i)
+{
+    switch (labels->width)
+    {
+        case sizeof(uint8_t):
+            return ((const uint8_t *) labels->array)[i];
+        case sizeof(uint16_t):
+            return ((const uint16_t *) labels->array)[i];
+        default:
+            return ((const uint32_t *) labels->array)[i];
+    }
+}
+
+/**
+ * Sets the label of the i-th point. Note that the counts are not updated.
+ *
+ * @param labels (labels_t *) : The labels.
+ * @param i (uint64_t) : The index of the point.
+ * @param label (uint32_t) : The index of it's cluster.
+ */
+static inline void labels_set(labels_t * labels, uint64_t i, uint32_t label)
+{
+    switch (labels->width)
+    {
+        case sizeof(uint8_t):
+            ((uint8_t *) labels->array)[i] = (uint8_t) label;
+            break;
+        case sizeof(uint16_t):
+            ((uint16_t *) labels->array)[i] = (uint16_t) label;
+            break;
+        default:
+            ((uint32_t *) labels->array)[i] = label;
+    }
+}
+
+/**
+ * Records that the i-th point has left the cluster from.
+ *
+ * @param moves (moves_t *) : The moves of the current assignment.
+ * @param i (uint64_t) : The index of the point.
+ * @param from (uint32_t) : It's label before the assignment.
+ */
+static inline void moves_push(moves_t * moves, uint64_t i, uint32_t from)
+{
+    if (moves->size == moves->capacity)
+    {
+        moves->overflow = true;
+        return;
+    }
+    moves->points[moves->size] = i;
+    moves->from[moves->size] = from;
+    moves->size++;
+}
+
+/**
+ * Empties the list of moves, before an assignment.
+ */
+static inline void moves_clear(moves_t * moves)
+{
+    moves->size = 0;
+    moves->overflow = false;
+}
+
+int labels_init(labels_t *, uint64_t, uint32_t);
+
+int labels_writeClustersToCSV(csv_t *, const labels_t *, const dataset_t *);
+
+void labels_destroy(labels_t *);
+
+int moves_init(moves_t *, uint64_t);
+
+void moves_destroy(moves_t *);
+
+#endif //LABELS_H
@@ -0,0 +1,110 @@
+#ifndef MEMO_H
+#define MEMO_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dataset.h"
+
+/**
+ * The number of bytes of centroids a table keeps at most, past it the trajectories of the next runs are dropped.
+ */
+#define MEMO_BUDGET (1 << 26)
+
+/**
+ * The number of lists of the table.
+ */
+#define MEMO_BUCKETS (1 << 14)
+
+/**
+ * The centroids met by a run after it's first iteration, in the order they were met.
+ *
+ * @param states (int64_t *) : The centroids, K * dimension coordinates per iteration (without padding).
+ * @param size (uint64_t) : The number of iterations recorded.
+ * @param capacity (uint64_t) : The number of iterations that fit in states.
+ */
+typedef struct {
+    int64_t * states;
+    uint64_t size;
+    uint64_t capacity;
+} memo_trajectory_t;
+
+/**
+ * The centroids of one iteration of a finished run, and the final centroids of that run.
+ *
+ * @param next (struct memo_entry *) : The next entry of the same list.
+ * @param hash (uint64_t) : The hash of the centroids, see <memo_hash>.
+ * @param state (const int64_t *) : The centroids, K * dimension coordinates.
+ * @param final (const dataset_t *) : The final centroids of the run.
+ * @param remaining (uint64_t) : The number of iterations the run did from these centroids, the last one included.
+ */
+typedef struct memo_entry {
+    struct memo_entry * next;
+    uint64_t hash;
+    const int64_t * state;
+    const dataset_t * final;
+    uint64_t remaining;
+} memo_entry_t;
+
+/**
+ * A finished run kept by the table : it's final centroids, followed in the same allocation by one entry and one copy
+ * of the centroids per iteration.
+ *
+ * @param next (struct memo_run *) : The run kept before this one.
+ * @param final (dataset_t) : The final centroids.
+ */
+typedef struct memo_run {
+    struct memo_run * next;
+    dataset_t final;
+} memo_run_t;
+
+/**
+ * The trajectories of the finished runs of Lloyd, shared by the calculating threads.
+ *
+ * Once it's first iteration is done, the run of Lloyd only depends on it's centroids : whatever the labels they were
+ * computed from, the next centroids and the point where the run stops (the first centroids equal to their update)
+ * follow. So a run meeting the centroids of a finished run, in the same order, ends with the same final centroids,
+ * and with the same clusters and distortion once the points are assigned to them. The order of the centroids is
+ * kept in the key : it decides the order of the final centroids and which one a point at the same distance of two
+ * of them is given to.
+ *
+ * @param K (uint32_t) : The number of centroids.
+ * @param dimension (uint32_t) : The dimension of the centroids.
+ * @param buckets (memo_entry_t **) : The MEMO_BUCKETS lists of entries, by hash.
+ * @param runs (memo_run_t *) : The runs kept, the last one first.
+ * @param used (uint64_t) : The number of bytes of the runs kept.
+ * @param budget (uint64_t) : The number of bytes the runs may take.
+ * @param lock (pthread_rwlock_t) : Held for reading by the lookups and for writing by the insertions.
+ *
+ * Note that there are specific function for this data structure.
+ *
+ *      - Initialize                = <memo_init>.
+ *      - Record a trajectory       = <memo_record>, emptied by <memo_trajectory_destroy>.
+ *      - Keep a finished run       = <memo_insert>.
+ *      - Find a known centroids    = <memo_find>.
+ *      - Destroy with content      = <memo_destroy>.
+ */
+typedef struct {
+    uint32_t K;
+    uint32_t dimension;
+    memo_entry_t ** buckets;
+    memo_run_t * runs;
+    uint64_t used;
+    uint64_t budget;
+    pthread_rwlock_t lock;
+} memo_t;
+
+int memo_init(memo_t *, uint32_t, uint32_t, uint64_t);
+
+int memo_record(memo_trajectory_t *, const dataset_t *);
+
+void memo_insert(memo_t *, const memo_trajectory_t *, const dataset_t *, uint64_t);
+
+bool memo_find(memo_t *, dataset_t *, uint64_t *);
+
+void memo_trajectory_destroy(memo_trajectory_t *);
+
+void memo_destroy(memo_t *);
+
+#endif //MEMO_H
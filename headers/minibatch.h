@@ -0,0 +1,29 @@
+#ifndef MINIBATCH_H
+#define MINIBATCH_H
+
+#include <stdint.h>
+
+#include "dataset.h"
+#include "labels.h"
+#include "func.h"
+
+/**
+ * The default number of points drawn in a batch.
+ */
+#define MINIBATCH_DEFAULT_SIZE 1024
+
+/**
+ * The default number of batches of a run.
+ */
+#define MINIBATCH_DEFAULT_ITERATIONS 100
+
+/**
+ * The seed of the draws. It is the same for all the runs, so the output does not depend on the order of the runs or
+ * on the number of threads.
+ */
+#define MINIBATCH_SEED 0x5DEECE66DULL
+
+int minibatch_kmeans(list_of_centroids_and_clusters_only *, const dataset_t *, uint32_t, const dataset_t *,
+                     uint32_t, uint32_t);
+
+#endif //MINIBATCH_H
@@ -0,0 +1,66 @@
+#ifndef NARROW_H
+#define NARROW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dataset.h"
+#include "distance.h"
+
+/**
+ * A copy of the points (or of the centroids) stored with the narrowest integers which can hold their coordinates,
+ * so the loops of Lloyd read 2 or 4 times less memory and the vectorized loops hold 2 or 4 times more coordinates.
+ *
+ * All the coordinates, of the points and of the centroids they are compared to, lie in [minimum, maximum]. The range
+ * holds 0, the centroid of an empty cluster, and is chosen so that the distances computed with an accumulator of
+ * the given width never overflow : the results are then exactly the ones of the int64_t loops.
+ *
+ * @param values (void *) : The matrix, aligned on DATASET_ALIGNMENT bytes, of int16_t or int32_t (stride == dimension).
+ * @param width (uint32_t) : The size of a coordinate in bytes, 2 or 4.
+ * @param accumulator (uint32_t) : The size in bytes of the integers the distances are summed in, 4 or 8.
+ * @param dimension (uint32_t) : The dimension of the points.
+ * @param size (uint64_t) : The number of points.
+ * @param minimum (int64_t) : The smallest coordinate allowed.
+ * @param maximum (int64_t) : The largest coordinate allowed.
+ *
+ * Note that there are specific function for this data structure.
+ *
+ *      - Initialize            = <narrow_init>.
+ *      - Fill                  = <narrow_pack>.
+ *      - Destroy with content  = <narrow_destroy>.
+ */
+typedef struct {
+    void * values;
+    uint32_t width;
+    uint32_t accumulator;
+    uint32_t dimension;
+    uint64_t size;
+    int64_t minimum;
+    int64_t maximum;
+} narrow_t;
+
+/**
+ * Returns the pointer to the coordinates of the i-th point, stored with int16_t.
+ */
+static inline const int16_t * narrow_row16(const narrow_t * narrow, uint64_t i)
+{
+    return (const int16_t *) narrow->values + i * narrow->dimension;
+}
+
+/**
+ * Returns the pointer to the coordinates of the i-th point, stored with int32_t.
+ */
+static inline const int32_t * narrow_row32(const narrow_t * narrow, uint64_t i)
+{
+    return (const int32_t *) narrow->values + i * narrow->dimension;
+}
+
+bool narrow_choose(narrow_t *, squared_distance_func_t, uint32_t, int64_t, int64_t);
+
+int narrow_init(narrow_t *, const narrow_t *, uint64_t);
+
+int narrow_pack(narrow_t *, const dataset_t *);
+
+void narrow_destroy(narrow_t *);
+
+#endif //NARROW_H
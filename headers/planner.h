@@ -0,0 +1,61 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "argumentsparser.h"
+
+/**
+ * The share of the free memory the runs in flight and the queued results may take.
+ */
+#define PLANNER_MEMORY_SHARE 2
+
+/**
+ * The number of results queued for the output-writer thread per run in flight.
+ */
+#define PLANNER_QUEUE_PER_RUN 2
+
+/**
+ * How the program runs on the machine, decided once the input file is read.
+ *
+ * @param cpus (uint32_t) : The number of cpus the process may use : those it may run on, bounded by the quota of
+ *                          it's cgroup.
+ * @param quota (double) : The quota of the cgroup in cpus, 0 without one.
+ * @param memory (uint64_t) : The memory the runs in flight and the queued results may take, in bytes.
+ * @param workers (uint32_t) : The number of calculating threads (-n if given).
+ * @param inter (uint32_t) : The number of runs in flight at once, each on it's own calculating thread (the others
+ *                           only take parts of their iterations).
+ * @param intra (uint32_t) : The largest number of parts an iteration of a run is split in.
+ * @param batch (uint64_t) : The number of combinations claimed at once by a calculating thread.
+ * @param queue (uint32_t) : The number of results queued for the output-writer thread.
+ * @param runs (uint64_t) : The number of runs.
+ * @param given (bool) : true if the number of calculating threads was given by -n.
+ *
+ * Note that there are specific function for this data structure.
+ *
+ *      - Read the machine      = <planner_init>.
+ *      - Decide                = <planner_plan>.
+ *      - Write the decision    = <planner_log>.
+ */
+typedef struct {
+    uint32_t cpus;
+    double quota;
+    uint64_t memory;
+    uint32_t workers;
+    uint32_t inter;
+    uint32_t intra;
+    uint64_t batch;
+    uint32_t queue;
+    uint64_t runs;
+    bool given;
+} plan_t;
+
+void planner_init(plan_t *);
+
+void planner_plan(plan_t *, const args_t *, uint64_t, uint32_t);
+
+void planner_log(const plan_t *, const args_t *, uint64_t, uint32_t, FILE *);
+
+#endif //PLANNER_H
@@ -4,6 +4,8 @@
 #include <string.h>
 #include <stdint.h>
 
+#include "csv.h"
+
 /**
  * This structures is used to represent a point of a certain dimension. 
  * - dimension (uint32_t *) : is the pointer to the dimension of the point.
@@ -32,6 +34,6 @@ typedef struct
 
 typedef point_t centroid_t ; 
 
-int pointToFILE(FILE *, point_t *);
+int pointToCSV(csv_t *, const point_t *);
 
 #endif //POINT_H
@@ -0,0 +1,96 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "team.h"
+
+/**
+ * The number of tasks a worker can have in it's deque at once, a power of 2. A run only pushes the parts of one step
+ * at a time, at most the size of the pool minus one.
+ */
+#define POOL_DEQUE_SIZE 256
+
+/**
+ * The work of each worker of a pool, until there's none left for it.
+ *
+ * @param arg (void *) : The argument given to <pool_run>.
+ * @param team (team_t *) : The team of the worker : the parts of a job run with it are tasks the other workers can
+ *                          steal.
+ */
+typedef void (*pool_work_t) (void * arg, team_t * team);
+
+/**
+ * A part of a job, run by the worker that pushed it or stolen by another one.
+ *
+ * @param job (team_job_t) : The job.
+ * @param arg (void *) : The argument of the job.
+ * @param member (uint32_t) : The part of the job.
+ * @param nbOfMembers (uint32_t) : The number of parts of the job.
+ * @param pending (uint32_t *) : The number of parts of the job not done yet, decremented once this one is.
+ */
+typedef struct {
+    team_job_t job;
+    void * arg;
+    uint32_t member;
+    uint32_t nbOfMembers;
+    uint32_t * pending;
+} pool_task_t;
+
+/**
+ * The deque of Chase and Lev of a worker : it pushes and pops it's tasks at the bottom, the other workers steal them
+ * at the top, the owner and the thieves only meet with a compare-and-swap on the last task.
+ *
+ * @param top (int64_t) : The position of the next task to steal, on it's own cache line.
+ * @param bottom (int64_t) : The position of the next task to push, on it's own cache line.
+ * @param tasks (pool_task_t * [POOL_DEQUE_SIZE]) : The tasks, by position modulo POOL_DEQUE_SIZE.
+ */
+typedef struct {
+    int64_t top __attribute__((aligned(TEAM_CACHE_LINE)));
+    int64_t bottom __attribute__((aligned(TEAM_CACHE_LINE)));
+    pool_task_t * tasks[POOL_DEQUE_SIZE];
+} pool_deque_t;
+
+/**
+ * A pool of worker threads stealing work from each other. Each worker first does it's own work (see <pool_work_t>),
+ * the jobs it runs with it's team are split in tasks pushed in it's deque : it runs them itself unless another
+ * worker steals them first. A worker whose work is done steals the tasks of the others until all the works are done,
+ * so the last runs are shared by all the workers.
+ *
+ * @param size (uint32_t) : The number of workers.
+ * @param deques (pool_deque_t *) : The deque of each worker.
+ * @param teams (team_t *) : The team of each worker, which runs the jobs with the pool.
+ * @param threads (pthread_t *) : The threads of the workers.
+ * @param working (uint32_t) : The number of workers still doing their own work.
+ * @param events (uint32_t) : Incremented when tasks are pushed or when the last work is done, the idle workers wait
+ *                            on it.
+ * @param idle (uint32_t) : The number of workers waiting for a task.
+ *
+ * Note that there are specific function for this data structure.
+ *
+ *      - Initialize                = <pool_init>.
+ *      - Run the workers           = <pool_run>.
+ *      - Run a job with the pool   = <pool_split>, through <team_run>.
+ *      - Destroy                   = <pool_destroy>.
+ */
+typedef struct pool {
+    uint32_t size;
+    pool_deque_t * deques;
+    team_t * teams;
+    pthread_t * threads;
+    uint32_t working;
+    uint32_t events;
+    uint32_t idle;
+} pool_t;
+
+int pool_init(pool_t *, uint32_t, uint32_t);
+
+int pool_run(pool_t *, pool_work_t, void *);
+
+void pool_split(pool_t *, uint32_t, uint32_t, team_job_t, void *);
+
+void pool_destroy(pool_t *);
+
+#endif //POOL_H
@@ -0,0 +1,90 @@
+#ifndef TEAM_H
+#define TEAM_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * The size of a cache line. The data written by the different members of a team are aligned and padded on it, so
+ * two members never write in the same line.
+ */
+#define TEAM_CACHE_LINE 64
+
+/**
+ * A job run by every member of a team.
+ *
+ * @param arg (void *) : The argument given to <team_run>.
+ * @param member (uint32_t) : The index of the member running the job, from 0 to nbOfMembers - 1.
+ * @param nbOfMembers (uint32_t) : The number of members running the job.
+ */
+typedef void (*team_job_t) (void * arg, uint32_t member, uint32_t nbOfMembers);
+
+struct pool;
+
+/**
+ * A team of threads working on the same run of k-means. The thread owning the team is it's member 0, the size - 1
+ * other members are helper threads waiting for the next job between two steps of the run.
+ *
+ * @param size (uint32_t) : The number of members, the owner included.
+ * @param threads (pthread_t *) : The size - 1 helper threads.
+ * @param nbOfThreads (uint32_t) : The number of helper threads started.
+ * @param mutex (pthread_mutex_t) : Protects the fields below.
+ * @param start (pthread_cond_t) : Signaled when a job is given to the helpers.
+ * @param done (pthread_cond_t) : Signaled when the last helper has finished the job.
+ * @param generation (uint64_t) : Incremented at each job, a helper knows this way that it has a new one.
+ * @param pending (uint32_t) : The number of helpers that have not finished the current job.
+ * @param nbOfMembers (uint32_t) : The number of members running the current job, the others skip it.
+ * @param job (team_job_t) : The current job.
+ * @param arg (void *) : The argument of the current job.
+ * @param stop (bool) : Set to make the helpers return.
+ * @param pool (struct pool *) : The pool of the team of a worker (see <pool_t>), NULL for a team with helpers : the
+ *                               parts of a job are then tasks the other workers of the pool can steal.
+ * @param worker (uint32_t) : The index of the worker in it's pool.
+ *
+ * ATTENTION : Note that there are specific functions for :
+ *              - initializing a team : <team_init>
+ *              - running a job on all the members : <team_run>
+ *              - stopping the helpers : <team_destroy>
+ */
+typedef struct {
+    uint32_t size;
+    pthread_t * threads;
+    uint32_t nbOfThreads;
+    pthread_mutex_t mutex;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    uint64_t generation;
+    uint32_t pending;
+    uint32_t nbOfMembers;
+    team_job_t job;
+    void * arg;
+    bool stop;
+    struct pool * pool;
+    uint32_t worker;
+} team_t;
+
+/**
+ * Returns the number of members of the team, 1 for a NULL team.
+ */
+static inline uint32_t team_size(const team_t * team)
+{
+    return (team == NULL) ? 1 : team->size;
+}
+
+/**
+ * Returns the first index of the part of [0, size) given to a member, when it is split in nbOfMembers contiguous
+ * parts. The part of the member is [team_begin(member), team_begin(member + 1)).
+ */
+static inline uint64_t team_begin(uint64_t size, uint32_t member, uint32_t nbOfMembers)
+{
+    return (uint64_t) (((unsigned __int128) size * member) / nbOfMembers);
+}
+
+int team_init(team_t *, uint32_t);
+
+void team_run(team_t *, uint32_t, team_job_t, void *);
+
+void team_destroy(team_t *);
+
+#endif //TEAM_H
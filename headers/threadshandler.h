@@ -13,16 +13,22 @@
 #include "argumentsparser.h"
 #include "filehandler.h"
 #include "circularbuffer.h"
-#include "arrayofclusters.h"
+#include "labels.h"
+#include "dataset.h"
+#include "team.h"
+#include "planner.h"
 
 typedef struct {
-    array_of_centroids *initialCentroids;
+    dataset_t *initialCentroids;
     int64_t distortion_distance;
-    array_of_centroids *finalCentroids;
+    dataset_t *finalCentroids;
     array_of_clusters *finalClusters;
+    uint64_t rank;
 }calculation_result_holder;
+
+int writeCalculationsHolderToCSV(csv_t *, calculation_result_holder *, bool, const file_t *);
  
-int putThreadsToWork(args_t *, file_t *, circular_buf * );
+int putThreadsToWork(args_t *, file_t *, const plan_t *);
 int setHighestPriority(pthread_attr_t * );
 
 #endif //THREADHANDLER_H
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef YINYANG_H
+#define YINYANG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dataset.h"
+#include "labels.h"
+#include "kernels.h"
+
+/**
+ * The number of centroids per group, on average.
+ */
+#define YINYANG_GROUP_SIZE 10
+
+/**
+ * The state of the assignment of Yinyang, kept between the iterations of one run of k-means. The centroids are
+ * split in groups once, at the first assignment, and each point has one lower bound per group.
+ *
+ * @param K (uint32_t) : The number of centroids.
+ * @param G (uint32_t) : The number of groups.
+ * @param groupOf (uint32_t *) : For each centroid, the index of it's group.
+ * @param members (uint32_t *) : The K indexes of the centroids, sorted by group.
+ * @param firstOfGroup (uint32_t *) : For each group, the position of it's first centroid in members (G + 1 elements).
+ * @param upper (double *) : For each point, an upper bound of the distance to it's centroid.
+ * @param lower (double *) : A size * G matrix, the lower bounds of the distances of each point to the centroids
+ *                           of each group, it's own centroid excepted.
+ * @param drifts (double *) : For each centroid, how much it has moved since the last assignment.
+ * @param groupDrifts (double *) : For each group, the largest drift of it's centroids.
+ * @param closest (int64_t *) : G elements, the smallest distance of a point to each group (temporary).
+ * @param secondClosest (int64_t *) : G elements, the second smallest distance of a point to each group (temporary).
+ * @param closestIndex (uint32_t *) : G elements, the closest centroid of each group, UINT32_MAX if the group has
+ *                                    been skipped (temporary).
+ * @param started (bool) : false before the first assignment.
+ * @param previous (dataset_t) : The centroids of the last assignment.
+ */
+typedef struct {
+    uint32_t K;
+    uint32_t G;
+    uint32_t * groupOf;
+    uint32_t * members;
+    uint32_t * firstOfGroup;
+    double * upper;
+    double * lower;
+    double * drifts;
+    double * groupDrifts;
+    int64_t * closest;
+    int64_t * secondClosest;
+    uint32_t * closestIndex;
+    bool started;
+    dataset_t previous;
+} yinyang_t;
+
+void * yinyang_create(const dataset_t *, uint32_t);
+
+int yinyang_assign(void *, const dataset_t *, const dataset_t *, labels_t *, moves_t *, const lloyd_kernels_t *);
+
+void yinyang_destroy(void *);
+
+#endif //YINYANG_H
@@ -0,0 +1,578 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "affinity.h"
+#include "dataset.h"
+#include "narrow.h"
+
+/**
+ * The path of the list of the cpus of a NUMA node, by it's number.
+ */
+#define AFFINITY_NODE_PATH "/sys/devices/system/node/node%u/cpulist"
+
+/**
+ * Parses a list of cpus such as "0-3,8,10-11", ended by '\0', ':', '/' or a new line.
+ *
+ * @param list (const char *) : The list.
+ * @param cpus (uint32_t *) : Filled with the cpus, in the order of the list (room for AFFINITY_MAX_CPUS of them).
+ * @param count (uint32_t *) : Set to the number of cpus.
+ *
+ * @return (const char *) : The end of the list, NULL if it's malformed, empty or too long.
+ */
+static const char * affinity_parseCpus(const char * list, uint32_t * cpus, uint32_t * count)
+{
+    *count = 0;
+    const char * c = list;
+    while (true)
+    {
+        char * end;
+        if (*c < '0' || *c > '9'){ return NULL; }
+        unsigned long first = strtoul(c, &end, 10);
+        unsigned long last = first;
+        c = end;
+        if (*c == '-')
+        {
+            c++;
+            if (*c < '0' || *c > '9'){ return NULL; }
+            last = strtoul(c, &end, 10);
+            c = end;
+        }
+        if (first > last || last >= AFFINITY_MAX_CPUS || *count + (last - first + 1) > AFFINITY_MAX_CPUS){ return NULL; }
+        for (unsigned long cpu = first; cpu <= last; cpu++){ cpus[(*count)++] = (uint32_t) cpu; }
+        if (*c != ','){ break; }
+        c++;
+    }
+    return (*c == '\0' || *c == ':' || *c == '/' || *c == '\n') ? c : NULL;
+}
+
+/**
+ * Adds a node with the given cpus to the topology.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+static int affinity_addNode(affinity_t * affinity, const uint32_t * cpus, uint32_t count)
+{
+    if (affinity->nbOfNodes == AFFINITY_MAX_NODES){ return -1; }
+    uint32_t total = (affinity->nbOfNodes == 0) ? 0 : affinity->nodeFirst[affinity->nbOfNodes];
+    uint32_t * nodeCpus = (uint32_t *) realloc(affinity->nodeCpus, sizeof(uint32_t) * (total + count));
+    if (nodeCpus == NULL){ return -1; }
+    affinity->nodeCpus = nodeCpus;
+    uint32_t * nodeFirst = (uint32_t *) realloc(affinity->nodeFirst, sizeof(uint32_t) * (affinity->nbOfNodes + 2));
+    if (nodeFirst == NULL){ return -1; }
+    affinity->nodeFirst = nodeFirst;
+
+    memcpy(nodeCpus + total, cpus, sizeof(uint32_t) * count);
+    nodeFirst[affinity->nbOfNodes] = total;
+    nodeFirst[affinity->nbOfNodes + 1] = total + count;
+    for (uint32_t i = 0; i < count; i++){ affinity->nodeOfCpu[cpus[i]] = affinity->nbOfNodes; }
+    affinity->nbOfNodes++;
+    return 0;
+}
+
+/**
+ * Fills the cpus the process is allowed to run on.
+ *
+ * @return (uint32_t) : The number of cpus, 0 if they are unknown.
+ */
+static uint32_t affinity_allowedCpus(uint32_t * cpus)
+{
+    cpu_set_t set;
+    uint32_t count = 0;
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &set) != 0){ return 0; }
+    for (uint32_t cpu = 0; cpu < AFFINITY_MAX_CPUS && cpu < CPU_SETSIZE; cpu++)
+    {
+        if (CPU_ISSET(cpu, &set)){ cpus[count++] = cpu; }
+    }
+    return count;
+}
+
+/**
+ * Reads the NUMA nodes of the machine, the nodes without cpu are left out. Without them (no NUMA support), the
+ * machine is a single node with the cpus the process is allowed to run on.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+static int affinity_readTopology(affinity_t * affinity)
+{
+    uint32_t cpus[AFFINITY_MAX_CPUS];
+    uint32_t count;
+    char path[64];
+    char line[4096];
+    for (uint32_t node = 0; node < AFFINITY_MAX_NODES; node++)
+    {
+        snprintf(path, sizeof(path), AFFINITY_NODE_PATH, node);
+        FILE * file = fopen(path, "r");
+        if (file == NULL){ continue; }
+        bool read = fgets(line, sizeof(line), file) != NULL;
+        fclose(file);
+        if (read && affinity_parseCpus(line, cpus, &count) != NULL)
+        {
+            if (affinity_addNode(affinity, cpus, count) != 0){ return -1; }
+        }
+    }
+    if (affinity->nbOfNodes > 0){ return 0; }
+
+    count = affinity_allowedCpus(cpus);
+    if (count == 0)
+    {
+        cpus[0] = 0;
+        count = 1;
+    }
+    return affinity_addNode(affinity, cpus, count);
+}
+
+/**
+ * Fills the cpus of the nodes one node after the other : the first cpu of each node, then the second one...
+ *
+ * @param affinity (const affinity_t *) : The topology.
+ * @param isAllowed (const bool *) : The cpus that can be taken, by their number, NULL to take all of them.
+ * @param cpus (uint32_t *) : Filled with the cpus (room for AFFINITY_MAX_CPUS of them).
+ *
+ * @return (uint32_t) : The number of cpus.
+ */
+static uint32_t affinity_spread(const affinity_t * affinity, const bool * isAllowed, uint32_t * cpus)
+{
+    uint32_t count = 0;
+    uint32_t total = affinity->nodeFirst[affinity->nbOfNodes];
+    for (uint32_t rank = 0; rank < total && count < AFFINITY_MAX_CPUS; rank++)
+    {
+        for (uint32_t node = 0; node < affinity->nbOfNodes && count < AFFINITY_MAX_CPUS; node++)
+        {
+            uint32_t position = affinity->nodeFirst[node] + rank;
+            if (position < affinity->nodeFirst[node + 1]
+                && (isAllowed == NULL || isAllowed[affinity->nodeCpus[position]]))
+            {
+                cpus[count++] = affinity->nodeCpus[position];
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * Checks the arguments of the affinity and of the topology before the program starts.
+ *
+ * @param cpus (const char *) : The cpus of the workers, "auto" or a list (see <affinity_init>), optionally followed by
+ *                              ':' and the cpus of the output-writer thread, NULL if not given.
+ * @param nodes (const char *) : The simulated topology, the lists of the cpus of each node separated by '/', NULL to
+ *                               read the one of the machine.
+ *
+ * @return (int) : 0 if they are well formed, else -1.
+ */
+int affinity_check(const char * cpus, const char * nodes)
+{
+    uint32_t list[AFFINITY_MAX_CPUS];
+    uint32_t count;
+    if (cpus != NULL)
+    {
+        const char * c = cpus;
+        if (strncmp(c, "auto", 4) == 0)
+        {
+            c += 4;
+        } else {
+            c = affinity_parseCpus(c, list, &count);
+        }
+        if (c != NULL && *c == ':'){ c = affinity_parseCpus(c + 1, list, &count); }
+        if (c == NULL || *c != '\0'){ return -1; }
+    }
+    if (nodes != NULL)
+    {
+        const char * c = nodes;
+        uint32_t nbOfNodes = 0;
+        do {
+            if (*c == '/'){ c++; }
+            c = affinity_parseCpus(c, list, &count);
+            nbOfNodes++;
+        } while (c != NULL && *c == '/' && nbOfNodes < AFFINITY_MAX_NODES);
+        if (c == NULL || *c != '\0'){ return -1; }
+    }
+    return 0;
+}
+
+/**
+ * Initializes the topology and the cpus of the threads.
+ *
+ * The workers are pinned each on one cpu, the i-th worker on the i-th cpu of the list (modulo it's length). With
+ * "auto", the list takes the cpus of the nodes one node after the other : the first cpu of each node, then the second
+ * one... so that the workers are spread over the nodes (only the cpus the process may run on, unless the topology is
+ * simulated). The output-writer thread may run on any cpu of it's list, it's not pinned without one.
+ *
+ * ATTENTION : Think of freeing it with the specific function <affinity_destroy> when done.
+ *
+ * @param affinity (affinity_t *) : The affinity.
+ * @param cpus (const char *) : The cpus, checked by <affinity_check>, NULL to pin the workers only if pin is set.
+ * @param nodes (const char *) : The simulated topology (see <affinity_check>), NULL to read the one of the machine.
+ * @param pin (bool) : true to pin the workers even without cpus (they are then "auto").
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+int affinity_init(affinity_t * affinity, const char * cpus, const char * nodes, bool pin)
+{
+    memset(affinity, 0, sizeof(affinity_t));
+    if (affinity_check(cpus, nodes) != 0)
+    {
+        fprintf(stderr, "[affinity.c] Malformed list of cpus\n");
+        return -1;
+    }
+    uint32_t list[AFFINITY_MAX_CPUS];
+    uint32_t count;
+    int possibleError = 0;
+    affinity->simulated = nodes != NULL;
+    if (nodes != NULL)
+    {
+        const char * c = nodes;
+        while (possibleError == 0 && c != NULL && *c != '\0')
+        {
+            c = affinity_parseCpus(c, list, &count);
+            possibleError = affinity_addNode(affinity, list, count);
+            if (*c == '/'){ c++; }
+        }
+    } else {
+        possibleError = affinity_readTopology(affinity);
+    }
+
+    const char * writer = NULL;
+    if (possibleError == 0 && ((cpus == NULL && pin) || (cpus != NULL && strncmp(cpus, "auto", 4) == 0)))
+    {
+        if (cpus != NULL && cpus[4] == ':'){ writer = cpus + 5; }
+        // The cpus of the nodes the process may run on, all of them with a simulated topology
+        uint32_t allowed[AFFINITY_MAX_CPUS];
+        uint32_t nbOfAllowed = (nodes == NULL) ? affinity_allowedCpus(allowed) : 0;
+        bool isAllowed[AFFINITY_MAX_CPUS] = { false };
+        for (uint32_t i = 0; i < nbOfAllowed; i++){ isAllowed[allowed[i]] = true; }
+        count = (nbOfAllowed > 0) ? affinity_spread(affinity, isAllowed, list) : 0;
+        if (count == 0){ count = affinity_spread(affinity, NULL, list); }
+    } else if (possibleError == 0 && cpus != NULL) {
+        writer = affinity_parseCpus(cpus, list, &count);
+        writer = (*writer == ':') ? writer + 1 : NULL;
+    } else {
+        count = 0;
+    }
+    if (possibleError == 0 && count > 0)
+    {
+        affinity->workerCpus = (uint32_t *) malloc( sizeof(uint32_t) * count );
+        if (affinity->workerCpus == NULL){ possibleError = -1; }
+        else {
+            memcpy(affinity->workerCpus, list, sizeof(uint32_t) * count);
+            affinity->nbOfWorkerCpus = count;
+        }
+    }
+    if (possibleError == 0 && writer != NULL)
+    {
+        affinity_parseCpus(writer, list, &count);
+        affinity->writerCpus = (uint32_t *) malloc( sizeof(uint32_t) * count );
+        if (affinity->writerCpus == NULL){ possibleError = -1; }
+        else {
+            memcpy(affinity->writerCpus, list, sizeof(uint32_t) * count);
+            affinity->nbOfWriterCpus = count;
+        }
+    }
+    if (possibleError != 0)
+    {
+        fprintf(stderr, "[affinity.c] Failed malloc when initiating the affinity of the threads\n");
+        affinity_destroy(affinity);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Pins a thread on the given cpus.
+ *
+ * @return (int) : 0 upon success, else -1 (a cpu the machine does not have, or the process may not run on).
+ */
+static int affinity_pin(pthread_t thread, const uint32_t * cpus, uint32_t count)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (uint32_t i = 0; i < count; i++){ CPU_SET(cpus[i], &set); }
+    return (pthread_setaffinity_np(thread, sizeof(cpu_set_t), &set) == 0) ? 0 : -1;
+}
+
+/**
+ * Tells that the threads could not be pinned, once for all the threads.
+ */
+static void affinity_warn(affinity_t * affinity)
+{
+    if (__atomic_exchange_n(&affinity->warned, 1, __ATOMIC_RELAXED) == 0)
+    {
+        fprintf(stderr, "[affinity.c] Warning -- some threads could not be pinned on their cpus, the system places them\n");
+    }
+}
+
+/**
+ * Pins the calling worker of the pool on it's cpu, if the workers are pinned.
+ *
+ * @param affinity (affinity_t *) : The affinity.
+ * @param worker (uint32_t) : The index of the worker.
+ *
+ * @return (int) : 0 upon success, else -1 (the worker runs where the system puts it).
+ */
+int affinity_pinWorker(affinity_t * affinity, uint32_t worker)
+{
+    if (affinity->workerCpus == NULL){ return 0; }
+    if (affinity_pin(pthread_self(), &affinity->workerCpus[worker % affinity->nbOfWorkerCpus], 1) != 0)
+    {
+        affinity_warn(affinity);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Pins the output-writer thread on it's cpus, if it's pinned.
+ *
+ * @param affinity (affinity_t *) : The affinity.
+ * @param thread (pthread_t) : The output-writer thread.
+ *
+ * @return (int) : 0 upon success, else -1 (the thread runs where the system puts it).
+ */
+int affinity_pinWriter(affinity_t * affinity, pthread_t thread)
+{
+    if (affinity->writerCpus == NULL){ return 0; }
+    if (affinity_pin(thread, affinity->writerCpus, affinity->nbOfWriterCpus) != 0)
+    {
+        affinity_warn(affinity);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Returns the node of a worker of the pool, 0 if the workers are not pinned.
+ *
+ * @param affinity (const affinity_t *) : The affinity.
+ * @param worker (uint32_t) : The index of the worker.
+ */
+uint32_t affinity_nodeOfWorker(const affinity_t * affinity, uint32_t worker)
+{
+    if (affinity->workerCpus == NULL){ return 0; }
+    return affinity->nodeOfCpu[affinity->workerCpus[worker % affinity->nbOfWorkerCpus]];
+}
+
+/**
+ * The argument of a thread placing points on it's node.
+ *
+ * @param affinity (const affinity_t *) : The affinity.
+ * @param node (uint32_t) : The node of the thread.
+ * @param source (const dataset_t *) : The points to copy.
+ * @param sourceNarrow (const narrow_t *) : The narrow points to copy, NULL if there are none.
+ * @param points (dataset_t *) : The copy of the points.
+ * @param narrow (narrow_t *) : The copy of the narrow points.
+ * @param allocate (bool) : true if the thread allocates the copies, false if they are already.
+ * @param begin (uint64_t) : The first point copied by the thread.
+ * @param end (uint64_t) : The point after the last one copied by the thread.
+ * @param pin (bool) : true if the thread is pinned on the cpus of it's node, false for a simulated node (whose cpus
+ *                     may not exist) or when the copy is done by the calling thread, whose cpus must not change.
+ * @param error (int) : Set to -1 if the copies could not be allocated.
+ */
+typedef struct {
+    const affinity_t * affinity;
+    uint32_t node;
+    const dataset_t * source;
+    const narrow_t * sourceNarrow;
+    dataset_t * points;
+    narrow_t * narrow;
+    bool allocate;
+    uint64_t begin;
+    uint64_t end;
+    bool pin;
+    int error;
+} affinity_placer_t;
+
+/**
+ * Copies a part of the points from a thread running on a node : the pages it writes first are placed on it.
+ *
+ * @param argT (void *) : A (affinity_placer_t *) pointer.
+ *
+ * @return (void *) NULL.
+ */
+static void * affinity_placerFunction(void * argT)
+{
+    affinity_placer_t * placer = (affinity_placer_t *) argT;
+    const affinity_t * affinity = placer->affinity;
+    const dataset_t * source = placer->source;
+    uint32_t node = placer->node;
+    // Not pinned (a simulated node or the calling thread), the copy is only placed where the system runs the thread
+    if (placer->pin)
+    {
+        affinity_pin(pthread_self(), &affinity->nodeCpus[affinity->nodeFirst[node]],
+                     affinity->nodeFirst[node + 1] - affinity->nodeFirst[node]);
+    }
+
+    if (placer->allocate)
+    {
+        placer->error = dataset_init(placer->points, source->size, source->dimension);
+        if (placer->error == 0 && placer->sourceNarrow != NULL)
+        {
+            placer->error = narrow_init(placer->narrow, placer->sourceNarrow, source->size);
+            if (placer->error != 0){ dataset_destroy(placer->points); }
+        }
+        if (placer->error != 0){ return NULL; }
+    }
+    dataset_t * points = placer->points;
+    for (uint64_t i = placer->begin; i < placer->end; i++)
+    {
+        memcpy(dataset_row(points, i), dataset_row(source, i), sizeof(int64_t) * source->dimension);
+    }
+    if (placer->sourceNarrow != NULL)
+    {
+        uint64_t row = (uint64_t) placer->narrow->dimension * placer->narrow->width;
+        memcpy((char *) placer->narrow->values + placer->begin * row,
+               (const char *) placer->sourceNarrow->values + placer->begin * row, (placer->end - placer->begin) * row);
+    }
+    return NULL;
+}
+
+/**
+ * Copies the points read by the workers, each node writing first the pages it must hold. With
+ * AFFINITY_NUMA_REPLICATE each node has it's own copy, with AFFINITY_NUMA_PARTITION the n-th of the N nodes holds the
+ * n-th N-th of a single copy. The copies are written by a thread pinned on the cpus of the node, unless the topology
+ * is simulated : then, or without NUMA support, the copies are the same but their pages are where the system puts
+ * them.
+ *
+ * ATTENTION : Think of freeing them with the specific function <affinity_destroyReplicas> when done.
+ *
+ * @param replicas (affinity_replicas_t *) : The copies.
+ * @param affinity (const affinity_t *) : The affinity, the workers of a node read the copy <affinity_nodeOfWorker>
+ *                                        modulo the number of copies.
+ * @param mode (affinity_numa_t) : AFFINITY_NUMA_REPLICATE or AFFINITY_NUMA_PARTITION.
+ * @param points (const dataset_t *) : The points.
+ * @param narrow (const narrow_t *) : The narrow copy of the points, NULL if there is none.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+int affinity_place(affinity_replicas_t * replicas, const affinity_t * affinity, affinity_numa_t mode,
+                   const dataset_t * points, const narrow_t * narrow)
+{
+    uint32_t nbOfNodes = affinity->nbOfNodes;
+    replicas->nbOfReplicas = (mode == AFFINITY_NUMA_REPLICATE) ? nbOfNodes : 1;
+    replicas->points = (dataset_t *) calloc(replicas->nbOfReplicas, sizeof(dataset_t));
+    replicas->narrow = (narrow != NULL) ? (narrow_t *) calloc(replicas->nbOfReplicas, sizeof(narrow_t)) : NULL;
+    affinity_placer_t * placers = (affinity_placer_t *) calloc(nbOfNodes, sizeof(affinity_placer_t));
+    pthread_t * threads = (pthread_t *) malloc( sizeof(pthread_t) * nbOfNodes );
+    bool * started = (bool *) calloc(nbOfNodes, sizeof(bool));
+    if (replicas->points == NULL || (narrow != NULL && replicas->narrow == NULL) || placers == NULL || threads == NULL
+        || started == NULL)
+    {
+        fprintf(stderr, "[affinity.c] Failed malloc when placing the points on the nodes\n");
+        free(replicas->points);
+        free(replicas->narrow);
+        free(placers);
+        free(threads);
+        free(started);
+        return -1;
+    }
+
+    int possibleError = 0;
+    bool partition = (mode != AFFINITY_NUMA_REPLICATE);
+    if (partition)
+    {
+        // Allocated here, the pages are only placed once written by the threads
+        possibleError = dataset_init(&replicas->points[0], points->size, points->dimension);
+        if (possibleError == 0 && narrow != NULL)
+        {
+            possibleError = narrow_init(&replicas->narrow[0], narrow, points->size);
+            if (possibleError != 0){ dataset_destroy(&replicas->points[0]); }
+        }
+    }
+    for (uint32_t node = 0; node < nbOfNodes && possibleError == 0; node++)
+    {
+        uint32_t replica = partition ? 0 : node;
+        placers[node] = (affinity_placer_t) { affinity, node, points, narrow, &replicas->points[replica],
+                                              (narrow != NULL) ? &replicas->narrow[replica] : NULL, !partition,
+                                              partition ? points->size * node / nbOfNodes : 0,
+                                              partition ? points->size * (node + 1) / nbOfNodes : points->size,
+                                              !affinity->simulated, 0 };
+        started[node] = pthread_create(&threads[node], NULL, &affinity_placerFunction, &placers[node]) == 0;
+        // Without a thread the copy is done here, wherever the system puts it : pinning the main thread would pin
+        // all the threads it creates next
+        if (!started[node])
+        {
+            placers[node].pin = false;
+            affinity_placerFunction(&placers[node]);
+        }
+    }
+    for (uint32_t node = 0; node < nbOfNodes; node++)
+    {
+        if (started[node]){ pthread_join(threads[node], NULL); }
+        if (placers[node].error != 0){ possibleError = -1; }
+    }
+    if (possibleError != 0)
+    {
+        fprintf(stderr, "[affinity.c] Failed malloc when placing the points on the nodes\n");
+        for (uint32_t node = 0; node < nbOfNodes; node++)
+        {
+            // The partitioned copy is shared by all the placers
+            if (placers[node].allocate && placers[node].error == 0 && placers[node].points != NULL)
+            {
+                dataset_destroy(placers[node].points);
+                if (narrow != NULL){ narrow_destroy(placers[node].narrow); }
+            }
+        }
+        if (partition)
+        {
+            dataset_destroy(&replicas->points[0]);
+            if (narrow != NULL){ narrow_destroy(&replicas->narrow[0]); }
+        }
+        free(replicas->points);
+        free(replicas->narrow);
+        replicas->points = NULL;
+        replicas->narrow = NULL;
+        replicas->nbOfReplicas = 0;
+    }
+    free(placers);
+    free(threads);
+    free(started);
+    return possibleError;
+}
+
+/**
+ * Frees the copies of the points.
+ *
+ * @param replicas (affinity_replicas_t *) : The copies.
+ *
+ * Note that it does not free the pointer it's self.
+ */
+void affinity_destroyReplicas(affinity_replicas_t * replicas)
+{
+    if (replicas == NULL){ return; }
+    for (uint32_t i = 0; i < replicas->nbOfReplicas; i++)
+    {
+        dataset_destroy(&replicas->points[i]);
+        if (replicas->narrow != NULL){ narrow_destroy(&replicas->narrow[i]); }
+    }
+    free(replicas->points);
+    free(replicas->narrow);
+    replicas->points = NULL;
+    replicas->narrow = NULL;
+    replicas->nbOfReplicas = 0;
+}
+
+/**
+ * Frees the topology and the cpus of the threads.
+ *
+ * @param affinity (affinity_t *) : The affinity.
+ *
+ * Note that it does not free the pointer it's self.
+ */
+void affinity_destroy(affinity_t * affinity)
+{
+    if (affinity == NULL){ return; }
+    free(affinity->nodeCpus);
+    free(affinity->nodeFirst);
+    free(affinity->workerCpus);
+    free(affinity->writerCpus);
+    affinity->nodeCpus = NULL;
+    affinity->nodeFirst = NULL;
+    affinity->workerCpus = NULL;
+    affinity->writerCpus = NULL;
+    affinity->nbOfNodes = 0;
+}
@@ -10,9 +10,10 @@
 #include "argumentsparser.h"
 #include "distance.h"
 #include "point.h"
-#include "arrayofpoints.h"
-#include "arrayofclusters.h"
+#include "labels.h"
 #include "func.h"
+#include "minibatch.h"
+#include "filehandler.h"
 
 squared_distance_func_t FORMULA_CHOOSED;
 /**
@@ -23,10 +24,18 @@ void usage(char *prog_name) {
     fprintf(stderr, "    %s [-p n_combinations_points] [-n n_threads] [input_filename]\n", prog_name);
     fprintf(stderr, "    -k n_clusters (default value: 2): the number of clusters to compute\n");
     fprintf(stderr, "    -p n_combinations (default value: equal to k): consider the n_combinations first points present in the input to generate possible initializations for the k-means algorithm\n");
-    fprintf(stderr, "    -n n_threads (default value: 4): sets the number of computing threads that will be used to execute the k-means algorithm\n");
+    fprintf(stderr, "    -n n_threads (default value: planned): sets the number of computing threads that will be used to execute the k-means algorithm. Without it, they are planned from the cpus available (cgroup quota included), the size of the input, k and the number of initializations, the decision is written on the standard error\n");
     fprintf(stderr, "    -f output_file (default value: stdout): sets the filename on which to write the csv result\n");
     fprintf(stderr, "    -q quiet mode: does not output the clusters content (the \"clusters\" column is simply not present in the csv)\n");
     fprintf(stderr, "    -d distance (manhattan by default): can be either \"euclidean\" or \"manhattan\". Chooses the distance formula to use by the algorithm to compute the distance between the points\n");
+    fprintf(stderr, "    -m algorithm (lloyd by default): can be \"lloyd\", \"elkan\", \"hamerly\", \"yinyang\" or \"kdtree\". Chooses how the points are assigned to their closest centroid, the results are the same. \"minibatch\" computes approximate centroids from batches of points instead\n");
+    fprintf(stderr, "    -b batch_size (default value: %d): the number of points drawn in each batch of the minibatch algorithm\n", MINIBATCH_DEFAULT_SIZE);
+    fprintf(stderr, "    -i n_batches (default value: %d): the number of batches of each run of the minibatch algorithm\n", MINIBATCH_DEFAULT_ITERATIONS);
+    fprintf(stderr, "    -s stream mode: the points are read again from the input file at each iteration instead of being kept in memory, for inputs larger than the memory (only with the lloyd algorithm)\n");
+    fprintf(stderr, "    -P prepare mode: also writes a copy of the input file in the byte order of the host, named after it with the suffix \"%s\". The next runs on the unchanged input file map the copy instead of converting the file\n", FILE_PREPARED_SUFFIX);
+    fprintf(stderr, "    -t n_best (default value: all): only writes the n_best results of lowest distortion, sorted, and writes a summary of all the runs (histogram of the distortions, iterations, number of distinct final centroids) on the standard error\n");
+    fprintf(stderr, "    -a cpus (default value: not pinned): pins the computing threads on the cpus, \"auto\" to spread them over the NUMA nodes or a list such as \"0-6,8\" (the i-th thread on the i-th cpu), optionally followed by \":\" and the cpus of the thread writing the csv (\"0-6:7\")\n");
+    fprintf(stderr, "    -u placement (default value: none): places the points read by the computing threads on the NUMA nodes (the threads are then pinned, \"auto\" if -a is not given), \"replicate\" for a copy per node, \"partition\" for a single copy split between the nodes. It can be followed by \":\" and simulated nodes, their lists of cpus separated by \"/\" (\"replicate:0-3/4-7\")\n");
 }
 
 /**
@@ -44,12 +53,15 @@ int parse_args(args_t *args, int argc, char *argv[]) {
     // the default values are the following, they will be changed depending on the arguments given to the program
     args->k = 2;
     args->n_first_initialization_points = args->k;
-    args->n_threads = 4;
+    args->n_threads = 0;    // planned from the machine and the input, see <planner_plan>
     args->quiet = false;
     args->squared_distance_func = squared_manhattan_distance;
     FORMULA_CHOOSED = squared_manhattan_distance;
+    args->algorithm = KMEANS_LLOYD;
+    args->batch_size = MINIBATCH_DEFAULT_SIZE;
+    args->batch_iterations = MINIBATCH_DEFAULT_ITERATIONS;
     int opt;
-    while ((opt = getopt(argc, argv, "n:p:k:f:d:q")) != -1) {
+    while ((opt = getopt(argc, argv, "n:p:k:f:d:m:b:i:t:a:u:sPq")) != -1) {
         switch (opt)
         {
             case 'n':
@@ -89,6 +101,78 @@ int parse_args(args_t *args, int argc, char *argv[]) {
                     FORMULA_CHOOSED = squared_euclidean_distance;
                 }
                 break;
+            case 'm':
+                if (strcmp("lloyd", optarg) == 0) {
+                    args->algorithm = KMEANS_LLOYD;
+                } else if (strcmp("elkan", optarg) == 0) {
+                    args->algorithm = KMEANS_ELKAN;
+                } else if (strcmp("hamerly", optarg) == 0) {
+                    args->algorithm = KMEANS_HAMERLY;
+                } else if (strcmp("yinyang", optarg) == 0) {
+                    args->algorithm = KMEANS_YINYANG;
+                } else if (strcmp("kdtree", optarg) == 0) {
+                    args->algorithm = KMEANS_KDTREE;
+                } else if (strcmp("minibatch", optarg) == 0) {
+                    args->algorithm = KMEANS_MINIBATCH;
+                } else {
+                    fprintf(stderr, "Wrong algorithm. Needs \"lloyd\", \"elkan\", \"hamerly\", \"yinyang\", \"kdtree\" or \"minibatch\", received \"%s\"\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'b':
+                if (atoi(optarg) <= 0) {
+                    fprintf(stderr, "Wrong batch size. Needs a positive integer, received \"%s\"\n", optarg);
+                    return -1;
+                } else {
+                    args->batch_size = (uint32_t) atoi(optarg);
+                }
+                break;
+            case 'i':
+                if (atoi(optarg) <= 0) {
+                    fprintf(stderr, "Wrong number of batches. Needs a positive integer, received \"%s\"\n", optarg);
+                    return -1;
+                } else {
+                    args->batch_iterations = (uint32_t) atoi(optarg);
+                }
+                break;
+            case 't':
+                if (atoi(optarg) <= 0) {
+                    fprintf(stderr, "Wrong number of best results. Needs a positive integer, received \"%s\"\n", optarg);
+                    return -1;
+                } else {
+                    args->top = (uint32_t) atoi(optarg);
+                }
+                break;
+            case 'a':
+                if (affinity_check(optarg, NULL) != 0) {
+                    fprintf(stderr, "Wrong cpus. Needs \"auto\" or a list such as \"0-6,8\", optionally followed by \":\" and a list, received \"%s\"\n", optarg);
+                    return -1;
+                } else {
+                    args->affinity = optarg;
+                }
+                break;
+            case 'u':
+                if (strncmp("replicate", optarg, 9) == 0 && (optarg[9] == '\0' || optarg[9] == ':')) {
+                    args->numa = AFFINITY_NUMA_REPLICATE;
+                    args->topology = (optarg[9] == ':') ? optarg + 10 : NULL;
+                } else if (strncmp("partition", optarg, 9) == 0 && (optarg[9] == '\0' || optarg[9] == ':')) {
+                    args->numa = AFFINITY_NUMA_PARTITION;
+                    args->topology = (optarg[9] == ':') ? optarg + 10 : NULL;
+                } else {
+                    fprintf(stderr, "Wrong placement. Needs \"replicate\" or \"partition\", optionally followed by \":\" and the nodes, received \"%s\"\n", optarg);
+                    return -1;
+                }
+                if (args->topology != NULL && affinity_check(NULL, args->topology) != 0) {
+                    fprintf(stderr, "Wrong nodes. Needs lists of cpus separated by \"/\" such as \"0-3/4-7\", received \"%s\"\n", args->topology);
+                    return -1;
+                }
+                break;
+            case 's':
+                args->stream = true;
+                break;
+            case 'P':
+                args->prepare = true;
+                break;
             case 'q':
                 args->quiet = true;
                 break;
@@ -109,6 +193,16 @@ int parse_args(args_t *args, int argc, char *argv[]) {
             return -1;
         }
     }
+    if (args->stream && args->algorithm != KMEANS_LLOYD)
+    {
+        fprintf(stderr, "[argumentsparser.c] The stream mode only works with the lloyd algorithm\n");
+        return -1;
+    }
+    if (args->stream && args->prepare)
+    {
+        fprintf(stderr, "[argumentsparser.c] The prepare mode needs the whole input file in memory, it can't be used with the stream mode\n");
+        return -1;
+    }
     if (args->n_first_initialization_points < args->k) 
     {
         fprintf(stderr, "[argumentsparser.c] Cannot generate an instance of k-means with less initialization points than needed clusters: %"PRIu32" < %"PRIu32"\n", args->n_first_initialization_points, args->k);
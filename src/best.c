@@ -0,0 +1,346 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "best.h"
+#include "dataset.h"
+#include "labels.h"
+
+/**
+ * Frees a result and it's content.
+ */
+static void best_freeHolder(calculation_result_holder * holder)
+{
+    dataset_destroy(holder->initialCentroids);
+    free(holder->initialCentroids);
+    dataset_destroy(holder->finalCentroids);
+    free(holder->finalCentroids);
+    if (holder->finalClusters != NULL)
+    {
+        labels_destroy(holder->finalClusters);
+        free(holder->finalClusters);
+    }
+    free(holder);
+}
+
+/**
+ * Returns true if the result a is better than the result b : a lower distortion, or the same one and a lower rank.
+ */
+static bool best_isBetter(const calculation_result_holder * a, const calculation_result_holder * b)
+{
+    if (a->distortion_distance != b->distortion_distance)
+    {
+        return (uint64_t) a->distortion_distance < (uint64_t) b->distortion_distance;
+    }
+    return a->rank < b->rank;
+}
+
+/**
+ * The order of <qsort>, the best results first.
+ */
+static int best_compare(const void * a, const void * b)
+{
+    const calculation_result_holder * first = *(calculation_result_holder * const *) a;
+    const calculation_result_holder * second = *(calculation_result_holder * const *) b;
+    if (best_isBetter(first, second)){ return -1; }
+    return best_isBetter(second, first) ? 1 : 0;
+}
+
+/**
+ * Returns the hash of the final centroids, which doesn't depend on their order : the sum of the mixed hashes
+ * (FNV-1a) of the centroids. It's never 0.
+ */
+static uint64_t best_hashSolution(const dataset_t * centroids)
+{
+    uint64_t sum = 0;
+    for (uint64_t k = 0; k < centroids->size; k++)
+    {
+        const int64_t * row = dataset_row(centroids, k);
+        uint64_t hash = 14695981039346656037ULL;
+        for (uint32_t m = 0; m < centroids->dimension; m++)
+        {
+            hash ^= (uint64_t) row[m];
+            hash *= 1099511628211ULL;
+        }
+        // A sum of the plain hashes would confuse two centroids with opposite differences
+        hash ^= hash >> 31;
+        hash *= 0xbf58476d1ce4e5b9ULL;
+        hash ^= hash >> 29;
+        sum += hash;
+    }
+    return (sum == 0) ? 1 : sum;
+}
+
+/**
+ * Adds the hash of a solution to the table of a shard, if it's not there yet.
+ *
+ * @return (int) : 0 upon success, else -1 when the table could not grow (the table is unchanged).
+ */
+static int best_addSolution(best_shard_t * shard, uint64_t hash)
+{
+    if (2 * (shard->nbOfSolutions + 1) > shard->capacity)
+    {
+        uint64_t capacity = (shard->capacity == 0) ? 1024 : shard->capacity * 2;
+        uint64_t * solutions = (uint64_t *) calloc(capacity, sizeof(uint64_t));
+        if (solutions == NULL){ return -1; }
+        for (uint64_t i = 0; i < shard->capacity; i++)
+        {
+            if (shard->solutions[i] == 0){ continue; }
+            uint64_t slot = shard->solutions[i] & (capacity - 1);
+            while (solutions[slot] != 0){ slot = (slot + 1) & (capacity - 1); }
+            solutions[slot] = shard->solutions[i];
+        }
+        free(shard->solutions);
+        shard->solutions = solutions;
+        shard->capacity = capacity;
+    }
+    uint64_t slot = hash & (shard->capacity - 1);
+    while (shard->solutions[slot] != 0)
+    {
+        if (shard->solutions[slot] == hash){ return 0; }
+        slot = (slot + 1) & (shard->capacity - 1);
+    }
+    shard->solutions[slot] = hash;
+    shard->nbOfSolutions++;
+    return 0;
+}
+
+/**
+ * Keeps a result in the heap of a shard if it's among it's top best, else frees it (or the worst one of the heap).
+ */
+static void best_keep(best_shard_t * shard, uint32_t top, calculation_result_holder * holder)
+{
+    calculation_result_holder ** heap = shard->heap;
+    if (shard->size < top)
+    {
+        // Sift up from the end
+        uint32_t i = shard->size++;
+        while (i > 0 && best_isBetter(heap[(i - 1) / 2], holder))
+        {
+            heap[i] = heap[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        heap[i] = holder;
+        return;
+    }
+    if (top == 0 || !best_isBetter(holder, heap[0]))
+    {
+        best_freeHolder(holder);
+        return;
+    }
+    best_freeHolder(heap[0]);
+    // Sift down from the top
+    uint32_t i = 0;
+    while (true)
+    {
+        uint32_t worst = 2 * i + 1;
+        if (worst >= shard->size){ break; }
+        if (worst + 1 < shard->size && best_isBetter(heap[worst], heap[worst + 1])){ worst++; }
+        if (!best_isBetter(holder, heap[worst])){ break; }
+        heap[i] = heap[worst];
+        i = worst;
+    }
+    heap[i] = holder;
+}
+
+/**
+ * Initializes the shards, empty.
+ *
+ * ATTENTION : Think of freeing it with the specific function <best_destroy> when done.
+ *
+ * @param best (best_t *) : The results kept.
+ * @param top (uint32_t) : The number of results to keep, at least 1.
+ * @param nbOfShards (uint32_t) : The number of calculating threads that will take a shard.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+int best_init(best_t * best, uint32_t top, uint32_t nbOfShards)
+{
+    if (best == NULL){ return -1; }
+    memset(best, 0, sizeof(best_t));
+    if (top == 0 || nbOfShards == 0){ return -1; }
+    best->top = top;
+    best->shards = (best_shard_t *) calloc(nbOfShards, sizeof(best_shard_t));
+    if (best->shards == NULL)
+    {
+        fprintf(stderr, "[best.c] Failed malloc when initiating the shards of the best results\n");
+        return -1;
+    }
+    best->nbOfShards = nbOfShards;
+    for (uint32_t s = 0; s < nbOfShards; s++)
+    {
+        best->shards[s].heap = (calculation_result_holder **) malloc( sizeof(calculation_result_holder *) * top );
+        best->shards[s].minIterations = UINT64_MAX;
+        if (best->shards[s].heap == NULL)
+        {
+            fprintf(stderr, "[best.c] Failed malloc when initiating the shards of the best results\n");
+            best_destroy(best);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Gives it's own shard to a calculating thread.
+ *
+ * @param best (best_t *) : The results kept, shared by the threads.
+ *
+ * @return (best_shard_t *) : The shard of the thread, NULL if they have all been taken.
+ */
+best_shard_t * best_claimShard(best_t * best)
+{
+    uint32_t s = __atomic_fetch_add(&best->nextShard, 1, __ATOMIC_RELAXED);
+    return (s < best->nbOfShards) ? &best->shards[s] : NULL;
+}
+
+/**
+ * Counts a result in the summary of a shard, then keeps it if it's among the best ones of the shard. Otherwise it's
+ * freed at once, or the result it replaces is.
+ *
+ * @param best (best_t *) : The results kept.
+ * @param shard (best_shard_t *) : The shard of the calling thread.
+ * @param holder (calculation_result_holder *) : The result, given to the shard in any case.
+ * @param iterations (uint64_t) : The number of iterations of the run.
+ *
+ * When the table of the solutions can not grow, the result is still counted and kept, but not it's solution : the
+ * number of solutions becomes a lower bound, which is told once for all the threads.
+ */
+void best_offer(best_t * best, best_shard_t * shard, calculation_result_holder * holder, uint64_t iterations)
+{
+    uint64_t distortion = (uint64_t) holder->distortion_distance;
+    uint32_t bucket = (distortion == 0) ? 0 : 64 - (uint32_t) __builtin_clzll(distortion);
+    shard->histogram[bucket]++;
+    shard->runs++;
+    shard->minIterations = (iterations < shard->minIterations) ? iterations : shard->minIterations;
+    shard->maxIterations = (iterations > shard->maxIterations) ? iterations : shard->maxIterations;
+    shard->sumIterations += iterations;
+    if (best_addSolution(shard, best_hashSolution(holder->finalCentroids)) != 0
+        && __atomic_exchange_n(&best->incomplete, 1, __ATOMIC_RELAXED) == 0)
+    {
+        fprintf(stderr, "[best.c] Warning -- failed malloc when growing the table of the solutions, the number of "
+                        "distinct final solutions is a lower bound\n");
+    }
+    best_keep(shard, best->top, holder);
+}
+
+/**
+ * Merges the shards in the first one, once the calculating threads are done, and sorts the best results.
+ *
+ * @param best (best_t *) : The results kept.
+ *
+ * @return (int) : 0 upon success, else -1 (the number of solutions is then a lower bound).
+ */
+int best_merge(best_t * best)
+{
+    int possibleError = 0;
+    best_shard_t * merged = &best->shards[0];
+    for (uint32_t s = 1; s < best->nbOfShards; s++)
+    {
+        best_shard_t * shard = &best->shards[s];
+        for (uint32_t i = 0; i < shard->size; i++)
+        {
+            best_keep(merged, best->top, shard->heap[i]);
+        }
+        shard->size = 0;
+        for (uint32_t b = 0; b < BEST_HISTOGRAM; b++)
+        {
+            merged->histogram[b] += shard->histogram[b];
+        }
+        merged->runs += shard->runs;
+        merged->minIterations = (shard->minIterations < merged->minIterations) ? shard->minIterations : merged->minIterations;
+        merged->maxIterations = (shard->maxIterations > merged->maxIterations) ? shard->maxIterations : merged->maxIterations;
+        merged->sumIterations += shard->sumIterations;
+        for (uint64_t i = 0; i < shard->capacity && possibleError == 0; i++)
+        {
+            if (shard->solutions[i] != 0){ possibleError = best_addSolution(merged, shard->solutions[i]); }
+        }
+    }
+    qsort(merged->heap, merged->size, sizeof(calculation_result_holder *), best_compare);
+    if (possibleError != 0){ best->incomplete = 1; }
+    return possibleError;
+}
+
+/**
+ * Writes the best results in the CSV format of the output, the lowest distortion first, once merged. They are
+ * rendered in the buffer of the calling thread, written to the file at once.
+ *
+ * @param best (const best_t *) : The results kept.
+ * @param file (FILE *) : The file to write to.
+ * @param quiet (bool) : To know if the quiet mode is active.
+ * @param inputFile (const file_t *) : The file of the points that are clustered.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+int best_write(const best_t * best, FILE * file, bool quiet, const file_t * inputFile)
+{
+    csv_t csv;
+    if (csv_init(&csv, file) != 0){ return -1; }
+    int error = 0;
+    for (uint32_t i = 0; i < best->shards[0].size && error == 0; i++)
+    {
+        error = writeCalculationsHolderToCSV(&csv, best->shards[0].heap[i], quiet, inputFile);
+    }
+    return (csv_destroy(&csv) != 0 || error != 0) ? -1 : 0;
+}
+
+/**
+ * Writes the summary of all the runs, once merged : their number, the number of different final centroids, the
+ * statistics of the iterations and the histogram of the distortions.
+ *
+ * @param best (const best_t *) : The results kept.
+ * @param file (FILE *) : The file to write to.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+int best_writeSummary(const best_t * best, FILE * file)
+{
+    const best_shard_t * merged = &best->shards[0];
+    int error = 0;
+    error += fprintf(file, "runs: %"PRIu64", distinct final solutions: %s%"PRIu64"\n", merged->runs,
+                     best->incomplete ? "at least " : "", merged->nbOfSolutions) < 0 ? -1 : 0;
+    if (merged->runs > 0)
+    {
+        error += fprintf(file, "iterations: min %"PRIu64", mean %.2f, max %"PRIu64"\n", merged->minIterations,
+                         (double) merged->sumIterations / (double) merged->runs, merged->maxIterations) < 0 ? -1 : 0;
+    }
+    error += fprintf(file, "distortion histogram:\n") < 0 ? -1 : 0;
+    if (merged->histogram[0] > 0)
+    {
+        error += fprintf(file, "    0: %"PRIu64"\n", merged->histogram[0]) < 0 ? -1 : 0;
+    }
+    for (uint32_t b = 1; b < BEST_HISTOGRAM; b++)
+    {
+        if (merged->histogram[b] == 0){ continue; }
+        error += fprintf(file, "    [2^%"PRIu32", 2^%"PRIu32"): %"PRIu64"\n", b - 1, b, merged->histogram[b]) < 0 ? -1 : 0;
+    }
+    return (error == 0) ? 0 : -1;
+}
+
+/**
+ * Frees the shards and the results still held.
+ *
+ * @param best (best_t *) : The results kept.
+ *
+ * Note that it does not free the pointer it's self.
+ */
+void best_destroy(best_t * best)
+{
+    if (best == NULL || best->shards == NULL){ return; }
+    for (uint32_t s = 0; s < best->nbOfShards; s++)
+    {
+        best_shard_t * shard = &best->shards[s];
+        for (uint32_t i = 0; i < shard->size; i++)
+        {
+            best_freeHolder(shard->heap[i]);
+        }
+        free(shard->heap);
+        free(shard->solutions);
+    }
+    free(best->shards);
+    best->shards = NULL;
+    best->nbOfShards = 0;
+}
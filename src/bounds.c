@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "bounds.h"
+#include "distance.h"
+#include "dataset.h"
+#include "kernels.h"
+
+/**
+ * Checks that the computations of k-means on the points are exact : the sums of the coordinates of a cluster and the
+ * squared distances fit in an int64_t. The centroids are truncated means, so they stay in the box holding the points
+ * and the origin (the centroid of an empty cluster). When it's not the case, the distances overflow and the closest
+ * centroid can't be found with the bounds.
+ *
+ * @param formula (squared_distance_func_t) : squared_manhattan_distance or squared_euclidean_distance.
+ * @param points (const dataset_t *) : The points.
+ *
+ * @return (bool) : true if the bounds can be used, else false.
+ */
+bool bounds_areExact(squared_distance_func_t formula, const dataset_t * points)
+{
+    uint64_t largest = 0;     // The largest absolute value of a coordinate
+    uint64_t squares = 0;     // The sum of the squared widths of the box
+    uint64_t widths = 0;      // The sum of the widths of the box
+    uint64_t total;
+
+    for (uint32_t m = 0; m < points->dimension; m++)
+    {
+        int64_t minimum = 0;
+        int64_t maximum = 0;
+        for (uint64_t i = 0; i < points->size; i++)
+        {
+            int64_t value = dataset_row(points, i)[m];
+            minimum = (value < minimum) ? value : minimum;
+            maximum = (value > maximum) ? value : maximum;
+        }
+        if (minimum == INT64_MIN){ return false; }
+        largest = ( (uint64_t) -minimum > largest ) ? (uint64_t) -minimum : largest;
+        largest = ( (uint64_t) maximum > largest ) ? (uint64_t) maximum : largest;
+
+        uint64_t width = (uint64_t) maximum - (uint64_t) minimum;
+        uint64_t square;
+        if (__builtin_mul_overflow(width, width, &square) || __builtin_add_overflow(squares, square, &squares) ||
+            __builtin_add_overflow(widths, width, &widths))
+        {
+            return false;
+        }
+    }
+    if (__builtin_mul_overflow(largest, points->size, &total) || total > INT64_MAX){ return false; }
+
+    if (formula == squared_euclidean_distance)
+    {
+        return squares <= INT64_MAX;
+    }
+    return !__builtin_mul_overflow(widths, widths, &total) && total <= INT64_MAX;
+}
+
+/**
+ * Computes how much each centroid has moved.
+ *
+ * @param previous (const dataset_t *) : The centroids before the update.
+ * @param centroids (const dataset_t *) : The centroids after the update.
+ * @param drifts (double *) : An array of K elements, where the upper bounds of the moves are stored.
+ * @param kernels (const lloyd_kernels_t *) : The loops selected for the formula and the dimension.
+ */
+void bounds_drifts(const dataset_t * previous, const dataset_t * centroids, double * drifts, const lloyd_kernels_t * kernels)
+{
+    for (uint64_t k = 0; k < centroids->size; k++)
+    {
+        int64_t squared = kernels->distance(dataset_row(previous, k), dataset_row(centroids, k), centroids->dimension);
+        drifts[k] = (squared == 0) ? 0 : bounds_upper(bounds_distance(squared));
+    }
+}
+
+/**
+ * Computes the half of the distances between the centroids. A point closer to it's centroid a than the half of the
+ * distance between a and c is closer to a than to c.
+ *
+ * @param centroids (const dataset_t *) : The K centroids.
+ * @param halves (double *) : A K * K matrix where the lower bounds of the halves are stored, or NULL if not needed.
+ * @param nearest (double *) : An array of K elements where the lower bound of the half of the distance of each
+ *                             centroid to the nearest other one is stored (INFINITY if K = 1).
+ * @param kernels (const lloyd_kernels_t *) : The loops selected for the formula and the dimension.
+ */
+void bounds_halfDistances(const dataset_t * centroids, double * halves, double * nearest, const lloyd_kernels_t * kernels)
+{
+    uint64_t K = centroids->size;
+    for (uint64_t k = 0; k < K; k++)
+    {
+        nearest[k] = INFINITY;
+    }
+    for (uint64_t a = 0; a < K; a++)
+    {
+        if (halves != NULL){ halves[a * K + a] = 0; }
+        for (uint64_t c = a + 1; c < K; c++)
+        {
+            int64_t squared = kernels->distance(dataset_row(centroids, a), dataset_row(centroids, c), centroids->dimension);
+            double half = bounds_lower(bounds_distance(squared)) / 2;
+            if (halves != NULL)
+            {
+                halves[a * K + c] = half;
+                halves[c * K + a] = half;
+            }
+            nearest[a] = (half < nearest[a]) ? half : nearest[a];
+            nearest[c] = (half < nearest[c]) ? half : nearest[c];
+        }
+    }
+}
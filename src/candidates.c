@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "candidates.h"
+#include "dataset.h"
+#include "labels.h"
+#include "kernels.h"
+#include "team.h"
+
+/**
+ * The matrix being built by a team.
+ *
+ * @param candidates (candidates_t *) : The matrix.
+ * @param kernels (const lloyd_kernels_t *) : The loops selected for the formula and the dimension.
+ */
+typedef struct {
+    candidates_t * candidates;
+    const lloyd_kernels_t * kernels;
+} candidates_build_t;
+
+/**
+ * The rows of the matrix of the part of a member, one block of points and one block of candidates at a time.
+ */
+static void candidates_buildJob(void * arg, uint32_t t, uint32_t nbOfMembers)
+{
+    candidates_build_t * build = (candidates_build_t *) arg;
+    candidates_t * candidates = build->candidates;
+    const dataset_t * points = candidates->points;
+    squared_row_distance_func_t distance = build->kernels->distance;
+    uint64_t begin = team_begin(candidates->nbOfPoints, t, nbOfMembers);
+    uint64_t end = team_begin(candidates->nbOfPoints, t + 1, nbOfMembers);
+
+    for (uint64_t first = begin; first < end; first += CANDIDATES_BLOCK)
+    {
+        uint64_t last = (first + CANDIDATES_BLOCK < end) ? first + CANDIDATES_BLOCK : end;
+        for (uint32_t j0 = 0; j0 < candidates->nbOfCandidates; j0 += CANDIDATES_BLOCK)
+        {
+            uint32_t j1 = (j0 + CANDIDATES_BLOCK < candidates->nbOfCandidates) ? j0 + CANDIDATES_BLOCK
+                                                                                : candidates->nbOfCandidates;
+            for (uint64_t i = first; i < last; i++)
+            {
+                uint64_t * row = candidates->distances + i * candidates->nbOfCandidates;
+                const int64_t * vector = dataset_row(points, i);
+                for (uint32_t j = j0; j < j1; j++)
+                {
+                    row[j] = (uint64_t) distance(vector, dataset_row(points, j), points->dimension);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Computes the distances between all the points and the first ones.
+ *
+ * ATTENTION : Think of freeing the matrix with the specific function <candidates_destroy> when done. The points must
+ * not be freed before it.
+ *
+ * @param candidates (candidates_t *) : The matrix.
+ * @param points (const dataset_t *) : The points.
+ * @param nbOfCandidates (uint32_t) : The number of candidates, at most the number of points.
+ * @param kernels (const lloyd_kernels_t *) : The loops of the runs, selected for the formula and the dimension.
+ * @param nThreads (uint32_t) : The number of threads sharing the computation.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+int candidates_build(candidates_t * candidates, const dataset_t * points, uint32_t nbOfCandidates,
+                     const lloyd_kernels_t * kernels, uint32_t nThreads)
+{
+    if (candidates == NULL){ return -1; }
+    memset(candidates, 0, sizeof(candidates_t));
+    if (nbOfCandidates > points->size){ return -1; }
+    candidates->points = points;
+    candidates->nbOfPoints = points->size;
+    candidates->nbOfCandidates = nbOfCandidates;
+    candidates->distances = (uint64_t *) malloc( sizeof(uint64_t) * points->size * nbOfCandidates );
+    if (candidates->distances == NULL)
+    {
+        fprintf(stderr, "[candidates.c] Failed malloc when initiating the distances to the candidates\n");
+        return -1;
+    }
+
+    // Without a team the calling thread computes the whole matrix
+    candidates_build_t build = { candidates, kernels };
+    team_t team;
+    bool teamed = team_init(&team, (nThreads == 0) ? 1 : nThreads) == 0;
+    team_run(teamed ? &team : NULL, teamed ? team_size(&team) : 1, candidates_buildJob, &build);
+    if (teamed){ team_destroy(&team); }
+    return 0;
+}
+
+/**
+ * Finds the candidates the centroids are equal to. Two candidates with the same coordinates have the same column.
+ *
+ * @param candidates (const candidates_t *) : The matrix.
+ * @param centroids (const dataset_t *) : The initial centroids of a run.
+ * @param columns (uint32_t *) : Where to store the column of each centroid.
+ *
+ * @return (bool) : true if every centroid is a candidate, else false.
+ */
+bool candidates_columns(const candidates_t * candidates, const dataset_t * centroids, uint32_t * columns)
+{
+    if (candidates == NULL || candidates->distances == NULL || centroids->dimension != candidates->points->dimension)
+    {
+        return false;
+    }
+    for (uint64_t k = 0; k < centroids->size; k++)
+    {
+        uint32_t j = 0;
+        while (j < candidates->nbOfCandidates
+               && memcmp(dataset_row(centroids, k), dataset_row(candidates->points, j),
+                         sizeof(int64_t) * centroids->dimension) != 0)
+        {
+            j++;
+        }
+        if (j == candidates->nbOfCandidates){ return false; }
+        columns[k] = j;
+    }
+    return true;
+}
+
+/**
+ * Like the assign of <lloyd_kernels_t>, with the distances of the matrix : assigns each point of the range to the
+ * closest of the K centroids (the first one in case of a tie), updates the labels, adds the points to the counts,
+ * which are not reset, and records the moves. If distortion is not NULL, the distances are added to it.
+ *
+ * @param candidates (const candidates_t *) : The matrix.
+ * @param columns (const uint32_t *) : The column of each centroid, see <candidates_columns>.
+ * @param K (uint32_t) : The number of centroids.
+ * @param labels (labels_t *) : The labels of the points.
+ * @param moves (moves_t *) : The list where the points that change of cluster are recorded.
+ * @param distortion (uint64_t *) : The sum of the distances, may be NULL.
+ * @param begin (uint64_t) : The first point of the range.
+ * @param end (uint64_t) : The end of the range.
+ *
+ * @return (int) : 1 if a point has changed of cluster, else 0.
+ */
+int candidates_assign(const candidates_t * candidates, const uint32_t * columns, uint32_t K, labels_t * labels,
+                      moves_t * moves, uint64_t * distortion, uint64_t begin, uint64_t end)
+{
+    int changed = 0;
+    uint64_t sum = 0;
+    for (uint64_t i = begin; i < end; i++)
+    {
+        const uint64_t * row = candidates->distances + i * candidates->nbOfCandidates;
+        uint32_t closest = 0;
+        uint64_t closestDistance = UINT64_MAX;
+        for (uint32_t k = 0; k < K; k++)
+        {
+            uint64_t distance = row[columns[k]];
+            if (distance < closestDistance)
+            {
+                closest = k;
+                closestDistance = distance;
+            }
+        }
+        uint32_t label = labels_get(labels, i);
+        if (closest != label)
+        {
+            moves_push(moves, i, label);
+            labels_set(labels, i, closest);
+            changed = 1;
+        }
+        labels->counts[closest]++;
+        sum += closestDistance;
+    }
+    if (distortion != NULL){ *distortion += sum; }
+    return changed;
+}
+
+/**
+ * Frees the matrix.
+ *
+ * @param candidates (candidates_t *) : The matrix.
+ *
+ * Note that it does not free the pointer it's self, nor the points.
+ */
+void candidates_destroy(candidates_t * candidates)
+{
+    if (candidates == NULL){ return; }
+    free(candidates->distances);
+    candidates->distances = NULL;
+    candidates->nbOfPoints = 0;
+    candidates->nbOfCandidates = 0;
+}
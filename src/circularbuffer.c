@@ -2,149 +2,186 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
-#include <getopt.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <limits.h>
 #include <inttypes.h>
 #include <pthread.h>
-#include <math.h>
-#include <semaphore.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
-#include "argumentsparser.h"
-#include "distance.h"
-#include "point.h"
-#include "arrayofpoints.h"
-#include "arrayofclusters.h"
-#include "func.h"
-#include "combinator.h"
-#include "threadshandler.h"
 #include "circularbuffer.h"
 
 /**
- * Initiliaze the variables of the given buffer.
- * 
- * The initiliazing function presume that this buffer will be used in a consumer producer problem. Therefore, 
- * it will allocate 2 mutexes (full, empty) and mutex (mutex) on the heap.
- * 
- * ATTENTION : Think of freeing the structure with the specific function <circularbuffer_destroy> when done.
- * 
- * @param buff (circular_buf *) : The pointer to the buffer.
- * @param mutex (pthread_mutex_t *) : The mutex to synchronise for the circular buffer.
- * @param MaxSize (uint32_t) : The maximum size. (MaxSize > 0).
- * @param array (void **) : The array of pointers that will be holding the data.
- * 
- * MaxSize must be equal to the length used to initialize the buffer. 
- * 
- * @return signal(int) : 0 Upon succes else -1.
+ * Sleeps until the counter of events is woken up, unless it's not the value seen anymore.
  */
-int circulabuffer_init(circular_buf * buff, pthread_mutex_t * mutex, uint32_t MaxSize, void ** array){
-    if ( buff == NULL ){ return -1; }
-    buff->array = array;
-    buff->maxSize = MaxSize;
-    buff->takePointer = 0;
-    buff->putPointer = 0;
-    buff->in = 0;
-    buff->done = 0;
-    buff->empty = (sem_t *) malloc(sizeof(sem_t));
-    if (buff->empty == NULL) { 
-        fprintf(stderr, "[circularbuffer.c] Failed malloc when allocating the empty semphore \n");
-        return -1; 
-    }
-    if (sem_init(buff->empty, 0, buff->maxSize) != 0)
+static void circularbuffer_wait(uint32_t * events, uint32_t seen)
+{
+    syscall(SYS_futex, events, FUTEX_WAIT_PRIVATE, seen, NULL, NULL, 0);
+}
+
+/**
+ * Counts an event and wakes up to count threads waiting on it, if there are any.
+ */
+static void circularbuffer_signal(uint32_t * events, uint32_t * waiting, int count)
+{
+    __atomic_fetch_add(events, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(waiting, __ATOMIC_SEQ_CST) > 0)
     {
-        free(buff->empty);
-        fprintf(stderr, "[circularbuffer.c] Failed malloc when initiating the empty semphore\n");
-        return -1;
+        syscall(SYS_futex, events, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
     }
+}
 
-    buff->full = (sem_t *) malloc(sizeof(sem_t));
-    if (buff->full == NULL) 
-    { 
-        free(buff->empty);
-        fprintf(stderr, "[circularbuffer.c] Failed malloc when allocating the full semphore\n");
-        return -1; 
+/**
+ * Puts at most count elements in the free slots following putPosition, without waiting.
+ *
+ * @return (uint32_t) : The number of elements put, 0 if the buffer is full.
+ */
+static uint32_t circularbuffer_tryPut(circular_buf * buff, void ** items, uint32_t count)
+{
+    uint64_t position = __atomic_load_n(&buff->putPosition, __ATOMIC_RELAXED);
+    while (true)
+    {
+        // The slots are free when the consumers have taken the element of the previous round
+        uint32_t ready = 0;
+        while (ready < count && ready < buff->maxSize
+               && __atomic_load_n(&buff->cells[(position + ready) & buff->mask].sequence, __ATOMIC_ACQUIRE) == position + ready)
+        {
+            ready++;
+        }
+        if (ready == 0)
+        {
+            uint64_t sequence = __atomic_load_n(&buff->cells[position & buff->mask].sequence, __ATOMIC_ACQUIRE);
+            if ((int64_t) (sequence - position) < 0){ return 0; }
+            // Another producer has claimed the position
+            position = __atomic_load_n(&buff->putPosition, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&buff->putPosition, &position, position + ready, true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED))
+        {
+            for (uint32_t i = 0; i < ready; i++)
+            {
+                circular_cell_t * cell = &buff->cells[(position + i) & buff->mask];
+                cell->data = items[i];
+                __atomic_store_n(&cell->sequence, position + i + 1, __ATOMIC_RELEASE);
+            }
+            return ready;
+        }
     }
+}
 
-    if (sem_init(buff->full, 0, 0) != 0)
+/**
+ * Takes at most count elements from the filled slots following takePosition, without waiting.
+ *
+ * @return (uint32_t) : The number of elements taken, 0 if the buffer is empty.
+ */
+static uint32_t circularbuffer_tryGet(circular_buf * buff, void ** items, uint32_t count)
+{
+    uint64_t position = __atomic_load_n(&buff->takePosition, __ATOMIC_RELAXED);
+    while (true)
     {
-        free(buff->empty);
-        free(buff->full);
-        fprintf(stderr, "[circularbuffer.c] Failed malloc when initiating the empty semphore\n");
-        return -1;
+        uint32_t ready = 0;
+        while (ready < count && ready < buff->maxSize
+               && __atomic_load_n(&buff->cells[(position + ready) & buff->mask].sequence, __ATOMIC_ACQUIRE) == position + ready + 1)
+        {
+            ready++;
+        }
+        if (ready == 0)
+        {
+            uint64_t sequence = __atomic_load_n(&buff->cells[position & buff->mask].sequence, __ATOMIC_ACQUIRE);
+            if ((int64_t) (sequence - (position + 1)) < 0){ return 0; }
+            // Another consumer has claimed the position
+            position = __atomic_load_n(&buff->takePosition, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&buff->takePosition, &position, position + ready, true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED))
+        {
+            for (uint32_t i = 0; i < ready; i++)
+            {
+                circular_cell_t * cell = &buff->cells[(position + i) & buff->mask];
+                items[i] = cell->data;
+                // Free for the put of the next round
+                __atomic_store_n(&cell->sequence, position + i + buff->maxSize, __ATOMIC_RELEASE);
+            }
+            return ready;
+        }
     }
+}
 
-    buff->mutex = mutex;
-    if ( pthread_mutex_init(buff->mutex, NULL) != 0 )
+/**
+ * Initiliaze the variables of the given buffer.
+ *
+ * The initiliazing function presume that this buffer will be used in a consumer producer problem. The size is rounded
+ * up to a power of 2, at least 2.
+ *
+ * ATTENTION : Think of freeing the structure with the specific function <circularbuffer_destroy> when done.
+ *
+ * @param buff (circular_buf *) : The pointer to the buffer.
+ * @param MaxSize (uint32_t) : The maximum size. (MaxSize > 0).
+ *
+ * @return signal(int) : 0 Upon succes else -1.
+ */
+int circulabuffer_init(circular_buf * buff, uint32_t MaxSize){
+    if ( buff == NULL ){ return -1; }
+    memset(buff, 0, sizeof(circular_buf));
+    if (MaxSize == 0 || MaxSize > (UINT32_MAX >> 1) + 1){ return -1; }
+    buff->maxSize = 2;
+    while (buff->maxSize < MaxSize){ buff->maxSize <<= 1; }
+    buff->mask = buff->maxSize - 1;
+    buff->cells = (circular_cell_t *) malloc( sizeof(circular_cell_t) * buff->maxSize );
+    if (buff->cells == NULL)
     {
-        free(buff->empty);
-        free(buff->full);
-        fprintf(stderr, "[circularbuffer.c] Couldn't initiate the buffer mutex\n");
+        fprintf(stderr, "[circularbuffer.c] Failed malloc when allocating the slots of the buffer\n");
         return -1;
     }
-    for (size_t i = 0; i < buff->maxSize; i++)
+    for (uint32_t i = 0; i < buff->maxSize; i++)
     {
-        buff->array[i] = NULL; 
+        buff->cells[i].sequence = i;
+        buff->cells[i].data = NULL;
     }
-    buff->waitingConsumers = 0;
-    buff->waitingProducers = 0; 
-    return 0; 
+    return 0;
 }
 
-/** 
+/**
  * This function sets the done signal on the bufffer.
- * 
+ *
  * @param buff (circular_buf *) : The buffer.
- */ 
+ */
 void circularbuffer_setDone(circular_buf * buff)
 {
-    pthread_mutex_lock(buff->mutex);
-    buff->done = 1;
-    pthread_mutex_unlock(buff->mutex);
+    __atomic_store_n(&buff->done, 1, __ATOMIC_SEQ_CST);
 }
 
 /**
- * Wakes up all producers waiting on the empty semaphore of the buffer.
- * 
+ * Wakes up all producers waiting for a free slot of the buffer.
+ *
  * @param buff (circular_buf *) : A buffer that has been initliazed using <circulabuffer_init> function in [circularbuffer.c].
  */
 void wakeAllProducers(circular_buf * buff)
 {
-    // When lock fails we still want to continue the execution cause the consumers might cause the program not to end
-    pthread_mutex_lock(buff->mutex);
-    // Critical Section
-    for (size_t i = 0; i < buff->waitingProducers; i++)
-    {
-        sem_post(buff->empty);
-    }
-    // End of critical section 
-    pthread_mutex_unlock(buff->mutex);
+    circularbuffer_signal(&buff->takes, &buff->waitingProducers, INT_MAX);
 }
 
 /**
- * Wakes up all producers waiting on the full semaphore of the buffer.
- * 
+ * Wakes up all consumers waiting for an element of the buffer.
+ *
  * @param buff (circular_buf *) : A buffer that has been initliazed using <circulabuffer_init> function in [circularbuffer.c].
  */
 void wakeAllConsumers(circular_buf * buff)
 {
-    // When lock fails we still want to continue the execution cause the producers might cause the program not to end
-    pthread_mutex_lock(buff->mutex);
-    // Critical Section
-    for (size_t i = 0; i < buff->waitingConsumers; i++)
-    {
-        sem_post(buff->full);
-    }
-    // End of critical section 
-    pthread_mutex_unlock(buff->mutex);
+    circularbuffer_signal(&buff->puts, &buff->waitingConsumers, INT_MAX);
 }
 
 /**
  * This function is to be called in case of an error on the buffer.
  * It'S purpose is to ensure in case of an error every thread working on the buffer, joins the main_thread
- * 
+ *
  * @param buff (circular_buf *) : The circular buffer.
  * @param nameOfFunction (char *) : The name of the function that called this function.
- *  
+ *
  */
 void circularbuffer_handleError(circular_buf * buff, char * nameOfFunction)
 {
@@ -154,13 +191,62 @@ void circularbuffer_handleError(circular_buf * buff, char * nameOfFunction)
     wakeAllConsumers(buff);
 }
 
+/**
+ * Adds elements into a circular buffer without race conditions problems, in their order. They are put as soon as
+ * there are free slots, several at once.
+ *
+ * ATTENTION : Note that the thread may have to wait for free space to be available in the buffer. Hence make sure that
+ * there are some other threads that are consuming the data and freeing spaces.
+ *
+ * @param buff (circular_buf *) : A buffer that has been initliazed using <circulabuffer_init> function in [circularbuffer.c].
+ * @param anErrorOccured (int *) : Variable used in order know if an error occured on the buffer. It doesn't need to be initiated.
+ * @param items (void **) : The pointers to the objects to add.
+ * @param count (uint32_t) : The number of objects.
+ *
+ * @return int. Upon success 0 else -1 (the buffer is done, the objects from the first one not put are not added).
+ */
+int circularbuffer_putMany(circular_buf * buff, int * anErrorOccured, void ** items, uint32_t count)
+{
+    uint32_t put = 0;
+    *anErrorOccured = 0;
+    while (put < count)
+    {
+        if (__atomic_load_n(&buff->done, __ATOMIC_SEQ_CST) == 1)
+        {
+            *anErrorOccured = 1;
+            return -1;
+        }
+        uint32_t added = circularbuffer_tryPut(buff, items + put, count - put);
+        if (added > 0)
+        {
+            put += added;
+            circularbuffer_signal(&buff->puts, &buff->waitingConsumers, (int) added);
+            continue;
+        }
+        // Full : the counter is read before trying again, so a get in between makes the wait return at once
+        uint32_t seen = __atomic_load_n(&buff->takes, __ATOMIC_SEQ_CST);
+        __atomic_fetch_add(&buff->waitingProducers, 1, __ATOMIC_SEQ_CST);
+        added = circularbuffer_tryPut(buff, items + put, count - put);
+        if (added == 0 && __atomic_load_n(&buff->done, __ATOMIC_SEQ_CST) == 0)
+        {
+            circularbuffer_wait(&buff->takes, seen);
+        }
+        __atomic_fetch_sub(&buff->waitingProducers, 1, __ATOMIC_SEQ_CST);
+        if (added > 0)
+        {
+            put += added;
+            circularbuffer_signal(&buff->puts, &buff->waitingConsumers, (int) added);
+        }
+    }
+    return 0;
+}
 
 /**
- * Adds an element into a circular buffer without race conditions problems. 
- * 
- * ATTENTION : Note that the thread may have to wait for free space to be available in the buffer. Hence make sure that 
+ * Adds an element into a circular buffer without race conditions problems.
+ *
+ * ATTENTION : Note that the thread may have to wait for free space to be available in the buffer. Hence make sure that
  * there are some other threads that are consuming the data and freeing spaces.
- * 
+ *
  * @param buff (circular_buf *) : A buffer that has been initliazed using <circulabuffer_init> function in [circularbuffer.c].
  * @param anErrorOccured (int *) : Variable used in order know if an error occured on the buffer. It doesn't need to be initiated.
  * @param toPut (void *) : The pointer to the object to add.
@@ -169,126 +255,75 @@ void circularbuffer_handleError(circular_buf * buff, char * nameOfFunction)
  */
 int circularbuffer_put(circular_buf * buff, int * anErrorOccured, void * toPut)
 {
-    pthread_mutex_lock(buff->mutex);
-    *anErrorOccured = (buff->done == 1);
-    buff->waitingProducers = (*anErrorOccured == 1 ) ? buff->waitingProducers : buff->waitingProducers + 1; 
-    pthread_mutex_unlock(buff->mutex);
-
-    if (*anErrorOccured == 1) // No need to add element 
-    {
-        return -1;
-    }
-
-    if (sem_wait(buff->empty) != 0) // Wait till there's a free zones
-    {
-        pthread_mutex_lock(buff->mutex);
-        buff->waitingProducers--;
-        pthread_mutex_unlock(buff->mutex);
-        circularbuffer_handleError(buff, "circularbuffer_put");
-        return -1;
-    }
-
-    pthread_mutex_lock(buff->mutex);
-    // Start Critic Section
+    return circularbuffer_putMany(buff, anErrorOccured, &toPut, 1);
+}
 
-    // If it's not full, then we can set the next put point
-    while ((buff->in < buff->maxSize) && buff->array[buff->putPointer] != NULL)
+/**
+ * Takes the next elements of the buffer, at most count, without race conditions problems. The thread waits until
+ * there is at least one, or until the buffer is done and empty.
+ *
+ * @param buff (circular_buf *) : A buffer that has been initliazed using <circulabuffer_init> function in [circularbuffer.c].
+ * @param noProducersLeftAndBufferEmpty (int *) : Set to 1 if the buffer is done and empty, else 0.
+ * @param items (void **) : Where to store the elements taken.
+ * @param count (uint32_t) : The largest number of elements to take.
+ * @param got (uint32_t *) : Where to store the number of elements taken.
+ *
+ * @return int. Upon success 0 else -1 (no element was taken).
+ */
+int circularbuffer_getMany(circular_buf * buff, int * noProducersLeftAndBufferEmpty, void ** items, uint32_t count,
+                           uint32_t * got)
+{
+    *noProducersLeftAndBufferEmpty = 0;
+    *got = 0;
+    while (true)
     {
-        buff->putPointer = (buff->putPointer < buff->maxSize - 1) ? buff->putPointer + 1 : 0; 
+        // Read before the elements : if it's set, the last ones are visible
+        uint32_t done = __atomic_load_n(&buff->done, __ATOMIC_SEQ_CST);
+        *got = circularbuffer_tryGet(buff, items, count);
+        if (*got > 0){ break; }
+        if (done == 1)
+        {
+            *noProducersLeftAndBufferEmpty = 1;
+            return -1;
+        }
+        // Empty : the counter is read before trying again, so a put in between makes the wait return at once
+        uint32_t seen = __atomic_load_n(&buff->puts, __ATOMIC_SEQ_CST);
+        __atomic_fetch_add(&buff->waitingConsumers, 1, __ATOMIC_SEQ_CST);
+        *got = circularbuffer_tryGet(buff, items, count);
+        if (*got == 0 && __atomic_load_n(&buff->done, __ATOMIC_SEQ_CST) == 0)
+        {
+            circularbuffer_wait(&buff->puts, seen);
+        }
+        __atomic_fetch_sub(&buff->waitingConsumers, 1, __ATOMIC_SEQ_CST);
+        if (*got > 0){ break; }
     }
-    
-    buff->array[buff->putPointer] = toPut;
-    buff->in = (buff->in == buff->maxSize) ? buff->maxSize : buff->in + 1;
-    buff->waitingProducers--;
-    
-    // End of Critic Section
-    pthread_mutex_unlock(buff->mutex);
-    if (sem_post(buff->full) != 0)
-    {
-        circularbuffer_handleError(buff, "circularbuffer_put");
-        return -1;
-    } 
+    circularbuffer_signal(&buff->takes, &buff->waitingProducers, (int) *got);
     return 0;
 }
 
 /**
  * Put an element from buffer in the holdResult pointer and removes the element
- * from the buffer.
- * 
- * ATTENTION : Note that the thread may have to wait for data to be put in the buffer. Hence make sure that 
- * there are some other threads that are producing the data.
- * 
- * @param buff (circular_buf *) : A buffer that has been initliazed using <circulabuffer_init> function.
- * @param noProducersLeftAndBufferEmpty (int *) : This will be used to store a proper variable to each 
- * thread as an inside signal to know if a thread has to wait or not.
- * @param holdResult (void **) : Pointer to the pointer that will hold the result.
+ *
+ * @param buff (circular_buf *) : A buffer that has been initliazed using <circulabuffer_init> function in [circularbuffer.c].
+ * @param noProducersLeftAndBufferEmpty (int *) : Set to 1 if the buffer is done and empty, else 0.
+ * @param holdResult (void **) : Where to store the element, NULL if there's none left.
+ *
+ * @return int. Upon success 0 else -1.
  */
 int circularbuffer_get(circular_buf * buff, int * noProducersLeftAndBufferEmpty, void ** holdResult)
 {
-    // Here we try to determine if it's worth entering the critical section or not
-    pthread_mutex_lock(buff->mutex);
-    *noProducersLeftAndBufferEmpty = ( buff->in == 0 && buff->done );
-    if (!*noProducersLeftAndBufferEmpty){
-        buff->waitingConsumers++;
-    }
-    pthread_mutex_unlock(buff->mutex);
-    if ( *noProducersLeftAndBufferEmpty )
-    {
-        *holdResult = NULL;
-        return -1;
-    }
-
-    if (sem_wait(buff->full) != 0) // Wait till there's a free zones
-    {
-        pthread_mutex_lock(buff->mutex);
-        buff->waitingConsumers--;
-        pthread_mutex_unlock(buff->mutex);
-        circularbuffer_handleError(buff, "circularbuffer_get");
-        return -1;
-    }
-    pthread_mutex_lock(buff->mutex);
-    // Start Critic Section
-    while ((buff->in > 0) && buff->array[buff->takePointer] == NULL)
-    {
-        buff->takePointer = (buff->takePointer < buff->maxSize - 1) ? buff->takePointer + 1 : 0;
-    }
-
-    buff->waitingConsumers--;
-    *holdResult = buff->array[buff->takePointer];
-    buff->array[buff->takePointer] = NULL;
-    buff->in = ( buff->in == 0 ) ? 0 : buff->in - 1;
-
-    // End of Critic Section
-    pthread_mutex_unlock(buff->mutex);
-    if ( sem_post(buff->empty) != 0)
-    {
-        circularbuffer_handleError(buff, "circularbuffer_get");
-        return -1;
-    } 
-    return 0;
+    uint32_t got;
+    *holdResult = NULL;
+    return circularbuffer_getMany(buff, noProducersLeftAndBufferEmpty, holdResult, 1, &got);
 }
 
 /**
- * Frees up a buffer that has been initialized.
- * 
+ * Frees up a buffer that has been initialized, once no thread uses it anymore.
+ *
  * @param buff (circular_buf *) : A buffer that has been initliazed using <circulabuffer_init> function in [circularbuffer.c]..
  */
 void circularbuffer_destroy(circular_buf * buff){
-    pthread_mutex_lock(buff->mutex);
-    uint32_t waitingProducers = buff->waitingProducers;
-    uint32_t waitingConsumers = buff->waitingConsumers;
-    pthread_mutex_unlock(buff->mutex);
-
-    while (waitingProducers > 0 && waitingConsumers > 0)
-    {
-        pthread_mutex_lock(buff->mutex);
-        waitingProducers = buff->waitingProducers;
-        waitingConsumers = buff->waitingConsumers;
-        pthread_mutex_unlock(buff->mutex);
-    }
-    
-    sem_destroy(buff->empty);
-    sem_destroy(buff->full);
-    free(buff->empty);
-    free(buff->full);
-}
\ No newline at end of file
+    free(buff->cells);
+    buff->cells = NULL;
+    buff->maxSize = 0;
+}
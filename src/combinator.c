@@ -1,120 +1,178 @@
 /*****************************************************
- * The algorithm used here was inspired from the following page.
- *
- * geeksforgeeks.org/print-all-possible-combinations-of-r-elements-in-a-given-array-of-size-n/
- *
- * We had to adapt it to our problem.
+ * The combinations are enumerated with the combinatorial number system : the lexicographic rank of a combination
+ * is a sum of binomial coefficients, so the combination of any rank is built directly (it's unranking) and the
+ * calculating threads share the enumeration with a single counter of ranks.
  *
+ * The binomial coefficients are computed with 128 bits and saturated, so the ranks stay exact even when C(p, k)
+ * does not fit in 64 bits.
  *****************************************************/
-#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <stdbool.h>
 
-#include "argumentsparser.h"
-#include "point.h"
-#include "func.h"
-#include "filehandler.h"
-#include "threadshandler.h"
+#include "dataset.h"
 #include "combinator.h"
 
 /**
- * This function generates all possible combinations of centroids.
- * 
- * @param arr (point_t *) : An array of all centroids to generate combinations from.
- * @param tempData (point_t *) : An array to store a combinations thoughout the iterations.
- * @param start (uint32_t) : Start index.
- * @param end (uint32_t) : End index.
- * @param index (uint32_t) : The current index in arr.
- * @param r (uint32_t) : The length wanted that each combination will have.
- * @param finalResultHolder (array_of_arrays_of_centroids * ) : The structure that will hold all possible combinations.
- * 
- * @return (int) : Upon success 0 else :
- *                  -1 if the error is due to the buffer.
- *                  -2 if the error is due to the function it's self.
- */ 
-int combinationHelper( 
-                        point_t * arr, point_t * tempData,
-                       size_t start, size_t end,
-                       size_t index, size_t r,
-                       circular_buf * finalResultHolder
-                    )
+ * Returns the binomial coefficient of n and r, or 2^64 if it's larger : more than any rank.
+ */
+static unsigned __int128 combinator_binomial(uint32_t n, uint32_t r)
 {
-    if (index == r)
+    const unsigned __int128 saturated = (unsigned __int128) 1 << 64;
+    if (r > n){ return 0; }
+    if (r > n - r){ r = n - r; }
+    unsigned __int128 binomial = 1;
+    for (uint32_t i = 1; i <= r; i++)
     {
-         int booleanToUseInPut;   
-        array_of_centroids * toAddToFinal = (array_of_centroids * ) malloc( sizeof(array_of_centroids) );
-        if(toAddToFinal == NULL)
-        {
-            fprintf(stderr, "[combinator.c] Failed malloc for the memory necesessary to hold an array of centroids structure\n");
-            return -2;
-        }
-        // Initiate the array of centroid
-        toAddToFinal->size = r;
-        toAddToFinal->points = (point_t *) malloc( sizeof(point_t) * r );
-        if (toAddToFinal->points == NULL) 
-        { 
-            toAddToFinal->size = 0;
-            // We are going to free the components of return
-            arrayOfPoints_destroy(toAddToFinal);
-            fprintf(stderr, "[combinator.c] Failed malloc to hold an array of centroids\n");
-            return -2; 
-        }
-        for (size_t i = 0; i < r; i++)
-        {
-            point_t * currentPoint = (toAddToFinal->points + i);
-            currentPoint->dimension = tempData[i].dimension;
-            currentPoint->values = (int64_t *) malloc( sizeof(int64_t) * currentPoint->dimension );
-            if (currentPoint->values == NULL)
-            {
-                toAddToFinal->size = 0;
-                arrayOfPoints_destroy(toAddToFinal);
-                fprintf(stderr, "[combinator.c] Failed malloc to hold values of a certain point\n");
-                return -2;
-            }
-            memcpy( currentPoint->values, tempData[i].values, sizeof(int64_t) * tempData[i].dimension );
-        }
-        // We add the combination to the circular buffer
-        return circularbuffer_put(finalResultHolder, &booleanToUseInPut, (void *) toAddToFinal);;
+        // Exact at each step : the product of i consecutive integers is divisible by i!
+        binomial = binomial * (n - r + i) / i;
+        if (binomial >= saturated){ return saturated; }
     }
-    int possibleError; // Will be used as a signal to know if an error occured 
-    for(size_t i = start; i <= end && end-i+1 >= r - index; i++)
+    return binomial;
+}
+
+/**
+ * Returns the number of combinations of k initial centroids among the p first points, UINT64_MAX if it doesn't fit.
+ *
+ * @param p (uint32_t) : The number of points to choose from.
+ * @param k (uint32_t) : The number of centroids.
+ *
+ * @return (uint64_t) : The binomial coefficient of p and k.
+ */
+uint64_t combinator_count(uint32_t p, uint32_t k)
+{
+    unsigned __int128 combinations = combinator_binomial(p, k);
+    return (combinations > UINT64_MAX) ? UINT64_MAX : (uint64_t) combinations;
+}
+
+/**
+ * Initializes the enumeration of the combinations, from the rank 0. The batches are small enough for all the threads
+ * to get some, and for the last ones to end together.
+ *
+ * @param combinator (combinator_t *) : The enumeration.
+ * @param p (uint32_t) : The number of points to choose from.
+ * @param k (uint32_t) : The number of centroids of a combination.
+ * @param nThreads (uint32_t) : The number of calculating threads sharing it.
+ */
+void combinator_init(combinator_t * combinator, uint32_t p, uint32_t k, uint32_t nThreads)
+{
+    combinator->p = p;
+    combinator->k = k;
+    combinator->nbOfCombinations = combinator_count(p, k);
+    combinator->batch = combinator->nbOfCombinations / ((uint64_t) 8 * ((nThreads == 0) ? 1 : nThreads));
+    combinator->batch = (combinator->batch < 1) ? 1 : combinator->batch;
+    combinator->batch = (combinator->batch > COMBINATOR_MAX_BATCH) ? COMBINATOR_MAX_BATCH : combinator->batch;
+    combinator->next = 0;
+    combinator->stopped = false;
+}
+
+/**
+ * Claims the next batch of combinations.
+ *
+ * @param combinator (combinator_t *) : The enumeration, shared by the threads.
+ * @param first (uint64_t *) : Where to store the rank of the first combination of the batch.
+ *
+ * @return (uint64_t) : The number of combinations of the batch, 0 when they have all been claimed.
+ */
+uint64_t combinator_claim(combinator_t * combinator, uint64_t * first)
+{
+    if (__atomic_load_n(&combinator->stopped, __ATOMIC_ACQUIRE)){ return 0; }
+    // The ranks can only pass the number of combinations by the batches of the threads claiming at the same time
+    uint64_t rank = __atomic_fetch_add(&combinator->next, combinator->batch, __ATOMIC_RELAXED);
+    if (rank >= combinator->nbOfCombinations){ return 0; }
+    *first = rank;
+    return (combinator->nbOfCombinations - rank < combinator->batch) ? combinator->nbOfCombinations - rank
+                                                                     : combinator->batch;
+}
+
+/**
+ * Stops the enumeration after an error, the threads get no combination anymore.
+ *
+ * @param combinator (combinator_t *) : The enumeration.
+ */
+void combinator_stop(combinator_t * combinator)
+{
+    fprintf(stderr, "[combinator.c] The enumeration of the combinations is stopped\n");
+    __atomic_store_n(&combinator->stopped, true, __ATOMIC_RELEASE);
+}
+
+/**
+ * Builds the combination of a rank : it's first index is the smallest one such that the combinations starting with
+ * it and the indexes before reach the rank, and so on.
+ *
+ * @param p (uint32_t) : The number of points to choose from.
+ * @param k (uint32_t) : The number of indexes.
+ * @param rank (uint64_t) : The lexicographic rank of the combination, less than C(p, k).
+ * @param indexes (uint32_t *) : Where to store the k increasing indexes.
+ */
+void combinator_unrank(uint32_t p, uint32_t k, uint64_t rank, uint32_t * indexes)
+{
+    uint32_t candidate = 0;
+    for (uint32_t i = 0; i < k; i++)
     {
-        tempData[index] = arr[i];
-        possibleError = combinationHelper(arr, tempData, i+1, end, index+1, r, finalResultHolder);
-        if (possibleError != 0) // This means an error occured
-        { 
-            return possibleError;
+        while (true)
+        {
+            // The combinations whose i-th index is the candidate
+            unsigned __int128 following = combinator_binomial(p - 1 - candidate, k - 1 - i);
+            if (rank < following){ break; }
+            rank -= (uint64_t) following;
+            candidate++;
         }
+        indexes[i] = candidate;
+        candidate++;
     }
-    return 0;
 }
 
 /**
- * This function calculates the initial centroids combinations and stores them in a buffer.
+ * Replaces a combination by the next one in lexicographic order.
  *
- * The number of elements in pointsToPickFrom >= K >= 1.
+ * @param p (uint32_t) : The number of points to choose from.
+ * @param k (uint32_t) : The number of indexes.
+ * @param indexes (uint32_t *) : The k increasing indexes of the combination.
  *
- * @param pointsToPickFrom (point_t *) : An array of points to pick from.
- * @param inputArgs (args_t *) : The strcuture representing the user input files.
- * @param buff (circular_buf *) : The buffer in which to store the combinations.
+ * @return (bool) : true if there is a next combination, false if it was the last one (the indexes are unchanged).
  */
-void * getAllCentroidCombinations( void * argT)
+bool combinator_next(uint32_t p, uint32_t k, uint32_t * indexes)
 {
-    int possibleError = 0;
-    if (argT == NULL){ return (NULL); }
-    combinations_args_t * args = (combinations_args_t *) argT;
-    point_t temp[args->inputArgs->k];
-    possibleError = combinationHelper(args->pointsToPickFrom, temp, 0,
-                     args->inputArgs->n_first_initialization_points-1,
-                     0, args->inputArgs->k, args->buff);
-    if (possibleError == -2 )
+    // The last index that can still grow
+    uint32_t i = k;
+    while (i > 0 && indexes[i - 1] == p - k + i - 1){ i--; }
+    if (i == 0){ return false; }
+    indexes[i - 1]++;
+    for (uint32_t j = i; j < k; j++){ indexes[j] = indexes[j - 1] + 1; }
+    return true;
+}
+
+/**
+ * Copies the points of a combination in a new dataset of initial centroids.
+ *
+ * ATTENTION : Think of freeing the dataset and it's content when done.
+ *
+ * @param points (const dataset_t *) : The dataset whose first points are the ones to choose from.
+ * @param k (uint32_t) : The number of centroids.
+ * @param indexes (const uint32_t *) : The indexes of the points of the combination.
+ *
+ * @return (dataset_t *) : The centroids, NULL in case of an error.
+ */
+dataset_t * combinator_centroids(const dataset_t * points, uint32_t k, const uint32_t * indexes)
+{
+    dataset_t * centroids = (dataset_t *) malloc( sizeof(dataset_t) );
+    if (centroids == NULL)
+    {
+        fprintf(stderr, "[combinator.c] Failed malloc for the memory necesessary to hold a dataset structure\n");
+        return NULL;
+    }
+    if (dataset_init(centroids, k, points->dimension) != 0)
     {
-        circularbuffer_handleError(args->buff, "getAllCentroidCombinations");
-    } else {
-        circularbuffer_setDone(args->buff);
-        wakeAllConsumers(args->buff);
+        free(centroids);
+        fprintf(stderr, "[combinator.c] Failed malloc to hold a dataset of centroids\n");
+        return NULL;
     }
-    return (NULL);
-}
\ No newline at end of file
+    for (uint32_t i = 0; i < k; i++)
+    {
+        memcpy(dataset_row(centroids, i), dataset_row(points, indexes[i]), sizeof(int64_t) * points->dimension);
+    }
+    return centroids;
+}
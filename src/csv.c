@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "csv.h"
+
+const char CSV_DIGIT_PAIRS[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+/**
+ * Initializes a writer of the rows of a file.
+ *
+ * ATTENTION : Think of freeing it with the specific function <csv_destroy> when done, the last rows are only written
+ *             then.
+ *
+ * @param csv (csv_t *) : The writer.
+ * @param file (FILE *) : The opened file.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+int csv_init(csv_t * csv, FILE * file)
+{
+    csv->file = file;
+    csv->length = 0;
+    csv->capacity = CSV_BUFFER_SIZE;
+    csv->error = 0;
+    csv->bytes = (char *) malloc(CSV_BUFFER_SIZE);
+    if (csv->bytes == NULL)
+    {
+        fprintf(stderr, "[csv.c] Failed malloc when initiating the buffer of the output file\n");
+        csv->capacity = 0;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Writes the buffer to the file, after what the file holds in it's own buffer.
+ *
+ * @param csv (csv_t *) : The writer.
+ *
+ * @return (int) : 0 upon success, else -1 (it stays so for the next writes).
+ */
+int csv_flush(csv_t * csv)
+{
+    if (csv->error != 0){ return -1; }
+    if (fflush(csv->file) != 0)
+    {
+        csv->error = -1;
+        return -1;
+    }
+    int fd = fileno(csv->file);
+    size_t written = 0;
+    while (written < csv->length)
+    {
+        ssize_t result = write(fd, csv->bytes + written, csv->length - written);
+        if (result < 0)
+        {
+            if (errno == EINTR){ continue; }
+            fprintf(stderr, "[csv.c] Error when writing the output file:\n\t%s\n", strerror(errno));
+            csv->error = -1;
+            break;
+        }
+        written += (size_t) result;
+    }
+    csv->length = 0;
+    return csv->error;
+}
+
+/**
+ * Makes room for the given number of bytes when the buffer is too full (see <csv_reserve>) : the buffer is written,
+ * and made larger if it's still too small.
+ *
+ * @param csv (csv_t *) : The writer.
+ * @param bytes (size_t) : The number of bytes.
+ *
+ * @return (char *) : The first byte of the room, NULL if a write failed or the buffer could not grow.
+ */
+char * csv_grow(csv_t * csv, size_t bytes)
+{
+    if (csv_flush(csv) != 0){ return NULL; }
+    if (bytes > csv->capacity)
+    {
+        char * larger = (char *) realloc(csv->bytes, bytes);
+        if (larger == NULL)
+        {
+            fprintf(stderr, "[csv.c] Failed malloc when growing the buffer of the output file\n");
+            csv->error = -1;
+            return NULL;
+        }
+        csv->bytes = larger;
+        csv->capacity = bytes;
+    }
+    return csv->bytes;
+}
+
+/**
+ * Writes what is left in the buffer and frees it.
+ *
+ * @param csv (csv_t *) : The writer.
+ *
+ * @return (int) : 0 if all the rows were written, else -1.
+ *
+ * Note that it does not free the pointer it's self, nor close the file.
+ */
+int csv_destroy(csv_t * csv)
+{
+    int error = (csv->bytes != NULL) ? csv_flush(csv) : csv->error;
+    free(csv->bytes);
+    csv->bytes = NULL;
+    csv->capacity = 0;
+    csv->length = 0;
+    return error;
+}
@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dataset.h"
+#include "point.h"
+
+/**
+ * Initialize the dataset structure by allocating an aligned matrix of size points of the given dimension.
+ * The content of the matrix is not initialized.
+ *
+ * @param dataset (dataset_t *) : The pointer to the structure.
+ * @param size (uint64_t) : The number of points.
+ * @param dimension (uint32_t) : The dimension of the points.
+ *
+ * @return int : 0 upon succes else -1.
+ */
+int dataset_init(dataset_t * dataset, uint64_t size, uint32_t dimension)
+{
+    dataset->values = NULL;
+    dataset->dimension = dimension;
+    dataset->stride = dimension;
+    dataset->size = size;
+
+    uint64_t nbOfValues = size * dimension;
+    if (dimension != 0 && nbOfValues / dimension != size){ return -1; }
+    if (nbOfValues == 0){ return 0; }
+    if (nbOfValues > SIZE_MAX / sizeof(int64_t)){ return -1; }
+
+    if (posix_memalign((void **) &dataset->values, DATASET_ALIGNMENT, sizeof(int64_t) * nbOfValues) != 0)
+    {
+        dataset->values = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Write the points of the dataset to the buffer of the output file given in parameter
+ *
+ * @param csv (csv_t *) : The writer of the output file.
+ * @param dataset (const dataset_t *) : The pointer to the dataset.
+ * @param quotations (bool) : Boolean indicating if the <"? should be added at the start and end.
+ *
+ * @return 0 upon success else, -1.
+ */
+int dataset_writeToCSV(csv_t * csv, const dataset_t * dataset, bool quotations)
+{
+    int error = 0;
+    point_t view;
+    if (quotations)
+    {
+        error += csv_putBytes(csv, "\"", 1);
+    }
+
+    error += csv_putBytes(csv, "[", 1);
+    for (uint64_t i = 0; i < dataset->size; i++)
+    {
+        view = dataset_point(dataset, i);
+        error += pointToCSV(csv, &view);
+        if (i < dataset->size-1)
+        {
+            error += csv_putBytes(csv, ", ", 2);
+        }
+    }
+    error += csv_putBytes(csv, "]", 1);
+    if (quotations)
+    {
+        error += csv_putBytes(csv, "\"", 1);
+    }
+    return (error < 0) ? -1 : 0;
+}
+
+/**
+ * Copies the points of a dataset into another one of the same size and dimension.
+ *
+ * @param destination (dataset_t *) : The dataset receiving the points.
+ * @param source (const dataset_t *) : The dataset to copy.
+ */
+void dataset_copy(dataset_t * destination, const dataset_t * source)
+{
+    for (uint64_t i = 0; i < source->size; i++)
+    {
+        memcpy(dataset_row(destination, i), dataset_row(source, i), sizeof(int64_t) * source->dimension);
+    }
+}
+
+/**
+ * Frees the matrix of the dataset.
+ *
+ * @param dataset (dataset_t *) : pointer to the dataset.
+ *
+ * Note that it does not free the pointer it's self.
+ */
+void dataset_destroy(dataset_t * dataset)
+{
+    free(dataset->values);
+    dataset->values = NULL;
+    dataset->size = 0;
+}
@@ -2,14 +2,782 @@
 #include <math.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 #include "distance.h"
 #include "point.h"
-#include "arrayofpoints.h"
+#include "dataset.h"
 #include "argumentsparser.h"
+#include "kernels.h"
+
+/*
+ * All the kernels compute with uint64_t, a signed overflow being undefined in C. The result is the same as 
+ * with int64_t on a two's complement machine, and it is the same, bit for bit, for every kernel : the sum
+ * of the terms modulo 2^64 does not depend on the order in which the terms are added.
+ */
+
+/**
+ * Calculates the sum of the absolute differences of the coordinates of two rows of dim coordinates, 
+ * one coordinate at a time. This is the manhattan distance, before squaring it.
+ * 
+ * @param p1 (const int64_t *) : The coordinates of a point.
+ * @param p2 (const int64_t *) : And the coordinates of another point.
+ * @param dim (uint32_t) : The dimension.
+ * 
+ * @return value (uint64_t)
+ */
+static inline uint64_t absolute_differences_scalar(const int64_t * p1, const int64_t * p2, uint32_t dim)
+{
+    uint64_t sum = 0;
+    uint64_t difference;
+    for (uint32_t i = 0; i < dim; i++){
+        difference = (uint64_t) p1[i] - (uint64_t) p2[i];
+        sum += ( (int64_t) difference < 0 ) ? -difference : difference;
+    }
+    return sum;
+}
+
+/**
+ * Calculates the squared manhattan distance between two rows of dim coordinates, one coordinate at a time.
+ * 
+ * @param p1 (const int64_t *) : The coordinates of a point.
+ * @param p2 (const int64_t *) : And the coordinates of another point.
+ * @param dim (uint32_t) : The dimension.
+ * 
+ * @return value (int64_t)
+ */
+static int64_t squared_manhattan_scalar(const int64_t * p1, const int64_t * p2, uint32_t dim)
+{
+    uint64_t sum = absolute_differences_scalar(p1, p2, dim);
+    return (int64_t) (sum * sum);
+}
 
 /**
- * Calculates the squared distance between two points using thje manhattan formula.
+ * Calculates the squared euclidean distance between two rows of dim coordinates, one coordinate at a time.
+ * 
+ * @param p1 (const int64_t *) : The coordinates of a point.
+ * @param p2 (const int64_t *) : And the coordinates of another point.
+ * @param dim (uint32_t) : The dimension.
+ * 
+ * @return value (int64_t)
+ */
+static int64_t squared_euclidean_scalar(const int64_t * p1, const int64_t * p2, uint32_t dim)
+{
+    uint64_t sum = 0;
+    uint64_t difference;
+    for (uint32_t i = 0; i < dim; i++){
+        difference = (uint64_t) p1[i] - (uint64_t) p2[i];
+        sum += difference * difference;
+    }
+    return (int64_t) sum;
+}
+
+/*
+ * The kernels on narrow coordinates. The difference of two int16_t fits in int32_t and it's absolute value or it's
+ * square in uint32_t, the difference of two int32_t fits in int64_t and it's absolute value in uint32_t. The
+ * distances are summed with uint64_t : with int16_t coordinates <narrow_choose> keeps them below 2^64, with int32_t
+ * ones they are summed modulo 2^64 like the int64_t kernels. Either way the result is the one of the int64_t kernels.
+ */
+
+/**
+ * Calculates the sum of the absolute differences of the coordinates of two rows of dim int16_t coordinates.
+ */
+static inline uint64_t absolute_differences16_scalar(const int16_t * p1, const int16_t * p2, uint32_t dim)
+{
+    uint64_t sum = 0;
+    int32_t difference;
+    for (uint32_t i = 0; i < dim; i++){
+        difference = (int32_t) p1[i] - (int32_t) p2[i];
+        sum += (uint64_t) ( (difference < 0) ? -difference : difference );
+    }
+    return sum;
+}
+
+/**
+ * Calculates the sum of the squared differences of the coordinates of two rows of dim int16_t coordinates.
+ */
+static inline uint64_t squared_differences16_scalar(const int16_t * p1, const int16_t * p2, uint32_t dim)
+{
+    uint64_t sum = 0;
+    int32_t difference;
+    for (uint32_t i = 0; i < dim; i++){
+        difference = (int32_t) p1[i] - (int32_t) p2[i];
+        sum += (uint64_t) ( (uint32_t) difference * (uint32_t) difference );
+    }
+    return sum;
+}
+
+/**
+ * Calculates the sum of the absolute differences of the coordinates of two rows of dim int32_t coordinates.
+ */
+static inline uint64_t absolute_differences32_scalar(const int32_t * p1, const int32_t * p2, uint32_t dim)
+{
+    uint64_t sum = 0;
+    int64_t difference;
+    for (uint32_t i = 0; i < dim; i++){
+        difference = (int64_t) p1[i] - (int64_t) p2[i];
+        sum += (uint64_t) ( (difference < 0) ? -difference : difference );
+    }
+    return sum;
+}
+
+/**
+ * Calculates the sum of the squared differences of the coordinates of two rows of dim int32_t coordinates.
+ */
+static inline uint64_t squared_differences32_scalar(const int32_t * p1, const int32_t * p2, uint32_t dim)
+{
+    uint64_t sum = 0;
+    uint64_t difference;
+    for (uint32_t i = 0; i < dim; i++){
+        difference = (uint64_t) ((int64_t) p1[i] - (int64_t) p2[i]);
+        sum += difference * difference;
+    }
+    return sum;
+}
+
+// The scalar kernels do not depend on the width of the accumulator
+static int64_t squared_manhattan16_scalar(const int16_t * p1, const int16_t * p2, uint32_t dim)
+{
+    uint64_t sum = absolute_differences16_scalar(p1, p2, dim);
+    return (int64_t) (sum * sum);
+}
+
+static int64_t squared_euclidean16_scalar(const int16_t * p1, const int16_t * p2, uint32_t dim)
+{
+    return (int64_t) squared_differences16_scalar(p1, p2, dim);
+}
+
+static int64_t squared_manhattan32_scalar(const int32_t * p1, const int32_t * p2, uint32_t dim)
+{
+    uint64_t sum = absolute_differences32_scalar(p1, p2, dim);
+    return (int64_t) (sum * sum);
+}
+
+static int64_t squared_euclidean32_scalar(const int32_t * p1, const int32_t * p2, uint32_t dim)
+{
+    return (int64_t) squared_differences32_scalar(p1, p2, dim);
+}
+
+/*
+ * Portable kernels, written with the vector extensions of GCC. They are compiled to the SIMD instructions of
+ * the target (NEON on the Raspberry Pi) or to scalar instructions when there are none.
+ */
+typedef uint64_t vector_u64_t __attribute__ ((vector_size (16)));
+typedef int64_t vector_i64_t __attribute__ ((vector_size (16)));
+#define VECTOR_LANES (sizeof(vector_u64_t) / sizeof(uint64_t))
+
+/**
+ * Loads VECTOR_LANES coordinates, the row does not need to be aligned.
+ */
+static inline vector_u64_t vector_load(const int64_t * row)
+{
+    vector_u64_t loaded;
+    memcpy(&loaded, row, sizeof(vector_u64_t));
+    return loaded;
+}
+
+/**
+ * Returns the sum of the lanes of the vector.
+ */
+static inline uint64_t vector_sum(vector_u64_t vector)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < VECTOR_LANES; i++)
+    {
+        sum += vector[i];
+    }
+    return sum;
+}
+
+/**
+ * Same as <squared_manhattan_scalar>, VECTOR_LANES coordinates at a time.
+ */
+static int64_t squared_manhattan_vector(const int64_t * p1, const int64_t * p2, uint32_t dim)
+{
+    vector_u64_t accumulator = {0};
+    vector_u64_t difference;
+    vector_u64_t sign;
+    uint32_t i = 0;
+    for (; i + VECTOR_LANES <= dim; i += VECTOR_LANES)
+    {
+        difference = vector_load(p1 + i) - vector_load(p2 + i);
+        sign = (vector_u64_t) ( (vector_i64_t) difference >> 63 );
+        accumulator += (difference ^ sign) - sign;
+    }
+    uint64_t sum = vector_sum(accumulator) + absolute_differences_scalar(p1 + i, p2 + i, dim - i);
+    return (int64_t) (sum * sum);
+}
+
+/**
+ * Same as <squared_euclidean_scalar>, VECTOR_LANES coordinates at a time.
+ */
+static int64_t squared_euclidean_vector(const int64_t * p1, const int64_t * p2, uint32_t dim)
+{
+    vector_u64_t accumulator = {0};
+    vector_u64_t difference;
+    uint32_t i = 0;
+    for (; i + VECTOR_LANES <= dim; i += VECTOR_LANES)
+    {
+        difference = vector_load(p1 + i) - vector_load(p2 + i);
+        accumulator += difference * difference;
+    }
+    return (int64_t) ( vector_sum(accumulator) + (uint64_t) squared_euclidean_scalar(p1 + i, p2 + i, dim - i) );
+}
+
+/*
+ * The portable narrow kernels widen the coordinates before the difference : 4 int16_t coordinates at a time summed
+ * in uint32_t lanes, 2 at a time in uint64_t lanes otherwise.
+ */
+typedef int16_t vector_i16x4_t __attribute__ ((vector_size (8)));
+typedef int16_t vector_i16x2_t __attribute__ ((vector_size (4)));
+typedef int32_t vector_i32x2_t __attribute__ ((vector_size (8)));
+typedef int32_t vector_i32x4_t __attribute__ ((vector_size (16)));
+typedef uint32_t vector_u32x4_t __attribute__ ((vector_size (16)));
+
+/**
+ * Loads 4 int16_t coordinates as int32_t.
+ */
+static inline vector_i32x4_t vector_load16x4(const int16_t * row)
+{
+    vector_i16x4_t loaded;
+    memcpy(&loaded, row, sizeof(vector_i16x4_t));
+    return __builtin_convertvector(loaded, vector_i32x4_t);
+}
+
+/**
+ * Loads 2 int16_t coordinates as int64_t.
+ */
+static inline vector_i64_t vector_load16x2(const int16_t * row)
+{
+    vector_i16x2_t loaded;
+    memcpy(&loaded, row, sizeof(vector_i16x2_t));
+    return __builtin_convertvector(loaded, vector_i64_t);
+}
+
+/**
+ * Loads 2 int32_t coordinates as int64_t.
+ */
+static inline vector_i64_t vector_load32x2(const int32_t * row)
+{
+    vector_i32x2_t loaded;
+    memcpy(&loaded, row, sizeof(vector_i32x2_t));
+    return __builtin_convertvector(loaded, vector_i64_t);
+}
+
+/**
+ * Returns the sum of the lanes of a vector of uint32_t.
+ */
+static inline uint64_t vector_sum32(vector_u32x4_t vector)
+{
+    return (uint64_t) (vector[0] + vector[1] + vector[2] + vector[3]);
+}
+
+/**
+ * Same as <squared_manhattan16_scalar>, when the sum fits in uint32_t.
+ */
+static int64_t squared_manhattan16_vector(const int16_t * p1, const int16_t * p2, uint32_t dim)
+{
+    vector_u32x4_t accumulator = {0};
+    vector_i32x4_t difference;
+    vector_i32x4_t sign;
+    uint32_t i = 0;
+    for (; i + 4 <= dim; i += 4)
+    {
+        difference = vector_load16x4(p1 + i) - vector_load16x4(p2 + i);
+        sign = difference >> 31;
+        accumulator += (vector_u32x4_t) ((difference ^ sign) - sign);
+    }
+    uint64_t sum = vector_sum32(accumulator) + absolute_differences16_scalar(p1 + i, p2 + i, dim - i);
+    return (int64_t) (sum * sum);
+}
+
+/**
+ * Same as <squared_euclidean16_scalar>, when the sum fits in uint32_t.
+ */
+static int64_t squared_euclidean16_vector(const int16_t * p1, const int16_t * p2, uint32_t dim)
+{
+    vector_u32x4_t accumulator = {0};
+    vector_u32x4_t difference;
+    uint32_t i = 0;
+    for (; i + 4 <= dim; i += 4)
+    {
+        difference = (vector_u32x4_t) (vector_load16x4(p1 + i) - vector_load16x4(p2 + i));
+        accumulator += difference * difference;
+    }
+    return (int64_t) ( vector_sum32(accumulator) + squared_differences16_scalar(p1 + i, p2 + i, dim - i) );
+}
+
+/**
+ * Same as <squared_manhattan16_scalar>, VECTOR_LANES coordinates at a time.
+ */
+static int64_t squared_manhattan16w_vector(const int16_t * p1, const int16_t * p2, uint32_t dim)
+{
+    vector_u64_t accumulator = {0};
+    vector_i64_t difference;
+    vector_i64_t sign;
+    uint32_t i = 0;
+    for (; i + VECTOR_LANES <= dim; i += VECTOR_LANES)
+    {
+        difference = vector_load16x2(p1 + i) - vector_load16x2(p2 + i);
+        sign = difference >> 63;
+        accumulator += (vector_u64_t) ((difference ^ sign) - sign);
+    }
+    uint64_t sum = vector_sum(accumulator) + absolute_differences16_scalar(p1 + i, p2 + i, dim - i);
+    return (int64_t) (sum * sum);
+}
+
+/**
+ * Same as <squared_euclidean16_scalar>, VECTOR_LANES coordinates at a time.
+ */
+static int64_t squared_euclidean16w_vector(const int16_t * p1, const int16_t * p2, uint32_t dim)
+{
+    vector_u64_t accumulator = {0};
+    vector_u64_t difference;
+    uint32_t i = 0;
+    for (; i + VECTOR_LANES <= dim; i += VECTOR_LANES)
+    {
+        difference = (vector_u64_t) (vector_load16x2(p1 + i) - vector_load16x2(p2 + i));
+        accumulator += difference * difference;
+    }
+    return (int64_t) ( vector_sum(accumulator) + squared_differences16_scalar(p1 + i, p2 + i, dim - i) );
+}
+
+/**
+ * Same as <squared_manhattan32_scalar>, VECTOR_LANES coordinates at a time.
+ */
+static int64_t squared_manhattan32_vector(const int32_t * p1, const int32_t * p2, uint32_t dim)
+{
+    vector_u64_t accumulator = {0};
+    vector_i64_t difference;
+    vector_i64_t sign;
+    uint32_t i = 0;
+    for (; i + VECTOR_LANES <= dim; i += VECTOR_LANES)
+    {
+        difference = vector_load32x2(p1 + i) - vector_load32x2(p2 + i);
+        sign = difference >> 63;
+        accumulator += (vector_u64_t) ((difference ^ sign) - sign);
+    }
+    uint64_t sum = vector_sum(accumulator) + absolute_differences32_scalar(p1 + i, p2 + i, dim - i);
+    return (int64_t) (sum * sum);
+}
+
+/**
+ * Same as <squared_euclidean32_scalar>, VECTOR_LANES coordinates at a time.
+ */
+static int64_t squared_euclidean32_vector(const int32_t * p1, const int32_t * p2, uint32_t dim)
+{
+    vector_u64_t accumulator = {0};
+    vector_u64_t difference;
+    uint32_t i = 0;
+    for (; i + VECTOR_LANES <= dim; i += VECTOR_LANES)
+    {
+        difference = (vector_u64_t) (vector_load32x2(p1 + i) - vector_load32x2(p2 + i));
+        accumulator += difference * difference;
+    }
+    return (int64_t) ( vector_sum(accumulator) + squared_differences32_scalar(p1 + i, p2 + i, dim - i) );
+}
+#if defined(__x86_64__) || defined(__i386__)
+/*
+ * x86 kernels. Each one is compiled for it's own instruction set with the target attribute, so the same binary
+ * runs on every x86 processor : <distance_init> only selects the kernels the processor supports.
+ * 
+ * There's no 64 bits multiplication before AVX-512DQ, the square of a difference d = hi * 2^32 + lo is computed
+ * modulo 2^64 as lo * lo + ((lo * hi) << 33).
+ */
+
+__attribute__ ((target ("sse4.2")))
+static inline __m128i square_epi64_sse4(__m128i difference)
+{
+    __m128i low = _mm_mul_epu32(difference, difference);
+    __m128i cross = _mm_mul_epu32(difference, _mm_srli_epi64(difference, 32));
+    return _mm_add_epi64(low, _mm_slli_epi64(cross, 33));
+}
+
+__attribute__ ((target ("sse4.2")))
+static int64_t squared_manhattan_sse4(const int64_t * p1, const int64_t * p2, uint32_t dim)
+{
+    __m128i accumulator = _mm_setzero_si128();
+    __m128i difference;
+    __m128i sign;
+    uint64_t lanes[2];
+    uint32_t i = 0;
+    for (; i + 2 <= dim; i += 2)
+    {
+        difference = _mm_sub_epi64(_mm_loadu_si128((const __m128i *) (p1 + i)), _mm_loadu_si128((const __m128i *) (p2 + i)));
+        sign = _mm_cmpgt_epi64(_mm_setzero_si128(), difference);
+        accumulator = _mm_add_epi64(accumulator, _mm_sub_epi64(_mm_xor_si128(difference, sign), sign));
+    }
+    _mm_storeu_si128((__m128i *) lanes, accumulator);
+    uint64_t sum = lanes[0] + lanes[1] + absolute_differences_scalar(p1 + i, p2 + i, dim - i);
+    return (int64_t) (sum * sum);
+}
+
+__attribute__ ((target ("sse4.2")))
+static int64_t squared_euclidean_sse4(const int64_t * p1, const int64_t * p2, uint32_t dim)
+{
+    __m128i accumulator = _mm_setzero_si128();
+    __m128i difference;
+    uint64_t lanes[2];
+    uint32_t i = 0;
+    for (; i + 2 <= dim; i += 2)
+    {
+        difference = _mm_sub_epi64(_mm_loadu_si128((const __m128i *) (p1 + i)), _mm_loadu_si128((const __m128i *) (p2 + i)));
+        accumulator = _mm_add_epi64(accumulator, square_epi64_sse4(difference));
+    }
+    _mm_storeu_si128((__m128i *) lanes, accumulator);
+    return (int64_t) ( lanes[0] + lanes[1] + (uint64_t) squared_euclidean_scalar(p1 + i, p2 + i, dim - i) );
+}
+
+__attribute__ ((target ("avx2")))
+static inline __m256i square_epi64_avx2(__m256i difference)
+{
+    __m256i low = _mm256_mul_epu32(difference, difference);
+    __m256i cross = _mm256_mul_epu32(difference, _mm256_srli_epi64(difference, 32));
+    return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 33));
+}
+
+__attribute__ ((target ("avx2")))
+static inline uint64_t sum_epi64_avx2(__m256i vector)
+{
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(vector), _mm256_extracti128_si256(vector, 1));
+    return (uint64_t) _mm_cvtsi128_si64(half) + (uint64_t) _mm_extract_epi64(half, 1);
+}
+
+__attribute__ ((target ("avx2")))
+static int64_t squared_manhattan_avx2(const int64_t * p1, const int64_t * p2, uint32_t dim)
+{
+    __m256i accumulator = _mm256_setzero_si256();
+    __m256i difference;
+    __m256i sign;
+    uint32_t i = 0;
+    for (; i + 4 <= dim; i += 4)
+    {
+        difference = _mm256_sub_epi64(_mm256_loadu_si256((const __m256i *) (p1 + i)), _mm256_loadu_si256((const __m256i *) (p2 + i)));
+        sign = _mm256_cmpgt_epi64(_mm256_setzero_si256(), difference);
+        accumulator = _mm256_add_epi64(accumulator, _mm256_sub_epi64(_mm256_xor_si256(difference, sign), sign));
+    }
+    uint64_t sum = sum_epi64_avx2(accumulator) + absolute_differences_scalar(p1 + i, p2 + i, dim - i);
+    return (int64_t) (sum * sum);
+}
+
+__attribute__ ((target ("avx2")))
+static int64_t squared_euclidean_avx2(const int64_t * p1, const int64_t * p2, uint32_t dim)
+{
+    __m256i accumulator = _mm256_setzero_si256();
+    __m256i difference;
+    uint32_t i = 0;
+    for (; i + 4 <= dim; i += 4)
+    {
+        difference = _mm256_sub_epi64(_mm256_loadu_si256((const __m256i *) (p1 + i)), _mm256_loadu_si256((const __m256i *) (p2 + i)));
+        accumulator = _mm256_add_epi64(accumulator, square_epi64_avx2(difference));
+    }
+    return (int64_t) ( sum_epi64_avx2(accumulator) + (uint64_t) squared_euclidean_scalar(p1 + i, p2 + i, dim - i) );
+}
+
+/*
+ * The narrow AVX2 kernels take the absolute differences as max - min, which fits in the unsigned integer of the
+ * width of the coordinates, then widen them : 16 int16_t or 8 int32_t coordinates at a time. The last coordinates
+ * are loaded with a mask of 32 bits lanes, the masked ones being 0 in both rows, so only an odd int16_t is left.
+ */
+
+__attribute__ ((target ("avx2")))
+static inline uint64_t sum_epi32_avx2(__m256i vector)
+{
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(vector), _mm256_extracti128_si256(vector, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    return (uint64_t) (uint32_t) _mm_cvtsi128_si32(half);
+}
+
+/**
+ * Returns the mask of the first lanes 32 bits lanes, lanes being below 8.
+ */
+__attribute__ ((target ("avx2")))
+static inline __m256i mask_epi32_avx2(uint32_t lanes)
+{
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32((int32_t) lanes), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+/**
+ * Returns the absolute differences of 16 int16_t coordinates, as uint16_t.
+ */
+__attribute__ ((target ("avx2")))
+static inline __m256i absolute_epi16_avx2(__m256i a, __m256i b)
+{
+    return _mm256_sub_epi16(_mm256_max_epi16(a, b), _mm256_min_epi16(a, b));
+}
+
+/**
+ * Returns the absolute differences of 8 int32_t coordinates, as uint32_t.
+ */
+__attribute__ ((target ("avx2")))
+static inline __m256i absolute_epi32_avx2(__m256i a, __m256i b)
+{
+    return _mm256_sub_epi32(_mm256_max_epi32(a, b), _mm256_min_epi32(a, b));
+}
+
+/**
+ * Adds the 8 uint32_t lanes of a vector to the 4 uint64_t lanes of an accumulator.
+ */
+__attribute__ ((target ("avx2")))
+static inline __m256i add_epu32_to_epi64_avx2(__m256i accumulator, __m256i vector)
+{
+    accumulator = _mm256_add_epi64(accumulator, _mm256_and_si256(vector, _mm256_set1_epi64x(0xFFFFFFFF)));
+    return _mm256_add_epi64(accumulator, _mm256_srli_epi64(vector, 32));
+}
+
+/**
+ * Returns the sums of the 16 uint16_t lanes of a vector two by two, as 8 uint32_t.
+ */
+__attribute__ ((target ("avx2")))
+static inline __m256i pairs_epu16_avx2(__m256i vector)
+{
+    return _mm256_add_epi32(_mm256_and_si256(vector, _mm256_set1_epi32(0xFFFF)), _mm256_srli_epi32(vector, 16));
+}
+
+/**
+ * Returns the squares of the 16 uint16_t lanes of a vector, put together from their low and high 16 bits, as two
+ * vectors of 8 uint32_t.
+ */
+__attribute__ ((target ("avx2")))
+static inline void square_epu16_avx2(__m256i vector, __m256i * first, __m256i * second)
+{
+    __m256i low = _mm256_mullo_epi16(vector, vector);
+    __m256i high = _mm256_mulhi_epu16(vector, vector);
+    *first = _mm256_unpacklo_epi16(low, high);
+    *second = _mm256_unpackhi_epi16(low, high);
+}
+
+/**
+ * Defines the 4 AVX2 kernels on int16_t coordinates, ACCUMULATE adding the 8 uint32_t lanes of a vector to the
+ * accumulator and SUM giving the sum of the accumulator.
+ */
+#define DEFINE_AVX2_KERNELS16(SUFFIX, ACCUMULATE, SUM)                                                                \
+__attribute__ ((target ("avx2")))                                                                                    \
+static int64_t squared_manhattan##SUFFIX##_avx2(const int16_t * p1, const int16_t * p2, uint32_t dim)                 \
+{                                                                                                                    \
+    __m256i accumulator = _mm256_setzero_si256();                                                                    \
+    __m256i mask;                                                                                                    \
+    uint32_t i = 0;                                                                                                  \
+    for (; i + 16 <= dim; i += 16)                                                                                   \
+    {                                                                                                                \
+        accumulator = ACCUMULATE(accumulator, pairs_epu16_avx2(absolute_epi16_avx2(                                  \
+                            _mm256_loadu_si256((const __m256i *) (p1 + i)), _mm256_loadu_si256((const __m256i *) (p2 + i)))));  \
+    }                                                                                                                \
+    if (i + 2 <= dim)                                                                                                \
+    {                                                                                                                \
+        mask = mask_epi32_avx2((dim - i) / 2);                                                                       \
+        accumulator = ACCUMULATE(accumulator, pairs_epu16_avx2(absolute_epi16_avx2(                                  \
+                            _mm256_maskload_epi32((const int *) (p1 + i), mask),                                     \
+                            _mm256_maskload_epi32((const int *) (p2 + i), mask))));                                  \
+        i += (dim - i) & ~1u;                                                                                        \
+    }                                                                                                                \
+    uint64_t sum = SUM(accumulator) + absolute_differences16_scalar(p1 + i, p2 + i, dim - i);                        \
+    return (int64_t) (sum * sum);                                                                                    \
+}                                                                                                                    \
+                                                                                                                     \
+__attribute__ ((target ("avx2")))                                                                                    \
+static int64_t squared_euclidean##SUFFIX##_avx2(const int16_t * p1, const int16_t * p2, uint32_t dim)                 \
+{                                                                                                                    \
+    __m256i accumulator = _mm256_setzero_si256();                                                                    \
+    __m256i first;                                                                                                   \
+    __m256i second;                                                                                                  \
+    __m256i mask;                                                                                                    \
+    uint32_t i = 0;                                                                                                  \
+    for (; i + 16 <= dim; i += 16)                                                                                   \
+    {                                                                                                                \
+        square_epu16_avx2(absolute_epi16_avx2(_mm256_loadu_si256((const __m256i *) (p1 + i)),                        \
+                                              _mm256_loadu_si256((const __m256i *) (p2 + i))), &first, &second);     \
+        accumulator = ACCUMULATE(ACCUMULATE(accumulator, first), second);                                            \
+    }                                                                                                                \
+    if (i + 2 <= dim)                                                                                                \
+    {                                                                                                                \
+        mask = mask_epi32_avx2((dim - i) / 2);                                                                       \
+        square_epu16_avx2(absolute_epi16_avx2(_mm256_maskload_epi32((const int *) (p1 + i), mask),                   \
+                                              _mm256_maskload_epi32((const int *) (p2 + i), mask)), &first, &second); \
+        accumulator = ACCUMULATE(ACCUMULATE(accumulator, first), second);                                            \
+        i += (dim - i) & ~1u;                                                                                        \
+    }                                                                                                                \
+    return (int64_t) ( SUM(accumulator) + squared_differences16_scalar(p1 + i, p2 + i, dim - i) );                   \
+}
+
+// The distances of the first ones fit in uint32_t lanes, those of the second ones are widened to uint64_t lanes
+DEFINE_AVX2_KERNELS16(16, _mm256_add_epi32, sum_epi32_avx2)
+DEFINE_AVX2_KERNELS16(16w, add_epu32_to_epi64_avx2, sum_epi64_avx2)
+
+__attribute__ ((target ("avx2")))
+static int64_t squared_manhattan32_avx2(const int32_t * p1, const int32_t * p2, uint32_t dim)
+{
+    __m256i accumulator = _mm256_setzero_si256();
+    __m256i mask;
+    uint32_t i = 0;
+    for (; i + 8 <= dim; i += 8)
+    {
+        accumulator = add_epu32_to_epi64_avx2(accumulator, absolute_epi32_avx2(
+                            _mm256_loadu_si256((const __m256i *) (p1 + i)), _mm256_loadu_si256((const __m256i *) (p2 + i))));
+    }
+    if (i < dim)
+    {
+        mask = mask_epi32_avx2(dim - i);
+        accumulator = add_epu32_to_epi64_avx2(accumulator, absolute_epi32_avx2(
+                            _mm256_maskload_epi32((const int *) (p1 + i), mask), _mm256_maskload_epi32((const int *) (p2 + i), mask)));
+    }
+    uint64_t sum = sum_epi64_avx2(accumulator);
+    return (int64_t) (sum * sum);
+}
+
+/**
+ * The absolute differences being below 2^32, their squares are exact with _mm256_mul_epu32.
+ */
+__attribute__ ((target ("avx2")))
+static int64_t squared_euclidean32_avx2(const int32_t * p1, const int32_t * p2, uint32_t dim)
+{
+    __m256i accumulator = _mm256_setzero_si256();
+    __m256i difference;
+    __m256i odd;
+    __m256i mask;
+    for (uint32_t i = 0; i < dim; i += 8)
+    {
+        if (dim - i >= 8)
+        {
+            difference = absolute_epi32_avx2(_mm256_loadu_si256((const __m256i *) (p1 + i)),
+                                             _mm256_loadu_si256((const __m256i *) (p2 + i)));
+        } else {
+            mask = mask_epi32_avx2(dim - i);
+            difference = absolute_epi32_avx2(_mm256_maskload_epi32((const int *) (p1 + i), mask),
+                                             _mm256_maskload_epi32((const int *) (p2 + i), mask));
+        }
+        odd = _mm256_srli_epi64(difference, 32);
+        accumulator = _mm256_add_epi64(accumulator, _mm256_add_epi64(_mm256_mul_epu32(difference, difference),
+                                                                     _mm256_mul_epu32(odd, odd)));
+    }
+    return (int64_t) sum_epi64_avx2(accumulator);
+}
+
+/*
+ * With AVX-512 the last coordinates are loaded with a mask, there's no scalar tail.
+ */
+
+__attribute__ ((target ("avx512f")))
+static int64_t squared_manhattan_avx512(const int64_t * p1, const int64_t * p2, uint32_t dim)
+{
+    __m512i accumulator = _mm512_setzero_si512();
+    __mmask8 mask;
+    for (uint32_t i = 0; i < dim; i += 8)
+    {
+        mask = (dim - i >= 8) ? 0xFF : (__mmask8) ((1u << (dim - i)) - 1);
+        accumulator = _mm512_add_epi64(accumulator, _mm512_abs_epi64(
+                            _mm512_sub_epi64(_mm512_maskz_loadu_epi64(mask, p1 + i), _mm512_maskz_loadu_epi64(mask, p2 + i))));
+    }
+    uint64_t sum = (uint64_t) _mm512_reduce_add_epi64(accumulator);
+    return (int64_t) (sum * sum);
+}
+
+__attribute__ ((target ("avx512f")))
+static int64_t squared_euclidean_avx512(const int64_t * p1, const int64_t * p2, uint32_t dim)
+{
+    __m512i accumulator = _mm512_setzero_si512();
+    __m512i difference;
+    __mmask8 mask;
+    for (uint32_t i = 0; i < dim; i += 8)
+    {
+        mask = (dim - i >= 8) ? 0xFF : (__mmask8) ((1u << (dim - i)) - 1);
+        difference = _mm512_sub_epi64(_mm512_maskz_loadu_epi64(mask, p1 + i), _mm512_maskz_loadu_epi64(mask, p2 + i));
+        accumulator = _mm512_add_epi64(accumulator, _mm512_add_epi64(_mm512_mul_epu32(difference, difference),
+                            _mm512_slli_epi64(_mm512_mul_epu32(difference, _mm512_srli_epi64(difference, 32)), 33)));
+    }
+    return _mm512_reduce_add_epi64(accumulator);
+}
+#endif
+
+/**
+ * All the implementations of the kernels, from the most to the least preferred.
+ * The name of an x86 implementation is the name used by __builtin_cpu_supports for the instruction set it needs.
+ */
+#define NARROW_KERNELS_OF(SET)                                                                                       \
+    squared_manhattan16_##SET, squared_euclidean16_##SET, squared_manhattan16w_##SET, squared_euclidean16w_##SET,      \
+    squared_manhattan32_##SET, squared_euclidean32_##SET
+
+// The narrow kernels of AVX-512 would need AVX-512BW, those of AVX2 are used instead, and the portable ones with SSE4.2
+static const distance_kernels_t ALL_KERNELS[] = {
+#if defined(__x86_64__) || defined(__i386__)
+    { "avx512f", squared_manhattan_avx512, squared_euclidean_avx512, NARROW_KERNELS_OF(avx2) },
+    { "avx2", squared_manhattan_avx2, squared_euclidean_avx2, NARROW_KERNELS_OF(avx2) },
+    { "sse4.2", squared_manhattan_sse4, squared_euclidean_sse4, NARROW_KERNELS_OF(vector) },
+#endif
+    { "vector", squared_manhattan_vector, squared_euclidean_vector, NARROW_KERNELS_OF(vector) },
+    { "scalar", squared_manhattan_scalar, squared_euclidean_scalar,
+      squared_manhattan16_scalar, squared_euclidean16_scalar, squared_manhattan16_scalar, squared_euclidean16_scalar,
+      squared_manhattan32_scalar, squared_euclidean32_scalar },
+};
+#define NB_OF_KERNELS (sizeof(ALL_KERNELS) / sizeof(distance_kernels_t))
+
+/**
+ * The kernels used by the program, the portable ones until <distance_init> is called.
+ */
+distance_kernels_t DISTANCE_KERNELS = { "vector", squared_manhattan_vector, squared_euclidean_vector, NARROW_KERNELS_OF(vector) };
+
+/**
+ * Tells if the processor supports the given implementation of the kernels.
+ * 
+ * @param kernels (const distance_kernels_t *) : The implementation.
+ * 
+ * @return true if it can be used.
+ */
+static bool distance_isSupported(const distance_kernels_t * kernels)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (strcmp(kernels->name, "avx512f") == 0){ return __builtin_cpu_supports("avx512f"); }
+    if (strcmp(kernels->name, "avx2") == 0){ return __builtin_cpu_supports("avx2"); }
+    if (strcmp(kernels->name, "sse4.2") == 0){ return __builtin_cpu_supports("sse4.2"); }
+#endif
+    return true;
+}
+
+/**
+ * Selects, once at startup, the fastest kernels supported by the processor.
+ */
+void distance_init(void)
+{
+    for (size_t i = 0; i < NB_OF_KERNELS; i++)
+    {
+        if (distance_isSupported(ALL_KERNELS + i))
+        {
+            DISTANCE_KERNELS = ALL_KERNELS[i];
+            return;
+        }
+    }
+}
+
+/**
+ * Gives all the implementations of the kernels supported by the processor, the first one being the one selected 
+ * by <distance_init>.
+ * 
+ * @param kernels (distance_kernels_t *) : An array of at least maxSize elements, to hold the implementations.
+ * @param maxSize (uint32_t) : The size of the array.
+ * 
+ * @return The number of implementations put in the array.
+ */
+uint32_t distance_supportedKernels(distance_kernels_t * kernels, uint32_t maxSize)
+{
+    uint32_t size = 0;
+    for (size_t i = 0; i < NB_OF_KERNELS && size < maxSize; i++)
+    {
+        if (distance_isSupported(ALL_KERNELS + i))
+        {
+            kernels[size++] = ALL_KERNELS[i];
+        }
+    }
+    return size;
+}
+
+/**
+ * Calculates the squared distance between two points using the manhattan formula.
  * 
  * @param p1 (point_t *) : A point.
  * @param p2 (point_t *) : And another point.
@@ -17,19 +785,11 @@
  * @return value (int64_t)
  */
 int64_t squared_manhattan_distance(const point_t *p1, const point_t *p2) {
-    int64_t dim = p1->dimension;
-    int64_t sum = 0;
-    int64_t *p1_val = p1->values;
-    int64_t *p2_val = p2->values;
-
-    for (size_t i = 0; i < dim; i++){
-        sum += abs( *(p1_val+i) - *(p2_val+i) );
-    }
-    return (sum * sum);
+    return DISTANCE_KERNELS.squared_manhattan(p1->values, p2->values, p1->dimension);
 }
 
 /**
- * Calculates the squared distance between two points using thje euclidean formula.
+ * Calculates the squared distance between two points using the euclidean formula.
  * 
  * @param p1 (point_t *) : A point.
  * @param p2 (point_t *) : And another point.
@@ -37,36 +797,19 @@ int64_t squared_manhattan_distance(const point_t *p1, const point_t *p2) {
  * @return value (int64_t)
  */
 int64_t squared_euclidean_distance(const point_t *p1, const point_t *p2) {
-    int64_t dim = p1->dimension;
-    int64_t sum = 0;
-    int64_t *p1_val = p1->values;
-    int64_t *p2_val = p2->values;
-
-    for (size_t i = 0; i < dim; i++){
-        sum += ( *(p1_val+i) - *(p2_val+i) ) * ( *(p1_val+i) - *(p2_val+i) );
-    }
-    return sum;
+    return DISTANCE_KERNELS.squared_euclidean(p1->values, p2->values, p1->dimension);
 }
 
 /**
  * A function that calculates the distortion distance of centroids to their correspondind clusters
  * 
- * @param centroids (array_of_centroids *) : The strcuture holding centroids.
- * @param clusters (array_of_arrays_of_points *) : The structure holding the clusters.
+ * @param centroids (const dataset_t *) : The dataset holding centroids.
+ * @param points (const dataset_t *) : The points.
+ * @param clusters (const labels_t *) : The labels of the points.
  * 
  * @return value (int64_t)
  */
-int64_t distortion_distance(const array_of_centroids *centroids, const array_of_arrays_of_points *clusters){
-    int64_t accum_sum = 0;
-    array_of_points * cluster_at_idx;
-    point_t * vector;
-
-    for (size_t i = 0; i < (clusters->size); i++){
-        cluster_at_idx = clusters->array + i;
-        for (size_t j = 0; j < cluster_at_idx->size; j++){
-            vector = cluster_at_idx->points + j;
-            accum_sum += FORMULA_CHOOSED( vector , ( centroids->points+i ) );
-        }
-    }
-    return accum_sum;
+int64_t distortion_distance(const dataset_t *centroids, const dataset_t *points, const labels_t *clusters){
+    const lloyd_kernels_t * kernels = kernels_select(FORMULA_CHOOSED, points->dimension);
+    return kernels->distortion(centroids, points, clusters, 0, points->size);
 }
@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "elkan.h"
+#include "bounds.h"
+#include "dataset.h"
+#include "labels.h"
+#include "kernels.h"
+
+/**
+ * Allocates the state of the assignment of Elkan for the points and K centroids.
+ *
+ * @param points (const dataset_t *) : The points to cluster.
+ * @param K (uint32_t) : The number of centroids.
+ *
+ * @return (void *) : The state, NULL in case of an error.
+ */
+void * elkan_create(const dataset_t * points, uint32_t K)
+{
+    elkan_t * state = (elkan_t *) calloc(1, sizeof(elkan_t));
+    if (state == NULL){ return NULL; }
+    state->K = K;
+
+    uint64_t nbOfBounds = points->size * K;
+    if (K != 0 && nbOfBounds / K != points->size)
+    {
+        free(state);
+        return NULL;
+    }
+    state->upper = (double *) malloc( sizeof(double) * (points->size == 0 ? 1 : points->size) );
+    state->lower = (double *) malloc( sizeof(double) * (nbOfBounds == 0 ? 1 : nbOfBounds) );
+    state->refreshed = (uint32_t *) malloc( sizeof(uint32_t) * (points->size == 0 ? 1 : points->size) );
+    state->capacity = 64;
+    state->totals = (double *) malloc( sizeof(double) * state->capacity * K );
+    state->halves = (double *) malloc( sizeof(double) * K * K );
+    state->nearest = (double *) malloc( sizeof(double) * K );
+    state->drifts = (double *) malloc( sizeof(double) * K );
+    if (state->upper == NULL || state->lower == NULL || state->refreshed == NULL || state->totals == NULL ||
+        state->halves == NULL || state->nearest == NULL || state->drifts == NULL)
+    {
+        elkan_destroy(state);
+        return NULL;
+    }
+    return state;
+}
+
+/**
+ * The first assignment computes all the distances, they give the bounds.
+ */
+static int elkan_assignAll(elkan_t * state, const dataset_t * centroids, const dataset_t * points, labels_t * labels,
+                           moves_t * moves, const lloyd_kernels_t * kernels)
+{
+    int changed = 0;
+    uint32_t K = state->K;
+    for (uint64_t i = 0; i < points->size; i++)
+    {
+        const int64_t * vector = dataset_row(points, i);
+        double * lower = state->lower + i * K;
+        uint32_t closest = 0;
+        int64_t closestDistance = 0;
+        for (uint32_t k = 0; k < K; k++)
+        {
+            int64_t distance = kernels->distance(vector, dataset_row(centroids, k), points->dimension);
+            lower[k] = bounds_lower(bounds_distance(distance));
+            if (k == 0 || distance < closestDistance)
+            {
+                closest = k;
+                closestDistance = distance;
+            }
+        }
+        state->upper[i] = bounds_upper(bounds_distance(closestDistance));
+        state->refreshed[i] = 0;
+        if (closest != labels_get(labels, i))
+        {
+            moves_push(moves, i, labels_get(labels, i));
+            labels_set(labels, i, closest);
+            changed = 1;
+        }
+        labels->counts[closest]++;
+    }
+    return changed;
+}
+
+/**
+ * Assigns each point to it's closest centroid, the same way as <assign_vectors_to_centroids>, using the bounds
+ * to skip most of the distances. The counts of the labels are updated.
+ *
+ * @param ptr (void *) : The state returned by <elkan_create>.
+ * @param centroids (const dataset_t *) : The centroids.
+ * @param points (const dataset_t *) : The points.
+ * @param labels (labels_t *) : The labels of the points, as left by the last assignment.
+ * @param moves (moves_t *) : The list where the points that change of cluster are recorded.
+ * @param kernels (const lloyd_kernels_t *) : The loops selected for the formula and the dimension.
+ *
+ * @return (int) : 1 if a point has changed of cluster, 0 if not, -1 in case of an error.
+ */
+int elkan_assign(void * ptr, const dataset_t * centroids, const dataset_t * points, labels_t * labels,
+                 moves_t * moves, const lloyd_kernels_t * kernels)
+{
+    elkan_t * state = (elkan_t *) ptr;
+    uint32_t K = state->K;
+    int changed = 0;
+
+    if (!state->started)
+    {
+        if (dataset_init(&state->previous, K, centroids->dimension) != 0){ return -1; }
+        state->started = true;
+        memset(labels->counts, 0, sizeof(uint64_t) * K);
+        memset(state->totals, 0, sizeof(double) * K);
+        state->nbOfTotals = 1;
+        changed = elkan_assignAll(state, centroids, points, labels, moves, kernels);
+        dataset_copy(&state->previous, centroids);
+        return changed;
+    }
+
+    if (state->nbOfTotals == state->capacity)
+    {
+        double * totals = (double *) realloc(state->totals, sizeof(double) * 2 * state->capacity * K);
+        if (totals == NULL){ return -1; }
+        state->totals = totals;
+        state->capacity *= 2;
+    }
+    uint32_t iteration = state->nbOfTotals++;
+    double * totals = state->totals + (uint64_t) iteration * K;
+    const double * totalsBefore = totals - K;
+
+    bounds_drifts(&state->previous, centroids, state->drifts, kernels);
+    bounds_halfDistances(centroids, state->halves, state->nearest, kernels);
+    for (uint32_t k = 0; k < K; k++)
+    {
+        totals[k] = bounds_increase(totalsBefore[k], state->drifts[k]);
+    }
+
+    for (uint64_t i = 0; i < points->size; i++)
+    {
+        uint32_t assigned = labels_get(labels, i);
+        const double * totalsThen = state->totals + (uint64_t) state->refreshed[i] * K;
+        double upper = bounds_increase(state->upper[i], bounds_driftSince(totals[assigned], totalsThen[assigned]));
+
+        if (upper < state->nearest[assigned]){ continue; }
+
+        // The bounds of the point are brought up to date
+        const int64_t * vector = dataset_row(points, i);
+        double * lower = state->lower + i * K;
+        for (uint32_t k = 0; k < K; k++)
+        {
+            lower[k] = bounds_decrease(lower[k], bounds_driftSince(totals[k], totalsThen[k]));
+        }
+        state->refreshed[i] = iteration;
+
+        uint32_t closest = assigned;
+        int64_t closestDistance = 0;
+        bool tight = false;
+        for (uint32_t k = 0; k < K; k++)
+        {
+            if (k == closest || upper < lower[k] || upper < state->halves[closest * K + k]){ continue; }
+            if (!tight)
+            {
+                closestDistance = kernels->distance(vector, dataset_row(centroids, closest), points->dimension);
+                upper = bounds_upper(bounds_distance(closestDistance));
+                lower[closest] = bounds_lower(bounds_distance(closestDistance));
+                tight = true;
+                if (upper < lower[k] || upper < state->halves[closest * K + k]){ continue; }
+            }
+            int64_t distance = kernels->distance(vector, dataset_row(centroids, k), points->dimension);
+            lower[k] = bounds_lower(bounds_distance(distance));
+            if (distance < closestDistance || (distance == closestDistance && k < closest))
+            {
+                closest = k;
+                closestDistance = distance;
+                upper = bounds_upper(bounds_distance(distance));
+            }
+        }
+        state->upper[i] = upper;
+
+        if (closest != assigned)
+        {
+            moves_push(moves, i, assigned);
+            labels_set(labels, i, closest);
+            labels->counts[assigned]--;
+            labels->counts[closest]++;
+            changed = 1;
+        }
+    }
+
+    dataset_copy(&state->previous, centroids);
+    return changed;
+}
+
+/**
+ * Frees the state of the assignment of Elkan.
+ *
+ * @param ptr (void *) : The state returned by <elkan_create>, may be NULL.
+ */
+void elkan_destroy(void * ptr)
+{
+    elkan_t * state = (elkan_t *) ptr;
+    if (state == NULL){ return; }
+    free(state->upper);
+    free(state->lower);
+    free(state->refreshed);
+    free(state->totals);
+    free(state->halves);
+    free(state->nearest);
+    free(state->drifts);
+    dataset_destroy(&state->previous);
+    free(state);
+}
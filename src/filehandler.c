@@ -9,139 +9,768 @@
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <inttypes.h>
+#include <pthread.h>
 
 #include "filehandler.h"
 #include "point.h"
-#include "arrayofclusters.h"
-#include "arrayofpoints.h"
+#include "labels.h"
+#include "dataset.h"
 #include "threadshandler.h"
 
 /**
- * Frees the fileStrcuture according to the number of initiated points.
+ * This structure of arguments is given to each thread converting a slice of the mapped file.
  * 
- * @param inputFile (file_t *) : The file structure.
- * @param initiatedPoints (size_t) : The number of correclty initiated points.
- */ 
-void freeDynamicFileStruct(file_t * inputFile, size_t initiatedPoints)
+ * @param source (const char *) : The first byte of the first big endian value of the slice.
+ * @param destination (int64_t *) : Where to store the first converted value.
+ * @param nbOfValues (uint64_t) : The number of values in the slice.
+ * @param minimum (int64_t) : Set to the smallest converted value (the slice must not be empty).
+ * @param maximum (int64_t) : Set to the largest converted value.
+ */
+typedef struct {
+    const char * source;
+    int64_t * destination;
+    uint64_t nbOfValues;
+    int64_t minimum;
+    int64_t maximum;
+} byteSwapArgs_t;
+
+/**
+ * Converts a slice of big endian values to the host byte order, and finds the range of the values on the way. This
+ * function must be given to the threads converting the mapped file.
+ * 
+ * @param argT (void *) : This should be a casted (byteSwapArgs_t *) pointer.
+ * 
+ * @return (void *) NULL.
+ */
+void * byteSwapSlice(void * argT)
+{
+    byteSwapArgs_t * args = (byteSwapArgs_t *) argT;
+    const char * source = args->source;
+    int64_t * destination = args->destination;
+    uint64_t value;
+    int64_t minimum = INT64_MAX;
+    int64_t maximum = INT64_MIN;
+    for (uint64_t i = 0; i < args->nbOfValues; i++)
+    {
+        // The source may not be aligned (the points start at an offset of 12 bytes in the file), memcpy 
+        // is compiled to a plain load where unaligned loads are allowed.
+        memcpy(&value, source + sizeof(uint64_t) * i, sizeof(uint64_t));
+        destination[i] = (int64_t) be64toh( value );
+        minimum = (destination[i] < minimum) ? destination[i] : minimum;
+        maximum = (destination[i] > maximum) ? destination[i] : maximum;
+    }
+    args->minimum = minimum;
+    args->maximum = maximum;
+    return (NULL);
+}
+
+/**
+ * Converts nbOfValues big endian values to the host byte order, the work is split in nThreads slices.
+ * If a thread can not be created, it's slice is converted by the calling thread.
+ * 
+ * @param source (const char *) : The big endian values, they don't need to be aligned.
+ * @param destination (int64_t *) : The buffer to store the converted values. It may be the source itself.
+ * @param nbOfValues (uint64_t) : The number of values to convert.
+ * @param nThreads (uint32_t) : The number of threads to use.
+ * @param minimum (int64_t *) : Where to store the smallest value (0 if there is none), may be NULL.
+ * @param maximum (int64_t *) : Where to store the largest value (0 if there is none), may be NULL.
+ */
+void byteSwapInParallel(const char * source, int64_t * destination, uint64_t nbOfValues, uint32_t nThreads,
+                        int64_t * minimum, int64_t * maximum)
+{
+    // It's not worth creating threads for less than a few pages per thread
+    uint64_t minimumSlice = 1 << 16;
+    if (nThreads == 0 || nbOfValues / nThreads < minimumSlice)
+    {
+        nThreads = (uint32_t) (nbOfValues / minimumSlice);
+    }
+    nThreads = (nThreads == 0) ? 1 : nThreads;
+
+    int64_t smallest = (nbOfValues == 0) ? 0 : INT64_MAX;
+    int64_t largest = (nbOfValues == 0) ? 0 : INT64_MIN;
+    pthread_t threads[nThreads];
+    bool launched[nThreads];
+    byteSwapArgs_t slices[nThreads];
+    uint64_t valuesPerThread = nbOfValues / nThreads;
+
+    for (uint32_t i = 0; i < nThreads; i++)
+    {
+        uint64_t first = valuesPerThread * i;
+        slices[i].source = source + sizeof(uint64_t) * first;
+        slices[i].destination = destination + first;
+        slices[i].nbOfValues = (i == nThreads - 1) ? nbOfValues - first : valuesPerThread;
+        // The calling thread takes care of the first slice
+        launched[i] = (i != 0) && (pthread_create(&threads[i], NULL, &byteSwapSlice, &slices[i]) == 0);
+    }
+    for (uint32_t i = 0; i < nThreads; i++)
+    {
+        if (launched[i])
+        {
+            pthread_join(threads[i], NULL);
+        } else {
+            byteSwapSlice(&slices[i]);
+        }
+        if (slices[i].nbOfValues > 0)
+        {
+            smallest = (slices[i].minimum < smallest) ? slices[i].minimum : smallest;
+            largest = (slices[i].maximum > largest) ? slices[i].maximum : largest;
+        }
+    }
+    if (minimum != NULL){ *minimum = smallest; }
+    if (maximum != NULL){ *maximum = largest; }
+}
+
+/**
+ * Reads exactly size bytes from the file descriptor.
+ * 
+ * @param fd (int) : The file descriptor.
+ * @param buffer (void *) : The buffer to fill.
+ * @param size (size_t) : The number of bytes to read.
+ * 
+ * @return (int). 0 Upon success else -1.
+ */
+int readExactly(int fd, void * buffer, size_t size)
+{
+    char * destination = (char *) buffer;
+    while (size > 0)
+    {
+        ssize_t hasRead = read(fd, destination, size);
+        if (hasRead < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (hasRead <= 0)
+        {
+            return -1;
+        }
+        destination += hasRead;
+        size -= (size_t) hasRead;
+    }
+    return 0;
+}
+
+/**
+ * Reads the points of a file which can not be mapped (a pipe for example) into the buffer of the structure,
+ * with large sequential reads, then converts them to the host byte order.
+ * 
+ * @param theStruct (file_t *) : The structure, the dataset must be initialized.
+ * @param fd (int) : The file descriptor, positioned right after the header.
+ * 
+ * @return (int). 0 Upon success else -1.
+ */
+int readStreamIntoFileStruct(file_t * theStruct, int fd)
+{
+    uint64_t nbOfValues = (uint64_t) theStruct->dataset.dimension * theStruct->dataset.size;
+    if (readExactly(fd, theStruct->dataset.values, sizeof(int64_t) * nbOfValues) != 0)
+    {
+        fprintf(stderr, "[filehandler.c] Error reading the points. It seems that the input file doesn't respect the specification\n");
+        return -1;
+    }
+    byteSwapInParallel((const char *) theStruct->dataset.values, theStruct->dataset.values, nbOfValues, 1,
+                       &theStruct->minimum, &theStruct->maximum);
+    return 0;
+}
+
+/**
+ * Reads the header of the binary file and checks that the points it announces can be held in memory and fit in the
+ * file.
+ * 
+ * @param fd (int) : The file descriptor, positioned at the start of the file.
+ * @param fileInfo (const struct stat *) : The status of the file.
+ * @param dimension (uint32_t *) : Where to store the dimension of the points.
+ * @param nbOfPoints (uint64_t *) : Where to store the number of points.
+ * 
+ * @return (int). 0 Upon success else -1.
+ */
+static int readHeader(int fd, const struct stat * fileInfo, uint32_t * dimension, uint64_t * nbOfPoints)
+{
+    // Reads the first 4 bytes which is the dimension and the next 8 bytes which is the number of points
+    if (readExactly(fd, dimension, sizeof(uint32_t)) != 0 || readExactly(fd, nbOfPoints, sizeof(uint64_t)) != 0)
+    { 
+        fprintf(stderr, "[filehandler.c] Error reading the header. It seems that the input file doesn't respect the specification\n");
+        return -1; 
+    } 
+    
+    // We ensure that we use the same integer encoding : big endian
+    *dimension = be32toh( *dimension ); 
+    *nbOfPoints = be64toh( *nbOfPoints );
+
+    // The number of values must be representable and must fit in the file
+    bool isRegularFile = S_ISREG(fileInfo->st_mode);
+    uint64_t nbOfValues = *nbOfPoints * (uint64_t) *dimension;
+    if ( (*dimension != 0 && nbOfValues / *dimension != *nbOfPoints) || 
+         nbOfValues > (SIZE_MAX - FILE_HEADER_SIZE) / sizeof(int64_t) ||
+         (isRegularFile && (uint64_t) fileInfo->st_size < FILE_HEADER_SIZE + nbOfValues * sizeof(int64_t)) )
+    {
+        fprintf(stderr, "[filehandler.c] The header announces %" PRIu64 " points of dimension %" PRIu32 " but the input file is too small\n", *nbOfPoints, *dimension);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Computes a 64 bits checksum of a content (FNV-1a, a word of 8 bytes at a time then the last bytes one by one).
+ * 
+ * @param content (const void *) : The content.
+ * @param size (size_t) : The size of the content in bytes.
+ * 
+ * @return (uint64_t) : The checksum.
+ */
+uint64_t fileChecksum(const void * content, size_t size)
+{
+    const char * bytes = (const char *) content;
+    uint64_t checksum = 0xCBF29CE484222325ULL;
+    uint64_t word;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        memcpy(&word, bytes + i, sizeof(uint64_t));
+        checksum = (checksum ^ word) * 0x100000001B3ULL;
+    }
+    for (; i < size; i++)
+    {
+        checksum = (checksum ^ (uint8_t) bytes[i]) * 0x100000001B3ULL;
+    }
+    return checksum;
+}
+
+/**
+ * Returns the pathname of the prepared copy of an input file, the pathname of the input file followed by
+ * FILE_PREPARED_SUFFIX.
+ * 
+ * ATTENTION : Think of freeing the pathname when done.
+ * 
+ * @param filePathName (const char *) : The pathname of the input file.
+ * 
+ * @return (char *) : The pathname, NULL if the malloc failed.
+ */
+static char * preparedPathName(const char * filePathName)
+{
+    size_t length = strlen(filePathName);
+    char * pathName = (char *) malloc( length + sizeof(FILE_PREPARED_SUFFIX) );
+    if (pathName == NULL){ return NULL; }
+    memcpy(pathName, filePathName, length);
+    memcpy(pathName + length, FILE_PREPARED_SUFFIX, sizeof(FILE_PREPARED_SUFFIX));
+    return pathName;
+}
+
+/**
+ * Maps the prepared copy of the input file in the structure, if there is one and it has been prepared from the input
+ * file as it is now (same size and time of last modification) on a host of the same byte order. The points are used
+ * as they are in the page cache, without any conversion.
+ * 
+ * @param theStruct (file_t *) : The structure to initialize.
+ * @param filePathName (const char *) : The pathname of the input file.
+ * @param source (const struct stat *) : The status of the input file.
+ * 
+ * @return (int). 0 if the prepared file is mapped, else -1 and the input file must be read.
+ */
+static int mapPreparedFile(file_t * theStruct, const char * filePathName, const struct stat * source)
 {
-    for (size_t i = 0; i < initiatedPoints; i++)
+    prepared_header_t header;
+    struct stat fileInfo;
+    char * pathName = preparedPathName(filePathName);
+    if (pathName == NULL){ return -1; }
+    int fd = open(pathName, O_RDONLY);
+    free(pathName);
+    if (fd < 0){ return -1; }
+
+    if (fstat(fd, &fileInfo) != 0 || pread(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header))
     {
-        free((inputFile->ptrToPoints + i)->values);
+        close(fd);
+        return -1;
     }
-    free(inputFile->ptrToPoints);
+    uint64_t nbOfValues = header.nbOfPoints * (uint64_t) header.stride;
+    bool isFresh = memcmp(header.magic, FILE_PREPARED_MAGIC, sizeof(header.magic)) == 0
+                   && header.version == FILE_PREPARED_VERSION
+                   && header.byteOrder == FILE_PREPARED_BYTE_ORDER
+                   && header.sourceSize == (uint64_t) source->st_size
+                   && header.sourceSeconds == (int64_t) source->st_mtim.tv_sec
+                   && header.sourceNanoseconds == (int64_t) source->st_mtim.tv_nsec
+                   && header.stride == header.dimension
+                   && header.offset % DATASET_ALIGNMENT == 0
+                   && header.offset >= sizeof(header)
+                   && (header.stride == 0 || nbOfValues / header.stride == header.nbOfPoints)
+                   && nbOfValues <= (SIZE_MAX - header.offset) / sizeof(int64_t)
+                   && (uint64_t) fileInfo.st_size >= header.offset + nbOfValues * sizeof(int64_t);
+    if (!isFresh)
+    {
+        close(fd);
+        return -1;
+    }
+
+    size_t mappingSize = (size_t) (header.offset + nbOfValues * sizeof(int64_t));
+    char * mapped = (char *) mmap(NULL, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED){ return -1; }
+    madvise(mapped, mappingSize, MADV_WILLNEED);
+
+    theStruct->mapping = mapped;
+    theStruct->mappingSize = mappingSize;
+    theStruct->dataset.values = (int64_t *) (mapped + header.offset);
+    theStruct->dataset.dimension = header.dimension;
+    theStruct->dataset.stride = header.stride;
+    theStruct->dataset.size = header.nbOfPoints;
+    theStruct->nbOfPoints = header.nbOfPoints;
+    theStruct->minimum = header.minimum;
+    theStruct->maximum = header.maximum;
+    return 0;
 }
 
 /**
  * Reads the binary file, and initialize the file_t structure given in the parameters.
  * 
+ * The file is mapped in memory and it's content is converted, in parallel, into the matrix of the dataset, the
+ * range of the coordinates being found during the conversion. The header is validated against the size of the file. If the file has an up to date prepared copy, written by
+ * <filePrepare>, the copy is mapped instead and nothing is converted.
+ * 
  * @param theStruct (file_t *) : The structure to initialize.
  * @param filePathName (const char *) : The pathName to the binary file.
+ * @param nThreads (uint32_t) : The number of threads that can be used to convert the points.
  * 
  * @return (int). 0 Upon success else -1.
  */
-int fileRead(file_t * theStruct, const char * filePathName)
+int fileRead(file_t * theStruct, const char * filePathName, uint32_t nThreads)
 {
     // Check if the pointer is NULL
     if(theStruct == NULL){ return -1; }
+    theStruct->dataset.values = NULL;
+    theStruct->dataset.size = 0;
+    theStruct->nbOfPoints = 0;
+    theStruct->streamed = false;
+    theStruct->fd = -1;
+    theStruct->mapping = NULL;
+    theStruct->mappingSize = 0;
+    theStruct->minimum = 0;
+    theStruct->maximum = 0;
 
-    FILE* file;
-    point_t * temp_point;
-    uint64_t alreadyInitiatedPoints = 0;
+    int fd;
+    struct stat fileInfo;
+    uint32_t dimension;
+    uint64_t nbOfPoints;
 
     // Opens the binary file
-    file = fopen(filePathName,"rb");
-    if (file == NULL)
+    fd = open(filePathName, O_RDONLY);
+    if (fd < 0)
     {
         fprintf(stderr,"[src/filehandler.c] Error when opening the input file < %s >:\n\t%s\n", filePathName, strerror(errno) );
         return -1;
     }
+    if (fstat(fd, &fileInfo) != 0)
+    {
+        fprintf(stderr,"[src/filehandler.c] Error when getting the status of the input file < %s >:\n\t%s\n", filePathName, strerror(errno) );
+        close(fd);
+        return -1;
+    }
+    bool isRegularFile = S_ISREG(fileInfo.st_mode);
+    if (isRegularFile && mapPreparedFile(theStruct, filePathName, &fileInfo) == 0)
+    {
+        close(fd);
+        return 0;
+    }
 
-    // Reads the first 4 bytes which is the dimension
-    if (fread( &(theStruct->dimension) ,sizeof(uint32_t), 1, file) != 1)
-    { 
-        fprintf(stderr, "[filehandler.c] Error reading the dimension. It seems that the input file doesn't respect the specification\n");
-        fclose(file);
-        return -1; 
-    } 
-    // Reads the next 4 bytes which is the number of points
-    if (fread( &(theStruct->nbOfPoints) ,sizeof(uint64_t), 1, file) != 1)
-    { 
-        fprintf(stderr, "[filehandler.c] Error reading the number of point. It seems that the input file doesn't respect the specification\n");
-        fclose(file);
-        return -1; 
-    } 
-    
-    // We ensure that we use the same integer encoding : big endian
-    theStruct->dimension = be32toh( theStruct->dimension ); 
-    theStruct->nbOfPoints = be64toh( theStruct->nbOfPoints );
-    theStruct->ptrToPoints = (point_t *) malloc(sizeof(point_t) * theStruct->nbOfPoints );
+    if (readHeader(fd, &fileInfo, &dimension, &nbOfPoints) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    theStruct->nbOfPoints = nbOfPoints;
+    uint64_t nbOfValues = nbOfPoints * (uint64_t) dimension;
 
-    if (theStruct->ptrToPoints == NULL )
+    if (dataset_init(&theStruct->dataset, nbOfPoints, dimension) != 0)
     {
-        fprintf(stderr, "[filehandler.c] Failed malloc when initiating the pointer to hold the points\n");
-        fclose(file);
+        fprintf(stderr, "[filehandler.c] Failed malloc when initiating the buffer to hold the points\n");
+        close(fd);
         return -1;
     }
+    size_t bufferSize = sizeof(int64_t) * nbOfValues;
+    if (bufferSize == 0)
+    {
+        close(fd);
+        return 0;
+    }
 
-    // We start reading the points now
-    for (uint64_t i = 0; i < theStruct->nbOfPoints; i++)
-    {   
-        temp_point = theStruct->ptrToPoints + i;
-        temp_point->values = (int64_t *) malloc( sizeof(int64_t) * theStruct->dimension );
+    if (isRegularFile == false)
+    {
+        int possibleError = readStreamIntoFileStruct(theStruct, fd);
+        close(fd);
+        if (possibleError != 0)
+        {
+            freeFileStruct(theStruct);
+        }
+        return possibleError;
+    }
 
-        if(temp_point->values == NULL)
+    // The points are converted straight from the page cache, without any intermediary copy
+    char * mapped = (char *) mmap(NULL, FILE_HEADER_SIZE + bufferSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        fprintf(stderr,"[src/filehandler.c] Error when mapping the input file < %s >:\n\t%s\n", filePathName, strerror(errno) );
+        freeFileStruct(theStruct);
+        return -1;
+    }
+    // The advices are not flags, each one is given on it's own
+    madvise(mapped, FILE_HEADER_SIZE + bufferSize, MADV_SEQUENTIAL);
+    madvise(mapped, FILE_HEADER_SIZE + bufferSize, MADV_WILLNEED);
+
+    byteSwapInParallel(mapped + FILE_HEADER_SIZE, theStruct->dataset.values, nbOfValues, nThreads,
+                       &theStruct->minimum, &theStruct->maximum);
+
+    munmap(mapped, FILE_HEADER_SIZE + bufferSize);
+    return 0;
+}
+
+/**
+ * Writes exactly size bytes to the file descriptor, at the given offset.
+ * 
+ * @param fd (int) : The file descriptor.
+ * @param buffer (const void *) : The bytes to write.
+ * @param size (size_t) : The number of bytes to write.
+ * @param offset (off_t) : The offset in the file.
+ * 
+ * @return (int). 0 Upon success else -1.
+ */
+static int writeExactly(int fd, const void * buffer, size_t size, off_t offset)
+{
+    const char * source = (const char *) buffer;
+    while (size > 0)
+    {
+        ssize_t hasWritten = pwrite(fd, source, size, offset);
+        if (hasWritten < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (hasWritten <= 0)
         {
-            fprintf(stderr, "[filehandler.c] Failed malloc when reading input points. Number of points that were already initiated : %lld \n", (long long int) alreadyInitiatedPoints);
-            fclose(file);
-            freeDynamicFileStruct(theStruct, alreadyInitiatedPoints);
             return -1;
         }
+        source += hasWritten;
+        offset += hasWritten;
+        size -= (size_t) hasWritten;
+    }
+    return 0;
+}
+
+/**
+ * Writes the prepared copy of an input file next to it, so that the next runs on this file map the copy instead of
+ * converting the file (see <fileRead>). The copy is written in a temporary file renamed at the end, so a run never
+ * sees a partial copy.
+ * 
+ * @param theStruct (const file_t *) : The input file, read by <fileRead>.
+ * @param filePathName (const char *) : The pathname of the input file, a regular file.
+ * 
+ * @return (int). 0 Upon success else -1.
+ */
+int filePrepare(const file_t * theStruct, const char * filePathName)
+{
+    if (theStruct == NULL || theStruct->streamed){ return -1; }
+    const dataset_t * points = &theStruct->dataset;
+    prepared_header_t header;
+    struct stat fileInfo;
+    int possibleError = 0;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FILE_PREPARED_MAGIC, sizeof(header.magic));
+    header.version = FILE_PREPARED_VERSION;
+    header.byteOrder = FILE_PREPARED_BYTE_ORDER;
+    header.dimension = points->dimension;
+    header.stride = points->dimension;
+    header.nbOfPoints = points->size;
+    header.offset = FILE_PREPARED_OFFSET;
+    header.minimum = theStruct->minimum;
+    header.maximum = theStruct->maximum;
 
-        temp_point->dimension = theStruct->dimension;
-        for (uint64_t j = 0; j < theStruct->dimension; j++)
+    // The checksum is computed from the input file it's self, to keep track of the content the copy comes from
+    int fd = open(filePathName, O_RDONLY);
+    if (fd < 0 || fstat(fd, &fileInfo) != 0 || !S_ISREG(fileInfo.st_mode))
+    {
+        fprintf(stderr, "[filehandler.c] Only a regular input file can be prepared\n");
+        if (fd >= 0){ close(fd); }
+        return -1;
+    }
+    header.sourceSize = (uint64_t) fileInfo.st_size;
+    header.sourceSeconds = (int64_t) fileInfo.st_mtim.tv_sec;
+    header.sourceNanoseconds = (int64_t) fileInfo.st_mtim.tv_nsec;
+    if (fileInfo.st_size > 0)
+    {
+        char * mapped = (char *) mmap(NULL, (size_t) fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED)
         {
-            fread(temp_point->values + j,sizeof(int64_t),1,file);
-            *(temp_point->values + j) = be64toh( *(temp_point->values + j) );
+            fprintf(stderr, "[filehandler.c] Error when mapping the input file < %s >:\n\t%s\n", filePathName, strerror(errno));
+            close(fd);
+            return -1;
         }
-        alreadyInitiatedPoints+=1;
+        madvise(mapped, (size_t) fileInfo.st_size, MADV_SEQUENTIAL);
+        header.checksum = fileChecksum(mapped, (size_t) fileInfo.st_size);
+        munmap(mapped, (size_t) fileInfo.st_size);
+    } else {
+        header.checksum = fileChecksum(NULL, 0);
+    }
+    close(fd);
+
+    char * pathName = preparedPathName(filePathName);
+    char * temporaryPathName = (pathName == NULL) ? NULL : (char *) malloc( strlen(pathName) + sizeof(".tmp") );
+    if (temporaryPathName == NULL)
+    {
+        fprintf(stderr, "[filehandler.c] Failed malloc when preparing the input file\n");
+        free(pathName);
+        return -1;
+    }
+    sprintf(temporaryPathName, "%s.tmp", pathName);
+
+    fd = open(temporaryPathName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        fprintf(stderr, "[filehandler.c] Error when creating the prepared file < %s >:\n\t%s\n", temporaryPathName, strerror(errno));
+        free(pathName);
+        free(temporaryPathName);
+        return -1;
+    }
+    // The points are contiguous, the stride of the dataset read by fileRead is it's dimension
+    size_t matrixSize = sizeof(int64_t) * points->size * points->dimension;
+    if (writeExactly(fd, &header, sizeof(header), 0) != 0
+        || writeExactly(fd, points->values, matrixSize, (off_t) header.offset) != 0
+        || ftruncate(fd, (off_t) (header.offset + matrixSize)) != 0)
+    {
+        fprintf(stderr, "[filehandler.c] Error when writing the prepared file < %s >:\n\t%s\n", temporaryPathName, strerror(errno));
+        possibleError = -1;
+    }
+    close(fd);
+    if (possibleError == 0 && rename(temporaryPathName, pathName) != 0)
+    {
+        fprintf(stderr, "[filehandler.c] Error when renaming the prepared file < %s >:\n\t%s\n", temporaryPathName, strerror(errno));
+        possibleError = -1;
+    }
+    if (possibleError != 0){ remove(temporaryPathName); }
+    free(pathName);
+    free(temporaryPathName);
+    return possibleError;
+}
+
+/**
+ * Opens the binary file to stream it : it's points are not kept in memory, they are read again in chunks with
+ * <fileReadPoints> at each pass over them. Only the nbOfFirstPoints first points, from which the initial centroids
+ * are picked, are read in the dataset of the structure.
+ * 
+ * ATTENTION : The file must be a regular file, it stays opened until <freeFileStruct>.
+ * 
+ * @param theStruct (file_t *) : The structure to initialize.
+ * @param filePathName (const char *) : The pathName to the binary file.
+ * @param nbOfFirstPoints (uint64_t) : The number of first points to read, at most the number of points of the file.
+ * 
+ * @return (int). 0 Upon success else -1.
+ */
+int fileOpenStream(file_t * theStruct, const char * filePathName, uint64_t nbOfFirstPoints)
+{
+    if(theStruct == NULL){ return -1; }
+    theStruct->dataset.values = NULL;
+    theStruct->dataset.size = 0;
+    theStruct->nbOfPoints = 0;
+    theStruct->streamed = true;
+    theStruct->mapping = NULL;
+    theStruct->mappingSize = 0;
+    theStruct->minimum = 0;
+    theStruct->maximum = 0;
+
+    struct stat fileInfo;
+    uint32_t dimension;
+    uint64_t nbOfPoints;
+
+    theStruct->fd = open(filePathName, O_RDONLY);
+    if (theStruct->fd < 0)
+    {
+        fprintf(stderr,"[src/filehandler.c] Error when opening the input file < %s >:\n\t%s\n", filePathName, strerror(errno) );
+        return -1;
+    }
+    if (fstat(theStruct->fd, &fileInfo) != 0 || !S_ISREG(fileInfo.st_mode))
+    {
+        fprintf(stderr,"[src/filehandler.c] The input file < %s > can only be streamed if it is a regular file\n", filePathName);
+        freeFileStruct(theStruct);
+        return -1;
+    }
+    if (readHeader(theStruct->fd, &fileInfo, &dimension, &nbOfPoints) != 0)
+    {
+        freeFileStruct(theStruct);
+        return -1;
+    }
+    theStruct->nbOfPoints = nbOfPoints;
+    posix_fadvise(theStruct->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    nbOfFirstPoints = (nbOfFirstPoints < nbOfPoints) ? nbOfFirstPoints : nbOfPoints;
+    if (dataset_init(&theStruct->dataset, nbOfFirstPoints, dimension) != 0)
+    {
+        fprintf(stderr, "[filehandler.c] Failed malloc when initiating the buffer to hold the first points\n");
+        freeFileStruct(theStruct);
+        return -1;
+    }
+    if (fileReadPoints(theStruct, 0, &theStruct->dataset) != 0)
+    {
+        freeFileStruct(theStruct);
+        return -1;
     }
-    // Close the file
-    fclose(file);
     return 0;
 }
 
 /**
- * Free the content of the file structure, and the content of each point.
+ * Returns the number of points of a chunk of a streamed file, so that a chunk is about FILE_CHUNK_SIZE bytes.
+ * 
+ * @param inputFile (const file_t *) : The streamed file.
+ * 
+ * @return (uint64_t) : The number of points, at least 1.
+ */
+uint64_t fileChunkSize(const file_t * inputFile)
+{
+    uint64_t pointSize = sizeof(int64_t) * (inputFile->dataset.dimension == 0 ? 1 : inputFile->dataset.dimension);
+    return (FILE_CHUNK_SIZE / pointSize == 0) ? 1 : FILE_CHUNK_SIZE / pointSize;
+}
+
+/**
+ * Reads points of a streamed file, in one sequential read, and converts them to the host byte order.
+ * 
+ * @param inputFile (const file_t *) : The streamed file. The file is only read at given offsets, so several threads
+ *                                     can read it at the same time.
+ * @param first (uint64_t) : The index of the first point to read.
+ * @param points (dataset_t *) : The dataset to fill, of the dimension of the file. It's size is the number of points
+ *                               to read.
+ * 
+ * @return (int). 0 Upon success else -1.
+ */
+int fileReadPoints(const file_t * inputFile, uint64_t first, dataset_t * points)
+{
+    uint64_t nbOfValues = points->size * points->dimension;
+    char * destination = (char *) points->values;
+    size_t size = sizeof(int64_t) * nbOfValues;
+    off_t offset = (off_t) (FILE_HEADER_SIZE + sizeof(int64_t) * first * points->dimension);
+    while (size > 0)
+    {
+        ssize_t hasRead = pread(inputFile->fd, destination, size, offset);
+        if (hasRead < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (hasRead <= 0)
+        {
+            fprintf(stderr, "[filehandler.c] Error reading the points of the streamed file\n");
+            return -1;
+        }
+        destination += hasRead;
+        offset += hasRead;
+        size -= (size_t) hasRead;
+    }
+    byteSwapInParallel((const char *) points->values, points->values, nbOfValues, 1, NULL, NULL);
+    return 0;
+}
+
+/**
+ * Writes the content of the clusters like <labels_writeClustersToCSV>, the points being read from a streamed file.
+ * The file is read once per cluster, so that only one chunk of points is held in memory.
+ * 
+ * @param csv (csv_t *) : The writer of the file to write to.
+ * @param labels (const labels_t *) : The labels of the points.
+ * @param inputFile (const file_t *) : The streamed file of the points.
+ * 
+ * @return int 0 Upon Success, else -1.
+ */
+int writeStreamedClustersToCSV(csv_t * csv, const labels_t * labels, const file_t * inputFile)
+{
+    int error = 0;
+    dataset_t chunk;
+    uint64_t chunkSize = fileChunkSize(inputFile);
+    point_t view;
+
+    if (dataset_init(&chunk, chunkSize, inputFile->dataset.dimension) != 0){ return -1; }
+
+    error += csv_putBytes(csv, "\"[", 2);
+    for (uint32_t k = 0; k < labels->K && error == 0; k++)
+    {
+        uint64_t written = 0;
+        error += csv_putBytes(csv, "[", 1);
+        for (uint64_t first = 0; first < inputFile->nbOfPoints && written < labels->counts[k] && error == 0; first += chunkSize)
+        {
+            chunk.size = (inputFile->nbOfPoints - first < chunkSize) ? inputFile->nbOfPoints - first : chunkSize;
+            if (fileReadPoints(inputFile, first, &chunk) != 0)
+            {
+                error = -1;
+                break;
+            }
+            for (uint64_t i = 0; i < chunk.size; i++)
+            {
+                if (labels_get(labels, first + i) != k){ continue; }
+                view = dataset_point(&chunk, i);
+                error += pointToCSV(csv, &view);
+                written++;
+                if (written < labels->counts[k])
+                {
+                    error += csv_putBytes(csv, ", ", 2);
+                }
+            }
+        }
+        error += csv_putBytes(csv, "]", 1);
+        if (k < labels->K-1)
+        {
+            error += csv_putBytes(csv, ", ", 2);
+        }
+    }
+    error += csv_putBytes(csv, "]\"", 2);
+
+    dataset_destroy(&chunk);
+    return error < 0 ? -1 : 0 ;
+}
+
+/**
+ * Free the content of the file structure.
  * 
  * @param (file_t *) : The file structure.
  */
 void freeFileStruct(file_t * inputFile)
 {
-    freeDynamicFileStruct(inputFile, inputFile->nbOfPoints);
+    if (inputFile->mapping != NULL)
+    {
+        munmap(inputFile->mapping, inputFile->mappingSize);
+        inputFile->mapping = NULL;
+        inputFile->dataset.values = NULL;
+    } else {
+        dataset_destroy(&inputFile->dataset);
+    }
+    if (inputFile->streamed && inputFile->fd >= 0)
+    {
+        close(inputFile->fd);
+        inputFile->fd = -1;
+    }
 }
 
 /**
  * Writes the content of a calculation resukt holder to a file in a (CSV) format
  * 
- * @param file (FILE *) : The file to write to
+ * @param csv (csv_t *) : The writer of the file to write to
  * @param holder (calculation_result_holder * ) : The holder of results.
  * @param quiet (bool) : To know if the quiet mode is active.
+ * @param inputFile (const file_t *) : The file of the points that are clustered.
  * 
  * @return int 0 Upon Success, else -1.
  */
-int writeCalculationsHolderToCSV(FILE * file, calculation_result_holder * holder, bool quiet)
+int writeCalculationsHolderToCSV(csv_t * csv, calculation_result_holder * holder, bool quiet, const file_t * inputFile)
 {
     int error = 0;
-    error += arrayOfPoints_writeToFILE(file, holder->initialCentroids, true);
-    error += fprintf(file, ",%lld,", (long long int) holder->distortion_distance ) < 0 ? 0 : -1 ; 
-    error += arrayOfPoints_writeToFILE(file, holder->finalCentroids, true);
+    error += dataset_writeToCSV(csv, holder->initialCentroids, true);
+    error += csv_putBytes(csv, ",", 1);
+    error += csv_putInt64(csv, holder->distortion_distance);
+    error += csv_putBytes(csv, ",", 1);
+    error += dataset_writeToCSV(csv, holder->finalCentroids, true);
     if (quiet == false)
     {
-        error += fprintf(file, ",") < 0 ? 0 : -1 ; 
-        error += arrayOfClusters_toFILE(file, holder->finalClusters);
+        error += csv_putBytes(csv, ",", 1);
+        if (inputFile->streamed)
+        {
+            error += writeStreamedClustersToCSV(csv, holder->finalClusters, inputFile);
+        } else {
+            error += labels_writeClustersToCSV(csv, holder->finalClusters, &inputFile->dataset);
+        }
     }
-    error += fprintf(file, "\n") < 0 ? 0 : -1 ; 
-    return error < 0 ? 0 : -1 ; 
+    error += csv_putBytes(csv, "\n", 1);
+    return error < 0 ? -1 : 0 ; 
 }
 
 /**
@@ -160,34 +789,55 @@ void * writeToCSVFromBuffer(void * argT)
 {
     int possibleError = 0;
     writerThreadArgs_t * args = (writerThreadArgs_t *) argT;
-    calculation_result_holder * holder;
+    // The rows are rendered in the buffer of the thread, written to the file once it's full
+    csv_t csv;
+    possibleError = csv_init(&csv, args->outPutFile);
+    // The results ready are taken at once, a batch at a time
+    calculation_result_holder * holders[CIRCULARBUFFER_BATCH];
+    uint32_t nbOfHolders = 0;
     int toBeUsedInGet = 0;
-    possibleError = circularbuffer_get(args->buff, &toBeUsedInGet, (void **) &holder);
+    if (circularbuffer_getMany(args->buff, &toBeUsedInGet, (void **) holders, CIRCULARBUFFER_BATCH, &nbOfHolders) != 0)
+    {
+        possibleError = -1;
+    }
 
-    while (holder != NULL && possibleError == 0)
+    while (nbOfHolders > 0)
     {
-        possibleError = writeCalculationsHolderToCSV(args->outPutFile, holder, args->quietMode);
+        for (uint32_t i = 0; i < nbOfHolders; i++)
+        {
+            calculation_result_holder * holder = holders[i];
+            if (possibleError == 0)
+            {
+                possibleError = writeCalculationsHolderToCSV(&csv, holder, args->quietMode, args->inputFile);
+            }
 
-        // Free all the resources used in this iteration 
-        arrayOfPoints_destroy(holder->initialCentroids);
-        free(holder->initialCentroids);
+            // Free all the resources used in this iteration 
+            dataset_destroy(holder->initialCentroids);
+            free(holder->initialCentroids);
 
-        arrayOfPoints_destroy(holder->finalCentroids);
-        free(holder->finalCentroids);
-        for (size_t k = 0; k < holder->finalClusters->size; k++)
-        {
-            free( (holder->finalClusters->array + k)->points );
+            dataset_destroy(holder->finalCentroids);
+            free(holder->finalCentroids);
+            if (holder->finalClusters != NULL)
+            {
+                labels_destroy(holder->finalClusters);
+                free(holder->finalClusters);
+            }
+            free(holder);
         }
-        free(holder->finalClusters->array);
-        free(holder->finalClusters);
-        free(holder);
 
         if(possibleError == 0)
         {
-            circularbuffer_get(args->buff, &toBeUsedInGet, (void **) &holder);
+            circularbuffer_getMany(args->buff, &toBeUsedInGet, (void **) holders, CIRCULARBUFFER_BATCH, &nbOfHolders);
         } else {
             fprintf(stderr, "[filehandler.c] An error occured writing to the CSV\n");
+            // The calculating threads stop instead of waiting for room in the buffer
+            circularbuffer_handleError(args->buff, "writeToCSVFromBuffer");
+            nbOfHolders = 0;
         }
     }
+    if (csv_destroy(&csv) != 0 && possibleError == 0)
+    {
+        fprintf(stderr, "[filehandler.c] An error occured writing to the CSV\n");
+    }
     return(NULL);
 }
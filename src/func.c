@@ -3,252 +3,1090 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
-#include <math.h>
+#include <stdbool.h>
 
 #include "point.h"
 #include "distance.h"
 #include "func.h"
 #include "filehandler.h"
-#include "distance.h"
+#include "dataset.h"
+#include "labels.h"
+#include "kernels.h"
+#include "bounds.h"
+#include "elkan.h"
+#include "hamerly.h"
+#include "yinyang.h"
+#include "team.h"
+#include "kdtree.h"
+#include "narrow.h"
 #include "argumentsparser.h"
 
 
 /**
- * These structures are used only once. In this source file.
-*/
-typedef struct {
-    int value;
-    array_of_clusters *clusters;
-}value_and_clusters;
-
-//extern squared_distance_func_t FORMULA_CHOOSED;
-
-/**
- * This function computes the new centroids ( a centroid_t ) from the current cluster_t.
- * @param clusters (array_of_arrays_of_points *) : A list of array_of_arrays_of_points.
- * @param K (uint32_t *) : A pointer, to the variable K.
- * @param DIMENSION (uint32_t *) : A pointer, to the dimension of points.
- * @return (centroid_t *) A pointer to a centroid_t. In case of an error, NULL is returned.
+ * This function computes the new centroids from the sums of the coordinates of the clusters.
+ * @param sums (const dataset_t *) : The sum of the coordinates of the points of each cluster.
+ * @param clusters (const labels_t *) : The labels of the points, with the number of points of each cluster.
+ * @return (dataset_t *) A pointer to the dataset of the K centroids. In case of an error, NULL is returned.
  */
-array_of_centroids * update_centroids(array_of_arrays_of_points* clusters, uint32_t K, uint32_t DIMENSION){
-    
-    array_of_centroids * centroids = (array_of_centroids *) malloc( sizeof(array_of_centroids) );
-    point_t * tempPoint;
-    // Array of points in the cluster_t at index i (from 0 to k-1)
-    array_of_points * cluster_k;
+dataset_t * update_centroids(const dataset_t * sums, const labels_t * clusters){
+    uint32_t K = clusters->K;
+    uint32_t DIMENSION = sums->dimension;
+    dataset_t * centroids = (dataset_t *) malloc( sizeof(dataset_t) );
+    int64_t * tempPoint;
+    int64_t * sum;
 
     if ( centroids == NULL ){ return NULL; } 
 
-    centroids->points = (point_t *) malloc( sizeof(point_t) * K );
-    centroids->size = K;
-
-    if (centroids->points == NULL){ 
+    if ( dataset_init(centroids, K, DIMENSION) != 0 ){ 
         free(centroids);
         return NULL; 
     }
 
     for (uint64_t k = 0; k < K; k++)
     {   
-        tempPoint = centroids->points + k;
-        if ( tempPoint == NULL) {
-            free(centroids->points); 
-            free(centroids);
-            return NULL;
-        }
-        
-        tempPoint->dimension = DIMENSION;
-        tempPoint->values = (int64_t *) calloc(DIMENSION, sizeof(int64_t) );
-        if ( tempPoint->values == NULL) {
-            free(tempPoint);
-            free(centroids->points); 
-            free(centroids);
-            return NULL;
-        }
-        
-        cluster_k = (clusters->array + k); 
-        for( uint64_t j = 0; j < cluster_k->size ; j++ )
-        {   
-            for (uint64_t m = 0; m < DIMENSION; m++){
-                *(tempPoint->values + m) = *(tempPoint->values + m) + *((cluster_k->points+j)->values+m);
-            }
-        }
-
+        tempPoint = dataset_row(centroids, k);
+        sum = dataset_row(sums, k);
         for (uint64_t n = 0; n < DIMENSION; n++){
-            if (cluster_k->size != 0)
-            {
-                *(tempPoint->values + n) = (int64_t) (*(tempPoint->values + n) / (cluster_k->size));
-            }
+            // The centroid of an empty cluster is the origin
+            tempPoint[n] = (clusters->counts[k] == 0) ? 0 : (int64_t) (sum[n] / (int64_t) (clusters->counts[k]));
         }
     }
 
     return centroids;
 }
 
+/**
+ * Brings the sums of the coordinates of the clusters up to date after an assignment. Only the points that have
+ * changed of cluster are moved from one sum to another, unless there are too many of them or the sums have never
+ * been computed : then all the points are summed in one sequential pass.
+ *
+ * The sums are computed modulo 2^64, so they are the same whatever the order of the additions and subtractions.
+ *
+ * @param sums (dataset_t *) : The sums of the K clusters.
+ * @param points (const dataset_t *) : The points.
+ * @param clusters (const labels_t *) : The labels of the points, after the assignment.
+ * @param moves (const moves_t *) : The points that have changed of cluster during the assignment.
+ * @param complete (bool) : true if all the points have to be summed.
+ * @param kernels (const lloyd_kernels_t *) : The loops selected for the formula and the dimension.
+ */
+void update_sums(dataset_t * sums, const dataset_t * points, const labels_t * clusters, const moves_t * moves,
+                 bool complete, const lloyd_kernels_t * kernels)
+{
+    if (sums->values == NULL){ return; }
+    if (complete || moves->overflow)
+    {
+        memset(sums->values, 0, sizeof(int64_t) * sums->size * sums->dimension);
+        kernels->accumulate(sums->values, points, clusters, 0, points->size);
+    } else {
+        kernels->move(sums->values, points, clusters, moves);
+    }
+}
+
 /**
  * Assign vectors to centroids.
  *
- * @param centroids(array_of_centroids *) : The array of centroids.
- * @param cluster (array_of_clusters *) : The current clusters.
- * @param K (uint32_T) : The number of clusters.
- * @param DIMENSION (uint32_t) : The dimension of points.
+ * @param centroids(const dataset_t *) : The centroids.
+ * @param points (const dataset_t *) : The points.
+ * @param clusters (labels_t *) : The current labels of the points, they are replaced by the new ones and the counts are updated.
+ * @param moves (moves_t *) : The list where the points that change of cluster are recorded.
+ * @param distortion (uint64_t *) : Set to the sum of the squared distances of the points to their closest centroid.
+ * @param kernels (const lloyd_kernels_t *) : The loops selected for the formula and the dimension.
  * 
- * @return (value_and_clusters *) : The result of the holding a signal to tel if the clusters has changed and the new clusters.
- *          In case of an error NULL.
+ * @return (int) : 1 if a point has changed of cluster, else 0.
  */
-value_and_clusters *  assign_vectors_to_centroids( 
-                                                    array_of_centroids * centroids, array_of_clusters * clusters,
-                                                    uint32_t K, uint32_t DIMENSION
-                                                 )
+int assign_vectors_to_centroids(const dataset_t * centroids, const dataset_t * points, labels_t * clusters,
+                                moves_t * moves, uint64_t * distortion, const lloyd_kernels_t * kernels)
 {
-    int unchanged = 1; //1 is True and 0 is False
-    array_of_clusters * new_clusters;
-    array_of_points * cluster_in_clusters_at_idx;
-    cluster_t * current_cluster_in_new_clusters;
-    point_t * pointInClustersArray;
-    uint64_t closest_centroid_idx;
-    uint64_t closest_centroid_distance;
-    point_t * pointInCentroids;
-    int64_t distance;
+    memset(clusters->counts, 0, sizeof(uint64_t) * clusters->K);
+    *distortion = 0;
+    return kernels->assign(centroids, points, clusters, moves, distortion, 0, points->size);
+}
 
-    value_and_clusters * toHoldResult = (value_and_clusters *) malloc( sizeof(value_and_clusters) );
+/**
+ * Like <assign_vectors_to_centroids>, on the narrow copy of the points.
+ *
+ * @param centroids (const narrow_t *) : The centroids, narrowed like the points.
+ * @param points (const narrow_t *) : The narrow points.
+ * @param clusters (labels_t *) : The current labels of the points, they are replaced by the new ones and the counts are updated.
+ * @param moves (moves_t *) : The list where the points that change of cluster are recorded.
+ * @param distortion (uint64_t *) : Set to the sum of the squared distances of the points to their closest centroid.
+ * @param kernels (const narrow_kernels_t *) : The loops selected for the formula and the layout of the points.
+ *
+ * @return (int) : 1 if a point has changed of cluster, else 0.
+ */
+static int assign_narrow_vectors_to_centroids(const narrow_t * centroids, const narrow_t * points, labels_t * clusters,
+                                              moves_t * moves, uint64_t * distortion, const narrow_kernels_t * kernels)
+{
+    memset(clusters->counts, 0, sizeof(uint64_t) * clusters->K);
+    *distortion = 0;
+    return kernels->assign(centroids, points, clusters, moves, distortion, 0, points->size);
+}
 
-    if (toHoldResult == NULL ){ return NULL; }
+/**
+ * Like <update_sums>, from the narrow copy of the points.
+ */
+static void update_narrow_sums(dataset_t * sums, const narrow_t * points, const labels_t * clusters,
+                               const moves_t * moves, bool complete, const narrow_kernels_t * kernels)
+{
+    if (sums->values == NULL){ return; }
+    if (complete || moves->overflow)
+    {
+        memset(sums->values, 0, sizeof(int64_t) * sums->size * sums->dimension);
+        kernels->accumulate(sums->values, points, clusters, 0, points->size);
+    } else {
+        kernels->move(sums->values, points, clusters, moves);
+    }
+}
 
-    new_clusters = (array_of_clusters *) malloc( sizeof(array_of_clusters));
+/**
+ * An assignment keeping a state between the iterations of a run.
+ *
+ * @param create (function) : Allocates the state for the points and K centroids, returns NULL in case of an error.
+ * @param assign (function) : Assigns the points to their closest centroid, updates the counts and records the moves,
+ *                            returns 1 if a point has changed of cluster, 0 if not and -1 in case of an error.
+ * @param destroy (function) : Frees the state.
+ */
+typedef struct {
+    void * (*create) (const dataset_t * points, uint32_t K);
+    int (*assign) (void * state, const dataset_t * centroids, const dataset_t * points, labels_t * clusters,
+                   moves_t * moves, const lloyd_kernels_t * kernels);
+    void (*destroy) (void * state);
+} assignment_t;
 
-    if (new_clusters == NULL)
+// The accelerated assignments, indexed by kmeans_algorithm_t
+static const assignment_t ASSIGNMENTS[] = {
+    [KMEANS_ELKAN] = { elkan_create, elkan_assign, elkan_destroy },
+    [KMEANS_HAMERLY] = { hamerly_create, hamerly_assign, hamerly_destroy },
+    [KMEANS_YINYANG] = { yinyang_create, yinyang_assign, yinyang_destroy },
+};
+
+
+/**
+ * What one member of a team computes during an iteration of Lloyd, on it's own contiguous part of the points. It is
+ * aligned on a cache line, like it's counts and sums, so the members never write in the same line.
+ *
+ * @param labels (labels_t) : The labels of all the points (the array is shared, each member only writes it's part),
+ *                            with the counts of the part of the member.
+ * @param moves (moves_t) : The points of the part that have changed of cluster.
+ * @param sums (int64_t *) : The K * dimension partial sums of the part.
+ * @param distortion (uint64_t) : The sum of the squared distances of the points of the part to their closest centroid.
+ * @param changed (int) : 1 if a point of the part has changed of cluster, else 0.
+ */
+typedef struct {
+    labels_t labels;
+    moves_t moves;
+    int64_t * sums;
+    uint64_t distortion;
+    int changed;
+} __attribute__((aligned(TEAM_CACHE_LINE))) lloyd_member_t;
+
+/**
+ * The iteration of Lloyd shared by the members of a team.
+ *
+ * @param centroids (const dataset_t *) : The centroids of the iteration.
+ * @param points (const dataset_t *) : The points.
+ * @param clusters (labels_t *) : The labels of the points.
+ * @param complete (bool) : true if the partial sums are computed from all the points of the parts, false if only from
+ *                          their moves.
+ * @param kernels (const lloyd_kernels_t *) : The loops selected for the formula and the dimension.
+ * @param narrowPoints (const narrow_t *) : The narrow copy of the points, NULL if there is none.
+ * @param narrowCentroids (const narrow_t *) : The centroids of the iteration narrowed like the points, NULL if they
+ *                                             could not be.
+ * @param narrowKernels (const narrow_kernels_t *) : The loops selected for the narrow points.
+ * @param candidates (const candidates_t *) : The distances to the candidates, NULL if there are none.
+ * @param columns (const uint32_t *) : The columns of the centroids of the iteration in the distances to the
+ *                                     candidates, NULL if the distances are computed.
+ * @param members (lloyd_member_t *) : The nbOfMembers members.
+ * @param nbOfMembers (uint32_t) : The number of members working on the run.
+ */
+typedef struct {
+    const dataset_t * centroids;
+    const dataset_t * points;
+    labels_t * clusters;
+    bool complete;
+    const lloyd_kernels_t * kernels;
+    const narrow_t * narrowPoints;
+    const narrow_t * narrowCentroids;
+    const narrow_kernels_t * narrowKernels;
+    const candidates_t * candidates;
+    const uint32_t * columns;
+    lloyd_member_t * members;
+    uint32_t nbOfMembers;
+} lloyd_team_t;
+
+/**
+ * Frees the members of a team allocated by <lloyd_team_init>.
+ */
+static void lloyd_team_destroy(lloyd_team_t * lloyd)
+{
+    if (lloyd->members == NULL){ return; }
+    for (uint32_t t = 0; t < lloyd->nbOfMembers; t++)
+    {
+        free(lloyd->members[t].labels.counts);
+        moves_destroy(&lloyd->members[t].moves);
+    }
+    free(lloyd->members);
+    lloyd->members = NULL;
+}
+
+/**
+ * Allocates the members of a team for a run of Lloyd. The counts and the sums of a member are allocated in one block
+ * aligned and padded on a cache line.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+static int lloyd_team_init(lloyd_team_t * lloyd, uint32_t nbOfMembers, const dataset_t * points, labels_t * clusters,
+                           const lloyd_kernels_t * kernels, const narrow_t * narrowPoints,
+                           const narrow_kernels_t * narrowKernels, const candidates_t * candidates)
+{
+    uint64_t K = clusters->K;
+    size_t bytes = sizeof(uint64_t) * K + sizeof(int64_t) * K * points->dimension;
+    bytes = (bytes + TEAM_CACHE_LINE - 1) / TEAM_CACHE_LINE * TEAM_CACHE_LINE;
+
+    lloyd->points = points;
+    lloyd->clusters = clusters;
+    lloyd->kernels = kernels;
+    lloyd->narrowPoints = narrowPoints;
+    lloyd->narrowCentroids = NULL;
+    lloyd->narrowKernels = narrowKernels;
+    lloyd->candidates = candidates;
+    lloyd->columns = NULL;
+    lloyd->nbOfMembers = nbOfMembers;
+    if (posix_memalign((void **) &lloyd->members, TEAM_CACHE_LINE, sizeof(lloyd_member_t) * nbOfMembers) != 0)
     {
-        free(toHoldResult);
-        return NULL;
+        lloyd->members = NULL;
+        return -1;
     }
+    memset(lloyd->members, 0, sizeof(lloyd_member_t) * nbOfMembers);
 
-    new_clusters->size = K;
-    new_clusters->array = (array_of_points *) malloc( sizeof(array_of_points) * K);
+    int possibleError = 0;
+    for (uint32_t t = 0; t < nbOfMembers; t++)
+    {
+        lloyd_member_t * member = &lloyd->members[t];
+        void * block;
+        uint64_t size = team_begin(points->size, t + 1, nbOfMembers) - team_begin(points->size, t, nbOfMembers);
+        member->labels = *clusters;
+        member->labels.counts = (posix_memalign(&block, TEAM_CACHE_LINE, bytes) == 0) ? (uint64_t *) block : NULL;
+        if (member->labels.counts == NULL || moves_init(&member->moves, size / 4) != 0)
+        {
+            possibleError = -1;
+            continue;
+        }
+        member->sums = (int64_t *) (member->labels.counts + K);
+    }
+    if (possibleError != 0){ lloyd_team_destroy(lloyd); }
+    return possibleError;
+}
 
-    if (new_clusters->array == NULL)
+/**
+ * The assignment of the part of a member, with the counts of the part.
+ */
+static void lloyd_assignJob(void * arg, uint32_t t, uint32_t nbOfMembers)
+{
+    lloyd_team_t * lloyd = (lloyd_team_t *) arg;
+    lloyd_member_t * member = &lloyd->members[t];
+    memset(member->labels.counts, 0, sizeof(uint64_t) * lloyd->clusters->K);
+    moves_clear(&member->moves);
+    member->distortion = 0;
+    uint64_t begin = team_begin(lloyd->points->size, t, nbOfMembers);
+    uint64_t end = team_begin(lloyd->points->size, t + 1, nbOfMembers);
+    if (lloyd->columns != NULL)
     {
-        free(toHoldResult);
-        free(new_clusters);
-        return NULL;
+        member->changed = candidates_assign(lloyd->candidates, lloyd->columns, lloyd->clusters->K, &member->labels,
+                                            &member->moves, &member->distortion, begin, end);
+    } else if (lloyd->narrowCentroids != NULL) {
+        member->changed = lloyd->narrowKernels->assign(lloyd->narrowCentroids, lloyd->narrowPoints, &member->labels,
+                                                       &member->moves, &member->distortion, begin, end);
+    } else {
+        member->changed = lloyd->kernels->assign(lloyd->centroids, lloyd->points, &member->labels, &member->moves,
+                                                 &member->distortion, begin, end);
     }
+}
 
-    // Initiliasing the clusters with the maximum 
-    for (size_t currentClusterIdx = 0; currentClusterIdx < K; currentClusterIdx++)
-    {   
-        arrayOfPoints_init((new_clusters->array + currentClusterIdx ), 0);
-    }
-    
-    for ( uint32_t current_centroid_idx = 0; current_centroid_idx < K; current_centroid_idx++){ // Ask: K is uint32t while current... is uint64_t
-
-        cluster_in_clusters_at_idx = clusters->array + current_centroid_idx;
-        
-        for (uint64_t i = 0; i < cluster_in_clusters_at_idx->size; i++){
-            // Equivalent of vector in the Python code
-            pointInClustersArray = cluster_in_clusters_at_idx->points + i;
-            pointInClustersArray->dimension = DIMENSION;
-            closest_centroid_idx = 0;
-            closest_centroid_distance = (int64_t) INFINITY;
-
-            // Here I am going to find the closest centroid for the given "pointInClustersArray" 
-            for (uint64_t centroid_idx = 0; centroid_idx < (centroids->size); centroid_idx++){
-                
-                pointInCentroids = centroids->points + centroid_idx;
-                distance = FORMULA_CHOOSED(pointInClustersArray, pointInCentroids);
-
-                if (distance < closest_centroid_distance){
-                    closest_centroid_idx = centroid_idx;
-                    closest_centroid_distance = distance;
+/**
+ * The partial sums of the part of a member : of all it's points if the iteration is complete, else the difference
+ * made by it's moves.
+ */
+static void lloyd_sumsJob(void * arg, uint32_t t, uint32_t nbOfMembers)
+{
+    lloyd_team_t * lloyd = (lloyd_team_t *) arg;
+    lloyd_member_t * member = &lloyd->members[t];
+    memset(member->sums, 0, sizeof(int64_t) * lloyd->clusters->K * lloyd->points->dimension);
+    if (lloyd->narrowPoints != NULL && lloyd->complete)
+    {
+        lloyd->narrowKernels->accumulate(member->sums, lloyd->narrowPoints, lloyd->clusters,
+                                         team_begin(lloyd->points->size, t, nbOfMembers),
+                                         team_begin(lloyd->points->size, t + 1, nbOfMembers));
+    } else if (lloyd->narrowPoints != NULL) {
+        lloyd->narrowKernels->move(member->sums, lloyd->narrowPoints, lloyd->clusters, &member->moves);
+    } else if (lloyd->complete) {
+        lloyd->kernels->accumulate(member->sums, lloyd->points, lloyd->clusters,
+                                   team_begin(lloyd->points->size, t, nbOfMembers),
+                                   team_begin(lloyd->points->size, t + 1, nbOfMembers));
+    } else {
+        lloyd->kernels->move(member->sums, lloyd->points, lloyd->clusters, &member->moves);
+    }
+}
+
+/**
+ * Does the assignment and the update of the sums of an iteration of Lloyd with a team, each member on it's own part
+ * of the points. The counts and the partial sums of the members are then added in the order of the members, the
+ * result is the same as the one of <assign_vectors_to_centroids> followed by <update_sums>.
+ *
+ * @param team (team_t *) : The team.
+ * @param lloyd (lloyd_team_t *) : The members, initialized by <lloyd_team_init>.
+ * @param centroids (const dataset_t *) : The centroids.
+ * @param narrowCentroids (const narrow_t *) : The centroids narrowed like the points, NULL if they could not be.
+ * @param columns (const uint32_t *) : The columns of the centroids in the distances to the candidates, NULL to
+ *                                     compute the distances.
+ * @param sums (dataset_t *) : The sums of the K clusters.
+ * @param distortion (uint64_t *) : Set to the sum of the squared distances of the points to their closest centroid.
+ * @param complete (bool) : true if all the points have to be summed.
+ *
+ * @return (int) : 1 if a point has changed of cluster, else 0.
+ */
+static int lloyd_team_iterate(team_t * team, lloyd_team_t * lloyd, const dataset_t * centroids,
+                              const narrow_t * narrowCentroids, const uint32_t * columns, dataset_t * sums,
+                              uint64_t * distortion, bool complete)
+{
+    uint32_t K = lloyd->clusters->K;
+    uint64_t length = (uint64_t) K * sums->dimension;
+    int changed = 0;
+
+    lloyd->centroids = centroids;
+    lloyd->narrowCentroids = narrowCentroids;
+    lloyd->columns = columns;
+    team_run(team, lloyd->nbOfMembers, lloyd_assignJob, lloyd);
+
+    memset(lloyd->clusters->counts, 0, sizeof(uint64_t) * K);
+    *distortion = 0;
+    for (uint32_t t = 0; t < lloyd->nbOfMembers; t++)
+    {
+        lloyd_member_t * member = &lloyd->members[t];
+        changed |= member->changed;
+        *distortion += member->distortion;
+        complete = complete || member->moves.overflow;
+        for (uint32_t k = 0; k < K; k++){ lloyd->clusters->counts[k] += member->labels.counts[k]; }
+    }
+
+    lloyd->complete = complete;
+    team_run(team, lloyd->nbOfMembers, lloyd_sumsJob, lloyd);
+
+    // The sums are modulo 2^64, the order of the additions does not change them
+    uint64_t * values = (uint64_t *) sums->values;
+    if (complete){ memset(values, 0, sizeof(uint64_t) * length); }
+    for (uint32_t t = 0; t < lloyd->nbOfMembers; t++)
+    {
+        const uint64_t * partial = (const uint64_t *) lloyd->members[t].sums;
+        for (uint64_t j = 0; j < length; j++){ values[j] += partial[j]; }
+    }
+    return changed;
+}
+
+/**
+ * The state of the filtering algorithm of Kanungo et al. during one pass over a kd-tree. The points of a node are
+ * only given to the centroids that may be the closest to one of them (the candidates) : when one candidate is left,
+ * all the points of the node are given to it at once, with the sums of the node.
+ *
+ * @param tree (const kdtree_t *) : The kd-tree of the points.
+ * @param centroids (const dataset_t *) : The centroids.
+ * @param sums (uint64_t *) : The sums of the K clusters, modulo 2^64.
+ * @param clusters (labels_t *) : The counts of the clusters.
+ * @param labeling (bool) : true if the labels of the points are set too, else only the sums and the counts are.
+ * @param candidates (uint32_t *) : depth * K indexes, the candidates of each level of the tree (temporary).
+ * @param middle (int64_t *) : The middle of the box of a node (temporary).
+ * @param euclidean (bool) : true for the euclidean formula, false for the manhattan one.
+ * @param kernels (const lloyd_kernels_t *) : The loops selected for the formula and the dimension.
+ */
+typedef struct {
+    const kdtree_t * tree;
+    const dataset_t * centroids;
+    uint64_t * sums;
+    labels_t * clusters;
+    bool labeling;
+    uint32_t * candidates;
+    int64_t * middle;
+    bool euclidean;
+    const lloyd_kernels_t * kernels;
+} filtering_t;
+
+/**
+ * Returns true if the centroid is strictly farther than the candidate from all the points of the box. The
+ * difference between the distances to both is a sum of one term per coordinate, each one monotonous : the smallest
+ * difference is reached at a corner, found one side at a time.
+ *
+ * The box holds points and both centroids are in the box of the points and the origin, so when <bounds_areExact>
+ * holds all the terms and their sum fit in an int64_t.
+ */
+static bool filtering_isFarther(const int64_t * centroid, const int64_t * candidate, const int64_t * lower,
+                                const int64_t * upper, uint32_t dimension, bool euclidean)
+{
+    uint64_t difference = 0;
+    for (uint32_t m = 0; m < dimension; m++)
+    {
+        if (centroid[m] == candidate[m]){ continue; }
+        int64_t ends[2] = { lower[m], upper[m] };
+        int64_t smallest = INT64_MAX;
+        for (int e = 0; e < 2; e++)
+        {
+            int64_t toCentroid = (int64_t) ((uint64_t) ends[e] - (uint64_t) centroid[m]);
+            int64_t toCandidate = (int64_t) ((uint64_t) ends[e] - (uint64_t) candidate[m]);
+            int64_t term;
+            if (euclidean)
+            {
+                term = toCentroid * toCentroid - toCandidate * toCandidate;
+            } else {
+                term = (toCentroid < 0 ? -toCentroid : toCentroid) - (toCandidate < 0 ? -toCandidate : toCandidate);
+            }
+            smallest = (term < smallest) ? term : smallest;
+        }
+        difference += (uint64_t) smallest;
+    }
+    return (int64_t) difference > 0;
+}
+
+/**
+ * Gives all the points of a node to one centroid.
+ */
+static void filtering_give(filtering_t * filtering, uint64_t index, uint32_t k)
+{
+    const kdtree_t * tree = filtering->tree;
+    const kdtree_node_t * node = &tree->nodes[index];
+    uint32_t dimension = tree->points->dimension;
+    uint64_t * sum = filtering->sums + (uint64_t) k * dimension;
+    const uint64_t * nodeSum = (const uint64_t *) tree->sums + index * dimension;
+
+    for (uint32_t m = 0; m < dimension; m++){ sum[m] += nodeSum[m]; }
+    filtering->clusters->counts[k] += node->end - node->begin;
+    if (filtering->labeling)
+    {
+        for (uint64_t position = node->begin; position < node->end; position++)
+        {
+            labels_set(filtering->clusters, tree->order[position], k);
+        }
+    }
+}
+
+/**
+ * Gives the points of a node to their closest centroid, among the candidates of the node.
+ *
+ * @param filtering (filtering_t *) : The pass.
+ * @param index (uint64_t) : The index of the node.
+ * @param candidates (const uint32_t *) : The candidates, in increasing order so the first one wins a tie.
+ * @param nbOfCandidates (uint32_t) : The number of candidates.
+ * @param level (uint32_t) : The level of the node.
+ */
+static void filtering_visit(filtering_t * filtering, uint64_t index, const uint32_t * candidates,
+                            uint32_t nbOfCandidates, uint32_t level)
+{
+    const kdtree_t * tree = filtering->tree;
+    const kdtree_node_t * node = &tree->nodes[index];
+    const dataset_t * centroids = filtering->centroids;
+    uint32_t dimension = tree->points->dimension;
+
+    if (nbOfCandidates == 1)
+    {
+        filtering_give(filtering, index, candidates[0]);
+        return;
+    }
+    if (kdtree_isLeaf(node))
+    {
+        for (uint64_t position = node->begin; position < node->end; position++)
+        {
+            uint64_t i = tree->order[position];
+            const int64_t * vector = dataset_row(tree->points, i);
+            uint32_t closest = candidates[0];
+            int64_t closestDistance = filtering->kernels->distance(vector, dataset_row(centroids, closest), dimension);
+            for (uint32_t c = 1; c < nbOfCandidates; c++)
+            {
+                int64_t distance = filtering->kernels->distance(vector, dataset_row(centroids, candidates[c]), dimension);
+                if (distance < closestDistance)
+                {
+                    closest = candidates[c];
+                    closestDistance = distance;
                 }
             }
+            uint64_t * sum = filtering->sums + (uint64_t) closest * dimension;
+            for (uint32_t m = 0; m < dimension; m++){ sum[m] += (uint64_t) vector[m]; }
+            filtering->clusters->counts[closest]++;
+            if (filtering->labeling){ labels_set(filtering->clusters, i, closest); }
+        }
+        return;
+    }
+
+    // The candidate closest to the middle of the box is compared to all the others
+    const int64_t * lower = tree->lower + index * dimension;
+    const int64_t * upper = tree->upper + index * dimension;
+    for (uint32_t m = 0; m < dimension; m++)
+    {
+        filtering->middle[m] = (int64_t) ((uint64_t) lower[m] + ((uint64_t) upper[m] - (uint64_t) lower[m]) / 2);
+    }
+    uint32_t best = candidates[0];
+    int64_t bestDistance = filtering->kernels->distance(filtering->middle, dataset_row(centroids, best), dimension);
+    for (uint32_t c = 1; c < nbOfCandidates; c++)
+    {
+        int64_t distance = filtering->kernels->distance(filtering->middle, dataset_row(centroids, candidates[c]), dimension);
+        if (distance < bestDistance)
+        {
+            best = candidates[c];
+            bestDistance = distance;
+        }
+    }
+
+    uint32_t * kept = filtering->candidates + (uint64_t) (level + 1) * centroids->size;
+    uint32_t nbOfKept = 0;
+    for (uint32_t c = 0; c < nbOfCandidates; c++)
+    {
+        if (candidates[c] == best || !filtering_isFarther(dataset_row(centroids, candidates[c]),
+                                                          dataset_row(centroids, best), lower, upper, dimension,
+                                                          filtering->euclidean))
+        {
+            kept[nbOfKept++] = candidates[c];
+        }
+    }
+    if (nbOfKept == 1)
+    {
+        filtering_give(filtering, index, best);
+        return;
+    }
+    filtering_visit(filtering, node->left, kept, nbOfKept, level + 1);
+    filtering_visit(filtering, node->right, kept, nbOfKept, level + 1);
+}
+
+/**
+ * Does one pass of the filtering algorithm : computes the sums and the counts of the clusters of the points
+ * assigned to their closest centroid, and their labels if asked.
+ */
+static void filtering_pass(filtering_t * filtering, const dataset_t * centroids, dataset_t * sums, bool labeling)
+{
+    uint32_t K = filtering->clusters->K;
+    filtering->centroids = centroids;
+    filtering->labeling = labeling;
+    memset(sums->values, 0, sizeof(int64_t) * sums->size * sums->stride);
+    memset(filtering->clusters->counts, 0, sizeof(uint64_t) * K);
+    for (uint32_t k = 0; k < K; k++){ filtering->candidates[k] = k; }
+    filtering_visit(filtering, 0, filtering->candidates, K, 0);
+}
 
-            // Append point to the corresponding new cluster
-            current_cluster_in_new_clusters = (new_clusters->array + closest_centroid_idx);
-            void * tempHolder;
-            arrayOfPoints_append(current_cluster_in_new_clusters, pointInClustersArray, & tempHolder);
-        
-            unchanged = (unchanged && closest_centroid_idx == current_centroid_idx);
+/**
+ * Returns true if both sets of centroids are the same.
+ */
+static bool centroids_areEqual(const dataset_t * a, const dataset_t * b)
+{
+    for (uint64_t k = 0; k < a->size; k++)
+    {
+        if (memcmp(dataset_row(a, k), dataset_row(b, k), sizeof(int64_t) * a->dimension) != 0){ return false; }
+    }
+    return true;
+}
+
+/**
+ * Computes the same clusters as <k_means> with the filtering algorithm of Kanungo et al. : an iteration visits the
+ * nodes of the kd-tree of the points instead of the points.
+ *
+ * Without the labels, the iterations stop when the centroids do not change anymore. With Lloyd's, they would stop
+ * at this iteration or at the next one, with the same centroids and labels : at the next one if a label given by the
+ * centroids before differs from the one given by the last centroids. The labels are set by a last pass with the
+ * centroids before, then by an assignment to the last ones which tells which, so the run counts the iterations of
+ * Lloyd's. The first iteration is the exception : Lloyd's stops when all the points stay in the first cluster.
+ *
+ * @param ptr (list_of_centroids_and_clusters_only * ) : Holds the result.
+ * @param initial_centroids (dataset_t *) : Inititial K centroids.
+ * @param K (uint32_k) : The number of clusters wanted.
+ * @param tree (const kdtree_t *) : The kd-tree of the points.
+ * @param kernels (const lloyd_kernels_t *) : The loops selected for the formula and the dimension.
+ *
+ * @return 0 upon successful completition else -1.
+ */
+static int k_means_filtering(list_of_centroids_and_clusters_only * ptr, dataset_t * initial_centroids, uint32_t K,
+                             const kdtree_t * tree, const lloyd_kernels_t * kernels)
+{
+    const dataset_t * points = tree->points;
+    dataset_t * finalCentroids = initial_centroids;
+    dataset_t * newCentroids;
+    dataset_t sums;
+    labels_t * clusters = (labels_t *) malloc( sizeof(labels_t) );
+    filtering_t filtering = { tree, NULL, NULL, clusters, false, NULL, NULL, FORMULA_CHOOSED == squared_euclidean_distance, kernels };
+
+    filtering.candidates = (uint32_t *) malloc( sizeof(uint32_t) * K * (tree->depth + 1) );
+    filtering.middle = (int64_t *) malloc( sizeof(int64_t) * (points->dimension == 0 ? 1 : points->dimension) );
+    if (clusters != NULL && labels_init(clusters, points->size, K) != 0)
+    {
+        free(clusters);
+        clusters = NULL;
+    }
+    if (clusters == NULL || filtering.candidates == NULL || filtering.middle == NULL || dataset_init(&sums, K, points->dimension) != 0)
+    {
+        fprintf(stderr, "[func.c] Failed malloc when initiating the filtering in kmeans\n");
+        if (clusters != NULL){ labels_destroy(clusters); }
+        free(clusters);
+        free(filtering.candidates);
+        free(filtering.middle);
+        return -1;
+    }
+    filtering.clusters = clusters;
+    filtering.sums = (uint64_t *) sums.values;
+
+    int nbOfIterations = 0;
+    bool stop = false;
+    // The centroids of the iteration before, kept to count the iterations like Lloyd's
+    dataset_t * previousCentroids = NULL;
+    // Without capacity, the last assignment only tells if a label changes
+    moves_t moves = { NULL, NULL, 0, 0, false };
+    int changed = 0;
+    uint64_t distortion = 0;
+    while (!stop)
+    {
+        filtering_pass(&filtering, finalCentroids, &sums, false);
+        newCentroids = update_centroids(&sums, clusters);
+        if (newCentroids == NULL)
+        {
+            fprintf(stderr, "[func.c] An error occured when updating the centroids\n");
+            break;
+        }
+        if (nbOfIterations == 0)
+        {
+            stop = clusters->counts[0] == points->size;
+        } else {
+            stop = centroids_areEqual(newCentroids, finalCentroids);
         }
+        if (stop && nbOfIterations > 0)
+        {
+            // The labels given by the centroids before, then by the last ones : if a label changes, Lloyd's does one
+            // more iteration, on the same centroids
+            filtering_pass(&filtering, previousCentroids, &sums, true);
+            memset(clusters->counts, 0, sizeof(uint64_t) * K);
+            changed = kernels->assign(finalCentroids, points, clusters, &moves, &distortion, 0, points->size);
+        } else if (stop) {
+            filtering_pass(&filtering, finalCentroids, &sums, true);
+        }
+        if (nbOfIterations > 1)
+        {   // If the iteration is equal to one that means previousCentroids points to initial centroids.
+            dataset_destroy(previousCentroids);
+            free(previousCentroids);
+        }
+        previousCentroids = finalCentroids;
+        finalCentroids = newCentroids;
+        nbOfIterations++;
+    }
+    dataset_destroy(&sums);
+    free(filtering.candidates);
+    free(filtering.middle);
+    if (nbOfIterations > 1)
+    {
+        dataset_destroy(previousCentroids);
+        free(previousCentroids);
+    }
+    if (!stop)
+    {
+        if (nbOfIterations > 0)
+        {
+            dataset_destroy(finalCentroids);
+            free(finalCentroids);
+        }
+        labels_destroy(clusters);
+        free(clusters);
+        return -1;
     }
 
-    toHoldResult->value = (unchanged == 1) ? 0 : 1;
-    toHoldResult->clusters = new_clusters;
-    return toHoldResult;
+    // The points of a node are given at once, their distances are only computed by the last assignment
+    if (nbOfIterations > 1)
+    {
+        ptr->distortion = (int64_t) distortion;
+    } else {
+        ptr->distortion = kernels->distortion(finalCentroids, tree->points, clusters, 0, tree->points->size);
+    }
+    ptr->iterations = (uint64_t) nbOfIterations + (changed > 0);
+    ptr->finalCentroids = finalCentroids;
+    ptr->finalClusters = clusters;
+    return 0;
 }
 
 /**
  * Creates clusters according to the initial centroids given.
  *  
  * @param resultHolder (list_of_centroids_and_clusters_only * ) : Holds the result.
- * @param initial_centroids (array_of_centroids *) : Inititial array of K centroids.
+ * @param initial_centroids (dataset_t *) : Inititial K centroids.
  * @param K (uint32_k) : The number of clusters wanted.
- * @param inputFile (file_t *) : The structure containing the input file data.
+ * @param points (const dataset_t *) : The points to cluster.
+ * @param algorithm (kmeans_algorithm_t) : The algorithm of the assignment. The accelerated ones fall back on the one
+ *                                         of Lloyd when the coordinates are too large for the bounds.
+ * @param team (team_t *) : The team sharing the iterations of Lloyd, NULL to run alone. The accelerated assignments
+ *                          are run by the calling thread only.
+ * @param tree (const kdtree_t *) : The kd-tree of the points, used by KMEANS_KDTREE, may be NULL.
+ * @param narrowPoints (const narrow_t *) : The narrow copy of the points, used by the iterations of Lloyd whose
+ *                                         centroids can be narrowed like them, may be NULL.
+ * @param candidates (const candidates_t *) : The distances between the points and the candidates to the initial
+ *                                           centroids, may be NULL. The first assignment of Lloyd reads them when
+ *                                           the initial centroids are candidates.
+ * @param memo (memo_t *) : The trajectories of the runs already finished, may be NULL. A run meeting centroids of one
+ *                          of them, with labels that change, takes it's final centroids and stops after assigning the
+ *                          points to them, then adds it's own trajectory. It counts the iterations it would have done.
  * 
  * @return 0 upon successful completition else -1.
  */
 int k_means(list_of_centroids_and_clusters_only * ptr,
-    array_of_centroids * initial_centroids, uint32_t K, file_t * inputFile)
+    dataset_t * initial_centroids, uint32_t K, const dataset_t * points, kmeans_algorithm_t algorithm, team_t * team,
+    const kdtree_t * tree, const narrow_t * narrowPoints, const candidates_t * candidates, memo_t * memo)
 {
-    value_and_clusters * holdsResult;
-    array_of_clusters * clusters;
+    labels_t * clusters;
     int nbOfIterations = 0; 
-    // Creates an new array of points for the finalCentroids to return 
-    array_of_centroids * finalCentroids = initial_centroids;
+    dataset_t * finalCentroids = initial_centroids;
+    dataset_t * newCentroids;
+    // The loops are chosen once for the whole run
+    const lloyd_kernels_t * kernels = kernels_select(FORMULA_CHOOSED, points->dimension);
+    const assignment_t * assignment = NULL;
+    void * state = NULL;
+    // The sum of the squared distances measured by the last assignment of Lloyd
+    uint64_t distortion = 0;
+    // The centroids of each iteration are narrowed like the points, when they fit
+    narrow_t narrowCentroids = { .values = NULL };
+    const narrow_kernels_t * narrowKernels = NULL;
+    // The sums of the clusters are kept between the iterations, past a quarter of the points moving they are recomputed
+    dataset_t sums;
+    moves_t moves;
+    // The centroids met after the first iteration, kept for the next runs, and whether they led to a known run
+    memo_trajectory_t trajectory = { .states = NULL };
+    bool known = false;
+    uint64_t remaining = 0;
+    // The columns of the initial centroids in the distances to the candidates, NULL if they are computed
+    uint32_t * columns = NULL;
+    // The members of the team taking part in the run, depending on the amount of work of an iteration
+    lloyd_team_t lloyd = { .members = NULL };
+    uint64_t nbOfMembers = points->size * K * points->dimension / LLOYD_WORK_PER_MEMBER;
+    nbOfMembers = (nbOfMembers < team_size(team)) ? nbOfMembers : team_size(team);
 
-    //Creates an empty array of clusters
-    clusters = (array_of_clusters *) malloc( sizeof(array_of_clusters) );
-    clusters->size = K;
-    clusters->array = (cluster_t *) malloc( sizeof(cluster_t) * K );
+    if (ptr == NULL){ return -1; }
 
-    // We initiate all clusters in clusters to an empty except the first one
-    for (size_t i = 0; i < K; i++)
+    if (algorithm == KMEANS_KDTREE && tree != NULL && tree->points == points && bounds_areExact(FORMULA_CHOOSED, points))
+    {
+        return k_means_filtering(ptr, initial_centroids, K, tree, kernels);
+    }
+    // The algorithms without an assignment of their own (kd-tree without a tree, mini-batch) are run with the one of Lloyd
+    if (algorithm != KMEANS_LLOYD && algorithm < sizeof(ASSIGNMENTS) / sizeof(ASSIGNMENTS[0])
+        && bounds_areExact(FORMULA_CHOOSED, points))
     {
-        if (i == 0)
+        assignment = &ASSIGNMENTS[algorithm];
+        state = assignment->create(points, K);
+        if (state == NULL)
         {
-            (clusters->array + i)->size = inputFile->nbOfPoints;
-            (clusters->array + i)->points = (point_t *) malloc( sizeof(point_t) * inputFile->nbOfPoints );
-            if (((clusters->array + i)->points ) == NULL )
-            {
-                fprintf(stderr, "[func.c] Failed malloc when initating clusters in kmeans\n");
-                return -1;
-            }
-            memcpy( (clusters->array + i)->points, inputFile->ptrToPoints, sizeof(point_t) * inputFile->nbOfPoints );
-        } else{
-            (clusters->array + i)->size = 0;
-            (clusters->array + i)->points = NULL;
+            fprintf(stderr, "[func.c] Failed malloc when initating the bounds in kmeans\n");
+            return -1;
         }
     }
 
-    int changed = 1;
-    while (changed)
+    // All the points start in the first cluster
+    clusters = (labels_t *) malloc( sizeof(labels_t) );
+    if (clusters == NULL || labels_init(clusters, points->size, K) != 0)
     {
-        holdsResult = assign_vectors_to_centroids(finalCentroids, clusters, K, inputFile->dimension);
-        
-        arrayOfClusters_destroy(clusters, false);
+        fprintf(stderr, "[func.c] Failed malloc when initating clusters in kmeans\n");
         free(clusters);
+        if (assignment != NULL){ assignment->destroy(state); }
+        return -1;
+    }
+    if (dataset_init(&sums, K, points->dimension) != 0 || moves_init(&moves, points->size / 4) != 0)
+    {
+        fprintf(stderr, "[func.c] Failed malloc when initating the sums of the clusters in kmeans\n");
+        dataset_destroy(&sums);
+        labels_destroy(clusters);
+        free(clusters);
+        if (assignment != NULL){ assignment->destroy(state); }
+        return -1;
+    }
+    if (narrowPoints != NULL && (assignment != NULL || narrowPoints->size != points->size
+                                 || narrow_init(&narrowCentroids, narrowPoints, K) != 0))
+    {
+        narrowPoints = NULL;
+    }
+    if (narrowPoints != NULL){ narrowKernels = kernels_selectNarrow(FORMULA_CHOOSED, narrowPoints); }
+    if (assignment == NULL && nbOfMembers > 1
+        && lloyd_team_init(&lloyd, nbOfMembers, points, clusters, kernels, narrowPoints, narrowKernels, candidates) != 0)
+    {
+        fprintf(stderr, "[func.c] Warning -- failed malloc for the members of the team, the run is done alone\n");
+    }
+    // The accelerated assignments compute their bounds during the first assignment, they don't read the candidates
+    if (candidates != NULL && assignment == NULL)
+    {
+        columns = (uint32_t *) malloc( sizeof(uint32_t) * K );
+        if (columns != NULL && !candidates_columns(candidates, initial_centroids, columns))
+        {
+            free(columns);
+            columns = NULL;
+        }
+    }
 
-        if (holdsResult == NULL)
+    int changed = 1;
+    while (changed)
+    {
+        moves_clear(&moves);
+        bool fromCandidates = columns != NULL && nbOfIterations == 0;
+        bool narrowed = !fromCandidates && narrowPoints != NULL && narrow_pack(&narrowCentroids, finalCentroids) == 0;
+        if (lloyd.members != NULL)
         {
-            fprintf(stderr, "[func.c] An error occured when assigning vectors to centroids\n");
-            return -1;
+            changed = lloyd_team_iterate(team, &lloyd, finalCentroids, narrowed ? &narrowCentroids : NULL,
+                                         fromCandidates ? columns : NULL, &sums, &distortion, nbOfIterations == 0);
+        } else if (fromCandidates) {
+            memset(clusters->counts, 0, sizeof(uint64_t) * K);
+            distortion = 0;
+            changed = candidates_assign(candidates, columns, K, clusters, &moves, &distortion, 0, points->size);
+        } else if (narrowed) {
+            changed = assign_narrow_vectors_to_centroids(&narrowCentroids, narrowPoints, clusters, &moves, &distortion,
+                                                         narrowKernels);
+        } else if (assignment == NULL) {
+            changed = assign_vectors_to_centroids(finalCentroids, points, clusters, &moves, &distortion, kernels);
+        } else {
+            changed = assignment->assign(state, finalCentroids, points, clusters, &moves, kernels);
+        }
+        if (known && changed >= 0)
+        {
+            // The last assignment, to the final centroids of the known run. That run did remaining iterations from the
+            // centroids met, the first of them giving the labels this run has now, so the rest follow. When they were
+            // it's last centroids, the labels of this run have changed there : one more assignment leaves them as is
+            nbOfIterations += (remaining > 1) ? (int) remaining : 2;
+            break;
+        }
+        // Past the first iteration the run only depends on it's centroids and labels : if another run met these
+        // centroids and the assignment changed a label, it goes on like that run did. The centroids are replaced by
+        // it's final ones, which are their own update, and a last assignment gives the clusters
+        if (memo != NULL && nbOfIterations > 0 && changed >= 0)
+        {
+            known = changed > 0 && memo_find(memo, finalCentroids, &remaining);
+            if (known){ continue; }
+            if (memo_record(&trajectory, finalCentroids) != 0){ memo = NULL; }
         }
-        
-        changed = holdsResult->value;
-        clusters = holdsResult->clusters;
-        free(holdsResult);
 
+        newCentroids = NULL;
+        if (changed >= 0)
+        {
+            if (lloyd.members == NULL && narrowPoints != NULL)
+            {
+                update_narrow_sums(&sums, narrowPoints, clusters, &moves, nbOfIterations == 0, narrowKernels);
+            } else if (lloyd.members == NULL) {
+                update_sums(&sums, points, clusters, &moves, nbOfIterations == 0, kernels);
+            }
+            newCentroids = update_centroids(&sums, clusters);
+        }
         if (nbOfIterations > 0)
         {   // If the iteration is equal to zero that means finalCentroids points to initial centroids.
-            arrayOfPoints_destroy(finalCentroids);
+            dataset_destroy(finalCentroids);
             free(finalCentroids);
         }
-        finalCentroids = update_centroids(clusters, K, inputFile->dimension);
+        finalCentroids = newCentroids;
+        if (finalCentroids == NULL)
+        {
+            fprintf(stderr, "[func.c] An error occured when updating the centroids\n");
+            labels_destroy(clusters);
+            free(clusters);
+            break;
+        }
         nbOfIterations++;
     }
+    if (assignment != NULL){ assignment->destroy(state); }
+    lloyd_team_destroy(&lloyd);
+    narrow_destroy(&narrowCentroids);
+    dataset_destroy(&sums);
+    moves_destroy(&moves);
+    free(columns);
+    if (finalCentroids != NULL){ memo_insert(memo, &trajectory, finalCentroids, (uint64_t) nbOfIterations); }
+    memo_trajectory_destroy(&trajectory);
+    if (finalCentroids == NULL){ return -1; }
 
-    if (ptr == NULL){ return -1; }
-    
+    // The last assignment of Lloyd measured the distances to the final centroids, unless it was the first one : the
+    // final centroids are then computed from the labels given by the initial ones
+    if (assignment == NULL && nbOfIterations > 1)
+    {
+        ptr->distortion = (int64_t) distortion;
+    } else {
+        ptr->distortion = kernels->distortion(finalCentroids, points, clusters, 0, points->size);
+    }
+    ptr->iterations = (uint64_t) nbOfIterations;
     ptr->finalCentroids = finalCentroids;
     ptr->finalClusters = clusters;
 
     return 0;
-}
\ No newline at end of file
+}
+
+/**
+ * Computes the same clusters as <k_means> with the algorithm of Lloyd, on a streamed file : each pass reads the
+ * points again, one chunk at a time, so only the centroids, the sums of the clusters, one chunk and (if kept) the
+ * labels are in memory.
+ *
+ * The iterations stop like the ones of <k_means_filtering>, which doesn't need the labels : when the centroids do not
+ * change anymore (or when all the points stay in the first cluster at the first iteration). A last pass assigns the
+ * points to the centroids of the last iteration, to set their labels and compute the distortion. It assigns each
+ * chunk to the centroids before first, so the run counts the iterations of Lloyd's like <k_means_filtering>.
+ *
+ * @param ptr (list_of_centroids_and_clusters_only * ) : Holds the result, with the distortion.
+ * @param initial_centroids (dataset_t *) : Inititial K centroids.
+ * @param K (uint32_k) : The number of clusters wanted.
+ * @param inputFile (const file_t *) : The streamed file, opened by <fileOpenStream>.
+ * @param labeled (bool) : true to keep the labels of the points, false to only keep the distortion (finalClusters is
+ *                         then NULL).
+ *
+ * @return 0 upon successful completition else -1.
+ */
+int k_means_streamed(list_of_centroids_and_clusters_only * ptr, dataset_t * initial_centroids, uint32_t K,
+                     const file_t * inputFile, bool labeled)
+{
+    uint32_t dimension = inputFile->dataset.dimension;
+    uint64_t nbOfPoints = inputFile->nbOfPoints;
+    uint64_t chunkSize = fileChunkSize(inputFile);
+    const lloyd_kernels_t * kernels = kernels_select(FORMULA_CHOOSED, dimension);
+    dataset_t * finalCentroids = initial_centroids;
+    dataset_t * newCentroids = NULL;
+    dataset_t chunk;
+    dataset_t sums;
+    labels_t chunkClusters;
+    labels_t * clusters = NULL;
+    // The moves of a chunk are not needed, the list stays empty
+    moves_t moves;
+
+    if (ptr == NULL){ return -1; }
+    int possibleError = 0;
+    if (dataset_init(&chunk, chunkSize, dimension) != 0)
+    {
+        possibleError = -1;
+    } else if (dataset_init(&sums, K, dimension) != 0) {
+        dataset_destroy(&chunk);
+        possibleError = -1;
+    } else if (labels_init(&chunkClusters, chunkSize, K) != 0) {
+        dataset_destroy(&chunk);
+        dataset_destroy(&sums);
+        possibleError = -1;
+    } else if (moves_init(&moves, 0) != 0) {
+        dataset_destroy(&chunk);
+        dataset_destroy(&sums);
+        labels_destroy(&chunkClusters);
+        possibleError = -1;
+    }
+    if (possibleError == 0 && labeled)
+    {
+        clusters = (labels_t *) malloc( sizeof(labels_t) );
+        if (clusters == NULL || labels_init(clusters, nbOfPoints, K) != 0)
+        {
+            free(clusters);
+            clusters = NULL;
+            dataset_destroy(&chunk);
+            dataset_destroy(&sums);
+            labels_destroy(&chunkClusters);
+            moves_destroy(&moves);
+            possibleError = -1;
+        }
+    }
+    if (possibleError != 0)
+    {
+        fprintf(stderr, "[func.c] Failed malloc when initating the streamed kmeans\n");
+        return -1;
+    }
+
+    int nbOfIterations = 0;
+    bool stop = false;
+    uint64_t distortion = 0;
+    // The centroids of the iteration before, kept to count the iterations like Lloyd's
+    dataset_t * previousCentroids = NULL;
+    int changed = 0;
+    while (!stop && possibleError == 0)
+    {
+        // The counts of the chunks are the ones of all the points
+        memset(chunkClusters.counts, 0, sizeof(uint64_t) * K);
+        memset(sums.values, 0, sizeof(int64_t) * sums.size * sums.stride);
+        for (uint64_t first = 0; first < nbOfPoints && possibleError == 0; first += chunkSize)
+        {
+            chunk.size = (nbOfPoints - first < chunkSize) ? nbOfPoints - first : chunkSize;
+            possibleError = fileReadPoints(inputFile, first, &chunk);
+            if (possibleError == 0)
+            {
+                moves_clear(&moves);
+                kernels->assign(finalCentroids, &chunk, &chunkClusters, &moves, NULL, 0, chunk.size);
+                kernels->accumulate(sums.values, &chunk, &chunkClusters, 0, chunk.size);
+            }
+        }
+        if (possibleError != 0){ break; }
+
+        newCentroids = update_centroids(&sums, &chunkClusters);
+        if (newCentroids == NULL)
+        {
+            fprintf(stderr, "[func.c] An error occured when updating the centroids\n");
+            possibleError = -1;
+            break;
+        }
+        if (nbOfIterations == 0)
+        {
+            stop = chunkClusters.counts[0] == nbOfPoints;
+        } else {
+            stop = centroids_areEqual(newCentroids, finalCentroids);
+        }
+
+        if (stop)
+        {
+            // The last pass, with the centroids of the last iteration. They are the final ones unless the run stops at the
+            // first iteration, the distances are then measured again
+            if (clusters != NULL){ memset(clusters->counts, 0, sizeof(uint64_t) * K); }
+            for (uint64_t first = 0; first < nbOfPoints && possibleError == 0; first += chunkSize)
+            {
+                chunk.size = (nbOfPoints - first < chunkSize) ? nbOfPoints - first : chunkSize;
+                possibleError = fileReadPoints(inputFile, first, &chunk);
+                if (possibleError != 0){ break; }
+                if (nbOfIterations > 0)
+                {
+                    // The labels given by the centroids before : if the last ones change one, Lloyd's does one more
+                    // iteration, on the same centroids
+                    moves_clear(&moves);
+                    kernels->assign(previousCentroids, &chunk, &chunkClusters, &moves, NULL, 0, chunk.size);
+                }
+                moves_clear(&moves);
+                changed |= kernels->assign(finalCentroids, &chunk, &chunkClusters, &moves,
+                                           (nbOfIterations > 0) ? &distortion : NULL, 0, chunk.size);
+                if (nbOfIterations == 0)
+                {
+                    distortion += (uint64_t) kernels->distortion(newCentroids, &chunk, &chunkClusters, 0, chunk.size);
+                }
+                for (uint64_t i = 0; clusters != NULL && i < chunk.size; i++)
+                {
+                    uint32_t label = labels_get(&chunkClusters, i);
+                    labels_set(clusters, first + i, label);
+                    clusters->counts[label]++;
+                }
+            }
+        }
+        if (nbOfIterations > 1)
+        {   // If the iteration is equal to one that means previousCentroids points to initial centroids.
+            dataset_destroy(previousCentroids);
+            free(previousCentroids);
+        }
+        previousCentroids = finalCentroids;
+        finalCentroids = newCentroids;
+        newCentroids = NULL;
+        nbOfIterations++;
+    }
+
+    dataset_destroy(&chunk);
+    dataset_destroy(&sums);
+    labels_destroy(&chunkClusters);
+    moves_destroy(&moves);
+    if (nbOfIterations > 1)
+    {
+        dataset_destroy(previousCentroids);
+        free(previousCentroids);
+    }
+    if (possibleError != 0)
+    {
+        if (nbOfIterations > 0)
+        {
+            dataset_destroy(finalCentroids);
+            free(finalCentroids);
+        }
+        if (clusters != NULL)
+        {
+            labels_destroy(clusters);
+            free(clusters);
+        }
+        return -1;
+    }
+
+    ptr->distortion = (int64_t) distortion;
+    ptr->iterations = (uint64_t) nbOfIterations + (nbOfIterations > 1 && changed > 0);
+    ptr->finalCentroids = finalCentroids;
+    ptr->finalClusters = clusters;
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "hamerly.h"
+#include "bounds.h"
+#include "dataset.h"
+#include "labels.h"
+#include "kernels.h"
+
+/**
+ * Allocates the state of the assignment of Hamerly for the points and K centroids.
+ *
+ * @param points (const dataset_t *) : The points to cluster.
+ * @param K (uint32_t) : The number of centroids.
+ *
+ * @return (void *) : The state, NULL in case of an error.
+ */
+void * hamerly_create(const dataset_t * points, uint32_t K)
+{
+    hamerly_t * state = (hamerly_t *) calloc(1, sizeof(hamerly_t));
+    if (state == NULL){ return NULL; }
+    state->K = K;
+
+    state->upper = (double *) malloc( sizeof(double) * (points->size == 0 ? 1 : points->size) );
+    state->lower = (double *) malloc( sizeof(double) * (points->size == 0 ? 1 : points->size) );
+    state->nearest = (double *) malloc( sizeof(double) * K );
+    state->drifts = (double *) malloc( sizeof(double) * K );
+    if (state->upper == NULL || state->lower == NULL || state->nearest == NULL || state->drifts == NULL)
+    {
+        hamerly_destroy(state);
+        return NULL;
+    }
+    return state;
+}
+
+/**
+ * Computes the distances of the i-th point to all the centroids. The closest one (the first one in case of a tie)
+ * gives the upper bound, the second closest the lower bound.
+ *
+ * @return (uint32_t) : The index of the closest centroid.
+ */
+static uint32_t hamerly_assignPoint(hamerly_t * state, const dataset_t * centroids, const dataset_t * points,
+                                    uint64_t i, const lloyd_kernels_t * kernels)
+{
+    const int64_t * vector = dataset_row(points, i);
+    uint32_t closest = 0;
+    int64_t closestDistance = INT64_MAX;
+    int64_t secondDistance = INT64_MAX;
+    for (uint32_t k = 0; k < state->K; k++)
+    {
+        int64_t distance = kernels->distance(vector, dataset_row(centroids, k), points->dimension);
+        if (k == 0 || distance < closestDistance)
+        {
+            secondDistance = closestDistance;
+            closest = k;
+            closestDistance = distance;
+        } else if (distance < secondDistance) {
+            secondDistance = distance;
+        }
+    }
+    state->upper[i] = bounds_upper(bounds_distance(closestDistance));
+    state->lower[i] = (state->K == 1) ? INFINITY : bounds_lower(bounds_distance(secondDistance));
+    return closest;
+}
+
+/**
+ * Assigns each point to it's closest centroid, the same way as <assign_vectors_to_centroids>. The centroids of a
+ * point are only looked at when it's bounds do not prove that it keeps it's centroid. The counts of the labels are
+ * updated.
+ *
+ * @param ptr (void *) : The state returned by <hamerly_create>.
+ * @param centroids (const dataset_t *) : The centroids.
+ * @param points (const dataset_t *) : The points.
+ * @param labels (labels_t *) : The labels of the points, as left by the last assignment.
+ * @param moves (moves_t *) : The list where the points that change of cluster are recorded.
+ * @param kernels (const lloyd_kernels_t *) : The loops selected for the formula and the dimension.
+ *
+ * @return (int) : 1 if a point has changed of cluster, 0 if not, -1 in case of an error.
+ */
+int hamerly_assign(void * ptr, const dataset_t * centroids, const dataset_t * points, labels_t * labels,
+                   moves_t * moves, const lloyd_kernels_t * kernels)
+{
+    hamerly_t * state = (hamerly_t *) ptr;
+    uint32_t K = state->K;
+    uint32_t closest;
+    int changed = 0;
+
+    if (!state->started)
+    {
+        if (dataset_init(&state->previous, K, centroids->dimension) != 0){ return -1; }
+        state->started = true;
+        memset(labels->counts, 0, sizeof(uint64_t) * K);
+        for (uint64_t i = 0; i < points->size; i++)
+        {
+            closest = hamerly_assignPoint(state, centroids, points, i, kernels);
+            if (closest != labels_get(labels, i))
+            {
+                moves_push(moves, i, labels_get(labels, i));
+                labels_set(labels, i, closest);
+                changed = 1;
+            }
+            labels->counts[closest]++;
+        }
+        dataset_copy(&state->previous, centroids);
+        return changed;
+    }
+
+    bounds_drifts(&state->previous, centroids, state->drifts, kernels);
+    bounds_halfDistances(centroids, NULL, state->nearest, kernels);
+
+    // The lower bound of a point moves by the largest drift of the other centroids
+    uint32_t largest = 0;
+    double secondDrift = 0;
+    for (uint32_t k = 1; k < K; k++)
+    {
+        if (state->drifts[k] > state->drifts[largest])
+        {
+            secondDrift = state->drifts[largest];
+            largest = k;
+        } else if (state->drifts[k] > secondDrift) {
+            secondDrift = state->drifts[k];
+        }
+    }
+
+    for (uint64_t i = 0; i < points->size; i++)
+    {
+        uint32_t assigned = labels_get(labels, i);
+        double upper = bounds_increase(state->upper[i], state->drifts[assigned]);
+        double lower = bounds_decrease(state->lower[i], (assigned == largest) ? secondDrift : state->drifts[largest]);
+        double bound = (lower > state->nearest[assigned]) ? lower : state->nearest[assigned];
+
+        if (upper < bound)
+        {
+            state->upper[i] = upper;
+            state->lower[i] = lower;
+            continue;
+        }
+        // The upper bound is made exact before looking at the other centroids
+        int64_t distance = kernels->distance(dataset_row(points, i), dataset_row(centroids, assigned), points->dimension);
+        upper = bounds_upper(bounds_distance(distance));
+        if (upper < bound)
+        {
+            state->upper[i] = upper;
+            state->lower[i] = lower;
+            continue;
+        }
+
+        closest = hamerly_assignPoint(state, centroids, points, i, kernels);
+        if (closest != assigned)
+        {
+            moves_push(moves, i, assigned);
+            labels_set(labels, i, closest);
+            labels->counts[assigned]--;
+            labels->counts[closest]++;
+            changed = 1;
+        }
+    }
+
+    dataset_copy(&state->previous, centroids);
+    return changed;
+}
+
+/**
+ * Frees the state of the assignment of Hamerly.
+ *
+ * @param ptr (void *) : The state returned by <hamerly_create>, may be NULL.
+ */
+void hamerly_destroy(void * ptr)
+{
+    hamerly_t * state = (hamerly_t *) ptr;
+    if (state == NULL){ return; }
+    free(state->upper);
+    free(state->lower);
+    free(state->nearest);
+    free(state->drifts);
+    dataset_destroy(&state->previous);
+    free(state);
+}
@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "kdtree.h"
+#include "dataset.h"
+
+/**
+ * Makes room for one more node, the arrays of the nodes are doubled when they are full.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+static int kdtree_reserve(kdtree_t * tree)
+{
+    if (tree->nbOfNodes < tree->capacity){ return 0; }
+    uint64_t capacity = (tree->capacity == 0) ? 64 : tree->capacity * 2;
+    uint32_t dimension = (tree->points->dimension == 0) ? 1 : tree->points->dimension;
+
+    kdtree_node_t * nodes = (kdtree_node_t *) realloc(tree->nodes, sizeof(kdtree_node_t) * capacity);
+    if (nodes == NULL){ return -1; }
+    tree->nodes = nodes;
+    int64_t * lower = (int64_t *) realloc(tree->lower, sizeof(int64_t) * capacity * dimension);
+    if (lower == NULL){ return -1; }
+    tree->lower = lower;
+    int64_t * upper = (int64_t *) realloc(tree->upper, sizeof(int64_t) * capacity * dimension);
+    if (upper == NULL){ return -1; }
+    tree->upper = upper;
+    int64_t * sums = (int64_t *) realloc(tree->sums, sizeof(int64_t) * capacity * dimension);
+    if (sums == NULL){ return -1; }
+    tree->sums = sums;
+
+    tree->capacity = capacity;
+    return 0;
+}
+
+/**
+ * Reorders the positions [begin, end) of the order so that the point at the position nth has the nth smallest m-th
+ * coordinate, the points before it a smaller or equal one and the points after it a larger or equal one (Hoare's
+ * selection).
+ */
+static void kdtree_select(uint64_t * order, const dataset_t * points, int64_t begin, int64_t end, int64_t nth,
+                          uint32_t m)
+{
+    while (end - begin > 1)
+    {
+        // The pivot is the median of the first, middle and last coordinates
+        int64_t a = dataset_row(points, order[begin])[m];
+        int64_t b = dataset_row(points, order[begin + (end - begin) / 2])[m];
+        int64_t c = dataset_row(points, order[end - 1])[m];
+        int64_t pivot = (a < b) ? ((b < c) ? b : ((a < c) ? c : a)) : ((a < c) ? a : ((b < c) ? c : b));
+
+        int64_t i = begin;
+        int64_t j = end - 1;
+        while (i <= j)
+        {
+            while (dataset_row(points, order[i])[m] < pivot){ i++; }
+            while (dataset_row(points, order[j])[m] > pivot){ j--; }
+            if (i <= j)
+            {
+                uint64_t swap = order[i];
+                order[i] = order[j];
+                order[j] = swap;
+                i++;
+                j--;
+            }
+        }
+        // [begin, j] is at most the pivot, [i, end) at least, and the positions in between are equal to it
+        if (nth <= j)
+        {
+            end = j + 1;
+        } else if (nth >= i) {
+            begin = i;
+        } else {
+            return;
+        }
+    }
+}
+
+/**
+ * Computes the box and the sums of the node, then splits it in two halves along the widest side of it's box if it
+ * has too many points.
+ *
+ * @param tree (kdtree_t *) : The tree being built.
+ * @param index (uint64_t) : The index of the node, it's begin and end are set.
+ * @param level (uint32_t) : The level of the node, 0 for the root.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+static int kdtree_split(kdtree_t * tree, uint64_t index, uint32_t level)
+{
+    const dataset_t * points = tree->points;
+    uint32_t dimension = points->dimension;
+    uint64_t begin = tree->nodes[index].begin;
+    uint64_t end = tree->nodes[index].end;
+    int64_t * lower = tree->lower + index * dimension;
+    int64_t * upper = tree->upper + index * dimension;
+    uint64_t * sums = (uint64_t *) tree->sums + index * dimension;
+
+    memcpy(lower, dataset_row(points, tree->order[begin]), sizeof(int64_t) * dimension);
+    memcpy(upper, dataset_row(points, tree->order[begin]), sizeof(int64_t) * dimension);
+    memset(sums, 0, sizeof(int64_t) * dimension);
+    for (uint64_t position = begin; position < end; position++)
+    {
+        const int64_t * vector = dataset_row(points, tree->order[position]);
+        for (uint32_t m = 0; m < dimension; m++)
+        {
+            lower[m] = (vector[m] < lower[m]) ? vector[m] : lower[m];
+            upper[m] = (vector[m] > upper[m]) ? vector[m] : upper[m];
+            sums[m] += (uint64_t) vector[m];
+        }
+    }
+
+    tree->nodes[index].left = 0;
+    tree->nodes[index].right = 0;
+    tree->depth = (level + 1 > tree->depth) ? level + 1 : tree->depth;
+    if (end - begin <= KDTREE_LEAF_SIZE){ return 0; }
+
+    uint32_t widest = 0;
+    for (uint32_t m = 1; m < dimension; m++)
+    {
+        if ((uint64_t) upper[m] - (uint64_t) lower[m] > (uint64_t) upper[widest] - (uint64_t) lower[widest])
+        {
+            widest = m;
+        }
+    }
+    uint64_t middle = begin + (end - begin) / 2;
+    if (dimension > 0)
+    {
+        kdtree_select(tree->order, points, (int64_t) begin, (int64_t) end, (int64_t) middle, widest);
+    }
+
+    // The arrays may move when the children are added, only indexes are kept
+    uint64_t left = tree->nbOfNodes;
+    if (kdtree_reserve(tree) != 0){ return -1; }
+    tree->nodes[left].begin = begin;
+    tree->nodes[left].end = middle;
+    tree->nbOfNodes++;
+    uint64_t right = tree->nbOfNodes;
+    if (kdtree_reserve(tree) != 0){ return -1; }
+    tree->nodes[right].begin = middle;
+    tree->nodes[right].end = end;
+    tree->nbOfNodes++;
+    tree->nodes[index].left = left;
+    tree->nodes[index].right = right;
+
+    if (kdtree_split(tree, left, level + 1) != 0){ return -1; }
+    return kdtree_split(tree, right, level + 1);
+}
+
+/**
+ * Builds the kd-tree of the points.
+ *
+ * ATTENTION : Think of freeing the tree with the specific function <kdtree_destroy> when done. The points must not
+ * be freed before it.
+ *
+ * @param tree (kdtree_t *) : The tree.
+ * @param points (const dataset_t *) : The points, at least one.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+int kdtree_build(kdtree_t * tree, const dataset_t * points)
+{
+    if (tree == NULL){ return -1; }
+    memset(tree, 0, sizeof(kdtree_t));
+    tree->points = points;
+    if (points->size == 0){ return -1; }
+
+    tree->order = (uint64_t *) malloc( sizeof(uint64_t) * points->size );
+    if (tree->order == NULL || kdtree_reserve(tree) != 0)
+    {
+        fprintf(stderr, "[kdtree.c] Failed malloc when initiating the kd-tree\n");
+        kdtree_destroy(tree);
+        return -1;
+    }
+    for (uint64_t i = 0; i < points->size; i++){ tree->order[i] = i; }
+
+    tree->nodes[0].begin = 0;
+    tree->nodes[0].end = points->size;
+    tree->nbOfNodes = 1;
+    if (kdtree_split(tree, 0, 0) != 0)
+    {
+        fprintf(stderr, "[kdtree.c] Failed malloc when building the kd-tree\n");
+        kdtree_destroy(tree);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Frees the content of a kd-tree.
+ *
+ * @param tree (kdtree_t *) : The tree.
+ *
+ * Note that it does not free the pointer it's self, nor the points.
+ */
+void kdtree_destroy(kdtree_t * tree)
+{
+    if (tree == NULL){ return; }
+    free(tree->order);
+    free(tree->nodes);
+    free(tree->lower);
+    free(tree->upper);
+    free(tree->sums);
+    tree->order = NULL;
+    tree->nodes = NULL;
+    tree->lower = NULL;
+    tree->upper = NULL;
+    tree->sums = NULL;
+    tree->nbOfNodes = 0;
+    tree->capacity = 0;
+    tree->depth = 0;
+}
@@ -0,0 +1,436 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "kernels.h"
+#include "distance.h"
+#include "dataset.h"
+#include "labels.h"
+#include "narrow.h"
+
+/*
+ * The loops of the Lloyd algorithm are instantiated by macros, once for each formula and each of the dimensions of
+ * KERNELS_DIMENSIONS, where the dimension is a constant : the compiler unrolls the loops over the coordinates and
+ * inlines the distance. The generic instantiation handles the other dimensions with the kernels of DISTANCE_KERNELS.
+ * Only the dimensions too small to fill a SIMD register are specialized : from 8 coordinates, the unrolled scalar
+ * loops are slower than the kernels of DISTANCE_KERNELS.
+ *
+ * Like the kernels of distance.c, the coordinates are combined with uint64_t so the results are the same, bit for bit.
+ */
+
+/**
+ * Calculates the squared manhattan distance between two rows of dim coordinates.
+ *
+ * @param p1 (const int64_t *) : The coordinates of a point.
+ * @param p2 (const int64_t *) : And the coordinates of another point.
+ * @param dim (uint32_t) : The dimension, a constant once inlined.
+ *
+ * @return value (uint64_t)
+ */
+static inline __attribute__((always_inline)) uint64_t manhattan_row(const int64_t * p1, const int64_t * p2, uint32_t dim)
+{
+    uint64_t sum = 0;
+    uint64_t difference;
+    #pragma GCC unroll 16
+    for (uint32_t i = 0; i < dim; i++){
+        difference = (uint64_t) p1[i] - (uint64_t) p2[i];
+        sum += ( (int64_t) difference < 0 ) ? -difference : difference;
+    }
+    return sum * sum;
+}
+
+/**
+ * Calculates the squared euclidean distance between two rows of dim coordinates.
+ *
+ * @param p1 (const int64_t *) : The coordinates of a point.
+ * @param p2 (const int64_t *) : And the coordinates of another point.
+ * @param dim (uint32_t) : The dimension, a constant once inlined.
+ *
+ * @return value (uint64_t)
+ */
+static inline __attribute__((always_inline)) uint64_t euclidean_row(const int64_t * p1, const int64_t * p2, uint32_t dim)
+{
+    uint64_t sum = 0;
+    uint64_t difference;
+    #pragma GCC unroll 16
+    for (uint32_t i = 0; i < dim; i++){
+        difference = (uint64_t) p1[i] - (uint64_t) p2[i];
+        sum += difference * difference;
+    }
+    return sum;
+}
+
+// The generic instantiations use the kernels selected by distance_init
+static inline __attribute__((always_inline)) uint64_t manhattan_generic_row(const int64_t * p1, const int64_t * p2, uint32_t dim)
+{
+    return (uint64_t) DISTANCE_KERNELS.squared_manhattan(p1, p2, dim);
+}
+
+static inline __attribute__((always_inline)) uint64_t euclidean_generic_row(const int64_t * p1, const int64_t * p2, uint32_t dim)
+{
+    return (uint64_t) DISTANCE_KERNELS.squared_euclidean(p1, p2, dim);
+}
+
+/**
+ * Defines the assign and distortion loops of a formula for a dimension.
+ *
+ * @param NAME : The suffix of the functions, <formula>_<dimension>.
+ * @param ROW : The function computing the distance between two rows.
+ * @param DIMENSION : An expression giving the dimension, from the dataset <points>.
+ * @param ROW_DIMENSION : An expression giving the dimension in the row distance, from it's parameter <dim>.
+ */
+#define DEFINE_FORMULA_KERNELS(NAME, ROW, DIMENSION, ROW_DIMENSION)                                                  \
+static int assign_##NAME(const dataset_t * centroids, const dataset_t * points, labels_t * labels, moves_t * moves,  \
+                         uint64_t * distortion, uint64_t begin, uint64_t end)                                        \
+{                                                                                                                    \
+    const uint32_t dimension = (DIMENSION);                                                                          \
+    const uint32_t K = (uint32_t) centroids->size;                                                                   \
+    int changed = 0;                                                                                                 \
+    uint64_t sum = 0;                                                                                                \
+    for (uint64_t i = begin; i < end; i++){                                                                          \
+        const int64_t * vector = dataset_row(points, i);                                                             \
+        uint32_t closest = 0;                                                                                        \
+        uint64_t closestDistance = UINT64_MAX;                                                                       \
+        for (uint32_t k = 0; k < K; k++){                                                                            \
+            uint64_t distance = ROW(vector, dataset_row(centroids, k), dimension);                                   \
+            if (distance < closestDistance){                                                                         \
+                closest = k;                                                                                         \
+                closestDistance = distance;                                                                          \
+            }                                                                                                        \
+        }                                                                                                            \
+        uint32_t label = labels_get(labels, i);                                                                      \
+        if (closest != label){                                                                                       \
+            moves_push(moves, i, label);                                                                             \
+            labels_set(labels, i, closest);                                                                          \
+            changed = 1;                                                                                             \
+        }                                                                                                            \
+        labels->counts[closest]++;                                                                                   \
+        sum += closestDistance;                                                                                      \
+    }                                                                                                                \
+    if (distortion != NULL){                                                                                         \
+        *distortion += sum;                                                                                          \
+    }                                                                                                                \
+    return changed;                                                                                                  \
+}                                                                                                                    \
+                                                                                                                     \
+static int64_t distortion_##NAME(const dataset_t * centroids, const dataset_t * points, const labels_t * labels,     \
+                                 uint64_t begin, uint64_t end)                                                       \
+{                                                                                                                    \
+    const uint32_t dimension = (DIMENSION);                                                                          \
+    uint64_t sum = 0;                                                                                                \
+    for (uint64_t i = begin; i < end; i++){                                                                          \
+        sum += ROW(dataset_row(points, i), dataset_row(centroids, labels_get(labels, i)), dimension);                \
+    }                                                                                                                \
+    return (int64_t) sum;                                                                                            \
+}                                                                                                                    \
+                                                                                                                     \
+static int64_t distance_##NAME(const int64_t * p1, const int64_t * p2, uint32_t dim)                                 \
+{                                                                                                                    \
+    (void) dim;                                                                                                      \
+    return (int64_t) ROW(p1, p2, (ROW_DIMENSION));                                                                   \
+}
+
+/**
+ * Defines the accumulate and move loops for a dimension, they do not depend on the formula.
+ *
+ * @param NAME : The suffix of the function, the dimension.
+ * @param DIMENSION : An expression giving the dimension, from the dataset <points>.
+ */
+#define DEFINE_ACCUMULATE_KERNEL(NAME, DIMENSION)                                                                    \
+static void accumulate_##NAME(int64_t * sums, const dataset_t * points, const labels_t * labels,                     \
+                              uint64_t begin, uint64_t end)                                                          \
+{                                                                                                                    \
+    const uint32_t dimension = (DIMENSION);                                                                          \
+    for (uint64_t i = begin; i < end; i++){                                                                          \
+        const int64_t * vector = dataset_row(points, i);                                                             \
+        uint64_t * sum = (uint64_t *) sums + (uint64_t) labels_get(labels, i) * dimension;                           \
+        _Pragma("GCC unroll 16")                                                                                     \
+        for (uint32_t m = 0; m < dimension; m++){                                                                    \
+            sum[m] += (uint64_t) vector[m];                                                                          \
+        }                                                                                                            \
+    }                                                                                                                \
+}                                                                                                                    \
+                                                                                                                     \
+static void move_##NAME(int64_t * sums, const dataset_t * points, const labels_t * labels, const moves_t * moves)    \
+{                                                                                                                    \
+    const uint32_t dimension = (DIMENSION);                                                                          \
+    for (uint64_t j = 0; j < moves->size; j++){                                                                      \
+        const int64_t * vector = dataset_row(points, moves->points[j]);                                              \
+        uint64_t * from = (uint64_t *) sums + (uint64_t) moves->from[j] * dimension;                                 \
+        uint64_t * to = (uint64_t *) sums + (uint64_t) labels_get(labels, moves->points[j]) * dimension;             \
+        _Pragma("GCC unroll 16")                                                                                     \
+        for (uint32_t m = 0; m < dimension; m++){                                                                    \
+            from[m] -= (uint64_t) vector[m];                                                                         \
+            to[m] += (uint64_t) vector[m];                                                                           \
+        }                                                                                                            \
+    }                                                                                                                \
+}
+
+/**
+ * Defines all the loops for a fixed dimension D.
+ */
+#define DEFINE_DIMENSION_KERNELS(D)                                                                                  \
+    DEFINE_FORMULA_KERNELS(manhattan_##D, manhattan_row, D, D)                                                       \
+    DEFINE_FORMULA_KERNELS(euclidean_##D, euclidean_row, D, D)                                                       \
+    DEFINE_ACCUMULATE_KERNEL(D, D)
+
+DEFINE_DIMENSION_KERNELS(1)
+DEFINE_DIMENSION_KERNELS(2)
+DEFINE_DIMENSION_KERNELS(3)
+DEFINE_DIMENSION_KERNELS(4)
+DEFINE_FORMULA_KERNELS(manhattan_generic, manhattan_generic_row, points->dimension, dim)
+DEFINE_FORMULA_KERNELS(euclidean_generic, euclidean_generic_row, points->dimension, dim)
+DEFINE_ACCUMULATE_KERNEL(generic, points->dimension)
+
+/**
+ * The entries of KERNELS, for the manhattan and the euclidean formula.
+ */
+#define KERNELS_ENTRIES(SUFFIX)                                                                                      \
+    { "manhattan_" #SUFFIX, assign_manhattan_##SUFFIX, accumulate_##SUFFIX, move_##SUFFIX,                           \
+      distortion_manhattan_##SUFFIX, distance_manhattan_##SUFFIX },                                                  \
+    { "euclidean_" #SUFFIX, assign_euclidean_##SUFFIX, accumulate_##SUFFIX, move_##SUFFIX,                           \
+      distortion_euclidean_##SUFFIX, distance_euclidean_##SUFFIX }
+
+static const uint32_t KERNELS_DIMENSIONS[] = { 1, 2, 3, 4, 0 };
+
+// For each dimension of KERNELS_DIMENSIONS (0 is the generic one), the manhattan then the euclidean kernels
+static const lloyd_kernels_t KERNELS[] = {
+    KERNELS_ENTRIES(1),
+    KERNELS_ENTRIES(2),
+    KERNELS_ENTRIES(3),
+    KERNELS_ENTRIES(4),
+    KERNELS_ENTRIES(generic),
+};
+
+/**
+ * Selects the loops for a formula and a dimension. It's meant to be called once per run, outside of the loops.
+ *
+ * @param formula (squared_distance_func_t) : squared_manhattan_distance or squared_euclidean_distance.
+ * @param dimension (uint32_t) : The dimension of the points.
+ *
+ * @return (const lloyd_kernels_t *) : The loops specialized for the dimension if there are, else the generic ones.
+ */
+const lloyd_kernels_t * kernels_select(squared_distance_func_t formula, uint32_t dimension)
+{
+    uint32_t offset = (formula == squared_euclidean_distance) ? 1 : 0;
+    uint32_t i = 0;
+    while (KERNELS_DIMENSIONS[i] != 0 && KERNELS_DIMENSIONS[i] != dimension)
+    {
+        i++;
+    }
+    return &KERNELS[2 * i + offset];
+}
+
+/*
+ * The same loops on narrow points (see narrow.h) : the coordinates are stored with TYPE, their differences computed
+ * with DIFFERENCE and the distances summed with ACCUMULATOR. The sums of the clusters stay int64_t. Like the int64_t
+ * loops, only the small dimensions are unrolled, the generic loops use the narrow kernels of DISTANCE_KERNELS.
+ */
+
+/**
+ * Defines the squared distances between two narrow rows, for a storage.
+ *
+ * @param NAME : The name of the storage.
+ * @param TYPE : The type of the coordinates.
+ * @param DIFFERENCE : A signed type holding the difference of two coordinates.
+ * @param ACCUMULATOR : An unsigned type holding the sum of the distances of all the coordinates.
+ */
+#define DEFINE_NARROW_ROWS(NAME, TYPE, DIFFERENCE, ACCUMULATOR)                                                      \
+static inline __attribute__((always_inline)) uint64_t manhattan_##NAME##_row(const TYPE * p1, const TYPE * p2,     \
+                                                                             uint32_t dim)                          \
+{                                                                                                                    \
+    ACCUMULATOR sum = 0;                                                                                             \
+    _Pragma("GCC unroll 16")                                                                                         \
+    for (uint32_t i = 0; i < dim; i++){                                                                              \
+        DIFFERENCE difference = (DIFFERENCE) p1[i] - (DIFFERENCE) p2[i];                                             \
+        sum += (ACCUMULATOR) ((difference < 0) ? -difference : difference);                                          \
+    }                                                                                                                \
+    return (uint64_t) sum * (uint64_t) sum;                                                                          \
+}                                                                                                                    \
+                                                                                                                     \
+static inline __attribute__((always_inline)) uint64_t euclidean_##NAME##_row(const TYPE * p1, const TYPE * p2,     \
+                                                                             uint32_t dim)                          \
+{                                                                                                                    \
+    ACCUMULATOR sum = 0;                                                                                             \
+    _Pragma("GCC unroll 16")                                                                                         \
+    for (uint32_t i = 0; i < dim; i++){                                                                              \
+        DIFFERENCE difference = (DIFFERENCE) p1[i] - (DIFFERENCE) p2[i];                                             \
+        sum += (ACCUMULATOR) difference * (ACCUMULATOR) difference;                                                  \
+    }                                                                                                                \
+    return (uint64_t) sum;                                                                                           \
+}
+
+DEFINE_NARROW_ROWS(int16, int16_t, int32_t, uint32_t)
+DEFINE_NARROW_ROWS(int16w, int16_t, int32_t, uint64_t)
+DEFINE_NARROW_ROWS(int32, int32_t, int64_t, uint64_t)
+
+/**
+ * Defines the rows of the generic narrow loops, with the kernels of DISTANCE_KERNELS for a storage.
+ *
+ * @param NAME : The name of the storage.
+ * @param TYPE : The type of the coordinates.
+ * @param KERNEL : The suffix of the kernels in DISTANCE_KERNELS.
+ */
+#define DEFINE_NARROW_GENERIC_ROWS(NAME, TYPE, KERNEL)                                                               \
+static inline __attribute__((always_inline)) uint64_t manhattan_##NAME##_generic_row(const TYPE * p1, const TYPE * p2, \
+                                                                                     uint32_t dim)                  \
+{                                                                                                                    \
+    return (uint64_t) DISTANCE_KERNELS.squared_manhattan##KERNEL(p1, p2, dim);                                       \
+}                                                                                                                    \
+                                                                                                                     \
+static inline __attribute__((always_inline)) uint64_t euclidean_##NAME##_generic_row(const TYPE * p1, const TYPE * p2, \
+                                                                                     uint32_t dim)                  \
+{                                                                                                                    \
+    return (uint64_t) DISTANCE_KERNELS.squared_euclidean##KERNEL(p1, p2, dim);                                       \
+}
+
+DEFINE_NARROW_GENERIC_ROWS(int16, int16_t, 16)
+DEFINE_NARROW_GENERIC_ROWS(int16w, int16_t, 16w)
+DEFINE_NARROW_GENERIC_ROWS(int32, int32_t, 32)
+
+/**
+ * Defines the narrow assign loop of a formula for a storage and a dimension.
+ *
+ * @param NAME : The suffix of the function, <formula>_<storage>_<dimension>.
+ * @param ROW : The function computing the distance between two rows.
+ * @param TYPE : The type of the coordinates.
+ * @param DIMENSION : An expression giving the dimension, from the matrix <points>.
+ */
+#define DEFINE_NARROW_FORMULA_KERNELS(NAME, ROW, TYPE, DIMENSION)                                                    \
+static int assign_##NAME(const narrow_t * centroids, const narrow_t * points, labels_t * labels, moves_t * moves,    \
+                         uint64_t * distortion, uint64_t begin, uint64_t end)                                        \
+{                                                                                                                    \
+    const uint32_t dimension = (DIMENSION);                                                                          \
+    const uint32_t K = (uint32_t) centroids->size;                                                                   \
+    const TYPE * centroidValues = (const TYPE *) centroids->values;                                                  \
+    int changed = 0;                                                                                                 \
+    uint64_t sum = 0;                                                                                                \
+    for (uint64_t i = begin; i < end; i++){                                                                          \
+        const TYPE * vector = (const TYPE *) points->values + i * dimension;                                         \
+        uint32_t closest = 0;                                                                                        \
+        uint64_t closestDistance = UINT64_MAX;                                                                       \
+        for (uint32_t k = 0; k < K; k++){                                                                            \
+            uint64_t distance = ROW(vector, centroidValues + (uint64_t) k * dimension, dimension);                   \
+            if (distance < closestDistance){                                                                         \
+                closest = k;                                                                                         \
+                closestDistance = distance;                                                                          \
+            }                                                                                                        \
+        }                                                                                                            \
+        uint32_t label = labels_get(labels, i);                                                                      \
+        if (closest != label){                                                                                       \
+            moves_push(moves, i, label);                                                                             \
+            labels_set(labels, i, closest);                                                                          \
+            changed = 1;                                                                                             \
+        }                                                                                                            \
+        labels->counts[closest]++;                                                                                   \
+        sum += closestDistance;                                                                                      \
+    }                                                                                                                \
+    if (distortion != NULL){                                                                                         \
+        *distortion += sum;                                                                                          \
+    }                                                                                                                \
+    return changed;                                                                                                  \
+}
+
+/**
+ * Defines the narrow accumulate and move loops for a type of coordinates and a dimension.
+ *
+ * @param NAME : The suffix of the functions, <type>_<dimension>.
+ * @param TYPE : The type of the coordinates.
+ * @param DIMENSION : An expression giving the dimension, from the matrix <points>.
+ */
+#define DEFINE_NARROW_ACCUMULATE_KERNEL(NAME, TYPE, DIMENSION)                                                       \
+static void accumulate_##NAME(int64_t * sums, const narrow_t * points, const labels_t * labels,                      \
+                              uint64_t begin, uint64_t end)                                                          \
+{                                                                                                                    \
+    const uint32_t dimension = (DIMENSION);                                                                          \
+    for (uint64_t i = begin; i < end; i++){                                                                          \
+        const TYPE * vector = (const TYPE *) points->values + i * dimension;                                         \
+        uint64_t * sum = (uint64_t *) sums + (uint64_t) labels_get(labels, i) * dimension;                           \
+        _Pragma("GCC unroll 16")                                                                                     \
+        for (uint32_t m = 0; m < dimension; m++){                                                                    \
+            sum[m] += (uint64_t) (int64_t) vector[m];                                                                \
+        }                                                                                                            \
+    }                                                                                                                \
+}                                                                                                                    \
+                                                                                                                     \
+static void move_##NAME(int64_t * sums, const narrow_t * points, const labels_t * labels, const moves_t * moves)     \
+{                                                                                                                    \
+    const uint32_t dimension = (DIMENSION);                                                                          \
+    for (uint64_t j = 0; j < moves->size; j++){                                                                      \
+        const TYPE * vector = (const TYPE *) points->values + moves->points[j] * dimension;                          \
+        uint64_t * from = (uint64_t *) sums + (uint64_t) moves->from[j] * dimension;                                 \
+        uint64_t * to = (uint64_t *) sums + (uint64_t) labels_get(labels, moves->points[j]) * dimension;             \
+        _Pragma("GCC unroll 16")                                                                                     \
+        for (uint32_t m = 0; m < dimension; m++){                                                                    \
+            from[m] -= (uint64_t) (int64_t) vector[m];                                                               \
+            to[m] += (uint64_t) (int64_t) vector[m];                                                                 \
+        }                                                                                                            \
+    }                                                                                                                \
+}
+
+/**
+ * Defines all the narrow loops for a dimension, D being the suffix of the functions and ROW the suffix of the rows
+ * (_row for the unrolled ones, _generic_row for those of DISTANCE_KERNELS).
+ */
+#define DEFINE_NARROW_DIMENSION_KERNELS(D, DIMENSION, ROW)                                                           \
+    DEFINE_NARROW_FORMULA_KERNELS(manhattan_int16_##D, manhattan_int16##ROW, int16_t, DIMENSION)                     \
+    DEFINE_NARROW_FORMULA_KERNELS(euclidean_int16_##D, euclidean_int16##ROW, int16_t, DIMENSION)                     \
+    DEFINE_NARROW_FORMULA_KERNELS(manhattan_int16w_##D, manhattan_int16w##ROW, int16_t, DIMENSION)                   \
+    DEFINE_NARROW_FORMULA_KERNELS(euclidean_int16w_##D, euclidean_int16w##ROW, int16_t, DIMENSION)                   \
+    DEFINE_NARROW_FORMULA_KERNELS(manhattan_int32_##D, manhattan_int32##ROW, int32_t, DIMENSION)                     \
+    DEFINE_NARROW_FORMULA_KERNELS(euclidean_int32_##D, euclidean_int32##ROW, int32_t, DIMENSION)                     \
+    DEFINE_NARROW_ACCUMULATE_KERNEL(int16_##D, int16_t, DIMENSION)                                                   \
+    DEFINE_NARROW_ACCUMULATE_KERNEL(int32_##D, int32_t, DIMENSION)
+
+DEFINE_NARROW_DIMENSION_KERNELS(1, 1, _row)
+DEFINE_NARROW_DIMENSION_KERNELS(2, 2, _row)
+DEFINE_NARROW_DIMENSION_KERNELS(3, 3, _row)
+DEFINE_NARROW_DIMENSION_KERNELS(4, 4, _row)
+DEFINE_NARROW_DIMENSION_KERNELS(generic, points->dimension, _generic_row)
+
+/**
+ * The entries of NARROW_KERNELS for a dimension : for each storage (int16_t summed in uint32_t, int16_t summed in
+ * uint64_t, int32_t), the manhattan then the euclidean kernels.
+ */
+#define NARROW_KERNELS_ENTRIES(D)                                                                                    \
+    { "manhattan_int16_" #D, assign_manhattan_int16_##D, accumulate_int16_##D, move_int16_##D },                    \
+    { "euclidean_int16_" #D, assign_euclidean_int16_##D, accumulate_int16_##D, move_int16_##D },                    \
+    { "manhattan_int16w_" #D, assign_manhattan_int16w_##D, accumulate_int16_##D, move_int16_##D },                  \
+    { "euclidean_int16w_" #D, assign_euclidean_int16w_##D, accumulate_int16_##D, move_int16_##D },                  \
+    { "manhattan_int32_" #D, assign_manhattan_int32_##D, accumulate_int32_##D, move_int32_##D },                    \
+    { "euclidean_int32_" #D, assign_euclidean_int32_##D, accumulate_int32_##D, move_int32_##D }
+
+// For each dimension of KERNELS_DIMENSIONS (0 is the generic one), the 6 kernels of NARROW_KERNELS_ENTRIES
+static const narrow_kernels_t NARROW_KERNELS[] = {
+    NARROW_KERNELS_ENTRIES(1),
+    NARROW_KERNELS_ENTRIES(2),
+    NARROW_KERNELS_ENTRIES(3),
+    NARROW_KERNELS_ENTRIES(4),
+    NARROW_KERNELS_ENTRIES(generic),
+};
+
+/**
+ * Selects the narrow loops for a formula and the layout of the narrow points.
+ *
+ * @param formula (squared_distance_func_t) : squared_manhattan_distance or squared_euclidean_distance.
+ * @param layout (const narrow_t *) : The narrow points, or their layout chosen by <narrow_choose>.
+ *
+ * @return (const narrow_kernels_t *) : The loops specialized for the dimension if there are, else the generic ones.
+ */
+const narrow_kernels_t * kernels_selectNarrow(squared_distance_func_t formula, const narrow_t * layout)
+{
+    uint32_t offset = (formula == squared_euclidean_distance) ? 1 : 0;
+    if (layout->width == sizeof(int32_t))
+    {
+        offset += 4;
+    } else if (layout->accumulator == sizeof(uint64_t)) {
+        offset += 2;
+    }
+    uint32_t i = 0;
+    while (KERNELS_DIMENSIONS[i] != 0 && KERNELS_DIMENSIONS[i] != layout->dimension)
+    {
+        i++;
+    }
+    return &NARROW_KERNELS[6 * i + offset];
+}
@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "labels.h"
+#include "dataset.h"
+#include "point.h"
+
+/**
+ * Initialize the labels of size points for K clusters. The width of a label is the smallest one able to hold K-1.
+ * All the points are put in the first cluster.
+ *
+ * @param labels (labels_t *) : The pointer to the structure.
+ * @param size (uint64_t) : The number of points.
+ * @param K (uint32_t) : The number of clusters (K > 0).
+ *
+ * @return int : 0 upon succes else -1.
+ */
+int labels_init(labels_t * labels, uint64_t size, uint32_t K)
+{
+    if (K <= UINT8_MAX + 1)
+    {
+        labels->width = sizeof(uint8_t);
+    } else if (K <= UINT16_MAX + 1) {
+        labels->width = sizeof(uint16_t);
+    } else {
+        labels->width = sizeof(uint32_t);
+    }
+    labels->size = size;
+    labels->K = K;
+
+    labels->counts = (uint64_t *) calloc(K, sizeof(uint64_t));
+    if (labels->counts == NULL){ return -1; }
+
+    // calloc(0, ...) may return NULL
+    labels->array = calloc(size == 0 ? 1 : size, labels->width);
+    if (labels->array == NULL)
+    {
+        free(labels->counts);
+        return -1;
+    }
+    labels->counts[0] = size;
+    return 0;
+}
+
+/**
+ * Write the content of the clusters to the buffer of the output file given in parameter. The points are grouped by
+ * label while they are written, inside a cluster they keep the order of the dataset.
+ *
+ * @param csv (csv_t *) : The writer of the output file.
+ * @param labels (const labels_t *) : The labels of the points.
+ * @param points (const dataset_t *) : The points that have been clustered.
+ *
+ * @return 0 upon success else, -1.
+ */
+int labels_writeClustersToCSV(csv_t * csv, const labels_t * labels, const dataset_t * points)
+{
+    int error = 0;
+    point_t view;
+
+    // Counting sort of the indexes of the points by label
+    uint64_t * order = (uint64_t *) malloc( sizeof(uint64_t) * (labels->size == 0 ? 1 : labels->size) );
+    uint64_t * firstOfCluster = (uint64_t *) malloc( sizeof(uint64_t) * labels->K );
+    if (order == NULL || firstOfCluster == NULL)
+    {
+        free(order);
+        free(firstOfCluster);
+        return -1;
+    }
+    uint64_t position = 0;
+    for (uint32_t k = 0; k < labels->K; k++)
+    {
+        firstOfCluster[k] = position;
+        position += labels->counts[k];
+    }
+    for (uint64_t i = 0; i < labels->size; i++)
+    {
+        order[ firstOfCluster[labels_get(labels, i)]++ ] = i;
+    }
+
+    error += csv_putBytes(csv, "\"[", 2);
+    position = 0;
+    for (uint32_t k = 0; k < labels->K; k++)
+    {
+        error += csv_putBytes(csv, "[", 1);
+        for (uint64_t j = 0; j < labels->counts[k]; j++)
+        {
+            view = dataset_point(points, order[position++]);
+            error += pointToCSV(csv, &view);
+            if (j < labels->counts[k]-1)
+            {
+                error += csv_putBytes(csv, ", ", 2);
+            }
+        }
+        error += csv_putBytes(csv, "]", 1);
+        if (k < labels->K-1)
+        {
+            error += csv_putBytes(csv, ", ", 2);
+        }
+    }
+    error += csv_putBytes(csv, "]\"", 2);
+
+    free(order);
+    free(firstOfCluster);
+    return error < 0 ? -1 : 0 ;
+}
+
+/**
+ * Frees the labels and the counts.
+ *
+ * @param labels (labels_t *) : pointer to the labels.
+ *
+ * Note that it does not free the pointer it's self.
+ */
+void labels_destroy(labels_t * labels)
+{
+    free(labels->array);
+    free(labels->counts);
+    labels->array = NULL;
+    labels->counts = NULL;
+}
+
+/**
+ * Initialize an empty list of moves.
+ *
+ * @param moves (moves_t *) : The pointer to the structure.
+ * @param capacity (uint64_t) : The number of moves that can be recorded.
+ *
+ * @return int : 0 upon succes else -1.
+ */
+int moves_init(moves_t * moves, uint64_t capacity)
+{
+    moves->capacity = capacity;
+    moves->points = (uint64_t *) malloc( sizeof(uint64_t) * (capacity == 0 ? 1 : capacity) );
+    moves->from = (uint32_t *) malloc( sizeof(uint32_t) * (capacity == 0 ? 1 : capacity) );
+    if (moves->points == NULL || moves->from == NULL)
+    {
+        moves_destroy(moves);
+        return -1;
+    }
+    moves_clear(moves);
+    return 0;
+}
+
+/**
+ * Frees the list of moves.
+ *
+ * @param moves (moves_t *) : pointer to the moves.
+ *
+ * Note that it does not free the pointer it's self.
+ */
+void moves_destroy(moves_t * moves)
+{
+    free(moves->points);
+    free(moves->from);
+    moves->points = NULL;
+    moves->from = NULL;
+}
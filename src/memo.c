@@ -0,0 +1,260 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "memo.h"
+#include "dataset.h"
+
+/**
+ * Continues the hash (FNV-1a, one coordinate at a time) of a sequence of coordinates.
+ *
+ * @param hash (uint64_t) : The hash of the coordinates before these ones, 14695981039346656037 for the first ones.
+ * @param values (const int64_t *) : The coordinates.
+ * @param count (uint64_t) : The number of coordinates.
+ *
+ * @return (uint64_t) : The hash of the sequence, these coordinates included.
+ */
+static uint64_t memo_hash(uint64_t hash, const int64_t * values, uint64_t count)
+{
+    for (uint64_t i = 0; i < count; i++)
+    {
+        hash ^= (uint64_t) values[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Returns the hash of the coordinates of the centroids, in their order.
+ */
+static uint64_t memo_hashCentroids(const dataset_t * centroids)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint64_t k = 0; k < centroids->size; k++)
+    {
+        hash = memo_hash(hash, dataset_row(centroids, k), centroids->dimension);
+    }
+    return hash;
+}
+
+/**
+ * Returns true if the centroids are the ones of the state, coordinate for coordinate and in the same order.
+ */
+static bool memo_matches(const int64_t * state, const dataset_t * centroids)
+{
+    for (uint64_t k = 0; k < centroids->size; k++)
+    {
+        if (memcmp(state + k * centroids->dimension, dataset_row(centroids, k), sizeof(int64_t) * centroids->dimension) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Initializes an empty table.
+ *
+ * ATTENTION : Think of freeing it with the specific function <memo_destroy> when done.
+ *
+ * @param memo (memo_t *) : The table.
+ * @param K (uint32_t) : The number of centroids of the runs.
+ * @param dimension (uint32_t) : The dimension of the centroids.
+ * @param budget (uint64_t) : The number of bytes the runs kept may take, MEMO_BUDGET by default.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+int memo_init(memo_t * memo, uint32_t K, uint32_t dimension, uint64_t budget)
+{
+    if (memo == NULL){ return -1; }
+    memset(memo, 0, sizeof(memo_t));
+    memo->K = K;
+    memo->dimension = dimension;
+    memo->budget = budget;
+    memo->buckets = (memo_entry_t **) calloc(MEMO_BUCKETS, sizeof(memo_entry_t *));
+    if (memo->buckets == NULL)
+    {
+        fprintf(stderr, "[memo.c] Failed malloc when initiating the table of the trajectories\n");
+        return -1;
+    }
+    if (pthread_rwlock_init(&memo->lock, NULL) != 0)
+    {
+        fprintf(stderr, "[memo.c] Failed to initiate the lock of the table of the trajectories\n");
+        free(memo->buckets);
+        memo->buckets = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Adds the centroids of an iteration at the end of a trajectory.
+ *
+ * @param trajectory (memo_trajectory_t *) : The trajectory, zeroed before the first iteration.
+ * @param centroids (const dataset_t *) : The centroids of the iteration.
+ *
+ * @return (int) : 0 upon success, else -1 (the trajectory is unchanged).
+ */
+int memo_record(memo_trajectory_t * trajectory, const dataset_t * centroids)
+{
+    uint64_t width = centroids->size * centroids->dimension;
+    if (trajectory->size == trajectory->capacity)
+    {
+        uint64_t capacity = (trajectory->capacity == 0) ? 16 : trajectory->capacity * 2;
+        int64_t * states = (int64_t *) realloc(trajectory->states, sizeof(int64_t) * width * capacity);
+        if (states == NULL){ return -1; }
+        trajectory->states = states;
+        trajectory->capacity = capacity;
+    }
+    int64_t * state = trajectory->states + trajectory->size * width;
+    for (uint64_t k = 0; k < centroids->size; k++)
+    {
+        memcpy(state + k * centroids->dimension, dataset_row(centroids, k), sizeof(int64_t) * centroids->dimension);
+    }
+    trajectory->size++;
+    return 0;
+}
+
+/**
+ * Keeps the trajectory of a finished run, so the runs meeting one of it's centroids can stop there. The centroids
+ * already known are skipped, and the whole trajectory is dropped if the budget of the table is spent.
+ *
+ * @param memo (memo_t *) : The table, NULL to keep nothing.
+ * @param trajectory (const memo_trajectory_t *) : The centroids of the run after it's first iteration.
+ * @param final (const dataset_t *) : The final centroids of the run.
+ * @param iterations (uint64_t) : The number of iterations of the run, the centroids of the trajectory were met from
+ *                                the second one.
+ */
+void memo_insert(memo_t * memo, const memo_trajectory_t * trajectory, const dataset_t * final, uint64_t iterations)
+{
+    if (memo == NULL || trajectory->size == 0){ return; }
+    uint64_t width = (uint64_t) memo->K * memo->dimension;
+    uint64_t block = sizeof(memo_run_t) + trajectory->size * (sizeof(memo_entry_t) + sizeof(int64_t) * width);
+    // The final centroids are counted in the budget too
+    uint64_t bytes = block + sizeof(int64_t) * width;
+
+    // The run is built before taking the lock, only it's entries are linked under it
+    memo_run_t * run = (memo_run_t *) malloc(block);
+    if (run == NULL){ return; }
+    if (dataset_init(&run->final, memo->K, memo->dimension) != 0)
+    {
+        free(run);
+        return;
+    }
+    dataset_copy(&run->final, final);
+    memo_entry_t * entries = (memo_entry_t *) (run + 1);
+    int64_t * states = (int64_t *) (entries + trajectory->size);
+    memcpy(states, trajectory->states, sizeof(int64_t) * width * trajectory->size);
+    for (uint64_t i = 0; i < trajectory->size; i++)
+    {
+        entries[i].state = states + i * width;
+        entries[i].hash = memo_hash(14695981039346656037ULL, entries[i].state, width);
+        entries[i].final = &run->final;
+        entries[i].remaining = (iterations > i + 1) ? iterations - (i + 1) : 1;
+        entries[i].next = NULL;
+    }
+
+    pthread_rwlock_wrlock(&memo->lock);
+    if (memo->used + bytes > memo->budget)
+    {
+        pthread_rwlock_unlock(&memo->lock);
+        dataset_destroy(&run->final);
+        free(run);
+        return;
+    }
+    for (uint64_t i = 0; i < trajectory->size; i++)
+    {
+        memo_entry_t ** bucket = &memo->buckets[entries[i].hash & (MEMO_BUCKETS - 1)];
+        const memo_entry_t * entry = *bucket;
+        while (entry != NULL
+               && (entry->hash != entries[i].hash || memcmp(entry->state, entries[i].state, sizeof(int64_t) * width) != 0))
+        {
+            entry = entry->next;
+        }
+        if (entry != NULL){ continue; }
+        entries[i].next = *bucket;
+        *bucket = &entries[i];
+    }
+    run->next = memo->runs;
+    memo->runs = run;
+    memo->used += bytes;
+    pthread_rwlock_unlock(&memo->lock);
+}
+
+/**
+ * Looks for centroids met by a finished run, in the same order.
+ *
+ * @param memo (memo_t *) : The table.
+ * @param centroids (dataset_t *) : The centroids of an iteration (after the first one). If they are known, they are
+ *                                  replaced by the final centroids of the run that met them.
+ * @param remaining (uint64_t *) : Where to store the number of iterations that run did from them, may be NULL.
+ *
+ * @return (bool) : true if the centroids were known and replaced, else false.
+ */
+bool memo_find(memo_t * memo, dataset_t * centroids, uint64_t * remaining)
+{
+    if (memo == NULL || centroids->size != memo->K || centroids->dimension != memo->dimension){ return false; }
+    uint64_t hash = memo_hashCentroids(centroids);
+    const dataset_t * final = NULL;
+    uint64_t iterations = 0;
+
+    pthread_rwlock_rdlock(&memo->lock);
+    for (const memo_entry_t * entry = memo->buckets[hash & (MEMO_BUCKETS - 1)]; entry != NULL; entry = entry->next)
+    {
+        if (entry->hash == hash && memo_matches(entry->state, centroids))
+        {
+            final = entry->final;
+            iterations = entry->remaining;
+            break;
+        }
+    }
+    pthread_rwlock_unlock(&memo->lock);
+
+    // The runs are only freed with the table, the final centroids stay valid without the lock
+    if (final == NULL){ return false; }
+    dataset_copy(centroids, final);
+    if (remaining != NULL){ *remaining = iterations; }
+    return true;
+}
+
+/**
+ * Frees the centroids of a trajectory.
+ *
+ * @param trajectory (memo_trajectory_t *) : The trajectory.
+ *
+ * Note that it does not free the pointer it's self.
+ */
+void memo_trajectory_destroy(memo_trajectory_t * trajectory)
+{
+    if (trajectory == NULL){ return; }
+    free(trajectory->states);
+    trajectory->states = NULL;
+    trajectory->size = 0;
+    trajectory->capacity = 0;
+}
+
+/**
+ * Frees the runs kept by the table, once no thread uses it anymore.
+ *
+ * @param memo (memo_t *) : The table.
+ *
+ * Note that it does not free the pointer it's self.
+ */
+void memo_destroy(memo_t * memo)
+{
+    if (memo == NULL || memo->buckets == NULL){ return; }
+    while (memo->runs != NULL)
+    {
+        memo_run_t * run = memo->runs;
+        memo->runs = run->next;
+        dataset_destroy(&run->final);
+        free(run);
+    }
+    free(memo->buckets);
+    memo->buckets = NULL;
+    memo->used = 0;
+    pthread_rwlock_destroy(&memo->lock);
+}
@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "minibatch.h"
+#include "dataset.h"
+#include "labels.h"
+#include "kernels.h"
+#include "func.h"
+#include "argumentsparser.h"
+
+/**
+ * Returns the next number of the generator splitmix64.
+ *
+ * @param state (uint64_t *) : The state of the generator, updated.
+ */
+static inline uint64_t minibatch_random(uint64_t * state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Returns the closest integer to a coordinate of a centroid, within the range of int64_t.
+ */
+static inline int64_t minibatch_round(double coordinate)
+{
+    if (coordinate >= 9223372036854775807.0){ return INT64_MAX; }
+    if (coordinate <= -9223372036854775808.0){ return INT64_MIN; }
+    return (int64_t) llround(coordinate);
+}
+
+/**
+ * Rounds the centroids computed with doubles to the integer centroids the points are assigned to.
+ */
+static void minibatch_roundCentroids(dataset_t * centroids, const double * centers)
+{
+    uint64_t length = centroids->size * centroids->dimension;
+    for (uint64_t j = 0; j < length; j++)
+    {
+        centroids->values[j] = minibatch_round(centers[j]);
+    }
+}
+
+/**
+ * Returns the index of the closest centroid to a point, the first one in case of a tie.
+ */
+static uint32_t minibatch_closest(const dataset_t * centroids, const int64_t * vector, const lloyd_kernels_t * kernels)
+{
+    uint32_t closest = 0;
+    uint64_t closestDistance = UINT64_MAX;
+    for (uint32_t k = 0; k < centroids->size; k++)
+    {
+        // Compared as uint64_t like the kernels : the squared distances past INT64_MAX stay ordered
+        uint64_t distance = (uint64_t) kernels->distance(vector, dataset_row(centroids, k), centroids->dimension);
+        if (k == 0 || distance < closestDistance)
+        {
+            closest = k;
+            closestDistance = distance;
+        }
+    }
+    return closest;
+}
+
+/**
+ * Computes approximate clusters with the mini-batch k-means of Sculley : at each iteration, batchSize points are
+ * drawn from the dataset (with replacement) and assigned to their closest centroid, then each centroid moves toward
+ * each of it's points with a learning rate of 1 / (the number of points it has been given since the start).
+ *
+ * The final centroids are rounded to integers and all the points are assigned to them, so the clusters and the
+ * distortion, measured during this last assignment, are exact for these centroids, like the ones of <k_means>.
+ *
+ * @param ptr (list_of_centroids_and_clusters_only *) : Holds the result.
+ * @param initial_centroids (const dataset_t *) : The K initial centroids.
+ * @param K (uint32_t) : The number of clusters wanted.
+ * @param points (const dataset_t *) : The points to cluster.
+ * @param batchSize (uint32_t) : The number of points drawn at each iteration.
+ * @param nbOfBatches (uint32_t) : The number of iterations.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+int minibatch_kmeans(list_of_centroids_and_clusters_only * ptr, const dataset_t * initial_centroids, uint32_t K,
+                     const dataset_t * points, uint32_t batchSize, uint32_t nbOfBatches)
+{
+    const lloyd_kernels_t * kernels = kernels_select(FORMULA_CHOOSED, points->dimension);
+    uint32_t dimension = points->dimension;
+    uint64_t state = MINIBATCH_SEED;
+    int possibleError = 0;
+
+    if (ptr == NULL){ return -1; }
+    if (points->size == 0){ nbOfBatches = 0; }
+
+    // The centroids move by fractions of points, they are kept in doubles between the batches
+    uint64_t length = (uint64_t) K * dimension;
+    double * centers = (double *) malloc( sizeof(double) * (length == 0 ? 1 : length) );
+    uint64_t * seen = (uint64_t *) calloc( K, sizeof(uint64_t) );
+    uint64_t * batch = (uint64_t *) malloc( sizeof(uint64_t) * (batchSize == 0 ? 1 : batchSize) );
+    uint32_t * batchLabels = (uint32_t *) malloc( sizeof(uint32_t) * (batchSize == 0 ? 1 : batchSize) );
+    dataset_t * centroids = (dataset_t *) malloc( sizeof(dataset_t) );
+    labels_t * clusters = (labels_t *) malloc( sizeof(labels_t) );
+    moves_t moves = { NULL, NULL, 0, 0, false };
+    if (centroids != NULL && dataset_init(centroids, K, dimension) != 0)
+    {
+        free(centroids);
+        centroids = NULL;
+    }
+    if (clusters != NULL && labels_init(clusters, points->size, K) != 0)
+    {
+        free(clusters);
+        clusters = NULL;
+    }
+    if (centers == NULL || seen == NULL || batch == NULL || batchLabels == NULL || centroids == NULL
+        || clusters == NULL || moves_init(&moves, 0) != 0)
+    {
+        fprintf(stderr, "[minibatch.c] Failed malloc when initiating the mini-batch k-means\n");
+        possibleError = -1;
+        nbOfBatches = 0;
+    } else {
+        for (uint64_t j = 0; j < length; j++)
+        {
+            centers[j] = (double) initial_centroids->values[j];
+        }
+        dataset_copy(centroids, initial_centroids);
+    }
+
+    for (uint32_t iteration = 0; iteration < nbOfBatches; iteration++)
+    {
+        // All the points of the batch are assigned before any centroid moves
+        for (uint32_t j = 0; j < batchSize; j++)
+        {
+            batch[j] = (uint64_t) (((unsigned __int128) minibatch_random(&state) * points->size) >> 64);
+            batchLabels[j] = minibatch_closest(centroids, dataset_row(points, batch[j]), kernels);
+        }
+        for (uint32_t j = 0; j < batchSize; j++)
+        {
+            const int64_t * vector = dataset_row(points, batch[j]);
+            double * center = centers + (uint64_t) batchLabels[j] * dimension;
+            double rate = 1.0 / (double) (++seen[batchLabels[j]]);
+            for (uint32_t m = 0; m < dimension; m++)
+            {
+                center[m] += rate * ((double) vector[m] - center[m]);
+            }
+        }
+        minibatch_roundCentroids(centroids, centers);
+    }
+
+    if (possibleError == 0)
+    {
+        // All the points start in the first cluster, like in k_means, and are assigned to the final centroids
+        uint64_t distortion = 0;
+        memset(clusters->counts, 0, sizeof(uint64_t) * K);
+        kernels->assign(centroids, points, clusters, &moves, &distortion, 0, points->size);
+        ptr->distortion = (int64_t) distortion;
+        ptr->iterations = nbOfBatches;
+        ptr->finalCentroids = centroids;
+        ptr->finalClusters = clusters;
+    } else {
+        if (centroids != NULL){ dataset_destroy(centroids); }
+        if (clusters != NULL){ labels_destroy(clusters); }
+        free(centroids);
+        free(clusters);
+    }
+    free(centers);
+    free(seen);
+    free(batch);
+    free(batchLabels);
+    moves_destroy(&moves);
+    return possibleError;
+}
@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "narrow.h"
+#include "dataset.h"
+#include "distance.h"
+
+/**
+ * Chooses the narrowest storage of the coordinates of a range, and the width of the accumulator of the distances.
+ * The range is widened to hold 0 : the centroid of an empty cluster is the origin, and the other centroids, being
+ * the truncated means of points, are in the range of the points.
+ *
+ * The distances are summed with uint32_t when the largest possible one fits : dimension * span for the manhattan
+ * formula (squared after the sum, with uint64_t), dimension * span^2 for the euclidean one. Otherwise they are summed
+ * with uint64_t, modulo 2^64 like the int64_t loops. Either way the distances are the same, bit for bit.
+ *
+ * @param narrow (narrow_t *) : Where to store the layout, without any coordinate (values is NULL and size is 0).
+ * @param formula (squared_distance_func_t) : squared_manhattan_distance or squared_euclidean_distance.
+ * @param dimension (uint32_t) : The dimension of the points.
+ * @param minimum (int64_t) : The smallest coordinate of the points.
+ * @param maximum (int64_t) : The largest coordinate of the points.
+ *
+ * @return (bool) : true if the coordinates fit in int32_t, else false and the points must be kept in int64_t.
+ */
+bool narrow_choose(narrow_t * narrow, squared_distance_func_t formula, uint32_t dimension, int64_t minimum,
+                   int64_t maximum)
+{
+    minimum = (minimum < 0) ? minimum : 0;
+    maximum = (maximum > 0) ? maximum : 0;
+    memset(narrow, 0, sizeof(narrow_t));
+    narrow->dimension = dimension;
+    narrow->minimum = minimum;
+    narrow->maximum = maximum;
+
+    if (minimum >= INT16_MIN && maximum <= INT16_MAX)
+    {
+        narrow->width = sizeof(int16_t);
+    } else if (minimum >= INT32_MIN && maximum <= INT32_MAX) {
+        narrow->width = sizeof(int32_t);
+    } else {
+        return false;
+    }
+
+    // The span is below 2^32, it's square times the dimension is below 2^96
+    uint64_t span = (uint64_t) maximum - (uint64_t) minimum;
+    unsigned __int128 largest = (unsigned __int128) dimension * span;
+    if (formula == squared_euclidean_distance){ largest *= span; }
+    // With int32_t coordinates the differences need int64_t, and so does the accumulator
+    narrow->accumulator = (narrow->width == sizeof(int16_t) && largest <= UINT32_MAX) ? sizeof(uint32_t) : sizeof(uint64_t);
+    return true;
+}
+
+/**
+ * Allocates a matrix of size points with the layout of another one.
+ *
+ * ATTENTION : Think of freeing it with the specific function <narrow_destroy> when done.
+ *
+ * @param narrow (narrow_t *) : The matrix to initialize.
+ * @param layout (const narrow_t *) : The layout, chosen by <narrow_choose>.
+ * @param size (uint64_t) : The number of points.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+int narrow_init(narrow_t * narrow, const narrow_t * layout, uint64_t size)
+{
+    *narrow = *layout;
+    narrow->size = size;
+    uint64_t bytes = size * layout->dimension * layout->width;
+    bytes = (bytes + DATASET_ALIGNMENT - 1) / DATASET_ALIGNMENT * DATASET_ALIGNMENT;
+    if (posix_memalign(&narrow->values, DATASET_ALIGNMENT, (bytes == 0) ? DATASET_ALIGNMENT : bytes) != 0)
+    {
+        narrow->values = NULL;
+        fprintf(stderr, "[narrow.c] Failed malloc when initiating the narrow points\n");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Copies the coordinates of a dataset of the same size and dimension in the matrix.
+ *
+ * @param narrow (narrow_t *) : The matrix, initialized by <narrow_init>.
+ * @param dataset (const dataset_t *) : The coordinates to copy.
+ *
+ * @return (int) : 0 upon success, -1 if a coordinate is out of the range of the matrix (it's content is then
+ *                 undefined).
+ */
+int narrow_pack(narrow_t * narrow, const dataset_t * dataset)
+{
+    uint32_t dimension = narrow->dimension;
+    if (dataset->size != narrow->size || dataset->dimension != dimension){ return -1; }
+    for (uint64_t i = 0; i < dataset->size; i++)
+    {
+        const int64_t * vector = dataset_row(dataset, i);
+        for (uint32_t m = 0; m < dimension; m++)
+        {
+            if (vector[m] < narrow->minimum || vector[m] > narrow->maximum){ return -1; }
+        }
+        if (narrow->width == sizeof(int16_t))
+        {
+            int16_t * row = (int16_t *) narrow->values + i * dimension;
+            for (uint32_t m = 0; m < dimension; m++){ row[m] = (int16_t) vector[m]; }
+        } else {
+            int32_t * row = (int32_t *) narrow->values + i * dimension;
+            for (uint32_t m = 0; m < dimension; m++){ row[m] = (int32_t) vector[m]; }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Frees the matrix.
+ *
+ * @param narrow (narrow_t *) : The matrix.
+ *
+ * Note that it does not free the pointer it's self.
+ */
+void narrow_destroy(narrow_t * narrow)
+{
+    if (narrow == NULL){ return; }
+    free(narrow->values);
+    narrow->values = NULL;
+    narrow->size = 0;
+}
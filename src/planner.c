@@ -0,0 +1,194 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <sched.h>
+#include <sys/sysinfo.h>
+
+#include "planner.h"
+#include "argumentsparser.h"
+#include "combinator.h"
+#include "func.h"
+#include "yinyang.h"
+
+/**
+ * The files holding the quota of the cgroup of the process : "<quota> <period>" or "max <period>" in the version 2,
+ * the quota (-1 without one) and the period in microseconds in two files in the version 1.
+ */
+#define PLANNER_CGROUP2_MAX "/sys/fs/cgroup/cpu.max"
+#define PLANNER_CGROUP1_QUOTA "/sys/fs/cgroup/cpu/cpu.cfs_quota_us"
+#define PLANNER_CGROUP1_PERIOD "/sys/fs/cgroup/cpu/cpu.cfs_period_us"
+
+/**
+ * Reads the quota of the cgroup of the process.
+ *
+ * @return (double) : The quota in cpus, 0 without one.
+ */
+static double planner_quota()
+{
+    long long quota = -1;
+    long long period = 0;
+    char word[32];
+    FILE * file = fopen(PLANNER_CGROUP2_MAX, "r");
+    if (file != NULL)
+    {
+        if (fscanf(file, "%31s %lld", word, &period) == 2 && strcmp(word, "max") != 0){ quota = atoll(word); }
+        fclose(file);
+    } else {
+        file = fopen(PLANNER_CGROUP1_QUOTA, "r");
+        if (file != NULL)
+        {
+            if (fscanf(file, "%lld", &quota) != 1){ quota = -1; }
+            fclose(file);
+        }
+        file = fopen(PLANNER_CGROUP1_PERIOD, "r");
+        if (file != NULL)
+        {
+            if (fscanf(file, "%lld", &period) != 1){ period = 0; }
+            fclose(file);
+        }
+    }
+    return (quota > 0 && period > 0) ? (double) quota / (double) period : 0;
+}
+
+/**
+ * Reads what the machine gives the process : the cpus it may run on, the quota of it's cgroup and the free memory.
+ * Until <planner_plan>, the number of workers is the number of cpus (or -n).
+ *
+ * @param plan (plan_t *) : The plan.
+ */
+void planner_init(plan_t * plan)
+{
+    memset(plan, 0, sizeof(plan_t));
+    cpu_set_t set;
+    int cpus = (sched_getaffinity(0, sizeof(cpu_set_t), &set) == 0) ? CPU_COUNT(&set) : get_nprocs();
+    plan->cpus = (cpus > 0) ? (uint32_t) cpus : 1;
+    plan->quota = planner_quota();
+    if (plan->quota > 0 && plan->quota < plan->cpus)
+    {
+        // A quota of 1.5 cpus still lets two threads run half of the time
+        plan->cpus = (uint32_t) plan->quota + ((plan->quota > (uint32_t) plan->quota) ? 1 : 0);
+    }
+    struct sysinfo info;
+    if (sysinfo(&info) == 0)
+    {
+        plan->memory = ((uint64_t) info.freeram + info.bufferram) * info.mem_unit / PLANNER_MEMORY_SHARE;
+    } else {
+        plan->memory = UINT64_MAX;
+    }
+    plan->workers = plan->cpus;
+}
+
+/**
+ * Returns about the memory taken by a run in flight : it's labels, it's centroids and sums, and the bounds of the
+ * accelerated assignments.
+ */
+static uint64_t planner_bytesPerRun(const args_t * args, uint64_t size, uint32_t dimension)
+{
+    uint64_t k = args->k;
+    uint64_t bytes = size * sizeof(uint32_t) + 4 * k * dimension * sizeof(int64_t);
+    switch (args->algorithm)
+    {
+        case KMEANS_ELKAN:
+            bytes += size * (k + 1) * sizeof(int64_t) + k * k * sizeof(int64_t);
+            break;
+        case KMEANS_HAMERLY:
+            bytes += size * 2 * sizeof(int64_t);
+            break;
+        case KMEANS_YINYANG:
+            bytes += size * ((k + YINYANG_GROUP_SIZE - 1) / YINYANG_GROUP_SIZE + 1) * sizeof(int64_t);
+            break;
+        case KMEANS_MINIBATCH:
+            bytes += (uint64_t) args->batch_size * (sizeof(uint32_t) + sizeof(uint64_t));
+            break;
+        default:
+            break;
+    }
+    return bytes;
+}
+
+/**
+ * Decides how the runs share the calculating threads, from the cpus and the memory read by <planner_init>, the size
+ * of the input and the arguments.
+ *
+ *  - The runs in flight are bounded by the cpus, the number of runs and the memory their labels and bounds take.
+ *  - An iteration of Lloyd is split in up to one part per cpu, each part being worth waking a thread for (see
+ *    LLOYD_WORK_PER_MEMBER), the other algorithms are not split.
+ *  - Without -n, there are as many calculating threads as the runs in flight and their parts can use.
+ *  - The combinations are claimed by batches shared between the runs in flight, and a few results per run in flight
+ *    are queued for the output-writer thread, as long as the memory holds their labels.
+ *
+ * @param plan (plan_t *) : The plan, initialized by <planner_init>.
+ * @param args (const args_t *) : The arguments of the program, with -n (n_threads) 0 if not given.
+ * @param size (uint64_t) : The number of points.
+ * @param dimension (uint32_t) : The dimension of the points.
+ */
+void planner_plan(plan_t * plan, const args_t * args, uint64_t size, uint32_t dimension)
+{
+    plan->given = args->n_threads > 0;
+    uint32_t workers = plan->given ? args->n_threads : plan->cpus;
+    plan->runs = combinator_count(args->n_first_initialization_points, args->k);
+
+    uint64_t perRun = planner_bytesPerRun(args, size, dimension);
+    uint64_t inter = plan->memory / ((perRun == 0) ? 1 : perRun);
+    inter = (inter < 1) ? 1 : inter;
+    inter = (inter < plan->runs) ? inter : plan->runs;
+    inter = (inter < workers) ? inter : workers;
+    plan->inter = (inter < 1) ? 1 : (uint32_t) inter;
+
+    uint64_t intra = 1;
+    if (args->algorithm == KMEANS_LLOYD && !args->stream)
+    {
+        intra = size * args->k * dimension / LLOYD_WORK_PER_MEMBER;
+        intra = (intra < 1) ? 1 : intra;
+        intra = (intra < workers) ? intra : workers;
+    }
+    plan->intra = (uint32_t) intra;
+
+    if (plan->given)
+    {
+        plan->workers = workers;
+    } else {
+        // More threads than the runs in flight and their parts would have nothing to do
+        uint64_t useful = (uint64_t) plan->inter * plan->intra;
+        plan->workers = (useful < workers) ? (uint32_t) useful : workers;
+    }
+
+    combinator_t combinator;
+    combinator_init(&combinator, args->n_first_initialization_points, args->k, plan->inter);
+    plan->batch = combinator.batch;
+
+    // With -t the results are kept by the calculating threads, the queue stays empty
+    uint64_t queue = (args->top > 0) ? 2 : (uint64_t) PLANNER_QUEUE_PER_RUN * plan->inter;
+    uint64_t perResult = 2 * (uint64_t) args->k * dimension * sizeof(int64_t)
+                         + (args->quiet ? 0 : size * sizeof(uint32_t));
+    uint64_t left = (plan->memory > perRun * plan->inter) ? plan->memory - perRun * plan->inter : 0;
+    uint64_t fits = left / ((perResult == 0) ? 1 : perResult);
+    queue = (queue < fits) ? queue : fits;
+    queue = (queue < 2) ? 2 : queue;
+    plan->queue = (queue > UINT32_MAX / 2) ? UINT32_MAX / 2 : (uint32_t) queue;
+}
+
+/**
+ * Writes the decision of the planner and what it's based on.
+ *
+ * @param plan (const plan_t *) : The plan, decided by <planner_plan>.
+ * @param args (const args_t *) : The arguments of the program.
+ * @param size (uint64_t) : The number of points.
+ * @param dimension (uint32_t) : The dimension of the points.
+ * @param file (FILE *) : Where to write it.
+ */
+void planner_log(const plan_t * plan, const args_t * args, uint64_t size, uint32_t dimension, FILE * file)
+{
+    char quota[48] = "no quota";
+    if (plan->quota > 0){ snprintf(quota, sizeof(quota), "quota of %.2f cpus", plan->quota); }
+    fprintf(file, "[planner.c] %"PRIu32" cpus (%s), %"PRIu64" points of dimension %"PRIu32", k = %"PRIu32", %"PRIu64" runs : "
+                  "%"PRIu32" calculating threads (%s), %"PRIu32" runs at once split in up to %"PRIu32" parts, batches of "
+                  "%"PRIu64" combinations, %"PRIu32" results queued\n",
+            plan->cpus, quota, size, dimension, args->k, plan->runs, plan->workers, plan->given ? "-n" : "planned",
+            plan->inter, plan->intra, plan->batch, plan->queue);
+}
@@ -5,26 +5,31 @@
 
 #include "point.h"
 #include "distance.h"
+#include "csv.h"
 
 /**
- * Prints the representation to opened file gave in parameter.
+ * Adds the representation of the point to the buffer of the output file, "(x, y, z)".
  * 
- * @param file (FILE *) : Opened fike.
- * @param point (point_t *) : The point strcuture to write.
+ * @param csv (csv_t *) : The writer of the output file.
+ * @param point (const point_t *) : The point strcuture to write.
  * 
- * @return int. 0 upon success else negative integer.
+ * @return int. 0 upon success else -1.
  */
-int pointToFILE(FILE * file, point_t * point){
-    int error = 0;
-    error += fprintf(file, "(") < 0 ? 0 : -1 ; 
-    for (size_t i = 0; i < point->dimension; i++)
+int pointToCSV(csv_t * csv, const point_t * point){
+    // The parenthesis, and each coordinate followed by ", " at most
+    char * c = csv_reserve(csv, 2 + (size_t) point->dimension * (CSV_INT64_LENGTH + 2));
+    if (c == NULL){ return -1; }
+    *c++ = '(';
+    for (uint32_t i = 0; i < point->dimension; i++)
     {
-        error += fprintf(file, "%lld",(long long int) point->values[i]);
+        c = csv_formatInt64(c, point->values[i]);
         if (i < point->dimension-1)
         {
-            error += fprintf(file, ", ") < 0 ? 0 : -1 ; 
+            *c++ = ',';
+            *c++ = ' ';
         }
     }
-    error += fprintf(file, ")") < 0 ? 0 : -1 ; 
-    return error;
-}
\ No newline at end of file
+    *c++ = ')';
+    csv_commit(csv, c);
+    return 0;
+}
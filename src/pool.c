@@ -0,0 +1,333 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "pool.h"
+#include "team.h"
+
+/**
+ * The argument of a worker thread.
+ *
+ * @param pool (pool_t *) : The pool of the worker.
+ * @param worker (uint32_t) : The index of the worker.
+ * @param work (pool_work_t) : The work of the workers.
+ * @param arg (void *) : The argument of the work.
+ */
+typedef struct {
+    pool_t * pool;
+    uint32_t worker;
+    pool_work_t work;
+    void * arg;
+} pool_worker_t;
+
+/**
+ * Sleeps until the word is woken up, unless it's not the value seen anymore.
+ */
+static void pool_wait(uint32_t * word, uint32_t seen)
+{
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, seen, NULL, NULL, 0);
+}
+
+/**
+ * Wakes up to count threads waiting on the word.
+ */
+static void pool_wake(uint32_t * word, int count)
+{
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+/**
+ * Tells the idle workers that there's something new : tasks to steal, or no work left.
+ */
+static void pool_signal(pool_t * pool, int count)
+{
+    __atomic_fetch_add(&pool->events, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&pool->idle, __ATOMIC_SEQ_CST) > 0){ pool_wake(&pool->events, count); }
+}
+
+/**
+ * Pushes a task at the bottom of the deque of it's owner.
+ *
+ * @return (bool) : true upon success, false if the deque is full.
+ */
+static bool pool_push(pool_deque_t * deque, pool_task_t * task)
+{
+    int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+    int64_t top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    if (bottom - top >= POOL_DEQUE_SIZE){ return false; }
+    __atomic_store_n(&deque->tasks[bottom & (POOL_DEQUE_SIZE - 1)], task, __ATOMIC_RELAXED);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * Pops the last task pushed in the deque, by it's owner.
+ *
+ * @return (pool_task_t *) : The task, NULL if the deque is empty or the last task was stolen.
+ */
+static pool_task_t * pool_pop(pool_deque_t * deque)
+{
+    int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+    if (top > bottom)
+    {
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    pool_task_t * task = __atomic_load_n(&deque->tasks[bottom & (POOL_DEQUE_SIZE - 1)], __ATOMIC_RELAXED);
+    if (top == bottom)
+    {
+        // The last task : the thieves may want it too
+        if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        {
+            task = NULL;
+        }
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    }
+    return task;
+}
+
+/**
+ * Steals the first task pushed in a deque, by another worker.
+ *
+ * @return (pool_task_t *) : The task, NULL if the deque is empty or another thief was faster.
+ */
+static pool_task_t * pool_steal(pool_deque_t * deque)
+{
+    int64_t top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+    if (top >= bottom){ return NULL; }
+    pool_task_t * task = __atomic_load_n(&deque->tasks[top & (POOL_DEQUE_SIZE - 1)], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+    {
+        return NULL;
+    }
+    return task;
+}
+
+/**
+ * Runs a task and tells the worker waiting for it's job when it was the last part.
+ */
+static void pool_runTask(pool_task_t * task)
+{
+    uint32_t * pending = task->pending;
+    task->job(task->arg, task->member, task->nbOfMembers);
+    // The task lives on the stack of the waiting worker, it's not read past this point
+    if (__atomic_sub_fetch(pending, 1, __ATOMIC_ACQ_REL) == 0){ pool_wake(pending, 1); }
+}
+
+/**
+ * Steals a task from the deques of the other workers, starting with the next one.
+ *
+ * @return (pool_task_t *) : The task, NULL if there was none.
+ */
+static pool_task_t * pool_stealAny(pool_t * pool, uint32_t worker)
+{
+    for (uint32_t i = 1; i < pool->size; i++)
+    {
+        pool_task_t * task = pool_steal(&pool->deques[(worker + i) % pool->size]);
+        if (task != NULL){ return task; }
+    }
+    return NULL;
+}
+
+/**
+ * Runs a job in nbOfMembers parts, the calling worker being the part 0, and returns when all of them are done. The
+ * other parts are pushed in the deque of the worker : it runs the ones that are not stolen, then helps the others
+ * (their tasks) until the stolen parts are done.
+ *
+ * @param pool (pool_t *) : The pool.
+ * @param worker (uint32_t) : The calling worker.
+ * @param nbOfMembers (uint32_t) : The number of parts of the job.
+ * @param job (team_job_t) : The job.
+ * @param arg (void *) : The argument given to the job.
+ */
+void pool_split(pool_t * pool, uint32_t worker, uint32_t nbOfMembers, team_job_t job, void * arg)
+{
+    if (nbOfMembers <= 1)
+    {
+        job(arg, 0, 1);
+        return;
+    }
+    pool_deque_t * deque = &pool->deques[worker];
+    pool_task_t tasks[nbOfMembers];
+    uint32_t pending = nbOfMembers - 1;
+    uint32_t pushed = 0;
+    // The thieves take the last parts first, the worker the first ones
+    for (uint32_t member = nbOfMembers - 1; member >= 1; member--)
+    {
+        tasks[member] = (pool_task_t) { job, arg, member, nbOfMembers, &pending };
+        if (pool_push(deque, &tasks[member]))
+        {
+            pushed++;
+        } else {
+            pool_runTask(&tasks[member]);
+        }
+    }
+    if (pushed > 0){ pool_signal(pool, (int) pushed); }
+
+    job(arg, 0, nbOfMembers);
+    pool_task_t * task;
+    while ((task = pool_pop(deque)) != NULL){ pool_runTask(task); }
+    uint32_t seen;
+    while ((seen = __atomic_load_n(&pending, __ATOMIC_ACQUIRE)) > 0)
+    {
+        task = pool_stealAny(pool, worker);
+        if (task != NULL)
+        {
+            pool_runTask(task);
+        } else {
+            pool_wait(&pending, seen);
+        }
+    }
+}
+
+/**
+ * The function run by the worker threads : the work of the worker, then the tasks of the others until all the works
+ * are done.
+ *
+ * @param argT (void *) : A (pool_worker_t *) pointer, freed by the worker.
+ *
+ * @return (void *) NULL.
+ */
+static void * pool_workerFunction(void * argT)
+{
+    pool_worker_t * worker = (pool_worker_t *) argT;
+    pool_t * pool = worker->pool;
+    uint32_t index = worker->worker;
+    worker->work(worker->arg, &pool->teams[index]);
+    free(worker);
+
+    if (__atomic_sub_fetch(&pool->working, 1, __ATOMIC_SEQ_CST) == 0){ pool_signal(pool, INT_MAX); }
+    while (true)
+    {
+        pool_task_t * task = pool_stealAny(pool, index);
+        if (task != NULL)
+        {
+            pool_runTask(task);
+            continue;
+        }
+        if (__atomic_load_n(&pool->working, __ATOMIC_SEQ_CST) == 0){ break; }
+        // The counter is read before trying again, so a push in between makes the wait return at once
+        uint32_t seen = __atomic_load_n(&pool->events, __ATOMIC_SEQ_CST);
+        __atomic_fetch_add(&pool->idle, 1, __ATOMIC_SEQ_CST);
+        task = pool_stealAny(pool, index);
+        if (task == NULL && __atomic_load_n(&pool->working, __ATOMIC_SEQ_CST) > 0)
+        {
+            pool_wait(&pool->events, seen);
+        }
+        __atomic_fetch_sub(&pool->idle, 1, __ATOMIC_SEQ_CST);
+        if (task != NULL){ pool_runTask(task); }
+    }
+    return NULL;
+}
+
+/**
+ * Initializes a pool of size workers, their deques and their teams. The jobs of a worker are split in up to parts
+ * tasks.
+ *
+ * ATTENTION : Think of freeing it with the specific function <pool_destroy> when done.
+ *
+ * @param pool (pool_t *) : The pool.
+ * @param size (uint32_t) : The number of workers (size > 0).
+ * @param parts (uint32_t) : The largest number of parts of a job, the size of the teams (at most size, at least 1).
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+int pool_init(pool_t * pool, uint32_t size, uint32_t parts)
+{
+    if (pool == NULL){ return -1; }
+    memset(pool, 0, sizeof(pool_t));
+    if (size == 0){ return -1; }
+    pool->size = size;
+    pool->teams = (team_t *) calloc(size, sizeof(team_t));
+    pool->threads = (pthread_t *) malloc( sizeof(pthread_t) * size );
+    if (posix_memalign((void **) &pool->deques, TEAM_CACHE_LINE, sizeof(pool_deque_t) * size) != 0)
+    {
+        pool->deques = NULL;
+    }
+    if (pool->teams == NULL || pool->threads == NULL || pool->deques == NULL)
+    {
+        fprintf(stderr, "[pool.c] Failed malloc when initiating the pool of workers\n");
+        pool_destroy(pool);
+        return -1;
+    }
+    memset(pool->deques, 0, sizeof(pool_deque_t) * size);
+    parts = (parts < 1) ? 1 : ((parts > size) ? size : parts);
+    for (uint32_t i = 0; i < size; i++)
+    {
+        // The team of a worker has no helper of it's own, it's jobs go to the pool
+        pool->teams[i].size = parts;
+        pool->teams[i].pool = pool;
+        pool->teams[i].worker = i;
+    }
+    return 0;
+}
+
+/**
+ * Starts the workers on their work and returns once all of them are done. If some workers cannot be started, the
+ * work is done by the others.
+ *
+ * @param pool (pool_t *) : The pool.
+ * @param work (pool_work_t) : The work of each worker.
+ * @param arg (void *) : The argument given to the work.
+ *
+ * @return (int) : 0 upon success, else -1 (no worker could be started).
+ */
+int pool_run(pool_t * pool, pool_work_t work, void * arg)
+{
+    uint32_t started = 0;
+    __atomic_store_n(&pool->working, pool->size, __ATOMIC_SEQ_CST);
+    for (uint32_t i = 0; i < pool->size; i++)
+    {
+        pool_worker_t * worker = (pool_worker_t *) malloc( sizeof(pool_worker_t) );
+        if (worker != NULL){ *worker = (pool_worker_t) { pool, i, work, arg }; }
+        if (worker == NULL || pthread_create(&pool->threads[i], NULL, &pool_workerFunction, worker) != 0)
+        {
+            free(worker);
+            fprintf(stderr, "[pool.c] Warning -- could only start %u workers\n", started);
+            break;
+        }
+        started++;
+    }
+    // The workers not started have no work to finish
+    if (started < pool->size
+        && __atomic_sub_fetch(&pool->working, pool->size - started, __ATOMIC_SEQ_CST) == 0)
+    {
+        pool_signal(pool, INT_MAX);
+    }
+    for (uint32_t i = 0; i < started; i++)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+    return (started == 0) ? -1 : 0;
+}
+
+/**
+ * Frees the deques and the teams of the pool, once <pool_run> has returned.
+ *
+ * @param pool (pool_t *) : The pool.
+ *
+ * Note that it does not free the pointer it's self.
+ */
+void pool_destroy(pool_t * pool)
+{
+    if (pool == NULL){ return; }
+    free(pool->teams);
+    free(pool->threads);
+    free(pool->deques);
+    pool->teams = NULL;
+    pool->threads = NULL;
+    pool->deques = NULL;
+    pool->size = 0;
+}
@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "team.h"
+#include "pool.h"
+
+/**
+ * The argument of a helper thread.
+ *
+ * @param team (team_t *) : The team of the helper.
+ * @param member (uint32_t) : The index of the helper in the team (at least 1).
+ */
+typedef struct {
+    team_t * team;
+    uint32_t member;
+} team_helper_t;
+
+/**
+ * The function run by the helper threads : waits for a job, runs it if the member takes part in it, tells the owner
+ * when the last helper is done, and starts again until the team is destroyed.
+ *
+ * @param argT (void *) : A (team_helper_t *) pointer, freed by the helper.
+ *
+ * @return (void *) NULL.
+ */
+static void * team_helperFunction(void * argT)
+{
+    team_helper_t * helper = (team_helper_t *) argT;
+    team_t * team = helper->team;
+    uint32_t member = helper->member;
+    uint64_t generation = 0;
+    free(helper);
+
+    pthread_mutex_lock(&team->mutex);
+    while (true)
+    {
+        while (!team->stop && team->generation == generation)
+        {
+            pthread_cond_wait(&team->start, &team->mutex);
+        }
+        if (team->stop){ break; }
+        generation = team->generation;
+        team_job_t job = team->job;
+        void * arg = team->arg;
+        uint32_t nbOfMembers = team->nbOfMembers;
+        pthread_mutex_unlock(&team->mutex);
+
+        if (member < nbOfMembers){ job(arg, member, nbOfMembers); }
+
+        pthread_mutex_lock(&team->mutex);
+        team->pending--;
+        if (team->pending == 0){ pthread_cond_signal(&team->done); }
+    }
+    pthread_mutex_unlock(&team->mutex);
+    return NULL;
+}
+
+/**
+ * Initializes a team of size members and starts it's size - 1 helper threads. If some helpers cannot be started, the
+ * team is only made of the ones that could.
+ *
+ * ATTENTION : Think of stopping the helpers with <team_destroy> when done.
+ *
+ * @param team (team_t *) : The team.
+ * @param size (uint32_t) : The number of members wanted, the calling thread included (size > 0).
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+int team_init(team_t * team, uint32_t size)
+{
+    if (team == NULL || size == 0){ return -1; }
+    team->size = 1;
+    team->nbOfThreads = 0;
+    team->generation = 0;
+    team->pending = 0;
+    team->nbOfMembers = 0;
+    team->job = NULL;
+    team->arg = NULL;
+    team->stop = false;
+    team->threads = NULL;
+    team->pool = NULL;
+    team->worker = 0;
+
+    if (pthread_mutex_init(&team->mutex, NULL) != 0)
+    {
+        fprintf(stderr, "[team.c] Couldn't initiate the mutex of the team\n");
+        return -1;
+    }
+    if (pthread_cond_init(&team->start, NULL) != 0)
+    {
+        pthread_mutex_destroy(&team->mutex);
+        fprintf(stderr, "[team.c] Couldn't initiate the condition of the team\n");
+        return -1;
+    }
+    if (pthread_cond_init(&team->done, NULL) != 0)
+    {
+        pthread_cond_destroy(&team->start);
+        pthread_mutex_destroy(&team->mutex);
+        fprintf(stderr, "[team.c] Couldn't initiate the condition of the team\n");
+        return -1;
+    }
+    if (size == 1){ return 0; }
+
+    team->threads = (pthread_t *) malloc( sizeof(pthread_t) * (size - 1) );
+    if (team->threads == NULL)
+    {
+        fprintf(stderr, "[team.c] Warning -- failed malloc for the helper threads, the team works alone\n");
+        return 0;
+    }
+    for (uint32_t member = 1; member < size; member++)
+    {
+        team_helper_t * helper = (team_helper_t *) malloc( sizeof(team_helper_t) );
+        if (helper != NULL)
+        {
+            helper->team = team;
+            helper->member = member;
+        }
+        if (helper == NULL || pthread_create(&team->threads[team->nbOfThreads], NULL, &team_helperFunction, helper) != 0)
+        {
+            free(helper);
+            fprintf(stderr, "[team.c] Warning -- could only start %u helper threads\n", team->nbOfThreads);
+            break;
+        }
+        team->nbOfThreads++;
+    }
+    team->size = team->nbOfThreads + 1;
+    return 0;
+}
+
+/**
+ * Runs a job on the nbOfMembers first members of the team, the calling thread being the member 0, and returns when
+ * all of them are done. With one member, the job is simply called. The team of a worker of a pool gives the parts
+ * to the pool instead (see <pool_split>).
+ *
+ * @param team (team_t *) : The team, NULL to run the job alone.
+ * @param nbOfMembers (uint32_t) : The number of members taking part in the job, at most the size of the team.
+ * @param job (team_job_t) : The job.
+ * @param arg (void *) : The argument given to the job.
+ */
+void team_run(team_t * team, uint32_t nbOfMembers, team_job_t job, void * arg)
+{
+    if (team != NULL && team->pool != NULL && nbOfMembers > 1)
+    {
+        pool_split(team->pool, team->worker, (nbOfMembers > team->size) ? team->size : nbOfMembers, job, arg);
+        return;
+    }
+    if (team == NULL || team->nbOfThreads == 0 || nbOfMembers <= 1)
+    {
+        job(arg, 0, 1);
+        return;
+    }
+    if (nbOfMembers > team->size){ nbOfMembers = team->size; }
+
+    pthread_mutex_lock(&team->mutex);
+    team->job = job;
+    team->arg = arg;
+    team->nbOfMembers = nbOfMembers;
+    team->pending = team->nbOfThreads;
+    team->generation++;
+    pthread_cond_broadcast(&team->start);
+    pthread_mutex_unlock(&team->mutex);
+
+    job(arg, 0, nbOfMembers);
+
+    pthread_mutex_lock(&team->mutex);
+    while (team->pending > 0)
+    {
+        pthread_cond_wait(&team->done, &team->mutex);
+    }
+    pthread_mutex_unlock(&team->mutex);
+}
+
+/**
+ * Stops the helper threads of the team and frees it's resources.
+ *
+ * @param team (team_t *) : The team initialized by <team_init>, may be NULL.
+ */
+void team_destroy(team_t * team)
+{
+    if (team == NULL){ return; }
+    pthread_mutex_lock(&team->mutex);
+    team->stop = true;
+    pthread_cond_broadcast(&team->start);
+    pthread_mutex_unlock(&team->mutex);
+
+    for (uint32_t i = 0; i < team->nbOfThreads; i++)
+    {
+        pthread_join(team->threads[i], NULL);
+    }
+    free(team->threads);
+    team->threads = NULL;
+    team->nbOfThreads = 0;
+    team->size = 1;
+    pthread_cond_destroy(&team->done);
+    pthread_cond_destroy(&team->start);
+    pthread_mutex_destroy(&team->mutex);
+}
@@ -11,86 +11,185 @@
 #include <semaphore.h>
 
 #include "threadshandler.h"
+#include "minibatch.h"
+#include "narrow.h"
+#include "memo.h"
+#include "candidates.h"
+#include "kernels.h"
+#include "combinator.h"
+#include "best.h"
+#include "pool.h"
+#include "affinity.h"
+#include "planner.h"
 
 /** 
  * It's structure of arguments given to the function to be executed by a thread calculating thread.
  * 
  * @param inputFile (file_t *) : The structure representing the input binary file.
  * @param programArgs (args_t *) : A structure containing the user input arguments.
- * @param read_buffer (circular_buf *) : A circular buffer in which to fetch initial centroids.
+ * @param combinator (combinator_t *) : The combinations of initial centroids, claimed by the calculating threads.
  * @param write_buffer (circular_buf *) : A circular buffer in which the string representations of the final clusers and centroids will be stored.
+ * @param tree (const kdtree_t *) : The kd-tree of the points, shared by all the calculating threads, NULL if not used.
+ * @param narrowPoints (const narrow_t *) : The narrow copy of the points, shared by all the calculating threads, NULL
+ *                                         if not used.
+ * @param candidates (const candidates_t *) : The distances between the points and the candidates to the initial
+ *                                           centroids, shared by all the calculating threads, NULL if not used.
+ * @param memo (memo_t *) : The trajectories of the finished runs, shared by all the calculating threads, NULL if not
+ *                          used.
+ * @param best (best_t *) : The best results, each calculating thread keeping it's own in a shard, NULL to give every
+ *                          result to the output-writer thread.
+ * @param affinity (affinity_t *) : The cpus the calculating threads are pinned on, NULL if they are not.
+ * @param replicas (const affinity_replicas_t *) : The copies of the points placed on the NUMA nodes, a calculating
+ *                                                 thread reading the one of it's node, NULL to read the input file.
+ * @param nbOfRunners (uint32_t) : The number of calculating threads claiming combinations, the others only take parts
+ *                                 of their runs.
  *
  */ 
 typedef struct {
     file_t * inputFile;
     args_t * programArgs;
-    circular_buf * read_buffer;
+    combinator_t * combinator;
     circular_buf * writer_buffer;
+    const kdtree_t * tree;
+    const narrow_t * narrowPoints;
+    const candidates_t * candidates;
+    memo_t * memo;
+    best_t * best;
+    affinity_t * affinity;
+    const affinity_replicas_t * replicas;
+    uint32_t nbOfRunners;
 } calculation_thread_arguments_t ;
 
+/**
+ * Runs k-means from the initial centroids of a combination and gives the result to the output-writer thread, or to
+ * the shard of the best results of the calculating thread.
+ *
+ * @param args (calculation_thread_arguments_t *) : The arguments of the calculating thread.
+ * @param team (team_t *) : The team of the calculating thread.
+ * @param shard (best_shard_t *) : The shard of the best results of the calculating thread, NULL if they are not kept.
+ * @param points (const dataset_t *) : The points read by the calculating thread.
+ * @param narrowPoints (const narrow_t *) : Their narrow copy, NULL if not used.
+ * @param indexes (const uint32_t *) : The indexes of the points of the combination.
+ * @param rank (uint64_t) : The rank of the combination.
+ *
+ * @return (int) : 0 upon success, else -1.
+ */
+static int runCombination(calculation_thread_arguments_t * args, team_t * team, best_shard_t * shard,
+                          const dataset_t * points, const narrow_t * narrowPoints, const uint32_t * indexes,
+                          uint64_t rank)
+{
+    int possibleError = 0;
+    int booleanToUseInPut;
+    list_of_centroids_and_clusters_only answerFromKeams;
+    dataset_t * centroids = combinator_centroids(points, args->programArgs->k, indexes);
+    if (centroids == NULL){ return -1; }
+
+    if (args->inputFile->streamed)
+    {
+        possibleError = k_means_streamed(&answerFromKeams, centroids, args->programArgs->k, args->inputFile,
+                                         !args->programArgs->quiet);
+    } else if (args->programArgs->algorithm == KMEANS_MINIBATCH) {
+        possibleError = minibatch_kmeans(&answerFromKeams, centroids, args->programArgs->k, points,
+                                         args->programArgs->batch_size, args->programArgs->batch_iterations);
+    } else {
+        possibleError = k_means(&answerFromKeams, centroids, args->programArgs->k, points,
+                                args->programArgs->algorithm, team, args->tree, narrowPoints,
+                                args->candidates, args->memo);
+    }
+    if (possibleError != 0)
+    {
+        fprintf(stderr, "[threadshandler.c] An error occured in kmeans function.\n");
+        dataset_destroy(centroids);
+        free(centroids);
+        return -1;
+    }
+    calculation_result_holder * tempHolder = (calculation_result_holder * ) malloc( sizeof(calculation_result_holder));
+    if (tempHolder == NULL)
+    {
+        fprintf(stderr, "[threadshandler.c] Failed malloc for the result of a run\n");
+        dataset_destroy(centroids);
+        free(centroids);
+        return -1;
+    }
+
+    tempHolder->initialCentroids = centroids;
+    tempHolder->finalCentroids = answerFromKeams.finalCentroids;
+    // Measured by the algorithm while assigning the points to the final centroids
+    tempHolder->distortion_distance = answerFromKeams.distortion;
+    tempHolder->finalClusters = answerFromKeams.finalClusters;
+    tempHolder->rank = rank;
+    if (args->programArgs->quiet && tempHolder->finalClusters != NULL)
+    {
+        // The content of the clusters is not written, there's no need to keep the labels
+        labels_destroy(tempHolder->finalClusters);
+        free(tempHolder->finalClusters);
+        tempHolder->finalClusters = NULL;
+    }
+
+    if (shard != NULL)
+    {
+        // Kept if it's among the best of the shard, freed otherwise
+        best_offer(args->best, shard, tempHolder, answerFromKeams.iterations);
+        return 0;
+    }
+    // Write the output to the buffer
+    return circularbuffer_put(args->writer_buffer, &booleanToUseInPut, (void *) tempHolder);
+}
 
 /**
- * This function must be given to each calculating thread. 
+ * The work of each calculating thread, a worker of the pool. It claims batches of combinations until they have all
+ * been claimed : the indexes of the first combination of a batch are built from it's rank, the next ones from the
+ * previous one. The iterations of it's runs are split in parts the idle workers can take, so the last runs are
+ * shared by all the workers. The workers past the runs in flight planned only take parts. A pinned worker reads the
+ * copy of the points of it's NUMA node, if they are placed.
  * 
  * @param argT (void *) : This must be a casted (calculation_thread_arguments_t *) pointer. This structure contains the 
  * arguments are necessary to the function well being.
- * 
- * /!\ Note that this function may loop forever if the buffer in the structure is not well 
- * maintained, meaning that once producers are done they must set a signal and wake all consumers 
- * that might be waiting on the circular buffer.
- * 
- * @return (void *) NULL.
+ * @param team (team_t *) : The team of the worker in the pool.
  */ 
-void * calculationsFunction(void * argT)
+void calculationsFunction(void * argT, team_t * team)
 {
     int possibleError = 0;
     // We cast the argument
     calculation_thread_arguments_t * args = (calculation_thread_arguments_t *) argT;
-    list_of_centroids_and_clusters_only answerFromKeams;
-    int booleanToUseInGet; 
-    int booleanToUseInPut; 
-    
-    // Variables that are going to hold results in each iteration
-    calculation_result_holder * tempHolder;
-
-    // Local variable to hold centroids obtained from the buffer
-    array_of_centroids * centroids;
-    // Get the a initial centroid combination
-    circularbuffer_get(args->read_buffer, &booleanToUseInGet, (void **)&centroids);
-   
-    while( centroids != NULL && possibleError == 0)
+    uint32_t p = args->combinator->p;
+    uint32_t k = args->combinator->k;
+    uint32_t indexes[k];
+    uint64_t rank;
+    best_shard_t * shard = NULL;
+    const dataset_t * points = &args->inputFile->dataset;
+    const narrow_t * narrowPoints = args->narrowPoints;
+    if (args->affinity != NULL)
     {
-        possibleError = k_means(&answerFromKeams, centroids, args->programArgs->k, args->inputFile);
-        if (possibleError != 0)
-        {
-            fprintf(stderr, "[threadshandler.c] An error occured in kmeans function.\n");
-            circularbuffer_handleError(args->read_buffer, "calculationsFunction");
-            circularbuffer_handleError(args->writer_buffer, "calculationsFunction");
-            return(NULL);
-        }
-        tempHolder = (calculation_result_holder * ) malloc( sizeof(calculation_result_holder));
-        if (tempHolder == NULL)
+        // Not pinned, the worker still reads the copy of the node it was meant for
+        affinity_pinWorker(args->affinity, team->worker);
+        if (args->replicas != NULL)
         {
-            printf("[threadshandler.c] A failed malloc for tempHolder \n");
-            circularbuffer_handleError(args->read_buffer, "calculationsFunction");
-            circularbuffer_handleError(args->writer_buffer, "calculationsFunction");
-            return(NULL);
+            uint32_t replica = affinity_nodeOfWorker(args->affinity, team->worker) % args->replicas->nbOfReplicas;
+            points = &args->replicas->points[replica];
+            if (narrowPoints != NULL){ narrowPoints = &args->replicas->narrow[replica]; }
         }
-        
-        tempHolder->initialCentroids = centroids;
-        tempHolder->finalCentroids = answerFromKeams.finalCentroids;
-        tempHolder->distortion_distance = distortion_distance(answerFromKeams.finalCentroids, answerFromKeams.finalClusters);
-        tempHolder->finalClusters = answerFromKeams.finalClusters;
-
-        // Write the output to the buffer
-        possibleError = circularbuffer_put(args->writer_buffer, &booleanToUseInPut,(void *) tempHolder);
-        if(possibleError == 0)
+    }
+    if (team->worker >= args->nbOfRunners){ return; }
+    // Each thread keeps it's best results apart from the others, without a lock
+    if (args->best != NULL){ shard = best_claimShard(args->best); }
+
+    uint64_t claimed = combinator_claim(args->combinator, &rank);
+    while (claimed > 0 && possibleError == 0)
+    {
+        combinator_unrank(p, k, rank, indexes);
+        for (uint64_t c = 0; c < claimed && possibleError == 0; c++)
         {
-            // Get the next centroids from the buffer
-            possibleError = circularbuffer_get(args->read_buffer, &booleanToUseInGet, (void **) &centroids);
+            if (c > 0){ combinator_next(p, k, indexes); }
+            possibleError = runCombination(args, team, shard, points, narrowPoints, indexes, rank + c);
         }
+        if (possibleError == 0){ claimed = combinator_claim(args->combinator, &rank); }
+    }
+    if (possibleError != 0)
+    {
+        combinator_stop(args->combinator);
+        circularbuffer_handleError(args->writer_buffer, "calculationsFunction");
     }
-    return(NULL);
 }
 
 /**
@@ -126,19 +225,15 @@ int setHighestPriority(pthread_attr_t * attribute){
  * This functions initialize the calculating threads and the output-writer thread. 
  * 
  * @param program_arguments (args_t) : The structure presenting program arguments.
- * @param inputFile (file_t *) : The pointer to the input file structure.
- * @param combinationsOfCentroids (circular_buf *) : The circular buffer in which calculating threads should get the centroids from.
+ * @param inputFile (file_t *) : The pointer to the input file structure, whose first points are combined into the
+ *                              initial centroids.
+ * @param plan (const plan_t *) : The numbers of calculating threads, of runs in flight and of parts of a run, and the
+ *                                size of the queue of the results, see <planner_plan>.
  * 
  * @return int. O upon succesfull, else -1.
  */
-int putThreadsToWork(   
-                        args_t * program_arguments, file_t * inputFile,
-                        circular_buf * initialCentroidsBuffer
-                    )
+int putThreadsToWork(args_t * program_arguments, file_t * inputFile, const plan_t * plan)
 {
-    // An array of threads 
-    pthread_t threadList[program_arguments->n_threads];
-    uint32_t initiatedThreads = 0;
     int possibleError = 0;
 
     // We open the output file in order to pass it to the writing  thread
@@ -146,7 +241,6 @@ int putThreadsToWork(
     if (outPutFile == NULL)
     {
         fprintf(stderr,"[threadsHandler.c]Error when opening the saving file < %s >:\n\t%s\n", program_arguments->output_pathName, strerror(errno) );
-        circularbuffer_handleError(initialCentroidsBuffer, "putThreadsToWork");
         return -1;
     }
 
@@ -160,15 +254,26 @@ int putThreadsToWork(
 
     // Initiliaze the stack for intermediare string before they are written into csv
     circular_buf bufferForCalculationsHolder;
-    pthread_mutex_t buffer_mutex;
-    calculation_result_holder * arrayToHoldResults[program_arguments->n_threads];
-    if (circulabuffer_init(&bufferForCalculationsHolder, &buffer_mutex, program_arguments->n_threads, (void **) arrayToHoldResults) != 0)
+    if (circulabuffer_init(&bufferForCalculationsHolder, plan->queue) != 0)
     {
         fprintf(stderr, "[threadshandler.c] Could not initialise the circular buffer for calculations\n");
         fclose(outPutFile);
         return -1;
     }
 
+    // The threads are pinned with -a, or spread over the NUMA nodes with -u
+    affinity_t affinity;
+    bool affinityBuilt = false;
+    if (program_arguments->affinity != NULL || program_arguments->numa != AFFINITY_NUMA_NONE)
+    {
+        affinityBuilt = affinity_init(&affinity, program_arguments->affinity, program_arguments->topology,
+                                      program_arguments->numa != AFFINITY_NUMA_NONE) == 0;
+        if (!affinityBuilt)
+        {
+            fprintf(stderr, "[threadshandler.c] Warning -- the cpus of the threads are unknown, they are not pinned\n");
+        }
+    }
+
     // We are going to create the thread that generates all combinations of initial centroids
     pthread_t outputWriterThread;
     bool initatedOutputWriterThread = false;
@@ -181,45 +286,125 @@ int putThreadsToWork(
         setHighestPriority(&attr); // If the highest priority isn't set it's not a problem we just lose the time efficiency
     }
     
-    writerThreadArgs_t argForWriter = { &bufferForCalculationsHolder, outPutFile, program_arguments->quiet };
+    writerThreadArgs_t argForWriter = { &bufferForCalculationsHolder, outPutFile, program_arguments->quiet, inputFile };
 
     if (possibleError == 0)
     {
         if (pthread_create(&outputWriterThread, &attr, &writeToCSVFromBuffer, &argForWriter) == 0)
         {
             initatedOutputWriterThread = true;
+            if (affinityBuilt){ affinity_pinWriter(&affinity, outputWriterThread); }
         } else {
             circularbuffer_handleError(&bufferForCalculationsHolder, "putThreadsToWork");
+            if (affinityBuilt){ affinity_destroy(&affinity); }
             return -1;
         }
     }
 
-    calculation_thread_arguments_t argumentToAllCalculatingThreads = { inputFile, program_arguments, initialCentroidsBuffer, &bufferForCalculationsHolder };
-    
-    if (possibleError == 0) // No error occured
+    uint64_t nbOfCombinations = combinator_count(program_arguments->n_first_initialization_points, program_arguments->k);
+    // The kd-tree is built once and only read by the calculating threads, without it the runs fall back on Lloyd's
+    kdtree_t tree;
+    bool treeBuilt = false;
+    if (program_arguments->algorithm == KMEANS_KDTREE)
+    {
+        treeBuilt = kdtree_build(&tree, &inputFile->dataset) == 0;
+        if (!treeBuilt)
+        {
+            fprintf(stderr, "[threadshandler.c] Warning -- the kd-tree could not be built, the algorithm of Lloyd is used\n");
+        }
+    }
+    // When the range of the coordinates found at load time fits in int16_t or int32_t, the iterations of Lloyd read
+    // a narrow copy of the points, built once like the kd-tree
+    narrow_t layout;
+    narrow_t narrowPoints;
+    bool narrowBuilt = false;
+    if (program_arguments->algorithm == KMEANS_LLOYD && !inputFile->streamed && inputFile->dataset.size > 0
+        && narrow_choose(&layout, program_arguments->squared_distance_func, inputFile->dataset.dimension,
+                         inputFile->minimum, inputFile->maximum))
     {
-        // Start the calculating threads 
-        for (size_t i = 0; i < program_arguments->n_threads; i++)
+        narrowBuilt = narrow_init(&narrowPoints, &layout, inputFile->dataset.size) == 0;
+        if (narrowBuilt && narrow_pack(&narrowPoints, &inputFile->dataset) != 0)
         {
-            if (pthread_create( &(threadList[i]), NULL, &calculationsFunction, &argumentToAllCalculatingThreads ) == 0){
-                initiatedThreads++;
-            } else {
-                // If no thread was initiated that means that no calculations will be made and that's a problem error otherwise it may due to max capacity
-                if (initiatedThreads <= 0){ 
-                    possibleError -= 1;
-                }
-                fprintf(stderr, "[threadshandler.c] Warning -- an error occured initiating calculation threads, had already initiated %d calculator threads\n", initiatedThreads);
-                break;
-            }
+            narrow_destroy(&narrowPoints);
+            narrowBuilt = false;
         }
     }
+    // With -u, the points read by the calculating threads are copied by threads running on the NUMA nodes. The
+    // kd-tree refers to the points it was built on, it keeps reading them
+    affinity_replicas_t replicas;
+    bool replicasBuilt = false;
+    if (affinityBuilt && program_arguments->numa != AFFINITY_NUMA_NONE)
+    {
+        if (inputFile->streamed || treeBuilt)
+        {
+            fprintf(stderr, "[threadshandler.c] Warning -- the points are not placed on the NUMA nodes with the stream mode or the kd-tree\n");
+        } else {
+            replicasBuilt = affinity_place(&replicas, &affinity, program_arguments->numa, &inputFile->dataset,
+                                           narrowBuilt ? &narrowPoints : NULL) == 0;
+        }
+    }
+    // The initial centroids of all the runs are among the p first points : when the runs use each of them more than
+    // once, the distances of their first assignment are computed once for all, if they fit in the budget
+    candidates_t candidates;
+    bool candidatesBuilt = false;
+    uint32_t p = program_arguments->n_first_initialization_points;
+    if (program_arguments->algorithm == KMEANS_LLOYD && !inputFile->streamed && p <= inputFile->dataset.size
+        && (unsigned __int128) nbOfCombinations * program_arguments->k > p
+        && (unsigned __int128) inputFile->dataset.size * p * sizeof(uint64_t) <= CANDIDATES_BUDGET)
+    {
+        candidatesBuilt = candidates_build(&candidates, &inputFile->dataset, p,
+                                           kernels_select(program_arguments->squared_distance_func, inputFile->dataset.dimension),
+                                           plan->workers) == 0;
+    }
+    // Many initializations end on the same centroids : the runs of Lloyd share where they went, a run meeting the
+    // centroids of a finished one stops there with the same result
+    memo_t memo;
+    bool memoBuilt = false;
+    if (!inputFile->streamed && program_arguments->algorithm != KMEANS_MINIBATCH && nbOfCombinations > 1)
+    {
+        memoBuilt = memo_init(&memo, program_arguments->k, inputFile->dataset.dimension, MEMO_BUDGET) == 0;
+        if (!memoBuilt)
+        {
+            fprintf(stderr, "[threadshandler.c] Warning -- the table of the trajectories could not be built, each run goes to it's end\n");
+        }
+    }
+    // The calculating threads claim the combinations themselves, by batches of consecutive ranks
+    combinator_t combinator;
+    combinator_init(&combinator, program_arguments->n_first_initialization_points, program_arguments->k,
+                    plan->inter);
+    // With -t, the calculating threads only keep their best results, the others are freed as soon as they are known
+    best_t best;
+    bool bestBuilt = false;
+    if (program_arguments->top > 0)
+    {
+        uint32_t top = (nbOfCombinations < program_arguments->top) ? (uint32_t) nbOfCombinations : program_arguments->top;
+        bestBuilt = best_init(&best, (top == 0) ? 1 : top, plan->inter) == 0;
+        if (!bestBuilt){ possibleError = -1; }
+    }
+    calculation_thread_arguments_t argumentToAllCalculatingThreads = { inputFile, program_arguments, &combinator, &bufferForCalculationsHolder,
+                                                                       treeBuilt ? &tree : NULL,
+                                                                       narrowBuilt ? &narrowPoints : NULL,
+                                                                       candidatesBuilt ? &candidates : NULL,
+                                                                       memoBuilt ? &memo : NULL,
+                                                                       bestBuilt ? &best : NULL,
+                                                                       affinityBuilt ? &affinity : NULL,
+                                                                       replicasBuilt ? &replicas : NULL,
+                                                                       plan->inter };
     
-    // Wait for each calculating thread to finish
-    if (initatedOutputWriterThread)
+    // The calculating threads are the workers of a pool : once there's no combination left to claim, a worker
+    // takes parts of the iterations of the runs still going on (with fewer combinations than threads, from the start)
+    pool_t pool;
+    if (possibleError == 0 && initatedOutputWriterThread)
     {
-        for (size_t i = 0; i < initiatedThreads; i++)
+        possibleError = pool_init(&pool, plan->workers, plan->intra);
+        if (possibleError == 0)
         {
-            pthread_join( threadList[i], NULL );
+            possibleError = pool_run(&pool, calculationsFunction, &argumentToAllCalculatingThreads);
+            pool_destroy(&pool);
+        }
+        if (possibleError != 0)
+        {
+            fprintf(stderr, "[threadshandler.c] An error occured initiating the calculation threads\n");
         }
     }
     
@@ -235,8 +420,30 @@ int putThreadsToWork(
     {
         pthread_join(outputWriterThread, NULL);
     }
+
+    // The best results are only known once all the runs are done, they are written in order after the others (none)
+    if (bestBuilt && possibleError == 0)
+    {
+        if (best_merge(&best) != 0)
+        {
+            fprintf(stderr, "[threadshandler.c] Warning -- the number of distinct final solutions is a lower bound\n");
+        }
+        if (best_write(&best, outPutFile, program_arguments->quiet, inputFile) != 0)
+        {
+            fprintf(stderr, "[threadshandler.c] An error occured writing the best results to the CSV\n");
+            possibleError = -1;
+        }
+        best_writeSummary(&best, stderr);
+    }
     
     circularbuffer_destroy(&bufferForCalculationsHolder);
+    if (treeBuilt){ kdtree_destroy(&tree); }
+    if (narrowBuilt){ narrow_destroy(&narrowPoints); }
+    if (candidatesBuilt){ candidates_destroy(&candidates); }
+    if (memoBuilt){ memo_destroy(&memo); }
+    if (bestBuilt){ best_destroy(&best); }
+    if (replicasBuilt){ affinity_destroyReplicas(&replicas); }
+    if (affinityBuilt){ affinity_destroy(&affinity); }
     
     if (EOF == fclose(outPutFile))
     { 
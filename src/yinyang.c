@@ -0,0 +1,340 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "yinyang.h"
+#include "bounds.h"
+#include "dataset.h"
+#include "labels.h"
+#include "kernels.h"
+
+/**
+ * The number of iterations of k-means used to group the centroids.
+ */
+#define YINYANG_GROUPING_ITERATIONS 5
+
+/**
+ * Allocates the state of the assignment of Yinyang for the points and K centroids.
+ *
+ * @param points (const dataset_t *) : The points to cluster.
+ * @param K (uint32_t) : The number of centroids.
+ *
+ * @return (void *) : The state, NULL in case of an error.
+ */
+void * yinyang_create(const dataset_t * points, uint32_t K)
+{
+    yinyang_t * state = (yinyang_t *) calloc(1, sizeof(yinyang_t));
+    if (state == NULL){ return NULL; }
+    state->K = K;
+    state->G = (K + YINYANG_GROUP_SIZE - 1) / YINYANG_GROUP_SIZE;
+    uint32_t G = state->G;
+
+    uint64_t nbOfBounds = points->size * G;
+    if (G != 0 && nbOfBounds / G != points->size)
+    {
+        free(state);
+        return NULL;
+    }
+    state->groupOf = (uint32_t *) malloc( sizeof(uint32_t) * K );
+    state->members = (uint32_t *) malloc( sizeof(uint32_t) * K );
+    state->firstOfGroup = (uint32_t *) malloc( sizeof(uint32_t) * (G + 1) );
+    state->upper = (double *) malloc( sizeof(double) * (points->size == 0 ? 1 : points->size) );
+    state->lower = (double *) malloc( sizeof(double) * (nbOfBounds == 0 ? 1 : nbOfBounds) );
+    state->drifts = (double *) malloc( sizeof(double) * K );
+    state->groupDrifts = (double *) malloc( sizeof(double) * G );
+    state->closest = (int64_t *) malloc( sizeof(int64_t) * G );
+    state->secondClosest = (int64_t *) malloc( sizeof(int64_t) * G );
+    state->closestIndex = (uint32_t *) malloc( sizeof(uint32_t) * G );
+    if (state->groupOf == NULL || state->members == NULL || state->firstOfGroup == NULL || state->upper == NULL ||
+        state->lower == NULL || state->drifts == NULL || state->groupDrifts == NULL || state->closest == NULL ||
+        state->secondClosest == NULL || state->closestIndex == NULL)
+    {
+        yinyang_destroy(state);
+        return NULL;
+    }
+    return state;
+}
+
+/**
+ * Splits the centroids in G groups of close centroids, with a few iterations of k-means on the centroids starting
+ * from the G first ones. The groups only change how many distances are skipped, not the result.
+ *
+ * @return (int) : 0 upon success, -1 in case of an error.
+ */
+static int yinyang_group(yinyang_t * state, const dataset_t * centroids, const lloyd_kernels_t * kernels)
+{
+    uint32_t K = state->K;
+    uint32_t G = state->G;
+    uint32_t dimension = centroids->dimension;
+    dataset_t seeds;
+    uint32_t * groupOf = state->groupOf;
+    uint64_t * sums = (uint64_t *) calloc( (uint64_t) G * dimension + 1, sizeof(uint64_t) );
+    if (sums == NULL || dataset_init(&seeds, G, dimension) != 0)
+    {
+        free(sums);
+        return -1;
+    }
+    for (uint32_t g = 0; g < G; g++)
+    {
+        memcpy(dataset_row(&seeds, g), dataset_row(centroids, g), sizeof(int64_t) * dimension);
+    }
+
+    for (uint32_t iteration = 0; iteration < YINYANG_GROUPING_ITERATIONS; iteration++)
+    {
+        memset(sums, 0, sizeof(uint64_t) * G * dimension);
+        memset(state->firstOfGroup, 0, sizeof(uint32_t) * (G + 1));
+        for (uint32_t k = 0; k < K; k++)
+        {
+            int64_t closestDistance = 0;
+            for (uint32_t g = 0; g < G; g++)
+            {
+                int64_t distance = kernels->distance(dataset_row(centroids, k), dataset_row(&seeds, g), dimension);
+                if (g == 0 || distance < closestDistance)
+                {
+                    groupOf[k] = g;
+                    closestDistance = distance;
+                }
+            }
+            state->firstOfGroup[groupOf[k]]++;
+            for (uint32_t m = 0; m < dimension; m++)
+            {
+                sums[groupOf[k] * dimension + m] += (uint64_t) dataset_row(centroids, k)[m];
+            }
+        }
+        for (uint32_t g = 0; g < G; g++)
+        {
+            if (state->firstOfGroup[g] == 0){ continue; }
+            for (uint32_t m = 0; m < dimension; m++)
+            {
+                dataset_row(&seeds, g)[m] = (int64_t) sums[g * dimension + m] / (int64_t) state->firstOfGroup[g];
+            }
+        }
+    }
+
+    // Counting sort of the centroids by group, firstOfGroup holds the sizes of the groups
+    uint32_t position = 0;
+    for (uint32_t g = 0; g <= G; g++)
+    {
+        uint32_t size = state->firstOfGroup[g];
+        state->firstOfGroup[g] = position;
+        position += size;
+    }
+    for (uint32_t k = 0; k < K; k++)
+    {
+        state->members[ state->firstOfGroup[groupOf[k]]++ ] = k;
+    }
+    for (uint32_t g = G; g > 0; g--)
+    {
+        state->firstOfGroup[g] = state->firstOfGroup[g - 1];
+    }
+    state->firstOfGroup[0] = 0;
+
+    dataset_destroy(&seeds);
+    free(sums);
+    return 0;
+}
+
+/**
+ * Computes the distances of the i-th point to the centroids of the groups not skipped, and keeps for each of these
+ * groups the closest and the second closest centroid. The lower bounds of these groups and the upper bound are
+ * replaced.
+ *
+ * @param assigned (uint32_t) : The centroid of the point, it's distance is assignedDistance.
+ * @param upper (double) : The upper bound of the distance of the point to it's centroid.
+ * @param skip (bool) : If true, a group is skipped when the upper bound is below it's lower bound.
+ *
+ * @return (uint32_t) : The index of the closest centroid.
+ */
+static uint32_t yinyang_assignPoint(yinyang_t * state, const dataset_t * centroids, const dataset_t * points,
+                                    uint64_t i, uint32_t assigned, int64_t assignedDistance, double upper, bool skip,
+                                    const lloyd_kernels_t * kernels)
+{
+    const int64_t * vector = dataset_row(points, i);
+    double * lower = state->lower + i * state->G;
+    uint32_t closest = assigned;
+    int64_t closestDistance = assignedDistance;
+
+    for (uint32_t g = 0; g < state->G; g++)
+    {
+        state->closestIndex[g] = UINT32_MAX;
+        if (state->firstOfGroup[g] == state->firstOfGroup[g + 1])
+        {   // The grouping may leave a group empty
+            lower[g] = INFINITY;
+            continue;
+        }
+        if (skip && upper < lower[g]){ continue; }
+
+        int64_t groupClosest = INT64_MAX;
+        int64_t groupSecond = INT64_MAX;
+        uint32_t groupIndex = UINT32_MAX;
+        for (uint32_t j = state->firstOfGroup[g]; j < state->firstOfGroup[g + 1]; j++)
+        {
+            uint32_t k = state->members[j];
+            int64_t distance = (k == assigned) ? assignedDistance :
+                               kernels->distance(vector, dataset_row(centroids, k), points->dimension);
+            if (groupIndex == UINT32_MAX || distance < groupClosest || (distance == groupClosest && k < groupIndex))
+            {
+                groupSecond = groupClosest;
+                groupClosest = distance;
+                groupIndex = k;
+            } else if (distance < groupSecond) {
+                groupSecond = distance;
+            }
+            if (distance < closestDistance || (distance == closestDistance && k < closest))
+            {
+                closest = k;
+                closestDistance = distance;
+                upper = bounds_upper(bounds_distance(distance));
+            }
+        }
+        state->closest[g] = groupClosest;
+        state->secondClosest[g] = groupSecond;
+        state->closestIndex[g] = groupIndex;
+    }
+
+    // The lower bound of a group excludes the closest centroid only
+    for (uint32_t g = 0; g < state->G; g++)
+    {
+        if (state->closestIndex[g] == UINT32_MAX){ continue; }
+        if (state->closestIndex[g] == closest && state->firstOfGroup[g + 1] - state->firstOfGroup[g] == 1)
+        {   // The group only holds the closest centroid
+            lower[g] = INFINITY;
+            continue;
+        }
+        int64_t distance = (state->closestIndex[g] == closest) ? state->secondClosest[g] : state->closest[g];
+        lower[g] = bounds_lower(bounds_distance(distance));
+    }
+    // A skipped group did not count the old centroid
+    uint32_t group = state->groupOf[assigned];
+    if (closest != assigned && state->closestIndex[group] == UINT32_MAX)
+    {
+        double bound = bounds_lower(bounds_distance(assignedDistance));
+        lower[group] = (bound < lower[group]) ? bound : lower[group];
+    }
+    state->upper[i] = upper;
+    return closest;
+}
+
+/**
+ * Assigns each point to it's closest centroid, the same way as <assign_vectors_to_centroids>. A point whose bounds
+ * prove it keeps it's centroid is skipped, else only the groups whose lower bound is below it's upper bound are
+ * looked at. The counts of the labels are updated.
+ *
+ * @param ptr (void *) : The state returned by <yinyang_create>.
+ * @param centroids (const dataset_t *) : The centroids.
+ * @param points (const dataset_t *) : The points.
+ * @param labels (labels_t *) : The labels of the points, as left by the last assignment.
+ * @param moves (moves_t *) : The list where the points that change of cluster are recorded.
+ * @param kernels (const lloyd_kernels_t *) : The loops selected for the formula and the dimension.
+ *
+ * @return (int) : 1 if a point has changed of cluster, 0 if not, -1 in case of an error.
+ */
+int yinyang_assign(void * ptr, const dataset_t * centroids, const dataset_t * points, labels_t * labels,
+                   moves_t * moves, const lloyd_kernels_t * kernels)
+{
+    yinyang_t * state = (yinyang_t *) ptr;
+    uint32_t K = state->K;
+    uint32_t G = state->G;
+    uint32_t closest;
+    int changed = 0;
+
+    if (!state->started)
+    {
+        if (dataset_init(&state->previous, K, centroids->dimension) != 0){ return -1; }
+        if (yinyang_group(state, centroids, kernels) != 0){ return -1; }
+        state->started = true;
+        memset(labels->counts, 0, sizeof(uint64_t) * K);
+        for (uint64_t i = 0; i < points->size; i++)
+        {
+            int64_t distance = kernels->distance(dataset_row(points, i), dataset_row(centroids, 0), points->dimension);
+            closest = yinyang_assignPoint(state, centroids, points, i, 0, distance,
+                                          bounds_upper(bounds_distance(distance)), false, kernels);
+            if (closest != labels_get(labels, i))
+            {
+                moves_push(moves, i, labels_get(labels, i));
+                labels_set(labels, i, closest);
+                changed = 1;
+            }
+            labels->counts[closest]++;
+        }
+        dataset_copy(&state->previous, centroids);
+        return changed;
+    }
+
+    bounds_drifts(&state->previous, centroids, state->drifts, kernels);
+    for (uint32_t g = 0; g < G; g++)
+    {
+        state->groupDrifts[g] = 0;
+        for (uint32_t j = state->firstOfGroup[g]; j < state->firstOfGroup[g + 1]; j++)
+        {
+            double drift = state->drifts[state->members[j]];
+            state->groupDrifts[g] = (drift > state->groupDrifts[g]) ? drift : state->groupDrifts[g];
+        }
+    }
+
+    for (uint64_t i = 0; i < points->size; i++)
+    {
+        uint32_t assigned = labels_get(labels, i);
+        double * lower = state->lower + i * G;
+        double upper = bounds_increase(state->upper[i], state->drifts[assigned]);
+        double globalLower = INFINITY;
+        for (uint32_t g = 0; g < G; g++)
+        {
+            lower[g] = bounds_decrease(lower[g], state->groupDrifts[g]);
+            globalLower = (lower[g] < globalLower) ? lower[g] : globalLower;
+        }
+
+        if (upper < globalLower)
+        {
+            state->upper[i] = upper;
+            continue;
+        }
+        // The upper bound is made exact before looking at the groups
+        int64_t distance = kernels->distance(dataset_row(points, i), dataset_row(centroids, assigned), points->dimension);
+        upper = bounds_upper(bounds_distance(distance));
+        if (upper < globalLower)
+        {
+            state->upper[i] = upper;
+            continue;
+        }
+
+        closest = yinyang_assignPoint(state, centroids, points, i, assigned, distance, upper, true, kernels);
+        if (closest != assigned)
+        {
+            moves_push(moves, i, assigned);
+            labels_set(labels, i, closest);
+            labels->counts[assigned]--;
+            labels->counts[closest]++;
+            changed = 1;
+        }
+    }
+
+    dataset_copy(&state->previous, centroids);
+    return changed;
+}
+
+/**
+ * Frees the state of the assignment of Yinyang.
+ *
+ * @param ptr (void *) : The state returned by <yinyang_create>, may be NULL.
+ */
+void yinyang_destroy(void * ptr)
+{
+    yinyang_t * state = (yinyang_t *) ptr;
+    if (state == NULL){ return; }
+    free(state->groupOf);
+    free(state->members);
+    free(state->firstOfGroup);
+    free(state->upper);
+    free(state->lower);
+    free(state->drifts);
+    free(state->groupDrifts);
+    free(state->closest);
+    free(state->secondClosest);
+    free(state->closestIndex);
+    dataset_destroy(&state->previous);
+    free(state);
+}
@@ -22,6 +22,7 @@
 #include "CUnit/Util.h"
 
 #include "argumentsparser.h"
+#include "minibatch.h"
 
 /****
  * It's main purpose is to parse the user input arguments.
@@ -173,6 +174,217 @@ void test_parse_args_silent_off()
     CU_ASSERT_EQUAL(errorSignal, -1);
 }
 
+/**
+ * The algorithm of the assignment is Lloyd's by default, an unknown one is an error.
+ */
+void test_parse_args_algorithm()
+{
+    args_t argument_holder;
+    int errorSignal;
+
+    optind = 1;
+    char * argv[2] = {"./kmeans", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 2, argv);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_EQUAL(argument_holder.algorithm, KMEANS_LLOYD);
+
+    optind = 1;
+    char * argv1[4] = {"./kmeans", "-m", "elkan", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv1);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_EQUAL(argument_holder.algorithm, KMEANS_ELKAN);
+
+    optind = 1;
+    char * argv3[4] = {"./kmeans", "-m", "hamerly", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv3);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_EQUAL(argument_holder.algorithm, KMEANS_HAMERLY);
+
+    optind = 1;
+    char * argv4[4] = {"./kmeans", "-m", "yinyang", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv4);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_EQUAL(argument_holder.algorithm, KMEANS_YINYANG);
+
+    optind = 1;
+    char * argv5[4] = {"./kmeans", "-m", "kdtree", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv5);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_EQUAL(argument_holder.algorithm, KMEANS_KDTREE);
+
+    optind = 1;
+    char * argv2[4] = {"./kmeans", "-m", "fastest", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv2);
+    CU_ASSERT_EQUAL(errorSignal, -1);
+}
+
+/**
+ * The size and the number of the batches have default values, and must be positive.
+ */
+void test_parse_args_minibatch()
+{
+    args_t argument_holder;
+    int errorSignal;
+
+    optind = 1;
+    char * argv[4] = {"./kmeans", "-m", "minibatch", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_EQUAL(argument_holder.algorithm, KMEANS_MINIBATCH);
+    CU_ASSERT_EQUAL(argument_holder.batch_size, MINIBATCH_DEFAULT_SIZE);
+    CU_ASSERT_EQUAL(argument_holder.batch_iterations, MINIBATCH_DEFAULT_ITERATIONS);
+
+    optind = 1;
+    char * argv1[8] = {"./kmeans", "-m", "minibatch", "-b", "64", "-i", "7", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 8, argv1);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_EQUAL(argument_holder.batch_size, 64);
+    CU_ASSERT_EQUAL(argument_holder.batch_iterations, 7);
+
+    optind = 1;
+    char * argv2[4] = {"./kmeans", "-b", "0", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv2);
+    CU_ASSERT_EQUAL(errorSignal, -1);
+
+    optind = 1;
+    char * argv3[4] = {"./kmeans", "-i", "-3", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv3);
+    CU_ASSERT_EQUAL(errorSignal, -1);
+}
+
+/**
+ * The stream mode is off by default, and only works with the algorithm of Lloyd.
+ */
+void test_parse_args_stream()
+{
+    args_t argument_holder;
+    int errorSignal;
+
+    optind = 1;
+    char * argv[2] = {"./kmeans", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 2, argv);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_FALSE(argument_holder.stream);
+
+    optind = 1;
+    char * argv1[3] = {"./kmeans", "-s", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 3, argv1);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_TRUE(argument_holder.stream);
+
+    optind = 1;
+    char * argv2[5] = {"./kmeans", "-s", "-m", "elkan", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 5, argv2);
+    CU_ASSERT_EQUAL(errorSignal, -1);
+}
+
+void test_parse_args_prepare()
+{
+    args_t argument_holder;
+    int errorSignal;
+
+    optind = 1;
+    char * argv[2] = {"./kmeans", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 2, argv);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_FALSE(argument_holder.prepare);
+
+    optind = 1;
+    char * argv1[3] = {"./kmeans", "-P", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 3, argv1);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_TRUE(argument_holder.prepare);
+
+    optind = 1;
+    char * argv2[4] = {"./kmeans", "-P", "-s", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv2);
+    CU_ASSERT_EQUAL(errorSignal, -1);
+}
+
+void test_parse_args_top()
+{
+    args_t argument_holder;
+    int errorSignal;
+
+    optind = 1;
+    char * argv[2] = {"./kmeans", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 2, argv);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_EQUAL(argument_holder.top, 0);
+
+    optind = 1;
+    char * argv1[4] = {"./kmeans", "-t", "3", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv1);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_EQUAL(argument_holder.top, 3);
+
+    optind = 1;
+    char * argv2[4] = {"./kmeans", "-t", "0", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv2);
+    CU_ASSERT_EQUAL(errorSignal, -1);
+}
+
+void test_parse_args_affinity()
+{
+    args_t argument_holder;
+    int errorSignal;
+
+    optind = 1;
+    char * argv[2] = {"./kmeans", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 2, argv);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_PTR_NULL(argument_holder.affinity);
+    CU_ASSERT_EQUAL(argument_holder.numa, AFFINITY_NUMA_NONE);
+
+    optind = 1;
+    char * argv1[6] = {"./kmeans", "-a", "0-6,8:7", "-u", "replicate:0-3/4-7", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 6, argv1);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_STRING_EQUAL(argument_holder.affinity, "0-6,8:7");
+    CU_ASSERT_EQUAL(argument_holder.numa, AFFINITY_NUMA_REPLICATE);
+    CU_ASSERT_STRING_EQUAL(argument_holder.topology, "0-3/4-7");
+
+    optind = 1;
+    char * argv2[4] = {"./kmeans", "-u", "partition", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv2);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_EQUAL(argument_holder.numa, AFFINITY_NUMA_PARTITION);
+    CU_ASSERT_PTR_NULL(argument_holder.topology);
+
+    optind = 1;
+    char * argv3[4] = {"./kmeans", "-a", "3-1", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv3);
+    CU_ASSERT_EQUAL(errorSignal, -1);
+
+    optind = 1;
+    char * argv4[4] = {"./kmeans", "-u", "replicate:0//1", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv4);
+    CU_ASSERT_EQUAL(errorSignal, -1);
+}
+
+void test_parse_args_planned_threads()
+{
+    args_t argument_holder;
+    int errorSignal;
+
+    optind = 1;
+    char * argv[2] = {"./kmeans", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 2, argv);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_EQUAL(argument_holder.n_threads, 0);
+
+    optind = 1;
+    char * argv1[4] = {"./kmeans", "-n", "3", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv1);
+    CU_ASSERT_EQUAL(errorSignal, 0);
+    CU_ASSERT_EQUAL(argument_holder.n_threads, 3);
+
+    optind = 1;
+    char * argv2[4] = {"./kmeans", "-n", "0", "input_binary/spreadPoints.bin"};
+    errorSignal = parse_args(&argument_holder, 4, argv2);
+    CU_ASSERT_EQUAL(errorSignal, -1);
+}
+
 int main(int argc, char const *argv[])
 {
     if (CUE_SUCCESS != CU_initialize_registry())
@@ -183,7 +395,14 @@ int main(int argc, char const *argv[])
     CU_pSuite pSuite = NULL;
     pSuite = CU_add_suite("Tests for local header <argumentsParser.h>", NULL, NULL );
 
-    if ( NULL == CU_add_test(pSuite, "for many different file", test_parse_args_silent_on) ) 
+    if ( (NULL == CU_add_test(pSuite, "for many different file", test_parse_args_silent_on)) ||
+         (NULL == CU_add_test(pSuite, "for the algorithms", test_parse_args_algorithm)) ||
+         (NULL == CU_add_test(pSuite, "for the batches", test_parse_args_minibatch)) ||
+         (NULL == CU_add_test(pSuite, "for the stream mode", test_parse_args_stream)) ||
+         (NULL == CU_add_test(pSuite, "for the prepare mode", test_parse_args_prepare)) ||
+         (NULL == CU_add_test(pSuite, "for the best results", test_parse_args_top)) ||
+         (NULL == CU_add_test(pSuite, "for the affinity of the threads", test_parse_args_affinity)) ||
+         (NULL == CU_add_test(pSuite, "for the planned threads", test_parse_args_planned_threads)) ) 
     {
         CU_cleanup_registry();
         return CU_get_error();
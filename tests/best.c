@@ -0,0 +1,113 @@
+/********************************************
+ * 
+ * This contains the CUnit tests for the file "src/best.c" and header "src/best.h"
+ * 
+ * For documentation and better understanding check the following website: 
+ * www.cunit.sourceforge.net/doc/index.html
+ * 
+ *******************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "CUnit/CUnit.h"
+#include "CUnit/Basic.h"
+#include "CUnit/Util.h"
+
+#include "best.h"
+#include "dataset.h"
+#include "threadshandler.h"
+
+/**
+ * Returns a result whose final centroids are the two points (value, 0) and (0, value).
+ */
+static calculation_result_holder * test_best_holder(int64_t distortion, uint64_t rank, int64_t value)
+{
+    calculation_result_holder * holder = (calculation_result_holder *) malloc( sizeof(calculation_result_holder) );
+    CU_ASSERT_PTR_NOT_NULL_FATAL( holder );
+    holder->initialCentroids = (dataset_t *) malloc( sizeof(dataset_t) );
+    holder->finalCentroids = (dataset_t *) malloc( sizeof(dataset_t) );
+    CU_ASSERT_PTR_NOT_NULL_FATAL( holder->initialCentroids );
+    CU_ASSERT_PTR_NOT_NULL_FATAL( holder->finalCentroids );
+    CU_ASSERT_EQUAL_FATAL( dataset_init(holder->initialCentroids, 2, 2), 0 );
+    CU_ASSERT_EQUAL_FATAL( dataset_init(holder->finalCentroids, 2, 2), 0 );
+    dataset_row(holder->finalCentroids, 0)[0] = value;
+    dataset_row(holder->finalCentroids, 0)[1] = 0;
+    dataset_row(holder->finalCentroids, 1)[0] = 0;
+    dataset_row(holder->finalCentroids, 1)[1] = value;
+    holder->finalClusters = NULL;
+    holder->distortion_distance = distortion;
+    holder->rank = rank;
+    return holder;
+}
+
+void test_best_keeps_the_lowest_distortions()
+{
+    best_t best;
+    CU_ASSERT_EQUAL_FATAL( best_init(&best, 3, 2), 0 );
+    best_shard_t * first = best_claimShard(&best);
+    best_shard_t * second = best_claimShard(&best);
+    CU_ASSERT_PTR_NOT_NULL_FATAL( first );
+    CU_ASSERT_PTR_NOT_NULL_FATAL( second );
+    CU_ASSERT_PTR_NULL( best_claimShard(&best) );
+
+    int64_t distortions[8] = { 40, 7, 100, 7, 3, 0, 12, 1 << 20 };
+    for (uint64_t rank = 0; rank < 8; rank++)
+    {
+        // Two values only : the other results end on the same solutions
+        best_offer(&best, (rank % 2 == 0) ? first : second,
+                   test_best_holder(distortions[rank], rank, 1 + (int64_t) rank % 2), rank + 2);
+        CU_ASSERT_TRUE( first->size <= 3 && second->size <= 3 );
+    }
+    // The same centroids in the other order are the same solution
+    calculation_result_holder * swapped = test_best_holder(500, 8, 2);
+    dataset_row(swapped->finalCentroids, 0)[0] = 0;
+    dataset_row(swapped->finalCentroids, 0)[1] = 2;
+    dataset_row(swapped->finalCentroids, 1)[0] = 2;
+    dataset_row(swapped->finalCentroids, 1)[1] = 0;
+    best_offer(&best, first, swapped, 2);
+
+    CU_ASSERT_EQUAL( best_merge(&best), 0 );
+    CU_ASSERT_EQUAL( best.incomplete, 0 );
+    const best_shard_t * merged = &best.shards[0];
+    CU_ASSERT_EQUAL( merged->size, 3 );
+    CU_ASSERT_EQUAL( merged->heap[0]->distortion_distance, 0 );
+    CU_ASSERT_EQUAL( merged->heap[1]->distortion_distance, 3 );
+    // The same distortion, the lowest rank first
+    CU_ASSERT_EQUAL( merged->heap[2]->distortion_distance, 7 );
+    CU_ASSERT_EQUAL( merged->heap[2]->rank, 1 );
+    CU_ASSERT_EQUAL( merged->runs, 9 );
+    CU_ASSERT_EQUAL( merged->nbOfSolutions, 2 );
+    CU_ASSERT_EQUAL( merged->minIterations, 2 );
+    CU_ASSERT_EQUAL( merged->maxIterations, 9 );
+    CU_ASSERT_EQUAL( merged->histogram[0], 1 );
+    CU_ASSERT_EQUAL( merged->histogram[3], 2 );
+    CU_ASSERT_EQUAL( merged->histogram[21], 1 );
+    best_destroy(&best);
+}
+
+int main(int argc, char const *argv[])
+{
+    if (CUE_SUCCESS != CU_initialize_registry())
+    {
+        return CU_get_error();
+    }
+ 
+    CU_pSuite pSuite = NULL;
+    pSuite = CU_add_suite("Tests for local header <best.h>", NULL, NULL );
+
+    if ( (NULL == CU_add_test(pSuite, "for the best results", test_best_keeps_the_lowest_distortions ))
+       ) 
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    printf("\n");
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+/********************************************
+ * 
+ * This contains the CUnit tests for the file "src/candidates.c" and header "src/candidates.h"
+ * 
+ * For documentation and better understanding check the following website: 
+ * www.cunit.sourceforge.net/doc/index.html
+ * 
+ *******************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "CUnit/CUnit.h"
+#include "CUnit/Basic.h"
+#include "CUnit/Util.h"
+
+#include "candidates.h"
+#include "kernels.h"
+#include "distance.h"
+#include "dataset.h"
+#include "labels.h"
+
+void test_candidates_assign_like_the_kernels()
+{
+    squared_distance_func_t formulas[2] = { squared_manhattan_distance, squared_euclidean_distance };
+    uint64_t size = 300;
+    uint32_t p = 7;
+    uint32_t K = 3;
+    srand(5);
+    for (uint32_t dim = 1; dim <= 5; dim++)
+    {
+        dataset_t points, centroids;
+        CU_ASSERT_EQUAL_FATAL( dataset_init(&points, size, dim), 0 );
+        CU_ASSERT_EQUAL_FATAL( dataset_init(&centroids, K, dim), 0 );
+        // Few distinct coordinates, so some distances are equal
+        for (uint64_t i = 0; i < size; i++)
+        {
+            for (uint32_t m = 0; m < dim; m++){ dataset_row(&points, i)[m] = rand() % 7 - 3; }
+        }
+        // The candidates 5, 1 and 3, in this order, and the candidate 1 twice among them
+        memcpy(dataset_row(&points, 4), dataset_row(&points, 1), sizeof(int64_t) * dim);
+        memcpy(dataset_row(&centroids, 0), dataset_row(&points, 5), sizeof(int64_t) * dim);
+        memcpy(dataset_row(&centroids, 1), dataset_row(&points, 1), sizeof(int64_t) * dim);
+        memcpy(dataset_row(&centroids, 2), dataset_row(&points, 3), sizeof(int64_t) * dim);
+
+        for (uint32_t f = 0; f < 2; f++)
+        {
+            const lloyd_kernels_t * kernels = kernels_select(formulas[f], dim);
+            candidates_t candidates;
+            uint32_t columns[3];
+            labels_t expected, labels;
+            moves_t expectedMoves, moves;
+            uint64_t expectedDistortion = 0;
+            uint64_t distortion = 0;
+            CU_ASSERT_EQUAL_FATAL( candidates_build(&candidates, &points, p, kernels, 3), 0 );
+            CU_ASSERT_TRUE_FATAL( candidates_columns(&candidates, &centroids, columns) );
+            for (uint32_t k = 0; k < K; k++)
+            {
+                CU_ASSERT_TRUE( columns[k] < p );
+                CU_ASSERT_EQUAL( memcmp(dataset_row(&points, columns[k]), dataset_row(&centroids, k), sizeof(int64_t) * dim), 0 );
+            }
+            CU_ASSERT_EQUAL_FATAL( labels_init(&expected, size, K), 0 );
+            CU_ASSERT_EQUAL_FATAL( labels_init(&labels, size, K), 0 );
+            CU_ASSERT_EQUAL_FATAL( moves_init(&expectedMoves, size), 0 );
+            CU_ASSERT_EQUAL_FATAL( moves_init(&moves, size), 0 );
+
+            CU_ASSERT_EQUAL( kernels->assign(&centroids, &points, &expected, &expectedMoves, &expectedDistortion, 0, size),
+                             candidates_assign(&candidates, columns, K, &labels, &moves, &distortion, 0, size) );
+            CU_ASSERT_EQUAL( expectedDistortion, distortion );
+            CU_ASSERT_EQUAL( expectedMoves.size, moves.size );
+            for (uint64_t i = 0; i < size; i++){ CU_ASSERT_EQUAL( labels_get(&expected, i), labels_get(&labels, i) ); }
+            CU_ASSERT_EQUAL( memcmp(expected.counts, labels.counts, sizeof(uint64_t) * K), 0 );
+
+            labels_destroy(&expected);
+            labels_destroy(&labels);
+            moves_destroy(&expectedMoves);
+            moves_destroy(&moves);
+            candidates_destroy(&candidates);
+        }
+        // A centroid which isn't among the candidates
+        dataset_row(&centroids, 2)[0] = 1000;
+        candidates_t candidates;
+        uint32_t columns[3];
+        CU_ASSERT_EQUAL_FATAL( candidates_build(&candidates, &points, p, kernels_select(formulas[0], dim), 1), 0 );
+        CU_ASSERT_FALSE( candidates_columns(&candidates, &centroids, columns) );
+        candidates_destroy(&candidates);
+        dataset_destroy(&points);
+        dataset_destroy(&centroids);
+    }
+}
+
+int main(int argc, char const *argv[])
+{
+    if (CUE_SUCCESS != CU_initialize_registry())
+    {
+        return CU_get_error();
+    }
+ 
+    CU_pSuite pSuite = NULL;
+    pSuite = CU_add_suite("Tests for local header <candidates.h>", NULL, NULL );
+
+    if ( (NULL == CU_add_test(pSuite, "for the distances to the candidates", test_candidates_assign_like_the_kernels ))
+       ) 
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    printf("\n");
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+/********************************************
+ * 
+ * This contains the CUnit tests for the file "src/combinator.c" and header "src/combinator.h"
+ * 
+ * For documentation and better understanding check the following website: 
+ * www.cunit.sourceforge.net/doc/index.html
+ * 
+ *******************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "CUnit/CUnit.h"
+#include "CUnit/Basic.h"
+#include "CUnit/Util.h"
+
+#include "combinator.h"
+
+void test_combinator_unranks_in_order()
+{
+    uint32_t indexes[12];
+    uint32_t expected[12];
+    for (uint32_t p = 1; p <= 12; p++)
+    {
+        for (uint32_t k = 1; k <= p; k++)
+        {
+            // The ranks follow the lexicographic order of the successors of {0, ..., k - 1}
+            for (uint32_t i = 0; i < k; i++){ expected[i] = i; }
+            uint64_t count = combinator_count(p, k);
+            for (uint64_t rank = 0; rank < count; rank++)
+            {
+                combinator_unrank(p, k, rank, indexes);
+                CU_ASSERT_EQUAL( memcmp(indexes, expected, sizeof(uint32_t) * k), 0 );
+                CU_ASSERT_EQUAL( combinator_next(p, k, expected), rank + 1 < count );
+            }
+        }
+    }
+    CU_ASSERT_EQUAL( combinator_count(40, 20), 137846528820ULL );
+    CU_ASSERT_EQUAL( combinator_count(3, 4), 0 );
+
+    // Beyond 2^64 combinations the count saturates and the ranks stay exact
+    CU_ASSERT_EQUAL( combinator_count(200, 100), UINT64_MAX );
+    uint32_t large[100];
+    combinator_unrank(200, 100, 0, large);
+    CU_ASSERT_EQUAL( large[99], 99 );
+    combinator_unrank(200, 100, UINT64_MAX - 1, large);
+    CU_ASSERT_EQUAL( large[0], 0 );
+    for (uint32_t i = 1; i < 100; i++){ CU_ASSERT_TRUE( large[i - 1] < large[i] && large[i] < 200 ); }
+
+    // The batches cover every rank once
+    combinator_t combinator;
+    combinator_init(&combinator, 12, 5, 3);
+    uint64_t first, total = 0, next = 0;
+    uint64_t claimed;
+    while ((claimed = combinator_claim(&combinator, &first)) > 0)
+    {
+        CU_ASSERT_EQUAL( first, next );
+        CU_ASSERT_TRUE( claimed <= COMBINATOR_MAX_BATCH );
+        next = first + claimed;
+        total += claimed;
+    }
+    CU_ASSERT_EQUAL( total, 792 );
+}
+
+int main(int argc, char const *argv[])
+{
+    if (CUE_SUCCESS != CU_initialize_registry())
+    {
+        return CU_get_error();
+    }
+ 
+    CU_pSuite pSuite = NULL;
+    pSuite = CU_add_suite("Tests for local header <combinator.h>", NULL, NULL );
+
+    if ( (NULL == CU_add_test(pSuite, "for the enumeration of the combinations", test_combinator_unranks_in_order ))
+       ) 
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    printf("\n");
+
+    return 0;
+}
@@ -22,6 +22,9 @@
 #include "CUnit/Util.h"
 
 #include "distance.h" 
+#include "kernels.h"
+#include "narrow.h"
+#include "labels.h"
 
 /**
  * 
@@ -109,6 +112,219 @@ void test_with_3dimension_points()
     CU_ASSERT_EQUAL( (int64_t) 576, squared_manhattan_distance( &p3, &p0) );
 }
 
+void test_with_large_coordinates()
+{
+    uint32_t dim1 = 1;
+    int64_t p0_arr[] = {0};
+    point_t p0 = { dim1, p0_arr };
+    int64_t p1_arr[] = {3000000000};
+    point_t p1 = { dim1, p1_arr };
+
+    // The absolute difference does not fit in an int
+    CU_ASSERT_EQUAL( (int64_t) 9000000000000000000, squared_manhattan_distance( &p0, &p1) );
+    CU_ASSERT_EQUAL( (int64_t) 9000000000000000000, squared_manhattan_distance( &p1, &p0) );
+    CU_ASSERT_EQUAL( (int64_t) 9000000000000000000, squared_euclidean_distance( &p0, &p1) );
+}
+
+/**
+ * Every implementation of the kernels supported by the processor must give the same result as the scalar one, 
+ * for every dimension (the SIMD kernels have a tail) and even when the sums overflow.
+ */
+void test_kernels_are_identical()
+{
+    distance_kernels_t kernels[8];
+    uint32_t nbOfKernels = distance_supportedKernels(kernels, 8);
+    distance_kernels_t * scalar = kernels + nbOfKernels - 1;
+    CU_ASSERT_EQUAL( 0, strcmp(scalar->name, "scalar") );
+
+    int64_t p1[40];
+    int64_t p2[40];
+    srand(42);
+    for (uint32_t trial = 0; trial < 200; trial++)
+    {
+        int64_t range = (trial % 2 == 0) ? 1000 : INT64_MAX;
+        for (uint32_t i = 0; i < 40; i++)
+        {
+            p1[i] = (int64_t) (((uint64_t) rand() << 33) ^ ((uint64_t) rand() << 16) ^ (uint64_t) rand()) % range;
+            p2[i] = -(int64_t) (((uint64_t) rand() << 33) ^ ((uint64_t) rand() << 16) ^ (uint64_t) rand()) % range;
+        }
+        for (uint32_t dim = 0; dim <= 40; dim++)
+        {
+            for (uint32_t k = 0; k < nbOfKernels; k++)
+            {
+                CU_ASSERT_EQUAL( scalar->squared_manhattan(p1, p2, dim), kernels[k].squared_manhattan(p1, p2, dim) );
+                CU_ASSERT_EQUAL( scalar->squared_euclidean(p1, p2, dim), kernels[k].squared_euclidean(p1, p2, dim) );
+            }
+        }
+    }
+}
+
+/**
+ * The narrow kernels of every implementation must give the same result as the scalar int64_t ones on the same
+ * coordinates, for every dimension (they have a masked or a scalar tail) and the extreme coordinates of their range.
+ */
+void test_narrow_kernels_are_identical()
+{
+    distance_kernels_t kernels[8];
+    uint32_t nbOfKernels = distance_supportedKernels(kernels, 8);
+    distance_kernels_t * scalar = kernels + nbOfKernels - 1;
+
+    // The distances of the int16_t kernels summed in uint32_t must fit : up to 40 * 10000^2 for the euclidean ones
+    int64_t ranges[4][2] = { {INT16_MIN, INT16_MAX}, {-5000, 5000}, {INT16_MIN, INT16_MAX}, {INT32_MIN, INT32_MAX} };
+    int16_t n1[40], n2[40];
+    int32_t m1[40], m2[40];
+    int64_t w1[40], w2[40];
+    srand(7);
+    for (uint32_t trial = 0; trial < 200; trial++)
+    {
+        for (uint32_t r = 0; r < 4; r++)
+        {
+            uint64_t span = (uint64_t) (ranges[r][1] - ranges[r][0]) + 1;
+            for (uint32_t i = 0; i < 40; i++)
+            {
+                uint64_t random1 = ((uint64_t) rand() << 31) ^ (uint64_t) rand();
+                uint64_t random2 = ((uint64_t) rand() << 31) ^ (uint64_t) rand();
+                w1[i] = ranges[r][0] + (int64_t) (random1 % span);
+                w2[i] = ranges[r][0] + (int64_t) (random2 % span);
+                if (trial % 4 == 0){ w1[i] = ranges[r][(i + trial / 4) % 2]; w2[i] = ranges[r][(i + trial / 4 + 1) % 2]; }
+                n1[i] = (int16_t) w1[i];
+                n2[i] = (int16_t) w2[i];
+                m1[i] = (int32_t) w1[i];
+                m2[i] = (int32_t) w2[i];
+            }
+            for (uint32_t dim = 0; dim <= 40; dim++)
+            {
+                int64_t manhattan = scalar->squared_manhattan(w1, w2, dim);
+                int64_t euclidean = scalar->squared_euclidean(w1, w2, dim);
+                for (uint32_t k = 0; k < nbOfKernels; k++)
+                {
+                    if (r == 0){ CU_ASSERT_EQUAL( manhattan, kernels[k].squared_manhattan16(n1, n2, dim) ); }
+                    if (r == 1){ CU_ASSERT_EQUAL( euclidean, kernels[k].squared_euclidean16(n1, n2, dim) ); }
+                    if (r <= 2)
+                    {
+                        CU_ASSERT_EQUAL( manhattan, kernels[k].squared_manhattan16w(n1, n2, dim) );
+                        CU_ASSERT_EQUAL( euclidean, kernels[k].squared_euclidean16w(n1, n2, dim) );
+                    }
+                    CU_ASSERT_EQUAL( manhattan, kernels[k].squared_manhattan32(m1, m2, dim) );
+                    CU_ASSERT_EQUAL( euclidean, kernels[k].squared_euclidean32(m1, m2, dim) );
+                }
+            }
+        }
+    }
+}
+
+/**
+ * The loops specialized for a dimension must give the same distances as the kernels, for both formulas.
+ */
+void test_specialized_loops_are_identical()
+{
+    int64_t p1[20];
+    int64_t p2[20];
+    srand(7);
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        p1[i] = (int64_t) (((uint64_t) rand() << 33) ^ (uint64_t) rand());
+        p2[i] = -(int64_t) rand();
+    }
+    for (uint32_t dim = 0; dim <= 20; dim++)
+    {
+        const lloyd_kernels_t * manhattan = kernels_select(squared_manhattan_distance, dim);
+        const lloyd_kernels_t * euclidean = kernels_select(squared_euclidean_distance, dim);
+        CU_ASSERT_EQUAL( DISTANCE_KERNELS.squared_manhattan(p1, p2, dim), manhattan->distance(p1, p2, dim) );
+        CU_ASSERT_EQUAL( DISTANCE_KERNELS.squared_euclidean(p1, p2, dim), euclidean->distance(p1, p2, dim) );
+    }
+    CU_ASSERT_EQUAL( 0, strcmp(kernels_select(squared_euclidean_distance, 3)->name, "euclidean_3") );
+    CU_ASSERT_EQUAL( 0, strcmp(kernels_select(squared_manhattan_distance, 5)->name, "manhattan_generic") );
+    // From 8 coordinates the SIMD kernels of DISTANCE_KERNELS are faster than the unrolled loops
+    CU_ASSERT_EQUAL( 0, strcmp(kernels_select(squared_manhattan_distance, 8)->name, "manhattan_generic") );
+    CU_ASSERT_EQUAL( 0, strcmp(kernels_select(squared_euclidean_distance, 16)->name, "euclidean_generic") );
+}
+
+/**
+ * The narrow loops must give the same labels, counts and sums as the int64_t ones, for every storage and accumulator
+ * chosen from the range of the points.
+ */
+void test_narrow_loops_are_identical()
+{
+    // Small coordinates, coordinates summed in uint64_t by the euclidean formula, and coordinates needing int32_t
+    int64_t ranges[3][2] = { {-300, 300}, {-30000, 32000}, {-268435456, 268435456} };
+    squared_distance_func_t formulas[2] = { squared_manhattan_distance, squared_euclidean_distance };
+    uint32_t K = 3;
+    uint64_t size = 60;
+    srand(11);
+    for (uint32_t r = 0; r < 3; r++)
+    {
+        for (uint32_t dim = 1; dim <= 17; dim++)
+        {
+            dataset_t points;
+            dataset_t centroids;
+            CU_ASSERT_EQUAL_FATAL( dataset_init(&points, size, dim), 0 );
+            CU_ASSERT_EQUAL_FATAL( dataset_init(&centroids, K, dim), 0 );
+            for (uint64_t i = 0; i < size * dim; i++)
+            {
+                points.values[i] = ranges[r][0] + (int64_t) ((uint64_t) rand() % (uint64_t) (ranges[r][1] - ranges[r][0] + 1));
+            }
+            // Two points and the origin, the centroid of an empty cluster
+            memcpy(dataset_row(&centroids, 0), dataset_row(&points, 3), sizeof(int64_t) * dim);
+            memcpy(dataset_row(&centroids, 1), dataset_row(&points, 7), sizeof(int64_t) * dim);
+            memset(dataset_row(&centroids, 2), 0, sizeof(int64_t) * dim);
+
+            for (uint32_t f = 0; f < 2; f++)
+            {
+                narrow_t layout, narrowPoints, narrowCentroids;
+                labels_t wide, narrow;
+                moves_t wideMoves, narrowMoves;
+                int64_t wideSums[3 * 17] = {0};
+                int64_t narrowSums[3 * 17] = {0};
+                CU_ASSERT_TRUE_FATAL( narrow_choose(&layout, formulas[f], dim, ranges[r][0], ranges[r][1]) );
+                CU_ASSERT_EQUAL( layout.width, (r == 2) ? sizeof(int32_t) : sizeof(int16_t) );
+                CU_ASSERT_EQUAL_FATAL( narrow_init(&narrowPoints, &layout, size), 0 );
+                CU_ASSERT_EQUAL_FATAL( narrow_init(&narrowCentroids, &layout, K), 0 );
+                CU_ASSERT_EQUAL( narrow_pack(&narrowPoints, &points), 0 );
+                CU_ASSERT_EQUAL( narrow_pack(&narrowCentroids, &centroids), 0 );
+                CU_ASSERT_EQUAL_FATAL( labels_init(&wide, size, K), 0 );
+                CU_ASSERT_EQUAL_FATAL( labels_init(&narrow, size, K), 0 );
+                CU_ASSERT_EQUAL_FATAL( moves_init(&wideMoves, size), 0 );
+                CU_ASSERT_EQUAL_FATAL( moves_init(&narrowMoves, size), 0 );
+
+                const lloyd_kernels_t * wideKernels = kernels_select(formulas[f], dim);
+                const narrow_kernels_t * narrowKernels = kernels_selectNarrow(formulas[f], &layout);
+                uint64_t wideDistortion = 0;
+                uint64_t narrowDistortion = 0;
+                CU_ASSERT_EQUAL( wideKernels->assign(&centroids, &points, &wide, &wideMoves, &wideDistortion, 0, size),
+                                 narrowKernels->assign(&narrowCentroids, &narrowPoints, &narrow, &narrowMoves,
+                                                       &narrowDistortion, 0, size) );
+                CU_ASSERT_EQUAL( wideDistortion, narrowDistortion );
+                CU_ASSERT_EQUAL( (int64_t) wideDistortion, wideKernels->distortion(&centroids, &points, &wide, 0, size) );
+                wideKernels->accumulate(wideSums, &points, &wide, 0, size);
+                narrowKernels->accumulate(narrowSums, &narrowPoints, &narrow, 0, size);
+                for (uint64_t i = 0; i < size; i++){ CU_ASSERT_EQUAL( labels_get(&wide, i), labels_get(&narrow, i) ); }
+                CU_ASSERT_EQUAL( memcmp(wide.counts, narrow.counts, sizeof(uint64_t) * K), 0 );
+                CU_ASSERT_EQUAL( memcmp(wideSums, narrowSums, sizeof(int64_t) * K * dim), 0 );
+
+                labels_destroy(&wide);
+                labels_destroy(&narrow);
+                moves_destroy(&wideMoves);
+                moves_destroy(&narrowMoves);
+                narrow_destroy(&narrowPoints);
+                narrow_destroy(&narrowCentroids);
+            }
+            dataset_destroy(&points);
+            dataset_destroy(&centroids);
+        }
+    }
+
+    // The accumulator is only narrowed when the largest distance fits, and the centroids must be in the range
+    narrow_t layout;
+    CU_ASSERT_TRUE( narrow_choose(&layout, squared_euclidean_distance, 16, -30000, 32000) );
+    CU_ASSERT_EQUAL( layout.accumulator, sizeof(uint64_t) );
+    CU_ASSERT_EQUAL( 0, strcmp(kernels_selectNarrow(squared_euclidean_distance, &layout)->name, "euclidean_int16w_generic") );
+    CU_ASSERT_TRUE( narrow_choose(&layout, squared_manhattan_distance, 16, 100, 20000) );
+    CU_ASSERT_EQUAL( layout.accumulator, sizeof(uint32_t) );
+    CU_ASSERT_EQUAL( layout.minimum, 0 );
+    CU_ASSERT_FALSE( narrow_choose(&layout, squared_manhattan_distance, 2, 0, (int64_t) 1 << 40) );
+}
+
 int main(int argc, char const *argv[])
 {
     if (CUE_SUCCESS != CU_initialize_registry())
@@ -120,7 +336,12 @@ int main(int argc, char const *argv[])
     pSuite = CU_add_suite("Tests for local header <distance.h>", NULL, NULL );
 
     if ( (NULL == CU_add_test(pSuite, "for 2 Dimension Points", test_with_2dimension_points )) ||
-         (NULL == CU_add_test(pSuite, "for 3 Dimension Points", test_with_3dimension_points ))
+         (NULL == CU_add_test(pSuite, "for 3 Dimension Points", test_with_3dimension_points )) ||
+         (NULL == CU_add_test(pSuite, "for large coordinates", test_with_large_coordinates )) ||
+         (NULL == CU_add_test(pSuite, "for all the kernels", test_kernels_are_identical )) ||
+         (NULL == CU_add_test(pSuite, "for all the narrow kernels", test_narrow_kernels_are_identical )) ||
+         (NULL == CU_add_test(pSuite, "for the specialized loops", test_specialized_loops_are_identical )) ||
+         (NULL == CU_add_test(pSuite, "for the narrow loops", test_narrow_loops_are_identical ))
        ) 
     {
         CU_cleanup_registry();
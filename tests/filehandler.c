@@ -23,21 +23,20 @@
 
 #include "distance.h" 
 #include "filehandler.h"
-#include "arrayofclusters.h"
-#include "arrayofpoints.h"
+#include "labels.h"
 #include "point.h"
 
 void test_for_fileRead_nbOfPoints(){
     file_t theStruct;
 
-   fileRead(&theStruct ,"input_binary/example.bin");
-    CU_ASSERT_TRUE(theStruct.nbOfPoints == (uint64_t) 7);
-    fileRead(&theStruct ,"input_binary/manyPoints.bin");
-    CU_ASSERT_TRUE(theStruct.nbOfPoints == (uint64_t) 48);
-    fileRead(&theStruct ,"input_binary/lotsOfPoints.bin");
-    CU_ASSERT_TRUE(theStruct.nbOfPoints == (uint64_t) 33000);
-    fileRead(&theStruct ,"input_binary/triPoints.bin");
-    CU_ASSERT_TRUE(theStruct.nbOfPoints == (uint64_t) 9);
+   fileRead(&theStruct ,"input_binary/example.bin", 2);
+    CU_ASSERT_TRUE(theStruct.dataset.size == (uint64_t) 7);
+    fileRead(&theStruct ,"input_binary/manyPoints.bin", 2);
+    CU_ASSERT_TRUE(theStruct.dataset.size == (uint64_t) 48);
+    fileRead(&theStruct ,"input_binary/lotsOfPoints.bin", 2);
+    CU_ASSERT_TRUE(theStruct.dataset.size == (uint64_t) 33000);
+    fileRead(&theStruct ,"input_binary/triPoints.bin", 2);
+    CU_ASSERT_TRUE(theStruct.dataset.size == (uint64_t) 9);
     
 }
 /*Finding number of points in any different files*/
@@ -46,17 +45,17 @@ void test_for_fileRead_nbOfPoints(){
 void test_for_fileRead_dim(){
     file_t theStruct;
     
-    fileRead(&theStruct ,"input_binary/example.bin");
-    CU_ASSERT_TRUE(theStruct.dimension == (uint64_t) 2);
+    fileRead(&theStruct ,"input_binary/example.bin", 2);
+    CU_ASSERT_TRUE(theStruct.dataset.dimension == (uint64_t) 2);
     
-    fileRead(&theStruct ,"input_binary/manyPoints.bin");
-    CU_ASSERT_TRUE(theStruct.dimension == (uint64_t) 2); 
+    fileRead(&theStruct ,"input_binary/manyPoints.bin", 2);
+    CU_ASSERT_TRUE(theStruct.dataset.dimension == (uint64_t) 2); 
     
-    fileRead(&theStruct ,"input_binary/lotsOfPoints.bin");  
-    CU_ASSERT_TRUE(theStruct.dimension == (uint64_t) 2);
+    fileRead(&theStruct ,"input_binary/lotsOfPoints.bin", 2);  
+    CU_ASSERT_TRUE(theStruct.dataset.dimension == (uint64_t) 2);
     
-    fileRead(&theStruct ,"input_binary/3dPoints.bin");  
-    CU_ASSERT_TRUE(theStruct.dimension == (uint64_t) 3);
+    fileRead(&theStruct ,"input_binary/3dPoints.bin", 2);  
+    CU_ASSERT_TRUE(theStruct.dataset.dimension == (uint64_t) 3);
     
 }
 /* Finding dimension in many files*/
@@ -65,7 +64,7 @@ void test_for_fileRead_dim(){
 
 void test_for_fileRead_point_t(){
     file_t theStruct;
-   fileRead(&theStruct ,"input_binary/example.bin");
+   fileRead(&theStruct ,"input_binary/example.bin", 2);
 
     int table[7][2];
     int x[7]={1,2,3,5,3,5,4};
@@ -77,29 +76,31 @@ void test_for_fileRead_point_t(){
     }
 
     int b = 1;
-    for(int i=0;i<theStruct.nbOfPoints;i++){
-        for(int j=0;j<theStruct.dimension;j++){
-            if(table [i][j]!=(&theStruct)->ptrToPoints[i].values[j])
+    for(int i=0;i<theStruct.dataset.size;i++){
+        for(int j=0;j<theStruct.dataset.dimension;j++){
+            if(table [i][j]!=(&theStruct)->dataset.values[i * theStruct.dataset.dimension + j])
             {
                 b=0;
             }
         }
     }
     CU_ASSERT_TRUE(b);
+    CU_ASSERT_EQUAL(theStruct.minimum, 1);
+    CU_ASSERT_EQUAL(theStruct.maximum, 7);
 /*Iteration of the entire file to test our founction*/
 /*************************************************************************/
 
-   fileRead(&theStruct ,"input_binary/lotsOfPoints.bin");
-    int a =(&theStruct)->ptrToPoints[23569].values[0];
-    int c =theStruct.ptrToPoints[23569].values[1];
+   fileRead(&theStruct ,"input_binary/lotsOfPoints.bin", 2);
+    int a =(&theStruct)->dataset.values[23569 * 2];
+    int c =theStruct.dataset.values[23569 * 2 + 1];
     CU_ASSERT_TRUE(a==14);
     CU_ASSERT_TRUE(c==7);
 
 
-  fileRead(&theStruct ,"input_binary/triPoints.bin");
-    int p =(&theStruct)->ptrToPoints[6].values[0];
-    int q =theStruct.ptrToPoints[6].values[1];
-    int r =theStruct.ptrToPoints[6].values[2];
+  fileRead(&theStruct ,"input_binary/triPoints.bin", 2);
+    int p =(&theStruct)->dataset.values[6 * 3];
+    int q =theStruct.dataset.values[6 * 3 + 1];
+    int r =theStruct.dataset.values[6 * 3 + 2];
     CU_ASSERT_TRUE(p==75);
     CU_ASSERT_TRUE(q==89);
     CU_ASSERT_TRUE(r==63);
@@ -107,6 +108,87 @@ void test_for_fileRead_point_t(){
 /* Search of specific points  */
 /*************************************************************************/
 
+void test_for_fileRead_truncated(){
+    file_t theStruct;
+    char header[] = {0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 7}; // 7 points of dimension 2
+    char points[6 * 2 * 8] = {0}; // But only 6 of them are in the file
+
+    FILE * truncated = fopen("input_binary/truncated.bin", "wb");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(truncated);
+    fwrite(header, sizeof(header), 1, truncated);
+    fwrite(points, sizeof(points), 1, truncated);
+    fclose(truncated);
+
+    CU_ASSERT_EQUAL(fileRead(&theStruct ,"input_binary/truncated.bin", 2), -1);
+    CU_ASSERT_EQUAL(fileRead(&theStruct ,"input_binary/doesNotExist.bin", 2), -1);
+    remove("input_binary/truncated.bin");
+}
+/* The header must be coherent with the size of the file */
+/*************************************************************************/
+
+void test_for_fileOpenStream(){
+    file_t wholeFile;
+    file_t streamedFile;
+    dataset_t chunk;
+
+    CU_ASSERT_EQUAL_FATAL(fileRead(&wholeFile ,"input_binary/lotsOfPoints.bin", 2), 0);
+    CU_ASSERT_EQUAL_FATAL(fileOpenStream(&streamedFile ,"input_binary/lotsOfPoints.bin", 3), 0);
+    CU_ASSERT_EQUAL(streamedFile.nbOfPoints, wholeFile.dataset.size);
+    CU_ASSERT_EQUAL(streamedFile.dataset.size, 3);
+    CU_ASSERT_EQUAL(memcmp(streamedFile.dataset.values, wholeFile.dataset.values, sizeof(int64_t) * 3 * wholeFile.dataset.dimension), 0);
+
+    // Reading the points in the middle of the file
+    CU_ASSERT_EQUAL_FATAL(dataset_init(&chunk, 5, wholeFile.dataset.dimension), 0);
+    CU_ASSERT_EQUAL(fileReadPoints(&streamedFile, 7, &chunk), 0);
+    CU_ASSERT_EQUAL(memcmp(chunk.values, dataset_row(&wholeFile.dataset, 7), sizeof(int64_t) * 5 * chunk.dimension), 0);
+    dataset_destroy(&chunk);
+    freeFileStruct(&streamedFile);
+    freeFileStruct(&wholeFile);
+
+    CU_ASSERT_EQUAL(fileOpenStream(&streamedFile ,"input_binary/doesNotExist.bin", 3), -1);
+}
+/* A streamed file only keeps it's first points, the others are read on demand */
+/*************************************************************************/
+
+void test_for_filePrepare(){
+    file_t readFile;
+    file_t preparedFile;
+
+    CU_ASSERT_EQUAL_FATAL(fileRead(&readFile ,"input_binary/lotsOfPoints.bin", 2), 0);
+    CU_ASSERT_EQUAL(readFile.mapping, NULL);
+    CU_ASSERT_EQUAL(filePrepare(&readFile ,"input_binary/lotsOfPoints.bin"), 0);
+
+    // The next read maps the prepared copy, which holds the same points
+    CU_ASSERT_EQUAL_FATAL(fileRead(&preparedFile ,"input_binary/lotsOfPoints.bin", 2), 0);
+    CU_ASSERT_NOT_EQUAL(preparedFile.mapping, NULL);
+    CU_ASSERT_EQUAL(preparedFile.nbOfPoints, readFile.nbOfPoints);
+    CU_ASSERT_EQUAL(preparedFile.dataset.size, readFile.dataset.size);
+    CU_ASSERT_EQUAL(preparedFile.dataset.dimension, readFile.dataset.dimension);
+    CU_ASSERT_EQUAL(preparedFile.minimum, readFile.minimum);
+    CU_ASSERT_EQUAL(preparedFile.maximum, readFile.maximum);
+    CU_ASSERT_EQUAL((uintptr_t) preparedFile.dataset.values % DATASET_ALIGNMENT, 0);
+    CU_ASSERT_EQUAL(memcmp(preparedFile.dataset.values, readFile.dataset.values, sizeof(int64_t) * readFile.dataset.size * readFile.dataset.dimension), 0);
+    freeFileStruct(&preparedFile);
+    freeFileStruct(&readFile);
+
+    // A copy which doesn't come from the file as it is now is ignored
+    prepared_header_t header;
+    FILE * prepared = fopen("input_binary/lotsOfPoints.bin" FILE_PREPARED_SUFFIX, "r+b");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(prepared);
+    CU_ASSERT_EQUAL_FATAL(fread(&header, sizeof(header), 1, prepared), 1);
+    header.sourceSize++;
+    rewind(prepared);
+    CU_ASSERT_EQUAL_FATAL(fwrite(&header, sizeof(header), 1, prepared), 1);
+    fclose(prepared);
+    CU_ASSERT_EQUAL_FATAL(fileRead(&preparedFile ,"input_binary/lotsOfPoints.bin", 2), 0);
+    CU_ASSERT_EQUAL(preparedFile.mapping, NULL);
+    CU_ASSERT_EQUAL(preparedFile.dataset.size, 33000);
+    freeFileStruct(&preparedFile);
+    remove("input_binary/lotsOfPoints.bin" FILE_PREPARED_SUFFIX);
+}
+/* A prepared copy is mapped as is, while the input file is unchanged */
+/*************************************************************************/
+
 int main(int argc, char const *argv[])
 {
     if (CUE_SUCCESS != CU_initialize_registry())
@@ -120,7 +202,10 @@ int main(int argc, char const *argv[])
     if (
          (NULL == CU_add_test(pSuite, "for many different file", test_for_fileRead_dim )) ||
          (NULL == CU_add_test(pSuite, "for many different file", test_for_fileRead_nbOfPoints )) ||
-         (NULL == CU_add_test(pSuite, "for many different file", test_for_fileRead_point_t )) 
+         (NULL == CU_add_test(pSuite, "for many different file", test_for_fileRead_point_t )) ||
+         (NULL == CU_add_test(pSuite, "for a truncated file", test_for_fileRead_truncated )) ||
+         (NULL == CU_add_test(pSuite, "for a streamed file", test_for_fileOpenStream )) ||
+         (NULL == CU_add_test(pSuite, "for a prepared file", test_for_filePrepare )) 
        ) 
     {
         CU_cleanup_registry();
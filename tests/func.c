@@ -0,0 +1,396 @@
+/********************************************
+ * 
+ * This contains the CUnit tests for the file "src/func.c" and header "src/func.h"
+ * 
+ * For documentation and better understanding check the following website: 
+ * www.cunit.sourceforge.net/doc/index.html
+ * 
+ *******************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "CUnit/CUnit.h"
+#include "CUnit/Basic.h"
+#include "CUnit/Util.h"
+
+#include "func.h"
+#include "bounds.h"
+#include "kdtree.h"
+#include "dataset.h"
+#include "labels.h"
+#include "kernels.h"
+#include "distance.h"
+#include "team.h"
+#include "narrow.h"
+#include "filehandler.h"
+#include "memo.h"
+#include "argumentsparser.h"
+
+/**
+ * Runs k-means from a copy of the initial centroids, the result is freed by <test_func_free>.
+ */
+static void test_func_run(list_of_centroids_and_clusters_only * result, const dataset_t * initial,
+                          const dataset_t * points, kmeans_algorithm_t algorithm, team_t * team, const kdtree_t * tree,
+                          const narrow_t * narrowPoints)
+{
+    dataset_t centroids;
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&centroids, initial->size, initial->dimension), 0 );
+    dataset_copy(&centroids, initial);
+    CU_ASSERT_EQUAL_FATAL( k_means(result, &centroids, (uint32_t) initial->size, points, algorithm, team, tree,
+                                   narrowPoints, NULL, NULL), 0 );
+    // The final centroids are always new ones, the initial ones are left to the caller
+    dataset_destroy(&centroids);
+}
+
+static void test_func_free(list_of_centroids_and_clusters_only * result)
+{
+    dataset_destroy(result->finalCentroids);
+    free(result->finalCentroids);
+    labels_destroy(result->finalClusters);
+    free(result->finalClusters);
+}
+
+/**
+ * Checks that two runs end on the same centroids, labels and distortion, and optionally the same number of
+ * iterations.
+ */
+static void test_func_compare(const list_of_centroids_and_clusters_only * expected,
+                              const list_of_centroids_and_clusters_only * result, const dataset_t * points,
+                              bool iterations)
+{
+    uint64_t K = expected->finalCentroids->size;
+    uint64_t wrong = 0;
+    CU_ASSERT_EQUAL( result->distortion, expected->distortion );
+    if (iterations){ CU_ASSERT_EQUAL( result->iterations, expected->iterations ); }
+    CU_ASSERT_EQUAL( memcmp(result->finalCentroids->values, expected->finalCentroids->values,
+                            sizeof(int64_t) * K * points->dimension), 0 );
+    CU_ASSERT_EQUAL( memcmp(result->finalClusters->counts, expected->finalClusters->counts, sizeof(uint64_t) * K), 0 );
+    for (uint64_t i = 0; i < points->size; i++)
+    {
+        wrong += labels_get(result->finalClusters, i) != labels_get(expected->finalClusters, i);
+    }
+    CU_ASSERT_EQUAL( wrong, 0 );
+}
+
+/**
+ * Runs all the assignments on the points and compares them with Lloyd's, with both formulas.
+ */
+static void test_func_all_like_lloyd(const dataset_t * points, const dataset_t * initial, bool exact)
+{
+    squared_distance_func_t formulas[2] = { squared_manhattan_distance, squared_euclidean_distance };
+    kmeans_algorithm_t algorithms[4] = { KMEANS_ELKAN, KMEANS_HAMERLY, KMEANS_YINYANG, KMEANS_KDTREE };
+    kdtree_t tree;
+    CU_ASSERT_EQUAL_FATAL( kdtree_build(&tree, points), 0 );
+    for (uint32_t f = 0; f < 2; f++)
+    {
+        list_of_centroids_and_clusters_only expected;
+        FORMULA_CHOOSED = formulas[f];
+        CU_ASSERT_EQUAL( bounds_areExact(FORMULA_CHOOSED, points), exact );
+        test_func_run(&expected, initial, points, KMEANS_LLOYD, NULL, NULL, NULL);
+        for (uint32_t a = 0; a < 4; a++)
+        {
+            list_of_centroids_and_clusters_only result;
+            test_func_run(&result, initial, points, algorithms[a], NULL, &tree, NULL);
+            test_func_compare(&expected, &result, points, true);
+            test_func_free(&result);
+        }
+        test_func_free(&expected);
+    }
+    kdtree_destroy(&tree);
+}
+
+void test_kmeans_algorithms_are_identical()
+{
+    dataset_t points, initial;
+    uint32_t K = 6;
+    srand(17);
+
+    // Spread points
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&points, 3000, 3), 0 );
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&initial, K, 3), 0 );
+    for (uint64_t i = 0; i < points.size * points.dimension; i++){ points.values[i] = rand() % 2001 - 1000; }
+    for (uint32_t k = 0; k < K; k++){ memcpy(dataset_row(&initial, k), dataset_row(&points, 7 * k), sizeof(int64_t) * 3); }
+    test_func_all_like_lloyd(&points, &initial, true);
+    dataset_destroy(&points);
+    dataset_destroy(&initial);
+
+    // Few distinct coordinates, and twice the same initial centroid : many distances are equal, the first centroid
+    // wins the ties
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&points, 2000, 2), 0 );
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&initial, K, 2), 0 );
+    for (uint64_t i = 0; i < points.size * points.dimension; i++){ points.values[i] = rand() % 4 * 2; }
+    for (uint32_t k = 0; k < K; k++){ memcpy(dataset_row(&initial, k), dataset_row(&points, k), sizeof(int64_t) * 2); }
+    memcpy(dataset_row(&initial, 3), dataset_row(&initial, 1), sizeof(int64_t) * 2);
+    test_func_all_like_lloyd(&points, &initial, true);
+    dataset_destroy(&points);
+    dataset_destroy(&initial);
+
+    // Points far from the origin : the box holding them and the origin is too large for the bounds, so the accelerated
+    // assignments fall back on Lloyd's, while the distances between the points and their centroids still fit
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&points, 1000, 2), 0 );
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&initial, K, 2), 0 );
+    for (uint64_t i = 0; i < points.size * points.dimension; i++){ points.values[i] = ((int64_t) 1 << 31) + rand() % 2001; }
+    for (uint32_t k = 0; k < K; k++){ memcpy(dataset_row(&initial, k), dataset_row(&points, k), sizeof(int64_t) * 2); }
+    test_func_all_like_lloyd(&points, &initial, false);
+    dataset_destroy(&points);
+    dataset_destroy(&initial);
+
+    // The truncated means of the labels given by the centroids before the last ones are the last ones, while a label
+    // still changes : Lloyd's does one more iteration
+    int64_t values[8] = { 7, 0, 2, 2, 4, 5, 3, 8 };
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&points, 8, 1), 0 );
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&initial, 3, 1), 0 );
+    memcpy(points.values, values, sizeof(values));
+    memcpy(initial.values, values, sizeof(int64_t) * 3);
+    test_func_all_like_lloyd(&points, &initial, true);
+    dataset_destroy(&points);
+    dataset_destroy(&initial);
+}
+
+/**
+ * The runs meeting the centroids of a finished run take it's final centroids, and end like the runs without the
+ * table : the same clusters, after the same number of iterations.
+ */
+void test_memo_runs_count_like_lloyd()
+{
+    squared_distance_func_t formulas[2] = { squared_manhattan_distance, squared_euclidean_distance };
+    uint32_t K = 3;
+    uint32_t p = 10;
+    dataset_t points, initial;
+    srand(31);
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&points, 500, 2), 0 );
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&initial, K, 2), 0 );
+    for (uint64_t i = 0; i < points.size * points.dimension; i++){ points.values[i] = rand() % 21; }
+    for (uint32_t f = 0; f < 2; f++)
+    {
+        memo_t memo;
+        FORMULA_CHOOSED = formulas[f];
+        CU_ASSERT_EQUAL_FATAL( memo_init(&memo, K, 2, MEMO_BUDGET), 0 );
+        // All the initializations among the first p points, many of them meet the same centroids
+        for (uint32_t a = 0; a < p; a++)
+        {
+            for (uint32_t b = a + 1; b < p; b++)
+            {
+                for (uint32_t c = b + 1; c < p; c++)
+                {
+                    list_of_centroids_and_clusters_only expected, result;
+                    dataset_t centroids;
+                    memcpy(dataset_row(&initial, 0), dataset_row(&points, a), sizeof(int64_t) * 2);
+                    memcpy(dataset_row(&initial, 1), dataset_row(&points, b), sizeof(int64_t) * 2);
+                    memcpy(dataset_row(&initial, 2), dataset_row(&points, c), sizeof(int64_t) * 2);
+                    test_func_run(&expected, &initial, &points, KMEANS_LLOYD, NULL, NULL, NULL);
+                    CU_ASSERT_EQUAL_FATAL( dataset_init(&centroids, K, 2), 0 );
+                    dataset_copy(&centroids, &initial);
+                    CU_ASSERT_EQUAL_FATAL( k_means(&result, &centroids, K, &points, KMEANS_LLOYD, NULL, NULL, NULL, NULL,
+                                                   &memo), 0 );
+                    test_func_compare(&expected, &result, &points, true);
+                    test_func_free(&expected);
+                    test_func_free(&result);
+                    dataset_destroy(&centroids);
+                }
+            }
+        }
+        memo_destroy(&memo);
+    }
+    dataset_destroy(&points);
+    dataset_destroy(&initial);
+}
+
+/**
+ * The streamed runs stop when their centroids do not change anymore, and count their iterations like Lloyd's.
+ */
+void test_streamed_runs_count_like_lloyd()
+{
+    squared_distance_func_t formulas[2] = { squared_manhattan_distance, squared_euclidean_distance };
+    const char * names[2] = { "input_binary/streamed.bin", "input_binary/lotsOfPoints.bin" };
+    // The points of the last case of <test_kmeans_algorithms_are_identical>
+    int64_t values[8] = { 7, 0, 2, 2, 4, 5, 3, 8 };
+    unsigned char header[12] = { 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 8 };
+    uint32_t K = 3;
+
+    FILE * file = fopen(names[0], "wb");
+    CU_ASSERT_PTR_NOT_NULL_FATAL( file );
+    fwrite(header, sizeof(header), 1, file);
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        unsigned char bytes[8];
+        for (uint32_t b = 0; b < 8; b++){ bytes[b] = (unsigned char) ((uint64_t) values[i] >> (56 - 8 * b)); }
+        fwrite(bytes, sizeof(bytes), 1, file);
+    }
+    fclose(file);
+
+    for (uint32_t n = 0; n < 2; n++)
+    {
+        for (uint32_t f = 0; f < 2; f++)
+        {
+            file_t wholeFile, streamedFile;
+            dataset_t initial, centroids;
+            list_of_centroids_and_clusters_only expected, result;
+            FORMULA_CHOOSED = formulas[f];
+            CU_ASSERT_EQUAL_FATAL( fileRead(&wholeFile, names[n], 2), 0 );
+            CU_ASSERT_EQUAL_FATAL( fileOpenStream(&streamedFile, names[n], K), 0 );
+            uint32_t dim = wholeFile.dataset.dimension;
+            CU_ASSERT_EQUAL_FATAL( dataset_init(&initial, K, dim), 0 );
+            CU_ASSERT_EQUAL_FATAL( dataset_init(&centroids, K, dim), 0 );
+            memcpy(initial.values, wholeFile.dataset.values, sizeof(int64_t) * K * dim);
+            dataset_copy(&centroids, &initial);
+
+            test_func_run(&expected, &initial, &wholeFile.dataset, KMEANS_LLOYD, NULL, NULL, NULL);
+            CU_ASSERT_EQUAL_FATAL( k_means_streamed(&result, &centroids, K, &streamedFile, true), 0 );
+            test_func_compare(&expected, &result, &wholeFile.dataset, true);
+
+            test_func_free(&expected);
+            test_func_free(&result);
+            dataset_destroy(&initial);
+            dataset_destroy(&centroids);
+            freeFileStruct(&streamedFile);
+            freeFileStruct(&wholeFile);
+        }
+    }
+    remove(names[0]);
+}
+
+/**
+ * The sums kept from one iteration to the next, by moving the points that changed of cluster or by summing all the
+ * points again once more than a quarter of them moved, are the ones of a complete sum.
+ */
+void test_sums_follow_the_moves()
+{
+    squared_distance_func_t formulas[2] = { squared_manhattan_distance, squared_euclidean_distance };
+    uint64_t size = 400;
+    uint32_t K = 3;
+    uint32_t dim = 3;
+    srand(23);
+    for (uint32_t f = 0; f < 2; f++)
+    {
+        const lloyd_kernels_t * kernels = kernels_select(formulas[f], dim);
+        dataset_t points, centroids, sums, expected;
+        labels_t clusters;
+        moves_t moves;
+        uint64_t distortion;
+        CU_ASSERT_EQUAL_FATAL( dataset_init(&points, size, dim), 0 );
+        CU_ASSERT_EQUAL_FATAL( dataset_init(&centroids, K, dim), 0 );
+        CU_ASSERT_EQUAL_FATAL( dataset_init(&sums, K, dim), 0 );
+        CU_ASSERT_EQUAL_FATAL( dataset_init(&expected, K, dim), 0 );
+        CU_ASSERT_EQUAL_FATAL( labels_init(&clusters, size, K), 0 );
+        // The capacity given by k_means
+        CU_ASSERT_EQUAL_FATAL( moves_init(&moves, size / 4), 0 );
+        for (uint64_t i = 0; i < size * dim; i++){ points.values[i] = rand() % 41 - 20; }
+        for (uint32_t k = 0; k < K; k++){ memcpy(dataset_row(&centroids, k), dataset_row(&points, k), sizeof(int64_t) * dim); }
+
+        for (uint32_t step = 0; step < 4; step++)
+        {
+            if (step == 1 || step == 3)
+            {
+                // Swapping two centroids moves all the points of both clusters
+                for (uint32_t m = 0; m < dim; m++)
+                {
+                    int64_t value = dataset_row(&centroids, 0)[m];
+                    dataset_row(&centroids, 0)[m] = dataset_row(&centroids, 1)[m];
+                    dataset_row(&centroids, 1)[m] = value;
+                }
+            } else if (step == 2) {
+                // A small step of one centroid only moves the points near the borders of it's cluster
+                dataset_row(&centroids, 2)[0] += 3;
+            }
+            moves_clear(&moves);
+            assign_vectors_to_centroids(&centroids, &points, &clusters, &moves, &distortion, kernels);
+            // All the points start in the first cluster, so most of them move at the first assignment
+            CU_ASSERT_EQUAL( moves.overflow, step != 2 );
+            if (step == 2){ CU_ASSERT_TRUE( moves.size > 0 ); }
+            update_sums(&sums, &points, &clusters, &moves, step == 0, kernels);
+
+            memset(expected.values, 0, sizeof(int64_t) * K * dim);
+            kernels->accumulate(expected.values, &points, &clusters, 0, size);
+            CU_ASSERT_EQUAL( memcmp(sums.values, expected.values, sizeof(int64_t) * K * dim), 0 );
+        }
+        dataset_destroy(&points);
+        dataset_destroy(&centroids);
+        dataset_destroy(&sums);
+        dataset_destroy(&expected);
+        labels_destroy(&clusters);
+        moves_destroy(&moves);
+    }
+}
+
+/**
+ * The iterations of Lloyd split between the members of a team, whose partial counts and sums are added at the end of
+ * each iteration, give the run of the thread alone, with the points in int64_t or narrowed.
+ */
+void test_teams_are_identical()
+{
+    squared_distance_func_t formulas[2] = { squared_manhattan_distance, squared_euclidean_distance };
+    uint32_t sizes[3] = { 1, 2, 4 };
+    uint64_t size = 20000;
+    uint32_t K = 4;
+    uint32_t dim = 4;
+    dataset_t points, initial;
+    srand(29);
+    // Enough work for the 4 members (see LLOYD_WORK_PER_MEMBER)
+    CU_ASSERT_EQUAL_FATAL( size * K * dim / LLOYD_WORK_PER_MEMBER >= 4, true );
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&points, size, dim), 0 );
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&initial, K, dim), 0 );
+    for (uint64_t i = 0; i < size * dim; i++){ points.values[i] = rand() % 2001 - 1000; }
+    for (uint32_t k = 0; k < K; k++){ memcpy(dataset_row(&initial, k), dataset_row(&points, k), sizeof(int64_t) * dim); }
+
+    for (uint32_t f = 0; f < 2; f++)
+    {
+        narrow_t layout, narrowPoints;
+        FORMULA_CHOOSED = formulas[f];
+        CU_ASSERT_TRUE_FATAL( narrow_choose(&layout, FORMULA_CHOOSED, dim, -1000, 1000) );
+        CU_ASSERT_EQUAL_FATAL( narrow_init(&narrowPoints, &layout, size), 0 );
+        CU_ASSERT_EQUAL_FATAL( narrow_pack(&narrowPoints, &points), 0 );
+        for (uint32_t narrowed = 0; narrowed < 2; narrowed++)
+        {
+            list_of_centroids_and_clusters_only expected;
+            const narrow_t * narrow = narrowed ? &narrowPoints : NULL;
+            test_func_run(&expected, &initial, &points, KMEANS_LLOYD, NULL, NULL, narrow);
+            for (uint32_t s = 0; s < 3; s++)
+            {
+                list_of_centroids_and_clusters_only result;
+                team_t team;
+                CU_ASSERT_EQUAL_FATAL( team_init(&team, sizes[s]), 0 );
+                CU_ASSERT_EQUAL( team_size(&team), sizes[s] );
+                test_func_run(&result, &initial, &points, KMEANS_LLOYD, &team, NULL, narrow);
+                test_func_compare(&expected, &result, &points, true);
+                test_func_free(&result);
+                team_destroy(&team);
+            }
+            test_func_free(&expected);
+        }
+        narrow_destroy(&narrowPoints);
+    }
+    dataset_destroy(&points);
+    dataset_destroy(&initial);
+}
+
+int main(int argc, char const *argv[])
+{
+    if (CUE_SUCCESS != CU_initialize_registry())
+    {
+        return CU_get_error();
+    }
+ 
+    CU_pSuite pSuite = NULL;
+    pSuite = CU_add_suite("Tests for local header <func.h>", NULL, NULL );
+
+    if ( (NULL == CU_add_test(pSuite, "for the algorithms giving the same clusters", test_kmeans_algorithms_are_identical )) ||
+         (NULL == CU_add_test(pSuite, "for the streamed runs", test_streamed_runs_count_like_lloyd )) ||
+         (NULL == CU_add_test(pSuite, "for the runs meeting a finished one", test_memo_runs_count_like_lloyd )) ||
+         (NULL == CU_add_test(pSuite, "for the sums following the moves", test_sums_follow_the_moves )) ||
+         (NULL == CU_add_test(pSuite, "for the teams of 1, 2 and 4 members", test_teams_are_identical ))
+       ) 
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    printf("\n");
+
+    return 0;
+}
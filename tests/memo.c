@@ -0,0 +1,99 @@
+/********************************************
+ * 
+ * This contains the CUnit tests for the file "src/memo.c" and header "src/memo.h"
+ * 
+ * For documentation and better understanding check the following website: 
+ * www.cunit.sourceforge.net/doc/index.html
+ * 
+ *******************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "CUnit/CUnit.h"
+#include "CUnit/Basic.h"
+#include "CUnit/Util.h"
+
+#include "memo.h"
+#include "dataset.h"
+
+void test_memo_finds_the_known_centroids()
+{
+    memo_t memo;
+    memo_trajectory_t trajectory = { .states = NULL };
+    dataset_t centroids, final, other;
+    CU_ASSERT_EQUAL_FATAL( memo_init(&memo, 2, 3, MEMO_BUDGET), 0 );
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&centroids, 2, 3), 0 );
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&final, 2, 3), 0 );
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&other, 2, 3), 0 );
+    int64_t values[6] = { 1, -2, 3, 40, 50, -60 };
+    for (uint32_t m = 0; m < 3; m++)
+    {
+        dataset_row(&centroids, 0)[m] = values[m];
+        dataset_row(&centroids, 1)[m] = values[3 + m];
+        dataset_row(&final, 0)[m] = values[m] + 1;
+        dataset_row(&final, 1)[m] = values[3 + m] - 1;
+        // The same centroids in the other order are another state
+        dataset_row(&other, 0)[m] = values[3 + m];
+        dataset_row(&other, 1)[m] = values[m];
+    }
+
+    CU_ASSERT_FALSE( memo_find(&memo, &centroids, NULL) );
+    CU_ASSERT_EQUAL_FATAL( memo_record(&trajectory, &centroids), 0 );
+    CU_ASSERT_EQUAL_FATAL( memo_record(&trajectory, &final), 0 );
+    CU_ASSERT_EQUAL( trajectory.size, 2 );
+    memo_insert(&memo, &trajectory, &final, 5);
+    memo_insert(&memo, &trajectory, &final, 5);
+
+    CU_ASSERT_FALSE( memo_find(&memo, &other, NULL) );
+    uint64_t remaining = 0;
+    CU_ASSERT_TRUE( memo_find(&memo, &centroids, &remaining) );
+    // Met at the second iteration of the five
+    CU_ASSERT_EQUAL( remaining, 4 );
+    for (uint32_t k = 0; k < 2; k++)
+    {
+        CU_ASSERT_EQUAL( memcmp(dataset_row(&centroids, k), dataset_row(&final, k), sizeof(int64_t) * 3), 0 );
+    }
+    CU_ASSERT_TRUE( memo_find(&memo, &final, &remaining) );
+    CU_ASSERT_EQUAL( remaining, 3 );
+
+    // Past the budget the trajectories are dropped
+    memo_t small;
+    CU_ASSERT_EQUAL_FATAL( memo_init(&small, 2, 3, 1), 0 );
+    memo_insert(&small, &trajectory, &final, 5);
+    CU_ASSERT_FALSE( memo_find(&small, &other, NULL) );
+    CU_ASSERT_FALSE( memo_find(&small, &final, NULL) );
+    memo_destroy(&small);
+
+    memo_trajectory_destroy(&trajectory);
+    memo_destroy(&memo);
+    dataset_destroy(&centroids);
+    dataset_destroy(&final);
+    dataset_destroy(&other);
+}
+
+int main(int argc, char const *argv[])
+{
+    if (CUE_SUCCESS != CU_initialize_registry())
+    {
+        return CU_get_error();
+    }
+ 
+    CU_pSuite pSuite = NULL;
+    pSuite = CU_add_suite("Tests for local header <memo.h>", NULL, NULL );
+
+    if ( (NULL == CU_add_test(pSuite, "for the table of the trajectories", test_memo_finds_the_known_centroids ))
+       ) 
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    printf("\n");
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+/********************************************
+ * 
+ * This contains the CUnit tests for the file "src/minibatch.c" and header "src/minibatch.h"
+ * 
+ * For documentation and better understanding check the following website: 
+ * www.cunit.sourceforge.net/doc/index.html
+ * 
+ *******************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "CUnit/CUnit.h"
+#include "CUnit/Basic.h"
+#include "CUnit/Util.h"
+
+#include "minibatch.h"
+#include "func.h"
+#include "dataset.h"
+#include "labels.h"
+#include "kernels.h"
+#include "distance.h"
+#include "argumentsparser.h"
+
+/**
+ * Two groups of points whose squared euclidean distances pass INT64_MAX : the batches still give each point to it's
+ * closest centroid, so the first centroid keeps the small points and the second one moves to the large ones.
+ */
+void test_minibatch_with_large_distances()
+{
+    int64_t values[6] = { 0, 1, 2, 3, 3100000000, 3100000001 };
+    dataset_t points, initial;
+    list_of_centroids_and_clusters_only result;
+    FORMULA_CHOOSED = squared_euclidean_distance;
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&points, 6, 1), 0 );
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&initial, 2, 1), 0 );
+    memcpy(points.values, values, sizeof(values));
+    memcpy(initial.values, values, sizeof(int64_t) * 2);
+
+    CU_ASSERT_EQUAL_FATAL( minibatch_kmeans(&result, &initial, 2, &points, 6, 5), 0 );
+    const int64_t * centroids = result.finalCentroids->values;
+    CU_ASSERT_TRUE( centroids[0] >= 0 && centroids[0] <= 3 );
+    CU_ASSERT_TRUE( centroids[1] > 3 && centroids[1] <= 3100000001 );
+    for (uint64_t i = 0; i < 6; i++){ CU_ASSERT_EQUAL( labels_get(result.finalClusters, i), (i < 4) ? 0 : 1 ); }
+    const lloyd_kernels_t * kernels = kernels_select(FORMULA_CHOOSED, 1);
+    CU_ASSERT_EQUAL( result.distortion, kernels->distortion(result.finalCentroids, &points, result.finalClusters, 0, 6) );
+
+    dataset_destroy(result.finalCentroids);
+    free(result.finalCentroids);
+    labels_destroy(result.finalClusters);
+    free(result.finalClusters);
+    dataset_destroy(&points);
+    dataset_destroy(&initial);
+}
+
+int main(int argc, char const *argv[])
+{
+    if (CUE_SUCCESS != CU_initialize_registry())
+    {
+        return CU_get_error();
+    }
+ 
+    CU_pSuite pSuite = NULL;
+    pSuite = CU_add_suite("Tests for local header <minibatch.h>", NULL, NULL );
+
+    if ( (NULL == CU_add_test(pSuite, "for distances past INT64_MAX", test_minibatch_with_large_distances ))
+       ) 
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    printf("\n");
+
+    return 0;
+}
@@ -1,6 +1,6 @@
 /********************************************
  * 
- * This contains the CUnit tests for the file "src/distance.c" and header "src/distance.h"
+ * This contains the CUnit tests for the file "src/point.c" and header "src/point.h", and the writer "src/csv.c"
  * 
  * For documentation and better understanding check the following website: 
  * www.cunit.sourceforge.net/doc/index.html
@@ -23,6 +23,48 @@
 #include "CUnit/Util.h"
 
 #include "point.h" 
+#include "csv.h"
+#include "dataset.h"
+
+/**
+ * Returns what was written to the file, and closes it.
+ */
+static char * readBack(FILE * file)
+{
+    off_t size = lseek(fileno(file), 0, SEEK_END);
+    char * content = (char *) malloc((size_t) size + 1);
+    if (pread(fileno(file), content, (size_t) size, 0) != size){ content[0] = '\0'; }
+    else { content[size] = '\0'; }
+    fclose(file);
+    return content;
+}
+
+static char * pointToString(point_t * point)
+{
+    FILE * file = tmpfile();
+    csv_t csv;
+    csv_init(&csv, file);
+    CU_ASSERT_EQUAL( pointToCSV(&csv, point), 0 );
+    CU_ASSERT_EQUAL( csv_destroy(&csv), 0 );
+    return readBack(file);
+}
+
+static char * pointArrayToString(point_t * points, uint64_t size)
+{
+    dataset_t dataset;
+    dataset_init(&dataset, size, points[0].dimension);
+    for (uint64_t i = 0; i < size; i++)
+    {
+        memcpy(dataset_row(&dataset, i), points[i].values, sizeof(int64_t) * points[i].dimension);
+    }
+    FILE * file = tmpfile();
+    csv_t csv;
+    csv_init(&csv, file);
+    CU_ASSERT_EQUAL( dataset_writeToCSV(&csv, &dataset, false), 0 );
+    CU_ASSERT_EQUAL( csv_destroy(&csv), 0 );
+    dataset_destroy(&dataset);
+    return readBack(file);
+}
 
 void test_for_pointToString_1Dimension(){
     uint32_t dim1 = 1;
@@ -161,6 +203,51 @@ void test_for_pointArrayToString_with_2Dimension_points(){
     free(ansForArr_4);
 }
 
+void test_for_formatInt64_like_printf(){
+    int64_t values[] = { 0, 1, -1, 9, 10, -10, 99, 100, -100, 999, 1000, 65535, -65536, 1234567890123456789LL,
+                         INT64_MAX, INT64_MIN, INT64_MIN + 1 };
+    char expected[32];
+    char formatted[CSV_INT64_LENGTH + 1];
+    for (size_t i = 0; i < sizeof(values) / sizeof(int64_t); i++)
+    {
+        snprintf(expected, sizeof(expected), "%lld", (long long int) values[i]);
+        *csv_formatInt64(formatted, values[i]) = '\0';
+        CU_ASSERT_STRING_EQUAL(formatted, expected);
+    }
+    // Around each power of ten
+    for (int64_t power = 1; power <= INT64_MAX / 10; power *= 10)
+    {
+        for (int64_t delta = -1; delta <= 1; delta++)
+        {
+            int64_t value = power * 10 + delta;
+            snprintf(expected, sizeof(expected), "%lld", (long long int) -value);
+            *csv_formatInt64(formatted, -value) = '\0';
+            CU_ASSERT_STRING_EQUAL(formatted, expected);
+        }
+    }
+}
+
+void test_for_csv_larger_than_the_buffer(){
+    // The rows are written when the buffer is full, in order
+    FILE * file = tmpfile();
+    csv_t csv;
+    csv_init(&csv, file);
+    fprintf(file, "header\n");
+    uint64_t expectedSize = 7;
+    for (int64_t i = 0; i < 300000; i++)
+    {
+        CU_ASSERT_EQUAL( csv_putInt64(&csv, i * 7919 - 1000000), 0 );
+        CU_ASSERT_EQUAL( csv_putBytes(&csv, "\n", 1), 0 );
+        char line[32];
+        expectedSize += (uint64_t) snprintf(line, sizeof(line), "%lld\n", (long long int) (i * 7919 - 1000000));
+    }
+    CU_ASSERT_EQUAL( csv_destroy(&csv), 0 );
+    char * content = readBack(file);
+    CU_ASSERT_EQUAL( strlen(content), expectedSize );
+    CU_ASSERT_EQUAL( strncmp(content, "header\n-1000000\n-992081\n", 24), 0 );
+    free(content);
+}
+
 int main(int argc, char const *argv[])
 {
     if (CUE_SUCCESS != CU_initialize_registry())
@@ -174,7 +261,10 @@ int main(int argc, char const *argv[])
     if ( (NULL == CU_add_test(pSuite, "for pointToString with 1 Dimension Points", test_for_pointToString_1Dimension )) ||
          (NULL == CU_add_test(pSuite, "for pointToString with 2 Dimension Points", test_for_pointToString_2Dimension )) || 
          (NULL == CU_add_test(pSuite, "for pointToString with 3 Dimension Points", test_for_pointToString_3Dimension )) ||
-         (NULL == CU_add_test(pSuite, "for pointArrayToString with 1 Dimension Points", test_for_pointArrayToString_with_1Dimension_points ))
+         (NULL == CU_add_test(pSuite, "for pointArrayToString with 1 Dimension Points", test_for_pointArrayToString_with_1Dimension_points )) ||
+         (NULL == CU_add_test(pSuite, "for pointArrayToString with 2 Dimension Points", test_for_pointArrayToString_with_2Dimension_points )) ||
+         (NULL == CU_add_test(pSuite, "for the numbers written like printf", test_for_formatInt64_like_printf )) ||
+         (NULL == CU_add_test(pSuite, "for rows larger than the buffer", test_for_csv_larger_than_the_buffer ))
        ) 
     {
         CU_cleanup_registry();
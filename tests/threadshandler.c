@@ -26,6 +26,14 @@
 #include "CUnit/Util.h"
 
 #include "threadshandler.h" 
+#include "circularbuffer.h"
+#include "pool.h"
+#include "affinity.h"
+#include "planner.h"
+
+#define TEST_RING_PRODUCERS 4
+#define TEST_RING_CONSUMERS 3
+#define TEST_RING_ITEMS 20000
 
 void test_with_2_threads()
 {    
@@ -61,6 +69,208 @@ void test_with_2_threads()
     CU_ASSERT_TRUE(timeWithTwoThread < timeWithOneThread);
 }
 
+/**
+ * The items of the test of the buffer, and the number of times each one was taken.
+ */
+static uint32_t ringItems[TEST_RING_PRODUCERS * TEST_RING_ITEMS];
+static uint32_t ringTaken[TEST_RING_PRODUCERS * TEST_RING_ITEMS];
+static circular_buf ring;
+
+static void * test_ring_producer(void * arg)
+{
+    uint32_t producer = (uint32_t) (uintptr_t) arg;
+    void * batch[5];
+    // Alternately one item and batches of 5, in order
+    for (uint32_t i = 0; i < TEST_RING_ITEMS; )
+    {
+        uint32_t count = (i % 2 == 0 || TEST_RING_ITEMS - i < 5) ? 1 : 5;
+        for (uint32_t j = 0; j < count; j++){ batch[j] = &ringItems[producer * TEST_RING_ITEMS + i + j]; }
+        int anErrorOccured;
+        if (circularbuffer_putMany(&ring, &anErrorOccured, batch, count) != 0){ return NULL; }
+        i += count;
+    }
+    return NULL;
+}
+
+static void * test_ring_consumer(void * arg)
+{
+    void * batch[CIRCULARBUFFER_BATCH];
+    uint32_t got;
+    int noProducersLeftAndBufferEmpty;
+    uint32_t last[TEST_RING_PRODUCERS];
+    memset(last, 0, sizeof(last));
+    while (circularbuffer_getMany(&ring, &noProducersLeftAndBufferEmpty, batch, CIRCULARBUFFER_BATCH, &got) == 0)
+    {
+        for (uint32_t i = 0; i < got; i++)
+        {
+            uint32_t item = *(uint32_t *) batch[i];
+            __atomic_fetch_add(&ringTaken[item], 1, __ATOMIC_RELAXED);
+            // A consumer gets the items of a producer in their order
+            uint32_t producer = item / TEST_RING_ITEMS;
+            CU_ASSERT_TRUE( last[producer] == 0 || item % TEST_RING_ITEMS >= last[producer] );
+            last[producer] = item % TEST_RING_ITEMS + 1;
+        }
+    }
+    CU_ASSERT_EQUAL( noProducersLeftAndBufferEmpty, 1 );
+    return NULL;
+}
+
+void test_circularbuffer_many_producers_and_consumers()
+{
+    pthread_t producers[TEST_RING_PRODUCERS];
+    pthread_t consumers[TEST_RING_CONSUMERS];
+    for (uint32_t i = 0; i < TEST_RING_PRODUCERS * TEST_RING_ITEMS; i++)
+    {
+        ringItems[i] = i;
+        ringTaken[i] = 0;
+    }
+    CU_ASSERT_EQUAL_FATAL( circulabuffer_init(&ring, 3), 0 );
+    CU_ASSERT_EQUAL( ring.maxSize, 4 );
+    for (uint32_t i = 0; i < TEST_RING_CONSUMERS; i++)
+    {
+        CU_ASSERT_EQUAL_FATAL( pthread_create(&consumers[i], NULL, test_ring_consumer, NULL), 0 );
+    }
+    for (uint32_t i = 0; i < TEST_RING_PRODUCERS; i++)
+    {
+        CU_ASSERT_EQUAL_FATAL( pthread_create(&producers[i], NULL, test_ring_producer, (void *) (uintptr_t) i), 0 );
+    }
+    for (uint32_t i = 0; i < TEST_RING_PRODUCERS; i++){ pthread_join(producers[i], NULL); }
+    circularbuffer_setDone(&ring);
+    wakeAllConsumers(&ring);
+    for (uint32_t i = 0; i < TEST_RING_CONSUMERS; i++){ pthread_join(consumers[i], NULL); }
+
+    uint32_t wrong = 0;
+    for (uint32_t i = 0; i < TEST_RING_PRODUCERS * TEST_RING_ITEMS; i++){ wrong += ringTaken[i] != 1; }
+    CU_ASSERT_EQUAL( wrong, 0 );
+
+    // Once done, the puts fail
+    int anErrorOccured;
+    CU_ASSERT_EQUAL( circularbuffer_put(&ring, &anErrorOccured, &ringItems[0]), -1 );
+    CU_ASSERT_EQUAL( anErrorOccured, 1 );
+    circularbuffer_destroy(&ring);
+}
+
+/**
+ * The parts of the jobs of the test of the pool : each part adds it's member to it's own slot.
+ */
+static uint64_t poolParts[TEST_RING_PRODUCERS * 8];
+static uint32_t poolWorks;
+static uint32_t poolWrongSplits;
+
+static void test_pool_job(void * arg, uint32_t member, uint32_t nbOfMembers)
+{
+    uint64_t * parts = (uint64_t *) arg;
+    parts[member] += member + 1;
+    if (nbOfMembers != TEST_RING_PRODUCERS){ __atomic_fetch_add(&poolWrongSplits, 1, __ATOMIC_RELAXED); }
+}
+
+static void test_pool_work(void * arg, team_t * team)
+{
+    __atomic_fetch_add(&poolWorks, 1, __ATOMIC_RELAXED);
+    // Only the first worker has jobs, the others take their parts
+    if (team->worker != 0){ return; }
+    uint64_t * parts = (uint64_t *) arg;
+    for (uint32_t i = 0; i < 1000; i++){ team_run(team, 8, test_pool_job, parts); }
+}
+
+void test_pool_shares_the_jobs()
+{
+    pool_t pool;
+    memset(poolParts, 0, sizeof(poolParts));
+    poolWorks = 0;
+    poolWrongSplits = 0;
+    CU_ASSERT_EQUAL_FATAL( pool_init(&pool, TEST_RING_PRODUCERS, TEST_RING_PRODUCERS), 0 );
+    CU_ASSERT_EQUAL( pool.teams[1].size, TEST_RING_PRODUCERS );
+    CU_ASSERT_EQUAL( pool_run(&pool, test_pool_work, poolParts), 0 );
+    CU_ASSERT_EQUAL( poolWorks, TEST_RING_PRODUCERS );
+    CU_ASSERT_EQUAL( poolWrongSplits, 0 );
+    // The parts are capped to the size of the pool, each one done once per job
+    for (uint32_t member = 0; member < 8; member++)
+    {
+        CU_ASSERT_EQUAL( poolParts[member], (member < TEST_RING_PRODUCERS) ? 1000 * (member + 1) : 0 );
+    }
+    pool_destroy(&pool);
+}
+
+void test_affinity_places_the_points()
+{
+    affinity_t affinity;
+    dataset_t points;
+    affinity_replicas_t replicas;
+    // Two simulated nodes, the workers are spread over them
+    CU_ASSERT_EQUAL_FATAL( affinity_init(&affinity, NULL, "0-1/2-3", true), 0 );
+    CU_ASSERT_EQUAL( affinity.nbOfNodes, 2 );
+    CU_ASSERT_TRUE( affinity.simulated );
+    CU_ASSERT_EQUAL( affinity_nodeOfWorker(&affinity, 0), 0 );
+    CU_ASSERT_EQUAL( affinity_nodeOfWorker(&affinity, 1), 1 );
+    CU_ASSERT_EQUAL( affinity_nodeOfWorker(&affinity, 2), 0 );
+    CU_ASSERT_EQUAL( affinity_nodeOfWorker(&affinity, 5), 1 );
+    CU_ASSERT_EQUAL_FATAL( dataset_init(&points, 1001, 3), 0 );
+    for (uint64_t i = 0; i < points.size * points.dimension; i++){ points.values[i] = (int64_t) (i * 7919 % 1000) - 500; }
+
+    CU_ASSERT_EQUAL_FATAL( affinity_place(&replicas, &affinity, AFFINITY_NUMA_REPLICATE, &points, NULL), 0 );
+    CU_ASSERT_EQUAL( replicas.nbOfReplicas, 2 );
+    for (uint32_t r = 0; r < replicas.nbOfReplicas; r++)
+    {
+        CU_ASSERT_EQUAL( replicas.points[r].size, points.size );
+        CU_ASSERT_EQUAL( memcmp(replicas.points[r].values, points.values, sizeof(int64_t) * 1001 * 3), 0 );
+    }
+    affinity_destroyReplicas(&replicas);
+
+    CU_ASSERT_EQUAL_FATAL( affinity_place(&replicas, &affinity, AFFINITY_NUMA_PARTITION, &points, NULL), 0 );
+    CU_ASSERT_EQUAL( replicas.nbOfReplicas, 1 );
+    CU_ASSERT_EQUAL( memcmp(replicas.points[0].values, points.values, sizeof(int64_t) * 1001 * 3), 0 );
+    affinity_destroyReplicas(&replicas);
+
+    dataset_destroy(&points);
+    affinity_destroy(&affinity);
+}
+
+void test_planner_splits_the_threads()
+{
+    plan_t plan;
+    args_t args;
+    memset(&args, 0, sizeof(args_t));
+    args.k = 3;
+    args.algorithm = KMEANS_LLOYD;
+    planner_init(&plan);
+    CU_ASSERT_TRUE( plan.cpus >= 1 );
+    plan.cpus = 8;
+    plan.memory = (uint64_t) 1 << 40;
+
+    // A single large run : all the cpus work on it's parts
+    args.n_first_initialization_points = 3;
+    planner_plan(&plan, &args, 1000000, 4);
+    CU_ASSERT_EQUAL( plan.runs, 1 );
+    CU_ASSERT_EQUAL( plan.inter, 1 );
+    CU_ASSERT_EQUAL( plan.intra, 8 );
+    CU_ASSERT_EQUAL( plan.workers, 8 );
+
+    // Many small runs : one thread per run, not split
+    args.n_first_initialization_points = 10;
+    planner_plan(&plan, &args, 1000, 2);
+    CU_ASSERT_EQUAL( plan.inter, 8 );
+    CU_ASSERT_EQUAL( plan.intra, 1 );
+    CU_ASSERT_EQUAL( plan.workers, 8 );
+    CU_ASSERT_EQUAL( plan.queue, 16 );
+
+    // The bounds of Elkan only leave room for two runs at once, no thread is left without work
+    args.algorithm = KMEANS_ELKAN;
+    plan.memory = 100000000;
+    planner_plan(&plan, &args, 1000000, 2);
+    CU_ASSERT_EQUAL( plan.inter, 2 );
+    CU_ASSERT_EQUAL( plan.intra, 1 );
+    CU_ASSERT_EQUAL( plan.workers, 2 );
+    CU_ASSERT_FALSE( plan.given );
+
+    // -n is kept as given
+    args.n_threads = 5;
+    planner_plan(&plan, &args, 1000000, 2);
+    CU_ASSERT_EQUAL( plan.workers, 5 );
+    CU_ASSERT_EQUAL( plan.inter, 2 );
+    CU_ASSERT_TRUE( plan.given );
+}
+
 int main(int argc, char const *argv[])
 {
     if (CUE_SUCCESS != CU_initialize_registry())
@@ -71,7 +281,11 @@ int main(int argc, char const *argv[])
     CU_pSuite pSuite = NULL;
     pSuite = CU_add_suite("Tests for local header <threadsHandler.h> and main.c", NULL, NULL );
 
-    if ( NULL == CU_add_test(pSuite, "for 2 Threads", test_with_2_threads ) )
+    if ( (NULL == CU_add_test(pSuite, "for 2 Threads", test_with_2_threads )) ||
+         (NULL == CU_add_test(pSuite, "for the buffer between the threads", test_circularbuffer_many_producers_and_consumers )) ||
+         (NULL == CU_add_test(pSuite, "for the pool of workers", test_pool_shares_the_jobs )) ||
+         (NULL == CU_add_test(pSuite, "for the points placed on the nodes", test_affinity_places_the_points )) ||
+         (NULL == CU_add_test(pSuite, "for the plan of the threads", test_planner_splits_the_threads )) )
     {
         CU_cleanup_registry();
         return CU_get_error();